@@ -0,0 +1,675 @@
+/*
+ * main.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * rr-perf, native benchmark of model loading and simulation. Times each
+ * phase of working with a model separately:
+ *
+ * parse:          libSBML parsing of the document
+ * load:           RoadRunner::load, always with RECOMPILE so that the model
+ *                 is generated on every repetition and not taken from the
+ *                 model cache.
+ * codegen_jit:    load minus parse, the model generation and JIT part of
+ *                 the load.
+ * first_simulate: the first simulation after loading.
+ * simulate:       a subsequent simulation of the same model.
+ * steady_state:   RoadRunner::steadyState from the initial conditions.
+ * stochastic:     a Gillespie simulation (stochastic models only).
+ *
+ * The models are the bioinf benchmark set from
+ * autotest/python-benchmark-bioinf, with the same integrator settings as
+ * rr_bench_ode.py and rr_bench_stoch.py, and the SBML ODE Solver benchmark
+ * set from data/sosbench, with the settings from each case's settings file.
+ *
+ * Each phase is repeated a number of times, and the statistics of the
+ * repetitions are written as JSON, so that the results can be tracked
+ * between releases, and the effect of load options compared, each -c
+ * option adds a configuration that all of the models are run with.
+ */
+
+#include "rrRoadRunner.h"
+#include "rrRoadRunnerOptions.h"
+#include "rrSBMLReader.h"
+#include "rrVersionInfo.h"
+#include "rrLogger.h"
+#include "rrStringUtils.h"
+#include "Integrator.h"
+
+#include <sbml/SBMLReader.h>
+#include <sbml/SBMLDocument.h>
+
+#include <Poco/Timestamp.h>
+#include <Poco/File.h>
+#include <Poco/Path.h>
+#include <Poco/DirectoryIterator.h>
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <stdexcept>
+#include <math.h>
+#include <stdlib.h>
+
+using namespace rr;
+using namespace std;
+
+#ifndef RR_PERF_BIOINF_DIR
+#define RR_PERF_BIOINF_DIR "autotest/python-benchmark-bioinf"
+#endif
+
+#ifndef RR_PERF_SOSBENCH_DIR
+#define RR_PERF_SOSBENCH_DIR "data/sosbench"
+#endif
+
+/**
+ * a model and how to simulate it.
+ */
+struct BenchModel
+{
+    string set;
+    string name;
+    string path;
+    double start;
+    double duration;
+    int steps;
+    double absolute;
+    double relative;
+    bool stochastic;
+};
+
+/**
+ * a set of load options that all the models are run with.
+ */
+struct BenchConfig
+{
+    string name;
+    uint32_t modelGeneratorOpt;
+};
+
+/**
+ * timings of one phase in seconds, one value per repetition.
+ */
+typedef map<string, vector<double> > Timings;
+
+static const char* phases[] = {
+    "parse", "load", "codegen_jit", "first_simulate", "simulate",
+    "steady_state", "stochastic"
+};
+
+static const int numPhases = sizeof(phases) / sizeof(phases[0]);
+
+static void usage()
+{
+    cerr << "usage: rr-perf [options] [model files]" << endl
+         << endl
+         << "  -r <n>         number of repetitions, default 5" << endl
+         << "  -o <file>      write the JSON results to file, default stdout" << endl
+         << "  -c <opts>      add a configuration, a comma separated list of load" << endl
+         << "                 options: none, optimize, gvn, cfg_simplification," << endl
+         << "                 instruction_combining, dead_inst_elimination," << endl
+         << "                 dead_code_elimination, instruction_simplifier," << endl
+         << "                 mcjit, symbol_cache. May be given more than once," << endl
+         << "                 default is the default load options" << endl
+         << "  -b <dir>       bioinf benchmark directory, default" << endl
+         << "                 " << RR_PERF_BIOINF_DIR << endl
+         << "  -s <dir>       sosbench directory, default" << endl
+         << "                 " << RR_PERF_SOSBENCH_DIR << endl
+         << "  -n <name>      only run models whose name contains name" << endl
+         << "  -v             log progress to stderr" << endl
+         << endl
+         << "Model files given on the command line are run instead of the" << endl
+         << "benchmark sets, with the bioinf integrator settings." << endl;
+}
+
+static double elapsed(const Poco::Timestamp& t)
+{
+    return t.elapsed() / 1e6;
+}
+
+static string jsonString(const string& s)
+{
+    stringstream ss;
+    ss << '"';
+    for (string::const_iterator i = s.begin(); i != s.end(); ++i)
+    {
+        switch (*i)
+        {
+        case '"':  ss << "\\\""; break;
+        case '\\': ss << "\\\\"; break;
+        case '\n': ss << "\\n"; break;
+        case '\r': ss << "\\r"; break;
+        case '\t': ss << "\\t"; break;
+        default:
+            if ((unsigned char)*i < 0x20)
+            {
+                ss << "\\u00" << "0123456789abcdef"[(*i >> 4) & 0xf]
+                   << "0123456789abcdef"[*i & 0xf];
+            }
+            else
+            {
+                ss << *i;
+            }
+        }
+    }
+    ss << '"';
+    return ss.str();
+}
+
+/**
+ * percentile of sorted values, linearly interpolated between the closest
+ * ranks.
+ */
+static double percentile(const vector<double>& sorted, double p)
+{
+    double rank = p / 100.0 * (sorted.size() - 1);
+    unsigned lo = (unsigned)floor(rank);
+    unsigned hi = (unsigned)ceil(rank);
+    return sorted[lo] + (rank - lo) * (sorted[hi] - sorted[lo]);
+}
+
+static void writeStats(ostream& out, const vector<double>& values)
+{
+    vector<double> sorted(values);
+    sort(sorted.begin(), sorted.end());
+
+    double sum = 0;
+    for (unsigned i = 0; i < sorted.size(); ++i)
+    {
+        sum += sorted[i];
+    }
+    double mean = sum / sorted.size();
+
+    double var = 0;
+    for (unsigned i = 0; i < sorted.size(); ++i)
+    {
+        var += (sorted[i] - mean) * (sorted[i] - mean);
+    }
+    double stddev = sorted.size() > 1 ? sqrt(var / (sorted.size() - 1)) : 0;
+
+    out << "{\"n\": " << sorted.size()
+        << ", \"min\": " << sorted.front()
+        << ", \"max\": " << sorted.back()
+        << ", \"mean\": " << mean
+        << ", \"stddev\": " << stddev
+        << ", \"median\": " << percentile(sorted, 50)
+        << ", \"p90\": " << percentile(sorted, 90)
+        << ", \"p95\": " << percentile(sorted, 95)
+        << ", \"samples\": [";
+
+    for (unsigned i = 0; i < values.size(); ++i)
+    {
+        out << (i ? ", " : "") << values[i];
+    }
+    out << "]}";
+}
+
+static uint32_t parseLoadOptions(const string& str)
+{
+    uint32_t opt = 0;
+    vector<string> names = splitString(str, ",");
+
+    for (unsigned i = 0; i < names.size(); ++i)
+    {
+        const string& n = names[i];
+        if (n == "none")                        opt |= 0;
+        else if (n == "optimize")               opt |= LoadSBMLOptions::OPTIMIZE;
+        else if (n == "gvn")                    opt |= LoadSBMLOptions::OPTIMIZE_GVN;
+        else if (n == "cfg_simplification")     opt |= LoadSBMLOptions::OPTIMIZE_CFG_SIMPLIFICATION;
+        else if (n == "instruction_combining")  opt |= LoadSBMLOptions::OPTIMIZE_INSTRUCTION_COMBINING;
+        else if (n == "dead_inst_elimination")  opt |= LoadSBMLOptions::OPTIMIZE_DEAD_INST_ELIMINATION;
+        else if (n == "dead_code_elimination")  opt |= LoadSBMLOptions::OPTIMIZE_DEAD_CODE_ELIMINATION;
+        else if (n == "instruction_simplifier") opt |= LoadSBMLOptions::OPTIMIZE_INSTRUCTION_SIMPLIFIER;
+        else if (n == "mcjit")                  opt |= LoadSBMLOptions::USE_MCJIT;
+        else if (n == "symbol_cache")           opt |= LoadSBMLOptions::LLVM_SYMBOL_CACHE;
+        else
+        {
+            throw invalid_argument("invalid load option: " + n);
+        }
+    }
+    return opt;
+}
+
+static BenchModel bioinfModel(const string& dir, const string& name,
+        const string& file, bool stochastic = false)
+{
+    BenchModel m;
+    m.set = "bioinf";
+    m.name = name;
+    m.path = Poco::Path(dir).append(Poco::Path(name)).append(Poco::Path(file)).toString();
+    m.stochastic = stochastic;
+
+    // same as rr_bench_ode.py and rr_bench_stoch.py
+    m.start = 0;
+    m.duration = stochastic ? 10 : 50;
+    m.steps = stochastic ? 10 : 50;
+    m.absolute = 1.0e-7;
+    m.relative = 1.0e-4;
+    return m;
+}
+
+static void addBioinfModels(const string& dir, vector<BenchModel>& models)
+{
+    static const char* numbered[] = {
+        "00001", "00002", "00050", "00100", "00150", "00200",
+        "00250", "00300", "00350", "00400", "00450", "00500"
+    };
+
+    models.push_back(bioinfModel(dir, "jean_marie", "Jean_Marie_AMPA16_RobHow_v6.xml"));
+    models.push_back(bioinfModel(dir, "jana_wolf", "Jana_WolfGlycolysis.xml"));
+    models.push_back(bioinfModel(dir, "biomod14", "BIOMD0000000014.xml"));
+    models.push_back(bioinfModel(dir, "biomod33", "BIOMD0000000033.xml"));
+
+    for (unsigned i = 0; i < sizeof(numbered) / sizeof(numbered[0]); ++i)
+    {
+        string name = numbered[i];
+        models.push_back(bioinfModel(dir, name, name + "-sbml-l2v4.xml"));
+    }
+
+    models.push_back(bioinfModel(dir, "stoch", "stoch_l2v4.xml", true));
+}
+
+/**
+ * read the settings file of a sosbench case, same format as the sbml
+ * test suite.
+ */
+static void readSettings(const string& fileName, BenchModel& m)
+{
+    ifstream in(fileName.c_str());
+
+    if (!in)
+    {
+        throw runtime_error("could not open settings file " + fileName);
+    }
+
+    string line;
+    while (getline(in, line))
+    {
+        string::size_type colon = line.find(':');
+        if (colon == string::npos)
+        {
+            continue;
+        }
+
+        string key = trim(line.substr(0, colon));
+        string value = trim(line.substr(colon + 1));
+
+        if (value.empty())
+        {
+            continue;
+        }
+
+        if (key == "start")         m.start = strtod(value.c_str(), 0);
+        else if (key == "duration") m.duration = strtod(value.c_str(), 0);
+        else if (key == "steps")    m.steps = strtol(value.c_str(), 0, 10);
+        else if (key == "absolute") m.absolute = strtod(value.c_str(), 0);
+        else if (key == "relative") m.relative = strtod(value.c_str(), 0);
+    }
+}
+
+static void addSosbenchModels(const string& dir, vector<BenchModel>& models)
+{
+    if (!Poco::File(dir).exists())
+    {
+        Log(Logger::LOG_WARNING) << "sosbench directory " << dir << " does not exist";
+        return;
+    }
+
+    vector<string> cases;
+    for (Poco::DirectoryIterator i(dir), end; i != end; ++i)
+    {
+        if (i->isDirectory())
+        {
+            cases.push_back(i.name());
+        }
+    }
+    sort(cases.begin(), cases.end());
+
+    for (unsigned c = 0; c < cases.size(); ++c)
+    {
+        Poco::Path caseDir = Poco::Path(dir).append(Poco::Path(cases[c] + "/"));
+
+        BenchModel m = bioinfModel(dir, cases[c], "");
+        m.set = "sosbench";
+        m.path = "";
+
+        for (Poco::DirectoryIterator i(caseDir), end; i != end; ++i)
+        {
+            if (i.name().find("-sbml-") != string::npos &&
+                    i.path().getExtension() == "xml")
+            {
+                m.path = i.path().toString();
+            }
+        }
+
+        if (m.path.empty())
+        {
+            continue;
+        }
+
+        Poco::Path settings(caseDir, cases[c] + "-settings.txt");
+        if (Poco::File(settings).exists())
+        {
+            readSettings(settings.toString(), m);
+        }
+
+        models.push_back(m);
+    }
+}
+
+static void setupIntegrator(RoadRunner& r, const BenchModel& m)
+{
+    if (m.stochastic)
+    {
+        r.setIntegrator("gillespie");
+    }
+    else
+    {
+        Integrator* integrator = r.getIntegrator();
+        integrator->setValue("relative_tolerance", m.relative);
+        integrator->setValue("absolute_tolerance", m.absolute);
+        integrator->setValue("stiff", false);
+    }
+}
+
+static void simulate(RoadRunner& r, const BenchModel& m)
+{
+    SimulateOptions opt;
+    opt.start = m.start;
+    opt.duration = m.duration;
+    opt.steps = m.steps;
+    opt.reset_model = true;
+    r.simulate(&opt);
+}
+
+/**
+ * run all the phases of one model repetitions times, any failures are
+ * collected in errors and the failing phase is not timed.
+ */
+static Timings benchModel(const BenchModel& m, const BenchConfig& config,
+        int repetitions, vector<string>& errors)
+{
+    Timings t;
+
+    string sbml = rr::SBMLReader::read(m.path);
+
+    LoadSBMLOptions loadOpt;
+    loadOpt.modelGeneratorOpt = config.modelGeneratorOpt | LoadSBMLOptions::RECOMPILE;
+
+    for (int rep = 0; rep < repetitions; ++rep)
+    {
+        Poco::Timestamp ts;
+        libsbml::SBMLDocument* doc = libsbml::readSBMLFromString(sbml.c_str());
+        double parse = elapsed(ts);
+        unsigned numErrors = doc->getNumErrors(libsbml::LIBSBML_SEV_FATAL);
+        delete doc;
+
+        if (numErrors)
+        {
+            errors.push_back("parse: document has fatal errors");
+            return t;
+        }
+
+        t["parse"].push_back(parse);
+
+        RoadRunner r;
+
+        try
+        {
+            ts.update();
+            r.load(sbml, &loadOpt);
+            double load = elapsed(ts);
+
+            t["load"].push_back(load);
+            t["codegen_jit"].push_back(max(load - parse, 0.0));
+        }
+        catch (std::exception& e)
+        {
+            errors.push_back(string("load: ") + e.what());
+            return t;
+        }
+
+        try
+        {
+            setupIntegrator(r, m);
+
+            ts.update();
+            simulate(r, m);
+            double first = elapsed(ts);
+
+            ts.update();
+            simulate(r, m);
+            double second = elapsed(ts);
+
+            t[m.stochastic ? "stochastic" : "first_simulate"].push_back(first);
+            if (!m.stochastic)
+            {
+                t["simulate"].push_back(second);
+            }
+        }
+        catch (std::exception& e)
+        {
+            errors.push_back(string("simulate: ") + e.what());
+        }
+
+        if (!m.stochastic)
+        {
+            try
+            {
+                r.reset();
+
+                ts.update();
+                r.steadyState();
+                t["steady_state"].push_back(elapsed(ts));
+            }
+            catch (std::exception& e)
+            {
+                // many of the models are oscillators or have no steady
+                // state, so record the reason only once.
+                if (rep == 0)
+                {
+                    errors.push_back(string("steady_state: ") + e.what());
+                }
+            }
+        }
+    }
+
+    return t;
+}
+
+static void writeModel(ostream& out, const BenchModel& m, const Timings& t,
+        const vector<string>& errors)
+{
+    out << "        {\"name\": " << jsonString(m.name)
+        << ", \"set\": " << jsonString(m.set)
+        << ", \"file\": " << jsonString(m.path) << "," << endl
+        << "         \"start\": " << m.start
+        << ", \"duration\": " << m.duration
+        << ", \"steps\": " << m.steps
+        << ", \"absolute\": " << m.absolute
+        << ", \"relative\": " << m.relative
+        << ", \"stochastic\": " << (m.stochastic ? "true" : "false") << "," << endl
+        << "         \"errors\": [";
+
+    for (unsigned i = 0; i < errors.size(); ++i)
+    {
+        out << (i ? ", " : "") << jsonString(errors[i]);
+    }
+
+    out << "]," << endl << "         \"timings\": {";
+
+    bool first = true;
+    for (int p = 0; p < numPhases; ++p)
+    {
+        Timings::const_iterator i = t.find(phases[p]);
+        if (i == t.end() || i->second.empty())
+        {
+            continue;
+        }
+
+        out << (first ? "" : ",") << endl << "            "
+            << jsonString(phases[p]) << ": ";
+        writeStats(out, i->second);
+        first = false;
+    }
+
+    out << endl << "         }}";
+}
+
+int main(int argc, char** argv)
+{
+    int repetitions = 5;
+    string outFile;
+    string bioinfDir = RR_PERF_BIOINF_DIR;
+    string sosbenchDir = RR_PERF_SOSBENCH_DIR;
+    string filter;
+    vector<string> files;
+    vector<BenchConfig> configs;
+
+    try
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+
+            if (arg == "-r" && hasValue)
+            {
+                repetitions = max(1, atoi(argv[++i]));
+            }
+            else if (arg == "-o" && hasValue)
+            {
+                outFile = argv[++i];
+            }
+            else if (arg == "-c" && hasValue)
+            {
+                BenchConfig config;
+                config.name = argv[++i];
+                config.modelGeneratorOpt = parseLoadOptions(config.name);
+                configs.push_back(config);
+            }
+            else if (arg == "-b" && hasValue)
+            {
+                bioinfDir = argv[++i];
+            }
+            else if (arg == "-s" && hasValue)
+            {
+                sosbenchDir = argv[++i];
+            }
+            else if (arg == "-n" && hasValue)
+            {
+                filter = argv[++i];
+            }
+            else if (arg == "-v")
+            {
+                Logger::enableConsoleLogging(Logger::LOG_NOTICE);
+            }
+            else if (arg[0] == '-')
+            {
+                usage();
+                return 1;
+            }
+            else
+            {
+                files.push_back(arg);
+            }
+        }
+
+        if (configs.empty())
+        {
+            BenchConfig config;
+            config.name = "default";
+            config.modelGeneratorOpt = LoadSBMLOptions().modelGeneratorOpt;
+            configs.push_back(config);
+        }
+
+        vector<BenchModel> models;
+        if (files.size())
+        {
+            for (unsigned i = 0; i < files.size(); ++i)
+            {
+                BenchModel m = bioinfModel("", "", "");
+                m.set = "files";
+                m.name = Poco::Path(files[i]).getBaseName();
+                m.path = files[i];
+                models.push_back(m);
+            }
+        }
+        else
+        {
+            addBioinfModels(bioinfDir, models);
+            addSosbenchModels(sosbenchDir, models);
+        }
+
+        ofstream file;
+        if (outFile.size())
+        {
+            file.open(outFile.c_str());
+            if (!file)
+            {
+                throw runtime_error("could not open output file " + outFile);
+            }
+        }
+        ostream& out = outFile.size() ? file : cout;
+        out.precision(9);
+
+        out << "{" << endl
+            << "  \"version\": " << jsonString(getVersionStr()) << "," << endl
+            << "  \"repetitions\": " << repetitions << "," << endl
+            << "  \"configurations\": [";
+
+        for (unsigned c = 0; c < configs.size(); ++c)
+        {
+            out << (c ? "," : "") << endl
+                << "    {\"name\": " << jsonString(configs[c].name)
+                << ", \"model_generator_opt\": " << configs[c].modelGeneratorOpt
+                << "," << endl << "     \"models\": [";
+
+            bool first = true;
+            for (unsigned i = 0; i < models.size(); ++i)
+            {
+                const BenchModel& m = models[i];
+
+                if (filter.size() && m.name.find(filter) == string::npos)
+                {
+                    continue;
+                }
+
+                Log(Logger::LOG_NOTICE) << "config " << configs[c].name
+                        << ", model " << m.set << "/" << m.name;
+
+                Timings t;
+                vector<string> errors;
+
+                try
+                {
+                    t = benchModel(m, configs[c], repetitions, errors);
+                }
+                catch (std::exception& e)
+                {
+                    errors.push_back(e.what());
+                }
+
+                out << (first ? "" : ",") << endl;
+                writeModel(out, m, t, errors);
+                out.flush();
+                first = false;
+            }
+
+            out << endl << "    ]}";
+        }
+
+        out << endl << "  ]" << endl << "}" << endl;
+    }
+    catch (std::exception& e)
+    {
+        cerr << "rr-perf: " << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
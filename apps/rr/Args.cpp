@@ -21,7 +21,9 @@ Duration(5),
 EndTime(StartTime + Duration),
 Steps(50),
 SelectionList(""),
-variableStep(false)
+variableStep(false),
+ServiceThreads(-1),
+ServicePort(0)
 {}
 
 string Usage(const string& prg)
@@ -34,7 +36,7 @@ string Usage(const string& prg)
     usage<<setfill('.');
     usage<<setw(25)<<"-v<debug level>"              <<" Debug levels: Error, Warning, Info, Debug. Default: Info\n";
     usage<<setw(25)<<"-m<FileName>"                 <<" SBML Model File Name (with path)\n";
-    usage<<setw(25)<<"-o<FileName>"                 <<" FileName for data output \n";
+    usage<<setw(25)<<"-o<FileName>"                 <<" FileName for data output, binary columnar format if it ends with .rrcd\n";
     usage<<setw(25)<<"-d<FilePath>"                 <<" Data output directory. If not given, data is output to current directory (implies -f is given)\n";
     usage<<setw(25)<<"-t<FilePath>"                 <<" Temporary data output directory. If not given, temp files are output to current directory\n";
     usage<<setw(25)<<"-p"                           <<" Pause before exiting.\n";
@@ -46,6 +48,10 @@ string Usage(const string& prg)
     usage<<setw(25)<<"-l<List>"                     <<" Set selection list. Separate variables using ',' or space\n";
     usage<<setw(25)<<"-version"                     <<" Prints the current version.\n\n";
     usage<<setw(25)<<"-x"                           <<" Enables variable step mode.\n\n";
+    usage<<setw(25)<<"-w<#>"                        <<" Service mode, run jobs read from stdin, one per line, on # worker threads. 0: one per core\n";
+    usage<<setw(25)<<"-k<port>"                     <<" Service mode, read jobs from connections on 127.0.0.1:port instead of stdin\n";
+    usage<<setw(25)<<""                             <<" Job format: id=<id> model=<file> start=<#> end=<#> steps=<#> selections=<a,b,..> variable=<0|1> integrator=<name> output=<file>\n";
+    usage<<setw(25)<<""                             <<" With -d, or always with -k, output is a file name in the data output directory (default: current directory)\n\n";
     usage<<setw(25)<<"-? "                          <<" Shows the help screen.\n\n";
 
     usage << "Version: " << rr::getVersionStr() << std::endl;
@@ -25,6 +25,8 @@ public:
     int                             Steps;              //option z
     string                          SelectionList;      //option l:
     bool variableStep;
+    int                             ServiceThreads;     //option w:
+    int                             ServicePort;        //option k:
 };
 
 #endif
@@ -0,0 +1,562 @@
+/*
+ * Service.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+#pragma hdrstop
+#include "Service.h"
+#include "rrRoadRunner.h"
+#include "rrExecutableModel.h"
+#include "rrLogger.h"
+#include "rrStringUtils.h"
+#include "rrUtils.h"
+#include "rrColumnarData.h"
+#include "Integrator.h"
+
+#include <Poco/Thread.h>
+#include <Poco/Runnable.h>
+#include <Poco/Mutex.h>
+#include <Poco/Condition.h>
+#include <Poco/Event.h>
+#include <Poco/Environment.h>
+#include <Poco/Net/ServerSocket.h>
+#include <Poco/Net/SocketAddress.h>
+#include <Poco/Net/SocketStream.h>
+#include <Poco/Net/TCPServer.h>
+#include <Poco/Net/TCPServerConnection.h>
+#include <Poco/Net/TCPServerConnectionFactory.h>
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <deque>
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+
+using namespace std;
+using namespace rr;
+using Poco::Mutex;
+
+static bool isBinaryOutput(const string& fileName)
+{
+    const string ext = ColumnarDataWriter::fileExtension;
+    return fileName.size() > ext.size() &&
+            fileName.compare(fileName.size() - ext.size(), ext.size(), ext) == 0;
+}
+
+void writeResult(RoadRunner& r, const ls::DoubleMatrix& result,
+        const string& fileName)
+{
+    if(isBinaryOutput(fileName))
+    {
+        const std::vector<SelectionRecord>& sel = r.getSelections();
+        std::vector<string> names(sel.size());
+        for(int i = 0; i < sel.size(); ++i)
+        {
+            names[i] = sel[i].to_string();
+        }
+
+        ColumnarDataWriter writer(fileName, names);
+        writer.writeRows(result.getArray(), result.RSize());
+        writer.close();
+    }
+    else
+    {
+        ofstream os(fileName.c_str());
+        if(!os)
+        {
+            throw runtime_error("could not open " + fileName + " for writing");
+        }
+        os << result;
+    }
+}
+
+/**
+ * where the replies of a set of jobs go, stdout or a connection. Counts the
+ * jobs which have not replied yet, so the source can wait for them before
+ * it goes away.
+ */
+class ReplySink
+{
+public:
+    ReplySink(ostream& os) : os(os), pending(0) {}
+
+    void begin()
+    {
+        Mutex::ScopedLock lock(mutex);
+        ++pending;
+    }
+
+    void send(const string& line)
+    {
+        Mutex::ScopedLock lock(mutex);
+        os << line << endl;
+        if(--pending == 0)
+        {
+            done.broadcast();
+        }
+    }
+
+    void wait()
+    {
+        Mutex::ScopedLock lock(mutex);
+        while(pending)
+        {
+            done.wait(mutex);
+        }
+    }
+
+private:
+    ostream& os;
+    Mutex mutex;
+    Poco::Condition done;
+    unsigned pending;
+};
+
+struct Job
+{
+    Job() : start(0), end(5), steps(50), variable(false),
+            integrator("cvode"), reply(0) {}
+
+    string id;
+    string model;
+    double start;
+    double end;
+    int steps;
+    bool variable;
+    string integrator;
+    vector<string> selections;
+    string output;
+    ReplySink* reply;
+};
+
+class JobQueue
+{
+public:
+    JobQueue() : closed(false) {}
+
+    void push(const Job& job)
+    {
+        Mutex::ScopedLock lock(mutex);
+        if(closed)
+        {
+            throw runtime_error("the service is shutting down");
+        }
+        jobs.push_back(job);
+        ready.signal();
+    }
+
+    /**
+     * wait for the next job, returns false once the queue is closed and
+     * empty.
+     */
+    bool pop(Job& job)
+    {
+        Mutex::ScopedLock lock(mutex);
+        while(jobs.empty() && !closed)
+        {
+            ready.wait(mutex);
+        }
+
+        if(jobs.empty())
+        {
+            return false;
+        }
+
+        job = jobs.front();
+        jobs.pop_front();
+        return true;
+    }
+
+    void close()
+    {
+        Mutex::ScopedLock lock(mutex);
+        closed = true;
+        ready.broadcast();
+    }
+
+private:
+    Mutex mutex;
+    Poco::Condition ready;
+    deque<Job> jobs;
+    bool closed;
+};
+
+/**
+ * models are loaded one at a time, so the first load of a model compiles
+ * it and the others pick it up from the model cache.
+ */
+static Mutex loadMutex;
+
+class JobWorker : public Poco::Runnable
+{
+public:
+    JobWorker(JobQueue& queue) : queue(queue) {}
+
+    ~JobWorker()
+    {
+        for(map<string, Model>::iterator i = models.begin(); i != models.end(); ++i)
+        {
+            delete i->second.r;
+        }
+    }
+
+    virtual void run()
+    {
+        Job job;
+        while(queue.pop(job))
+        {
+            try
+            {
+                runJob(job);
+                job.reply->send("ok " + job.id + " " + job.output);
+            }
+            catch(std::exception& e)
+            {
+                Log(Logger::LOG_ERROR) << "job " << job.id << ": " << e.what();
+
+                // replies are one line each.
+                string what = e.what();
+                std::replace(what.begin(), what.end(), '\n', ' ');
+                job.reply->send("error " + job.id + " " + what);
+            }
+        }
+    }
+
+private:
+    struct Model
+    {
+        RoadRunner* r;
+        vector<string> selections;
+    };
+
+    JobQueue& queue;
+    map<string, Model> models;
+
+    Model& getModel(const string& fileName)
+    {
+        map<string, Model>::iterator i = models.find(fileName);
+        if(i != models.end())
+        {
+            return i->second;
+        }
+
+        Model m;
+        {
+            Mutex::ScopedLock lock(loadMutex);
+            m.r = new RoadRunner(fileName);
+        }
+
+        const vector<SelectionRecord>& sel = m.r->getSelections();
+        for(int j = 0; j < sel.size(); ++j)
+        {
+            m.selections.push_back(sel[j].to_string());
+        }
+
+        Log(Logger::LOG_INFORMATION) << "loaded " << fileName;
+
+        return models[fileName] = m;
+    }
+
+    void runJob(const Job& job)
+    {
+        Model& m = getModel(job.model);
+        RoadRunner& r = *m.r;
+
+        // nothing carries over from the last job on this model.
+        r.setIntegrator(job.integrator);
+        r.reset(SelectionRecord::ALL);
+        r.setSelections(job.selections.size() ? job.selections : m.selections);
+
+        Integrator* integrator = r.getIntegrator();
+        if(integrator->hasValue("variable_step_size"))
+        {
+            integrator->setValue("variable_step_size", job.variable);
+        }
+
+        SimulateOptions& opt = r.getSimulateOptions();
+        opt.start = job.start;
+        opt.duration = job.end - job.start;
+        opt.steps = job.steps;
+
+        writeResult(r, *r.simulate(), job.output);
+    }
+};
+
+static double parseDouble(const string& key, const string& value)
+{
+    istringstream is(value);
+    double d;
+    if(!(is >> d) || !is.eof())
+    {
+        throw invalid_argument("invalid value for " + key + ": " + value);
+    }
+    return d;
+}
+
+static int parseInt(const string& key, const string& value)
+{
+    istringstream is(value);
+    int i;
+    if(!(is >> i) || !is.eof())
+    {
+        throw invalid_argument("invalid value for " + key + ": " + value);
+    }
+    return i;
+}
+
+static Job parseJob(const string& line)
+{
+    Job job;
+    istringstream is(line);
+    string token;
+
+    while(is >> token)
+    {
+        string::size_type eq = token.find('=');
+        if(eq == string::npos)
+        {
+            throw invalid_argument("expected key=value, got " + token);
+        }
+
+        string key = token.substr(0, eq);
+        string value = token.substr(eq + 1);
+
+        if(key == "id")                 job.id = value;
+        else if(key == "model")         job.model = value;
+        else if(key == "output")        job.output = value;
+        else if(key == "start")         job.start = parseDouble(key, value);
+        else if(key == "end")           job.end = parseDouble(key, value);
+        else if(key == "steps")         job.steps = parseInt(key, value);
+        else if(key == "variable")      job.variable = parseInt(key, value) != 0;
+        else if(key == "integrator")    job.integrator = value;
+        else if(key == "selections")    job.selections = splitString(value, ",");
+        else
+        {
+            throw invalid_argument("unknown key " + key);
+        }
+    }
+
+    if(job.model.empty() || job.output.empty())
+    {
+        throw invalid_argument("model and output are required");
+    }
+
+    if(job.end <= job.start)
+    {
+        throw invalid_argument("end must be greater than start");
+    }
+
+    return job;
+}
+
+/**
+ * the file a job writes to, confined to the output directory if there is
+ * one.
+ */
+static string outputPath(const string& outputDir, const string& output)
+{
+    if(outputDir.empty())
+    {
+        return output;
+    }
+
+    if(output.find_first_of("/\\:") != string::npos || output == "." || output == "..")
+    {
+        throw invalid_argument("output must be a file name in the output "
+                "directory, got " + output);
+    }
+
+    return joinPath(outputDir, output);
+}
+
+Service::Service(unsigned numThreads, const string& outputDir) :
+        queue(new JobQueue()),
+        jobCount(0),
+        outputDir(outputDir)
+{
+    if(numThreads == 0)
+    {
+        numThreads = Poco::Environment::processorCount();
+    }
+
+    for(unsigned i = 0; i < numThreads; ++i)
+    {
+        workers.push_back(new JobWorker(*queue));
+        threads.push_back(new Poco::Thread());
+        threads.back()->start(*workers.back());
+    }
+
+    Log(Logger::LOG_NOTICE) << "rr service started with " << numThreads
+            << " worker threads";
+}
+
+Service::~Service()
+{
+    stop();
+    delete queue;
+}
+
+void Service::stop()
+{
+    queue->close();
+
+    for(unsigned i = 0; i < threads.size(); ++i)
+    {
+        threads[i]->join();
+        delete threads[i];
+        delete workers[i];
+    }
+
+    threads.clear();
+    workers.clear();
+}
+
+bool Service::submit(const string& line, ReplySink& reply)
+{
+    string::size_type first = line.find_first_not_of(" \t\r");
+    if(first == string::npos || line[first] == '#')
+    {
+        return true;
+    }
+
+    if(line.compare(first, 8, "shutdown") == 0)
+    {
+        return false;
+    }
+
+    reply.begin();
+
+    // each server connection submits from its own thread.
+    string number;
+    {
+        static Mutex countMutex;
+        Mutex::ScopedLock lock(countMutex);
+        ostringstream os;
+        os << ++jobCount;
+        number = os.str();
+    }
+
+    // the id once the line is parsed, so a refused job is replied to by
+    // the id it was submitted with.
+    string id = number;
+
+    try
+    {
+        Job job = parseJob(line);
+        if(job.id.empty())
+        {
+            job.id = number;
+        }
+        id = job.id;
+        job.output = outputPath(outputDir, job.output);
+        job.reply = &reply;
+        queue->push(job);
+    }
+    catch(std::exception& e)
+    {
+        reply.send("error " + id + " " + e.what());
+    }
+
+    return true;
+}
+
+int Service::runStdin()
+{
+    ReplySink reply(cout);
+    string line;
+
+    while(getline(cin, line) && submit(line, reply))
+    {
+    }
+
+    reply.wait();
+    stop();
+    return 0;
+}
+
+/**
+ * a client of the server, its jobs are replied to on the same connection.
+ */
+class JobConnection : public Poco::Net::TCPServerConnection
+{
+public:
+    JobConnection(const Poco::Net::StreamSocket& socket, Service& service,
+            Poco::Event& shutdown) :
+            Poco::Net::TCPServerConnection(socket),
+            service(service),
+            shutdown(shutdown)
+    {
+    }
+
+    virtual void run()
+    {
+        // the replies are written by the worker threads while this one
+        // reads, so each direction has its own stream and buffer.
+        Poco::Net::SocketInputStream input(socket());
+        Poco::Net::SocketOutputStream output(socket());
+        ReplySink reply(output);
+        string line;
+
+        while(getline(input, line))
+        {
+            if(!service.submit(line, reply))
+            {
+                shutdown.set();
+                break;
+            }
+        }
+
+        // the sink lives on this stack, so wait for the jobs in flight.
+        reply.wait();
+    }
+
+private:
+    Service& service;
+    Poco::Event& shutdown;
+};
+
+class JobConnectionFactory : public Poco::Net::TCPServerConnectionFactory
+{
+public:
+    JobConnectionFactory(Service& service, Poco::Event& shutdown) :
+            service(service), shutdown(shutdown)
+    {
+    }
+
+    virtual Poco::Net::TCPServerConnection* createConnection(
+            const Poco::Net::StreamSocket& socket)
+    {
+        return new JobConnection(socket, service, shutdown);
+    }
+
+private:
+    Service& service;
+    Poco::Event& shutdown;
+};
+
+int Service::runServer(unsigned short port)
+{
+    // anyone on this host can connect, so they only get to write to the
+    // output directory.
+    if(outputDir.empty())
+    {
+        outputDir = ".";
+    }
+
+    Poco::Event shutdown;
+    Poco::Net::ServerSocket socket(Poco::Net::SocketAddress("127.0.0.1", port));
+    Poco::Net::TCPServer server(new JobConnectionFactory(*this, shutdown), socket);
+
+    server.start();
+    Log(Logger::LOG_NOTICE) << "rr service listening on 127.0.0.1:" << port;
+
+    shutdown.wait();
+
+    // stop accepting connections, jobs submitted on the open ones after
+    // this point are refused.
+    server.stop();
+    stop();
+    return 0;
+}
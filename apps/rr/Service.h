@@ -0,0 +1,111 @@
+/*
+ * Service.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef ServiceH
+#define ServiceH
+#include <string>
+#include <vector>
+#include "rr-libstruct/lsMatrix.h"
+
+namespace rr
+{
+class RoadRunner;
+}
+
+class JobQueue;
+class JobWorker;
+class ReplySink;
+
+namespace Poco
+{
+class Thread;
+}
+
+/**
+ * write a simulation result to a file, in the binary columnar format if the
+ * file name has the columnar data extension, as text otherwise.
+ */
+void writeResult(rr::RoadRunner& r, const ls::DoubleMatrix& result,
+        const std::string& fileName);
+
+/**
+ * The long running service mode of rr.
+ *
+ * Jobs are read one per line, either from stdin or from TCP connections on
+ * the loopback interface, and run on a fixed pool of worker threads. Each
+ * worker keeps the RoadRunner instances it has loaded, keyed by model file
+ * name, so a model is parsed and compiled once rather than once per job. As
+ * the instances stay alive, the compiled code is also shared between the
+ * workers through the LLVM model cache.
+ *
+ * A job is a list of key=value pairs separated by white space, i.e.
+ * @code
+ * id=42 model=/data/m.xml start=0 end=100 steps=1000 selections=time,S1,S2 output=/tmp/42.rrcd
+ * @endcode
+ *
+ * model and output are required. start (0), end (5), steps (50),
+ * selections (the model defaults), variable (0) and integrator (cvode) are
+ * optional, the id defaults to the job number. The model is reset to its
+ * initial state before each job.
+ *
+ * If the service has an output directory, output must be a plain file
+ * name, and the file is written to that directory. Otherwise it is any path
+ * the process can write to.
+ *
+ * The TCP server has no authentication, any local user or process can
+ * connect and submit jobs, which load any model file and run with the
+ * permissions of the service. The server therefore always confines the
+ * output to its output directory, the current directory if none was given.
+ *
+ * When a job finishes, a single line is written back to where it came
+ * from, either "ok <id> <output>" or "error <id> <message>". Jobs run
+ * concurrently, so the replies may come in any order. Blank lines and
+ * lines starting with '#' are ignored, a "shutdown" line stops the server.
+ */
+class Service
+{
+public:
+    /**
+     * create the workers, zero threads uses one per core. If outputDir is
+     * not empty, the jobs may only write files in it.
+     */
+    Service(unsigned numThreads, const std::string& outputDir = "");
+
+    /**
+     * waits for any jobs in progress to finish.
+     */
+    ~Service();
+
+    /**
+     * run jobs read from stdin, replies go to stdout, returns at the end
+     * of the input once all the jobs are done.
+     */
+    int runStdin();
+
+    /**
+     * accept connections on 127.0.0.1:port, each one may submit any number
+     * of jobs, until one of them sends "shutdown". The output of the jobs
+     * is confined to the output directory, or the current directory.
+     */
+    int runServer(unsigned short port);
+
+    /**
+     * parse a job line and queue it, or reply with an error if the line is
+     * not a valid job. Returns false if the line is "shutdown".
+     */
+    bool submit(const std::string& line, ReplySink& reply);
+
+private:
+    JobQueue* queue;
+    std::vector<JobWorker*> workers;
+    std::vector<Poco::Thread*> threads;
+    unsigned jobCount;
+    std::string outputDir;
+
+    void stop();
+};
+
+#endif
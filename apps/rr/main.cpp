@@ -4,6 +4,7 @@
 #include "rrUtils.h"
 #include "rrGetOptions.h"
 #include "Args.h"
+#include "Service.h"
 #include "Integrator.h"
 #include "rrVersionInfo.h"
 
@@ -25,6 +26,7 @@ using namespace std;
 using namespace rr;
 
 void ProcessCommandLineArguments(int argc, char* argv[], Args& args);
+
 int main(int argc, char * argv[])
 {
     string settingsFile;
@@ -60,6 +62,14 @@ int main(int argc, char * argv[])
         Log(Logger::LOG_INFORMATION) << "Current Log level is:"
         		<< Logger::getCurrentLevelAsString();
 
+        if(args.ServiceThreads >= 0 || args.ServicePort > 0)
+        {
+            Service service(args.ServiceThreads > 0 ? args.ServiceThreads : 0,
+                    args.DataOutputFolder);
+            return args.ServicePort > 0 ? service.runServer(args.ServicePort)
+                    : service.runStdin();
+        }
+
         if(!args.ModelFileName.size())
         {
             Log(lInfo)<<"Please supply a sbml model file name, using option -m<modelfilename>";
@@ -83,8 +93,7 @@ int main(int argc, char * argv[])
 
         if(args.OutputFileName.size() >  0)
         {
-        	ofstream os(args.OutputFileName.c_str());
-        	os << res;
+            writeResult(rr, res, args.OutputFileName);
         }
         else
         {
@@ -104,7 +113,7 @@ void ProcessCommandLineArguments(int argc, char* argv[], Args& args)
 {
     char c;
 
-    while ((c = GetOptions(argc, argv, (const char*) ("xcpuo:v:n:d:t:l:m:s:e:z:"))) != -1)
+    while ((c = GetOptions(argc, argv, (const char*) ("xcpuo:v:n:d:t:l:m:s:e:z:w:k:"))) != -1)
     {
         switch (c)
         {
@@ -131,6 +140,8 @@ void ProcessCommandLineArguments(int argc, char* argv[], Args& args)
             case ('e'): args.EndTime                        = toDouble(rrOptArg);                  break;
             case ('z'): args.Steps                          = toInt(rrOptArg);                     break;
             case ('o'): args.OutputFileName                 = rrOptArg;                            break;
+            case ('w'): args.ServiceThreads                 = toInt(rrOptArg);                     break;
+            case ('k'): args.ServicePort                    = toInt(rrOptArg);                     break;
             case ('?'):
             {
                     cout<<Usage(argv[0])<<endl;
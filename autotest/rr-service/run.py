@@ -0,0 +1,150 @@
+"""
+Service mode tests of the rr app, a round trip of jobs through stdin, and
+a TCP server which must keep the job output in its -d directory.
+
+usage: run.py <rr executable> <sbml model>
+"""
+from __future__ import print_function
+import os
+import shutil
+import socket
+import subprocess
+import sys
+import tempfile
+import time
+
+failures = 0
+
+def check(condition, message):
+    global failures
+    if not condition:
+        failures += 1
+        print('FAILED: ' + message)
+
+def replies(text):
+    """the reply lines, the log may be interleaved on the console"""
+    result = {}
+    for line in text.splitlines():
+        words = line.split(' ', 2)
+        if len(words) == 3 and words[0] in ('ok', 'error'):
+            result[words[1]] = (words[0], words[2])
+    return result
+
+def freePort():
+    s = socket.socket()
+    s.bind(('127.0.0.1', 0))
+    port = s.getsockname()[1]
+    s.close()
+    return port
+
+def testStdin(rr, model, scratch):
+    outdir = os.path.join(scratch, 'stdin')
+    os.mkdir(outdir)
+
+    jobs = ('id=a model={0} end=10 steps=20 selections=time,S1 output=a.txt\n'
+            '# a comment, then a blank line\n'
+            '\n'
+            'id=b model={0} end=10 steps=20 output=b.rrcd\n'
+            'id=c model={1} output=c.txt\n'
+            'id=d model={0} output=../d.txt\n').format(
+                model, os.path.join(scratch, 'missing.xml'))
+
+    p = subprocess.Popen([rr, '-w2', '-d' + outdir], stdin=subprocess.PIPE,
+                         stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+                         universal_newlines=True)
+    out, err = p.communicate(jobs)
+    r = replies(out)
+
+    check(p.returncode == 0, 'stdin service exit code {0}'.format(p.returncode))
+    check(sorted(r.keys()) == ['a', 'b', 'c', 'd'], 'stdin replies: ' + out)
+    check(r.get('a', ('',))[0] == 'ok' and r.get('b', ('',))[0] == 'ok',
+          'stdin jobs a and b should succeed: ' + out)
+    check(r.get('c', ('',))[0] == 'error', 'missing model should fail: ' + out)
+    check(r.get('d', ('',))[0] == 'error', 'output outside -d should fail: ' + out)
+
+    for name in ['a.txt', 'b.rrcd']:
+        f = os.path.join(outdir, name)
+        check(os.path.isfile(f) and os.path.getsize(f) > 0,
+              'stdin job output file ' + name)
+    check(not os.path.exists(os.path.join(scratch, 'd.txt')),
+          'stdin job wrote outside -d')
+
+def testServer(rr, model, scratch):
+    outdir = os.path.join(scratch, 'server')
+    os.mkdir(outdir)
+    port = freePort()
+
+    p = subprocess.Popen([rr, '-w2', '-k{0}'.format(port), '-d' + outdir],
+                         stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+
+    s = None
+    for i in range(100):
+        try:
+            s = socket.create_connection(('127.0.0.1', port))
+            break
+        except socket.error:
+            time.sleep(0.1)
+
+    check(s is not None, 'could not connect to the service')
+    if s is None:
+        p.kill()
+        p.wait()
+        return
+
+    outside = os.path.join(scratch, 'outside.txt')
+    jobs = ('id=ok model={0} output=ok.txt\n'
+            'id=abs model={0} output={1}\n'
+            'id=up model={0} output=../outside.txt\n'
+            'id=dot model={0} output=..\n').format(model, outside)
+    s.sendall(jobs.encode())
+
+    # read until all four jobs have replied.
+    data = ''
+    s.settimeout(60)
+    while len(replies(data)) < 4:
+        chunk = s.recv(4096)
+        if not chunk:
+            break
+        data += chunk.decode()
+    r = replies(data)
+
+    s.sendall('shutdown\n'.encode())
+    s.close()
+
+    for i in range(300):
+        if p.poll() is not None:
+            break
+        time.sleep(0.1)
+    if p.poll() is None:
+        p.kill()
+        check(False, 'the service did not shut down')
+    p.wait()
+
+    check(r.get('ok', ('',))[0] == 'ok', 'server job in -d should succeed: ' + data)
+    check(os.path.isfile(os.path.join(outdir, 'ok.txt')), 'server job output file')
+
+    for id in ['abs', 'up', 'dot']:
+        check(r.get(id, ('',))[0] == 'error',
+              'server job {0} outside -d should fail: {1}'.format(id, data))
+    check(not os.path.exists(outside), 'server job wrote outside -d')
+
+def main():
+    if len(sys.argv) != 3:
+        print(__doc__)
+        return 1
+
+    rr = os.path.abspath(sys.argv[1])
+    model = os.path.abspath(sys.argv[2])
+    scratch = tempfile.mkdtemp()
+
+    try:
+        testStdin(rr, model, scratch)
+        testServer(rr, model, scratch)
+    finally:
+        shutil.rmtree(scratch)
+
+    print('{0} failures'.format(failures))
+    return failures
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -7,6 +7,7 @@
 #include "rrException.h"
 #include "rrConfig.h"
 #include "rrUtils.h"
+#include "rrPerfCounters.h"
 
 #include <cvode/cvode.h>
 #include <cvode/cvode_dense.h>
@@ -29,8 +30,24 @@ namespace rr
 	const int CVODEIntegrator::mDefaultMaxAdamsOrder = 12;
 	const int CVODEIntegrator::mDefaultMaxBDFOrder = 5;
 
+	/**
+	* stiffness detection, the product of the step size and the Jacobian
+	* norm is compared with the stability limit of the Adams method every
+	* stiffnessCheckInterval steps. Above stiffLimit the Adams steps are
+	* limited by stability rather than accuracy, below nonStiffLimit the BDF
+	* steps are limited by accuracy, so Adams could take them as well, at a
+	* lower cost. The gap between them, and the number of checks in a row
+	* needed to switch, stop the method from flipping back and forth.
+	*/
+	static const long stiffnessCheckInterval = 20;
+	static const double stiffLimit = 0.5;
+	static const double nonStiffLimit = 0.1;
+	static const int stiffnessVotesToSwitch = 3;
+
 	int cvodeDyDtFcn(realtype t, N_Vector cv_y, N_Vector cv_ydot, void *userData);
 	int cvodeRootFcn(realtype t, N_Vector y, realtype *gout, void *userData);
+	int cvodeDenseJacFcn(long int N, realtype t, N_Vector y, N_Vector fy,
+		DlsMat J, void *userData, N_Vector tmp1, N_Vector tmp2, N_Vector tmp3);
 
 	// Sets the value of an element in a N_Vector object
 	inline void SetVector(N_Vector v, int Index, double Value)
@@ -45,6 +62,17 @@ namespace rr
 		return data[Index];
 	}
 
+	// weighted RMS norm, the norm of the CVODE error test.
+	static double wrmsNorm(const vector<double>& v, const vector<double>& w)
+	{
+		double s = 0;
+		for (unsigned i = 0; i < v.size(); ++i)
+		{
+			s += v[i] * w[i] * v[i] * w[i];
+		}
+		return sqrt(s / v.size());
+	}
+
 	/**
 	* Purpose
 	* This function processes error and warning messages from CVODE and its
@@ -97,6 +125,7 @@ namespace rr
         addSetting("relative_tolerance", 1e-6, "Relative Tolerance", "Specifies the scalar relative tolerance (double).", "(double) CVODE calculates a vector of error weights which is used in all error and convergence tests. The weighted RMS norm for the relative tolerance should not become smaller than this value.");
         addSetting("absolute_tolerance", 1e-15, "Absolute Tolerance", "Specifies the scalar absolute tolerance (double).", "(double) CVODE calculates a vector of error weights which is used in all error and convergence tests. The weighted RMS norm for the absolute tolerance should not become smaller than this value.");
         addSetting("stiff",              true, "Stiff", "Specifies whether the integrator attempts to solve stiff equations. (bool)", "(bool) Specifies whether the integrator attempts to solve stiff equations. Ensure the integrator can solver stiff differential equations by setting this value to true.");
+        addSetting("stiffness_detection", false, "Stiffness Detection", "Switch between the Adams and BDF methods as the problem becomes stiff or non-stiff. (bool)", "(bool) Monitor the step size against the stability limit of the Adams method, and switch between the Adams and BDF methods as the problem becomes stiff or non-stiff during the integration. The integration starts with the method chosen by the stiff setting.");
         addSetting("maximum_bdf_order",  mDefaultMaxBDFOrder, "Maximum BDF Order", "Specifies the maximum order for Backward Differentiation Formula integration. (int)", "(int) Specifies the maximum order for Backward Differentiation Formula integration. This integration method is used for stiff problems. Default value is 5.");
         addSetting("maximum_adams_order",mDefaultMaxAdamsOrder, "Maximum Adams Order", "Specifies the maximum order for Adams-Moulton intergration. (int)", "(int) Specifies the maximum order for Adams-Moulton intergration. This integration method is used for non-stiff problems. Default value is 12.");
         addSetting("maximum_num_steps",  mDefaultMaxNumSteps, "Maximum Number of Steps", "Specifies the maximum number of steps to be taken by the CVODE solver in its attempt to reach tout. (int)", "(int) Maximum number of steps to be taken by the CVODE solver in its attempt to reach tout.");
@@ -119,11 +148,18 @@ namespace rr
 		variableStepPendingEvent(false),
 		variableStepTimeEndEvent(false),
 		variableStepPostEventState(0),
+		mStiff(true),
+		mStiffnessCheckSteps(0),
+		mStiffnessVotes(0),
+		mResetInitialStep(false),
 		typecode_(CVODE_INT_TYPECODE)
 	{
+		resetPerfReported();
+
 		Log(Logger::LOG_INFORMATION) << "creating CVODEIntegrator";
 
 		resetSettings();
+		mStiff = getValueAsBool("stiff");
 
 		if (aModel)
 		{
@@ -325,10 +361,11 @@ namespace rr
                 setCVODETolerances();
             }
         }
-		if (key == "stiff")
+		if (key == "stiff" || (key == "stiffness_detection" && mStiff != getValueAsBool("stiff")))
 		{
 			// If the integrator is changed from stiff to standard, we must re-create CVode.
 			Log(Logger::LOG_INFORMATION) << "Integrator stiffness has been changed. Re-creating CVode.";
+			mStiff = getValueAsBool("stiff");
 			freeCVode();
 			createCVode();
 		}
@@ -345,7 +382,7 @@ namespace rr
 		CVodeSetMinStep(mCVODE_Memory, getValueAsDouble("minimum_time_step"));
 		CVodeSetMaxStep(mCVODE_Memory, getValueAsDouble("maximum_time_step"));
 		CVodeSetMaxNumSteps(mCVODE_Memory, getValueAsInt("maximum_num_steps") > 0 ? getValueAsInt("maximum_num_steps") : mDefaultMaxNumSteps);
-		if (getValueAsBool("stiff"))
+		if (mStiff)
             CVodeSetMaxOrd(mCVODE_Memory, getValueAsInt("maximum_bdf_order"));
         else
             CVodeSetMaxOrd(mCVODE_Memory, getValueAsInt("maximum_adams_order"));
@@ -361,6 +398,8 @@ namespace rr
 			return;
 		}
 
+		RR_PERF_ONLY(updatePerfCounters());
+
 		int result = CVodeReInit(mCVODE_Memory, t0, mStateVector);
 
 		if (result != CV_SUCCESS)
@@ -368,10 +407,23 @@ namespace rr
 			handleCVODEError(result);
 		}
 
+		resetPerfReported();
+
 		setCVODETolerances();
 	}
 
 	double CVODEIntegrator::integrate(double timeStart, double hstep)
+	{
+		RR_PERF_TIMER(mModel ? mModel->getPerfCounters() : 0, INTEGRATE_TIME);
+
+		double result = integrateSteps(timeStart, hstep);
+
+		RR_PERF_ONLY(updatePerfCounters());
+
+		return result;
+	}
+
+	double CVODEIntegrator::integrateSteps(double timeStart, double hstep)
 	{
 		static const double epsilon = std::numeric_limits<double>::epsilon();
 		// CVODE root tolerance, used for backing up when an event fires (see CVODE User Doc pp. 13)
@@ -505,11 +557,39 @@ namespace rr
 				applyPendingEvents(timeEnd);
 				}
 
+				if (mResetInitialStep)
+				{
+					CVodeSetInitStep(mCVODE_Memory, getValueAsDouble("initial_time_step"));
+					mResetInitialStep = false;
+				}
+
+				if (getValueAsBool("stiffness_detection"))
+				{
+					checkStiffness(timeEnd);
+				}
+
 				if (listener)
 				{
 					listener->onTimeStep(this, mModel, timeEnd);
 				}
 			}
+			else if (nResult < 0 && isInterrupted())
+			{
+				// the failed rhs evaluation may come from the step itself
+				// (CV_RHSFUNC_FAIL), the difference quotient Jacobian of the
+				// linear solver setup (CV_LSETUP_FAIL) or the first step after
+				// a (re)init (CV_FIRST_RHSFUNC_ERR). CVODE is back at its last
+				// completed step, leave the model there.
+				double tInterrupt = timeStart;
+				CVodeGetCurrentTime(mCVODE_Memory, &tInterrupt);
+				if (CVodeGetDky(mCVODE_Memory, tInterrupt, 0, mStateVector) == CV_SUCCESS)
+				{
+					assignResultsToModel();
+				}
+				mModel->setTime(tInterrupt);
+
+				throw IntegratorInterruptedException(tInterrupt);
+			}
 			else
 			{
 				handleCVODEError(nResult);
@@ -539,6 +619,62 @@ namespace rr
 		return timeEnd;
 	}
 
+	void CVODEIntegrator::updatePerfCounters()
+	{
+		PerfCounters* counters = mModel ? mModel->getPerfCounters() : 0;
+
+		if (!counters || !mCVODE_Memory)
+		{
+			return;
+		}
+
+		static const PerfCounters::Counter names[NUM_PERF_STATS] = {
+			PerfCounters::INTEGRATOR_STEPS,
+			PerfCounters::INTEGRATOR_RHS_EVALS,
+			PerfCounters::INTEGRATOR_LINEAR_SOLVER_SETUPS,
+			PerfCounters::INTEGRATOR_ERROR_TEST_FAILS,
+			PerfCounters::INTEGRATOR_NONLINEAR_ITERATIONS,
+			PerfCounters::INTEGRATOR_NONLINEAR_CONV_FAILS,
+			PerfCounters::INTEGRATOR_ROOT_EVALS,
+			PerfCounters::INTEGRATOR_JACOBIAN_EVALS,
+			PerfCounters::INTEGRATOR_JACOBIAN_RHS_EVALS
+		};
+
+		// CVODE counts from the last (re)init of its memory, -1 if a
+		// statistic is not available.
+		long int current[NUM_PERF_STATS];
+		std::fill(current, current + NUM_PERF_STATS, -1L);
+
+		CVodeGetNumSteps(mCVODE_Memory, &current[0]);
+		CVodeGetNumRhsEvals(mCVODE_Memory, &current[1]);
+		CVodeGetNumLinSolvSetups(mCVODE_Memory, &current[2]);
+		CVodeGetNumErrTestFails(mCVODE_Memory, &current[3]);
+		CVodeGetNumNonlinSolvIters(mCVODE_Memory, &current[4]);
+		CVodeGetNumNonlinSolvConvFails(mCVODE_Memory, &current[5]);
+
+		if (mModel->getNumEvents() > 0)
+			CVodeGetNumGEvals(mCVODE_Memory, &current[6]);
+
+		// these fail if the dense linear solver is not attached, i.e. when
+		// not stiff.
+		CVDlsGetNumJacEvals(mCVODE_Memory, &current[7]);
+		CVDlsGetNumRhsEvals(mCVODE_Memory, &current[8]);
+
+		for (int i = 0; i < NUM_PERF_STATS; ++i)
+		{
+			if (current[i] > mPerfReported[i])
+			{
+				counters->add(names[i], current[i] - mPerfReported[i]);
+				mPerfReported[i] = current[i];
+			}
+		}
+	}
+
+	void CVODEIntegrator::resetPerfReported()
+	{
+		std::fill(mPerfReported, mPerfReported + NUM_PERF_STATS, 0L);
+	}
+
 	void CVODEIntegrator::tweakTolerances()
 	{
 		double minAbs = Config::getDouble(Config::CVODE_MIN_ABSOLUTE);
@@ -570,9 +706,6 @@ namespace rr
 		int allocStateVectorSize = 0;
 		int realStateVectorSize = mModel->getStateVector(0);
 
-		// cvode return code
-		int err;
-
 		if (realStateVectorSize > 0)
 		{
 			stateVectorVariables = true;
@@ -598,7 +731,20 @@ namespace rr
 			SetVector(mStateVector, i, 0.);
 		}
 
-		if (getValueAsBool("stiff"))
+		initCVodeMemory(0.0);
+		mModel->resetEvents();
+	}
+
+	void CVODEIntegrator::initCVodeMemory(double t0)
+	{
+		resetPerfReported();
+
+		const int allocStateVectorSize = NV_LENGTH_S(mStateVector);
+
+		// cvode return code
+		int err;
+
+		if (mStiff)
 		{
 			Log(Logger::LOG_INFORMATION) << "using stiff integrator";
 			mCVODE_Memory = (void*)CVodeCreate(CV_BDF, CV_NEWTON);
@@ -620,8 +766,6 @@ namespace rr
 		// for some sbml tests.
 		CVodeSetMaxNumSteps(mCVODE_Memory, mDefaultMaxNumSteps);
 
-		double t0 = 0.0;
-
 		if ((err = CVodeSetUserData(mCVODE_Memory, (void*) this)) != CV_SUCCESS)
 		{
 			handleCVODEError(err);
@@ -644,16 +788,159 @@ namespace rr
 
 		// only allocate this if we are using stiff solver.
 		// otherwise, CVode will NOT free it if using standard solver.
-		if (getValueAsBool("stiff"))
+		if (mStiff)
 		{
 			if ((err = CVDense(mCVODE_Memory, allocStateVectorSize)) != CV_SUCCESS)
 			{
 				handleCVODEError(err);
 			}
+
+			// use a coloured finite difference Jacobian if the model has a
+			// sparse structure, otherwise the CVODE internal one is the same.
+			std::vector<std::vector<unsigned> > pattern;
+			if (stateVectorVariables && mModel->getStateVectorJacobianPattern(pattern))
+			{
+				jacobianColoring = JacobianColoring(allocStateVectorSize, pattern);
+
+				if (jacobianColoring.getNumColors() < allocStateVectorSize)
+				{
+					Log(Logger::LOG_INFORMATION) << "using coloured Jacobian, "
+						<< jacobianColoring.getNumColors() << " evaluations instead of "
+						<< allocStateVectorSize;
+
+					if ((err = CVDlsSetDenseJacFn(mCVODE_Memory, cvodeDenseJacFcn)) != CV_SUCCESS)
+					{
+						handleCVODEError(err);
+					}
+				}
+			}
 		}
 
 		setCVODETolerances();
-		mModel->resetEvents();
+	}
+
+	void CVODEIntegrator::checkStiffness(double time)
+	{
+		long steps = 0;
+		if (!haveVariables() || CVodeGetNumSteps(mCVODE_Memory, &steps) != CV_SUCCESS)
+		{
+			return;
+		}
+
+		// the count starts again at each re-init, i.e. after events.
+		if (steps < mStiffnessCheckSteps)
+		{
+			mStiffnessCheckSteps = 0;
+		}
+
+		if (steps - mStiffnessCheckSteps < stiffnessCheckInterval)
+		{
+			return;
+		}
+
+		mStiffnessCheckSteps = steps;
+
+		double h = 0;
+		CVodeGetCurrentStep(mCVODE_Memory, &h);
+		double hNorm = fabs(h) * estimateJacobianNorm(time);
+
+		bool other = mStiff ? hNorm < nonStiffLimit : hNorm > stiffLimit;
+		mStiffnessVotes = other ? mStiffnessVotes + 1 : 0;
+
+		Log(Logger::LOG_TRACE) << "stiffness check at time " << time
+			<< ", h * |J| = " << hNorm << ", " << mStiffnessVotes
+			<< " in a row for switching";
+
+		if (mStiffnessVotes >= stiffnessVotesToSwitch)
+		{
+			switchMethod(time);
+		}
+	}
+
+	double CVODEIntegrator::estimateJacobianNorm(double time)
+	{
+		const int n = NV_LENGTH_S(mStateVector);
+		const double* y = NV_DATA_S(mStateVector);
+		const double relTol = getValueAsDouble("relative_tolerance");
+		const double absTol = getValueAsDouble("absolute_tolerance");
+
+		vector<double> weights(n), f0(n), f1(n), y1(n);
+		for (int i = 0; i < n; ++i)
+		{
+			weights[i] = 1.0 / (relTol * fabs(y[i]) + absTol);
+		}
+
+		mModel->getStateVectorRate(time, y, &f0[0]);
+
+		// start from the rate, the fast modes dominate it in a stiff phase.
+		vector<double> v = f0;
+		if (wrmsNorm(v, weights) == 0)
+		{
+			for (int i = 0; i < n; ++i)
+			{
+				v[i] = 1.0 / weights[i];
+			}
+		}
+
+		double norm = 0;
+		for (int iter = 0; iter < 3; ++iter)
+		{
+			// a perturbation the size of the error tolerance.
+			double scale = 1.0 / wrmsNorm(v, weights);
+			if (!(scale < numeric_limits<double>::infinity()))
+			{
+				break;
+			}
+
+			for (int i = 0; i < n; ++i)
+			{
+				y1[i] = y[i] + scale * v[i];
+			}
+
+			mModel->getStateVectorRate(time, &y1[0], &f1[0]);
+
+			for (int i = 0; i < n; ++i)
+			{
+				v[i] = f1[i] - f0[i];
+			}
+
+			norm = wrmsNorm(v, weights);
+		}
+
+		// evaluating the rates sets the model state.
+		assignResultsToModel();
+
+		return norm;
+	}
+
+	void CVODEIntegrator::switchMethod(double time)
+	{
+		double h = 0;
+		CVodeGetCurrentStep(mCVODE_Memory, &h);
+
+		RR_PERF_ONLY(updatePerfCounters());
+
+		CVodeFree(&mCVODE_Memory);
+		mCVODE_Memory = 0;
+
+		mStiff = !mStiff;
+		mStiffnessVotes = 0;
+		mStiffnessCheckSteps = 0;
+
+		Log(Logger::LOG_INFORMATION) << "switching to the "
+			<< (mStiff ? "stiff BDF" : "non-stiff Adams") << " method at time "
+			<< time << ", step size " << h;
+
+		initCVodeMemory(time);
+		updateCVODE();
+
+		if (h > 0)
+		{
+			CVodeSetInitStep(mCVODE_Memory, h);
+			mResetInitialStep = true;
+		}
+
+		RR_PERF_COUNT(mModel->getPerfCounters(), INTEGRATOR_METHOD_SWITCHES, 1);
 	}
 
 	void CVODEIntegrator::testRootsAtInitialTime()
@@ -734,6 +1021,21 @@ namespace rr
 			return;
 		}
 
+		// a restart begins with the configured method, not the one stiffness
+		// detection switched to during the last integration.
+		mStiffnessVotes = 0;
+		mStiffnessCheckSteps = 0;
+
+		if (mStiff != getValueAsBool("stiff"))
+		{
+			Log(Logger::LOG_INFORMATION) << "Restoring the configured "
+				<< (getValueAsBool("stiff") ? "stiff BDF" : "non-stiff Adams") << " method";
+			mStiff = getValueAsBool("stiff");
+			RR_PERF_ONLY(updatePerfCounters());
+			freeCVode();
+			createCVode();
+		}
+
 		// apply any events that trigger before or at time 0.
 		// important NOT to set model time before we check get
 		// the initial event state, initially time is < 0.
@@ -776,6 +1078,13 @@ namespace rr
 
 		assert(cvInstance && "userData pointer is NULL in cvode dydt callback");
 
+		// an unrecoverable error ends the step, CVode returns an error and
+		// integrate throws the interruption.
+		if (cvInstance->interrupt && cvInstance->interrupt->interrupted())
+		{
+			return -1;
+		}
+
 		ExecutableModel *model = cvInstance->mModel;
 
 		model->getStateVectorRate(time, y, ydot);
@@ -791,6 +1100,70 @@ namespace rr
 		return CV_SUCCESS;
 	}
 
+	// Cvode calls this to compute the Jacobian for the stiff solver. Same
+	// forward differences and increments as the CVODE internal dense
+	// Jacobian, but all the columns of a colour are perturbed at once.
+	int cvodeDenseJacFcn(long int N, realtype time, N_Vector cv_y, N_Vector cv_fy,
+		DlsMat J, void *userData, N_Vector tmp1, N_Vector tmp2, N_Vector tmp3)
+	{
+		CVODEIntegrator* cvInstance = (CVODEIntegrator*)userData;
+
+		assert(cvInstance && "userData pointer is NULL in cvode Jacobian callback");
+
+		ExecutableModel *model = cvInstance->mModel;
+		const JacobianColoring& coloring = cvInstance->jacobianColoring;
+
+		double* y = NV_DATA_S(cv_y);
+		double* fy = NV_DATA_S(cv_fy);
+		double* ewt = NV_DATA_S(tmp1);
+		double* ftemp = NV_DATA_S(tmp2);
+		double* inc = NV_DATA_S(tmp3);
+
+		double h = 0;
+		CVodeGetErrWeights(cvInstance->mCVODE_Memory, tmp1);
+		CVodeGetCurrentStep(cvInstance->mCVODE_Memory, &h);
+
+		const double uround = std::numeric_limits<double>::epsilon();
+		const double srur = sqrt(uround);
+		const double fnorm = N_VWrmsNorm(cv_fy, tmp1);
+		const double minInc = (fnorm != 0.0) ? (1000 * fabs(h) * uround * N * fnorm) : 1.0;
+
+		for (unsigned c = 0; c < coloring.getNumColors(); ++c)
+		{
+			const std::vector<unsigned>& cols = coloring.getColorColumns(c);
+
+			// inc holds the saved y values while perturbed.
+			for (unsigned i = 0; i < cols.size(); ++i)
+			{
+				unsigned j = cols[i];
+				double yj = y[j];
+				y[j] += std::max(srur * fabs(yj), minInc / ewt[j]);
+				inc[j] = yj;
+			}
+
+			model->getStateVectorRate(time, y, ftemp);
+
+			for (unsigned i = 0; i < cols.size(); ++i)
+			{
+				unsigned j = cols[i];
+				double yj = inc[j];
+				double invInc = 1.0 / (y[j] - yj);
+				y[j] = yj;
+
+				double* col = DENSE_COL(J, j);
+				const std::vector<unsigned>& rows = coloring.getColumnRows(j);
+				for (unsigned k = 0; k < rows.size(); ++k)
+				{
+					col[rows[k]] = (ftemp[rows[k]] - fy[rows[k]]) * invInc;
+				}
+			}
+		}
+
+		Log(Logger::LOG_TRACE) << __FUNC__ << ", model: " << model;
+
+		return CV_SUCCESS;
+	}
+
 	void CVODEIntegrator::freeCVode()
 	{
 		// cvode does not check for null values.
@@ -1029,7 +1402,12 @@ namespace rr
         CVODEIntegrator* i = (CVODEIntegrator*)eh_data;
         i->checkType();
 
-		if (error_code < 0) {
+		if (error_code < 0 && i->isInterrupted()) {
+			// the rhs refused to evaluate because the run was interrupted,
+			// integrate reports that instead of an error.
+			Log(Logger::LOG_DEBUG) << "CVODE interrupted: " << msg;
+		}
+		else if (error_code < 0) {
 			Log(Logger::LOG_ERROR) << "CVODE Error: " << i->cvodeDecodeError(error_code, false)
 				<< ", Module: " << module << ", Function: " << function
 				<< ", Message: " << msg;
@@ -17,6 +17,7 @@
 
 #include "Integrator.h"
 #include "rrRoadRunnerOptions.h"
+#include "rrSparse.h"
 
 #include <string>
 #include <vector>
@@ -28,6 +29,11 @@
 */
 typedef struct _generic_N_Vector *N_Vector;
 
+/**
+* CVode dense matrix struct
+*/
+typedef struct _DlsMat *DlsMat;
+
 namespace rr
 {
     using std::string;
@@ -231,13 +237,93 @@ namespace rr
         void applyEvents(double timeEnd, std::vector<unsigned char> &previousEventStatus);
         double applyVariableStepPendingEvents();
 
+        /**
+         * the integration loop of integrate.
+         */
+        double integrateSteps(double timeStart, double hstep);
+
+        /**
+         * add the CVODE statistics gathered since the last call to the
+         * model's performance counters. CVODE restarts its statistics at
+         * every (re)init of its memory, i.e. after each event, so this is
+         * also called right before the memory is reinitialized or freed
+         * during a run.
+         */
+        void updatePerfCounters();
+
+        enum { NUM_PERF_STATS = 9 };
+
+        /**
+         * the CVODE statistics already added to the performance counters,
+         * counted from the last (re)init of the CVODE memory.
+         */
+        long int mPerfReported[NUM_PERF_STATS];
+
+        void resetPerfReported();
+
         void createCVode();
         void freeCVode();
         bool stateVectorVariables;
 
+        /**
+         * create and initialize the CVODE memory at t0 for the current
+         * state vector, with the method in use.
+         */
+        void initCVodeMemory(double t0);
+
+        /**
+         * whether the BDF method is in use, this is the stiff setting
+         * unless stiffness_detection has switched it.
+         */
+        bool mStiff;
+
+        /**
+         * CVODE step count at the last stiffness check, and the number of
+         * checks in a row which favoured the other method.
+         */
+        long mStiffnessCheckSteps;
+        int mStiffnessVotes;
+
+        /**
+         * the step size carried over a method switch is only the initial
+         * step of the first run after it.
+         */
+        bool mResetInitialStep;
+
+        /**
+         * with stiffness_detection, every so many steps compare the step
+         * size with the stability limit of the Adams method and switch
+         * methods if the other one suits the problem better.
+         */
+        void checkStiffness(double time);
+
+        /**
+         * estimate the norm of the Jacobian at the current state, in the
+         * error weighted norm, by a few power iterations of finite
+         * differences of the state vector rate.
+         */
+        double estimateJacobianNorm(double time);
+
+        /**
+         * switch between Adams and BDF at time, CVODE can not change the
+         * method of a run, so a new one is started from the current state
+         * with the current step size, the rest of the history is specific
+         * to the method.
+         */
+        void switchMethod(double time);
+
+        /**
+         * column colouring of the state vector Jacobian, used by the
+         * stiff solver to compute the Jacobian with one model evaluation
+         * per colour.
+         */
+        JacobianColoring jacobianColoring;
+
 
         friend int cvodeDyDtFcn(double t, N_Vector cv_y, N_Vector cv_ydot, void *f_data);
         friend int cvodeRootFcn(double t, N_Vector y, double *gout, void *g_data);
+        friend int cvodeDenseJacFcn(long int N, double t, N_Vector y, N_Vector fy,
+                DlsMat J, void *user_data, N_Vector tmp1, N_Vector tmp2, N_Vector tmp3);
 
         unsigned long typecode_;
     };
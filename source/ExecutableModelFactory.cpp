@@ -10,6 +10,7 @@
 
 #if defined(BUILD_LLVM)
 #include "llvm/LLVMModelGenerator.h"
+#include "llvm/LLVMModelExporter.h"
 #include "llvm/LLVMCompiler.h"
 #endif
 
@@ -67,6 +68,31 @@ ExecutableModel* rr::ExecutableModelFactory::createModel(
     return rrllvm::LLVMModelGenerator::createModel(sbml, opt.modelGeneratorOpt);
 }
 
+void ExecutableModelFactory::exportModel(const std::string& sbml,
+        const std::string& fileName, const Dictionary* dict)
+{
+    LoadSBMLOptions opt(dict);
+    rrllvm::LLVMModelExporter::exportModel(sbml, opt.modelGeneratorOpt, fileName);
+}
+
+ExecutableModel* ExecutableModelFactory::loadExportedModel(
+        const std::string& fileName)
+{
+    return rrllvm::LLVMModelExporter::loadModel(fileName);
+}
+
+BasicDictionary ExecutableModelFactory::getModelCacheStatistics()
+{
+    BasicDictionary stats;
+    rrllvm::LLVMModelGenerator::getCacheStatistics(stats);
+    return stats;
+}
+
+void ExecutableModelFactory::clearModelCache()
+{
+    rrllvm::LLVMModelGenerator::clearCache();
+}
+
 /*
 ModelGenerator* createModelGenerator(const string& compiler, const string& tempFolder,
             const string& supportCodeFolder)
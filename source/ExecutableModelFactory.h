@@ -30,6 +30,47 @@ public:
      * but it may be any dictionary.
      */
     static ExecutableModel *createModel(const std::string& sbml, const Dictionary* dict = 0);
+
+    /**
+     * compile an sbml model ahead of time and write the generated code
+     * to a native object file. The object file must be linked into a shared
+     * library before it can be loaded with loadExportedModel.
+     *
+     * The code is compiled for Config::LLVM_TARGET_CPU, the generic CPU of
+     * the architecture by default, so it can be moved to other machines.
+     * The CPU is recorded, and loadExportedModel rejects a model compiled
+     * for a CPU, or CPU features, the machine does not have.
+     *
+     * @param sbml: an sbml string
+     * @param fileName: the object file to write.
+     * @param dict: a dictionary of options, typically a LoadSBMLOptions object.
+     */
+    static void exportModel(const std::string& sbml, const std::string& fileName,
+            const Dictionary* dict = 0);
+
+    /**
+     * creates a NEW model from a shared library made from an exported
+     * model, no sbml parsing or code generation is performed.
+     */
+    static ExecutableModel *loadExportedModel(const std::string& fileName);
+
+    /**
+     * statistics of the compiled model cache, see
+     * Config::LLVM_MODEL_CACHE_SIZE.
+     *
+     * "hits" and "misses" count the models which were found in the cache,
+     * and the ones which were compiled. "evictions" counts the models
+     * released to stay within the cache size. "models" and "size" are the
+     * number and estimated size in bytes of the models the cache keeps,
+     * "capacity" is the cache size in bytes.
+     */
+    static BasicDictionary getModelCacheStatistics();
+
+    /**
+     * release all of the models the cache keeps, models in use stay
+     * shared. The statistics are not reset.
+     */
+    static void clearModelCache();
 };
 
 } /* namespace rr */
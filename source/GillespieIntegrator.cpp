@@ -168,11 +168,11 @@ namespace rr
 
 		/*	In addition to typically value-setting behavior, some settings require further changes
 		within CVODE. */
-		if (key == "seed")
+		if (key == "seed" || key == "replicate")
 		{
 			try
 			{
-				unsigned long seed = val.convert<unsigned long>();
+				unsigned long seed = getValue("seed").convert<unsigned long>();
 				setEngineSeed(seed);
 			}
 			catch (std::exception& e)
@@ -180,7 +180,7 @@ namespace rr
 				std::stringstream ss;
 				ss << "Could not convert the value \"" << val.toString();
 				ss << "\" to an unsigned long integer. " << endl;
-				ss << "The seed must be a number between 0 and ";
+				ss << "The " << key << " must be a number between 0 and ";
 				ss << std::numeric_limits<unsigned long>::max();
 				ss << "; error message: " << e.what() << ".";
 				throw std::invalid_argument(ss.str());
@@ -194,6 +194,7 @@ namespace rr
 
         // Set default integrator settings.
         addSetting("seed",              defaultSeed(), "Seed", "Set the seed into the random engine. (ulong)", "(ulong) Set the seed into the random engine.");
+        addSetting("replicate",         0u,    "Replicate", "Select the independent random stream for this replicate. (uint)", "(uint) Replicates with the same seed but different replicate numbers draw from independent random streams, so they can be run in parallel and any one of them reproduced by itself.");
         addSetting("variable_step_size",true, "Variable Step Size", "Perform a variable time step simulation. (bool)", "(bool) Enabling this setting will allow the integrator to adapt the size of each time step. This will result in a non-uniform time column.");
         addSetting("initial_time_step", 0.0,   "Initial Time Step", "Specifies the initial time step size. (double)", "(double) Specifies the initial time step size.");
         addSetting("minimum_time_step", 0.0,   "Minimum Time Step", "Specifies the minimum absolute value of step size allowed. (double)", "(double) The minimum absolute value of step size allowed.");
@@ -236,6 +237,9 @@ namespace rr
 
 		while (t < tf)
 		{
+			// the model is at t, with the reactions so far.
+			checkInterrupt(t);
+
 			// random uniform numbers
 			double r1 = urand();
 			double r2 = urand();
@@ -417,15 +421,25 @@ namespace rr
 
 	double GillespieIntegrator::urand()
 	{
-		return (double)engine() / (double)engine.max();
+		return engine.uniform();
 	}
 
 	void GillespieIntegrator::setEngineSeed(unsigned long seed)
 	{
-		Log(Logger::LOG_INFORMATION) << "Using user specified seed value: " << seed;
+		unsigned replicate = getValue("replicate").convert<unsigned>();
+
+		Log(Logger::LOG_INFORMATION) << "Using user specified seed value: " << seed
+			<< ", replicate: " << replicate;
+
+		engine.seed(seed, replicate, Philox::SSA_STREAM);
 
-		// MSVC needs an explicit cast, fail to compile otherwise.
-		engine.seed((unsigned long)seed);
+		// the model draws the distribution functions and event tie breaks from
+		// its own streams of the same seed and replicate.
+		if (model)
+		{
+			model->setRandomSeed(seed);
+			model->setRandomReplicate(replicate);
+		}
 	}
 
 	} /* namespace rr */
@@ -19,7 +19,7 @@
 #include "Integrator.h"
 #include "rrRoadRunnerOptions.h"
 #include "rrExecutableModel.h"
-#include "tr1proxy/rr_random.h"
+#include "rrPhilox.h"
 
 // == CODE ====================================================
 
@@ -136,8 +136,7 @@ namespace rr
 
     private:
         ExecutableModel *model;
-        cxx11_ns::mt19937 engine;
-        //unsigned long seed;
+        Philox engine;
         double timeScale;
         double stoichScale;
         int nReactions;
@@ -56,6 +56,42 @@ namespace rr
 
 	typedef cxx11_ns::shared_ptr<IntegratorListener> IntegratorListenerPtr;
 
+	/*-------------------------------------------------------------------------------------------
+		IntegratorInterrupt is asked by an integrator, between its internal steps, whether to
+		stop, so a long integration between two output points can be cut short.
+	---------------------------------------------------------------------------------------------*/
+	class IntegratorInterrupt
+	{
+	public:
+
+		/**
+		* true if the integration should stop. It is called often, so it should be cheap,
+		* and once it returns true it must keep returning true.
+		*/
+		virtual bool interrupted() = 0;
+
+		virtual ~IntegratorInterrupt() {};
+	};
+
+	/**
+	* thrown by integrate when the interrupt of the integrator asked it to stop. The
+	* model is left at the time and state of the last completed internal step.
+	*/
+	class IntegratorInterruptedException : public std::runtime_error
+	{
+	public:
+		explicit IntegratorInterruptedException(double time) :
+			std::runtime_error("integration interrupted"),
+			time(time)
+		{
+		}
+
+		/**
+		* the model time where the integration stopped.
+		*/
+		double time;
+	};
+
 	/*-------------------------------------------------------------------------------------------
 		Integrator is an abstract base class that provides an interface to specific integrator
 		class implementations.
@@ -71,6 +107,8 @@ namespace rr
 			Other
 		};
 
+		Integrator() : interrupt(0) {};
+
 		virtual ~Integrator() {};
 
         virtual IntegrationMethod getIntegrationMethod() const = 0;
@@ -109,6 +147,33 @@ namespace rr
     */
     virtual std::string toRepr() const;
 		/* !-- END OF CARRYOVER METHODS */
+
+		/**
+		* set the interrupt checked between the internal steps of integrate, or 0 for
+		* none. It is not owned by the integrator, and is only supported by integrators
+		* which take more than one step per call, others ignore it.
+		*/
+		void setInterrupt(IntegratorInterrupt* i) { interrupt = i; }
+
+		/**
+		* true if there is an interrupt and it asked the integration to stop.
+		*/
+		bool isInterrupted() const { return interrupt && interrupt->interrupted(); }
+
+	protected:
+		IntegratorInterrupt* interrupt;
+
+		/**
+		* throw an IntegratorInterruptedException if the interrupt asks to stop, the
+		* model must be at the given time.
+		*/
+		void checkInterrupt(double time)
+		{
+			if (interrupt && interrupt->interrupted())
+			{
+				throw IntegratorInterruptedException(time);
+			}
+		}
 	};
 
 
@@ -10,6 +10,10 @@
 
 #include <cassert>
 #include <math.h>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <algorithm>
 
 extern "C" {
 #include <clapack/f2c.h>
@@ -23,7 +27,10 @@ namespace rr
     {
         Log(Logger::LOG_NOTICE) << "Creating Runge-Kutta Fehlberg integrator";
         stateVectorSize = hCurrent = hmin = hmax = 0;
+        tStep = hStep = tOutput = 0;
+        stepPending = false;
         k1 = k2 = k3 = k4 = k5 = k6 = err = y = ytmp = NULL;
+        ynew = fnew = yout = NULL;
         syncWithModel(m);
     }
 
@@ -39,8 +46,12 @@ namespace rr
         delete []err;
         delete []y;
         delete []ytmp;
+        delete []ynew;
+        delete []fnew;
+        delete []yout;
 
         model = m;
+        stepPending = false;
 
         resetSettings();
 
@@ -55,13 +66,19 @@ namespace rr
             err = new double[stateVectorSize];
             y = new double[stateVectorSize];
             ytmp = new double[stateVectorSize];
+            ynew = new double[stateVectorSize];
+            fnew = new double[stateVectorSize];
+            yout = new double[stateVectorSize];
             hCurrent = 0.;
-            hmin = getValueAsDouble("minimum_time_step"); // TODO: replace hmin with getValueAsDouble("minimum_time_step")
-            hmax = getValueAsDouble("maximum_time_step"); // TODO: replace hmax with getValueAsDouble("maximum_time_step")
+            hmin = getValueAsDouble("minimum_time_step");
+            hmax = getValueAsDouble("maximum_time_step");
         } else {
             stateVectorSize = hCurrent = hmin = hmax = 0;
             k1 = k2 = k3 = k4 = k5 = k6 = err = y = ytmp = NULL;
+            ynew = fnew = yout = NULL;
         }
+
+        events.syncWithModel(model);
     }
 
     RK45Integrator::~RK45Integrator()
@@ -75,22 +92,13 @@ namespace rr
         delete []err;
         delete []y;
         delete []ytmp;
+        delete []ynew;
+        delete []fnew;
+        delete []yout;
     }
 
-    double RK45Integrator::integrate(double t, double tEnd)
+    double RK45Integrator::integrate(double t, double h)
     {
-        double h = getValueAsDouble("initial_time_step");
-        if (hCurrent != 0.)
-          h = hCurrent;
-        // NOTE: @kirichoi, please implement rk45 here
-//         static const double epsilon = 1e-3;
-//         double tf = 0;
-        bool singleStep;
-
-        assert(h > hmin && "h must be > hmin");
-//         tf = t + h;
-        singleStep = false;
-
         if (!model) {
             throw std::runtime_error("RK45Integrator::integrate: No model");
         }
@@ -98,22 +106,115 @@ namespace rr
         Log(Logger::LOG_DEBUG) <<
                 "RK45Integrator::integrate(" << t << ", " << h << ")";
 
+        hmin = getValueAsDouble("minimum_time_step");
+        hmax = getValueAsDouble("maximum_time_step");
+
+        // in variable step mode, RoadRunner passes the end time rather
+        // than the step size.
+        const bool varstep = getValueAsBool("variable_step_size");
+        const double tf = varstep ? h : t + h;
+
+        // steps stop at tf if the model has events, so the event
+        // assignments are not made ahead of the output, or in variable
+        // step mode. Otherwise they go past it and the output is interpolated.
+        const bool clip = varstep || events.getNumEvents() > 0;
+
+        double tRoot = 0;
+
+        assert(tf > t && "tf must be > t");
+
+        if (!canResume(t)) {
+            stepPending = false;
+            model->setTime(t);
+            model->getStateVector(y);
+            model->getStateVectorRate(t, y, k1);
+        }
+
+        while (true) {
+            if (stepPending) {
+                if (tf <= tStep + hStep) {
+                    evaluate(tf, yout);
+
+                    tOutput = tf;
+                    model->setTime(tf);
+                    model->setStateVector(yout);
+                    getModelInputs(outputInputs);
+
+                    Log(Logger::LOG_DEBUG) << "RK45: interpolated output at " << tf;
+                    return tf;
+                }
+
+                // continue from the end of the pending step, the rate at
+                // the end is the first stage of the next step.
+                t = tStep + hStep;
+                std::swap(y, ynew);
+                std::swap(k1, fnew);
+                stepPending = false;
+            }
+
+            if (interrupt && interrupt->interrupted()) {
+                stepPending = false;
+                model->setTime(t);
+                model->setStateVector(y);
+                throw IntegratorInterruptedException(t);
+            }
+
+            events.beginStep(t, y);
+
+            double t1 = step(t, clip ? events.getStopTime(tf)
+                    : std::numeric_limits<double>::infinity());
+
+            if (events.findRoot(t1, ynew, *this, tRoot, ytmp)) {
+                std::swap(y, ytmp);
+                t = tRoot;
+                events.applyTriggeredEvents(t, y);
+                model->getStateVectorRate(t, y, k1);
+            } else if (clip) {
+                std::swap(y, ynew);
+                std::swap(k1, fnew);
+                t = t1;
+
+                if (events.applyPendingEvents(t, y) > 0) {
+                    model->getStateVectorRate(t, y, k1);
+                }
+            } else {
+                stepPending = true;
+                continue;
+            }
+
+            if (varstep || t >= tf) {
+                model->setTime(t);
+                model->setStateVector(y);
+
+                Log(Logger::LOG_DEBUG) << "RK45: end of step at " << t;
+                return t;
+            }
+        }
+    }
+
+    double RK45Integrator::step(double t, double tLimit)
+    {
+        double h = getValueAsDouble("initial_time_step");
+        if (hCurrent != 0.)
+          h = hCurrent;
+
+        const double epsilon = getValueAsDouble("epsilon");
+
         // blas daxpy: y -> y + \alpha x
         integer n = stateVectorSize;
         integer inc = 1;
         integer i;
         double alpha = 0;
         double error, q;
+        bool last;
 
-        do {
-          assert(h > 1e-13);
-
-          model->setTime(t);
-
-          model->getStateVector(y);
+        while (true) {
+          last = t + h >= tLimit;
+          if (last) {
+            h = tLimit - t;
+          }
 
-          // k1 = f(t_n, y_n)
-          model->getStateVectorRate(t, y, k1);
+          // k1 = f(t_n, y_n) is supplied by the caller
 
           // k2 = f(t_n + h/4, y_n + (h/4) * k_1)
           alpha = h/4.;
@@ -172,7 +273,7 @@ namespace rr
           // E = abs(k1/360 - (128/4275)*k3 - (2197/75240)*k4 + (1/50)*k5 + (2/55)*k6)
           for (i = 0; i < stateVectorSize; i++) {
             err[i] = 0.;
-	  }
+          }
           alpha = 1./360;
           daxpy_(&n, &alpha, k1, &inc, err, &inc);
           alpha = -128./4275;
@@ -184,60 +285,120 @@ namespace rr
           alpha = 2./55;
           daxpy_(&n, &alpha, k6, &inc, err, &inc);
           error = dnrm2_(&n, err, &inc);
-          q = 0.84*pow(getValueAsDouble("epsilon")/error, 0.25);
+          q = 0.84*pow(epsilon/error, 0.25);
 
           Log(Logger::LOG_DEBUG) <<
-	    "RK45 step: t = " << t << ", error = " << error << ", epsilon = " << getValueAsDouble("epsilon") << ", h = " << h;
-          if (error <= getValueAsDouble("epsilon")) {
+            "RK45 step: t = " << t << ", error = " << error << ", epsilon = " << epsilon << ", h = " << h;
+
+          double hNext;
+          if (q <= 0.1) {
+            hNext = 0.1*h;
+          } else if (q > 4) {
+            hNext = 4*h;
+          } else {
+            hNext = q*h;
+          }
 
-            Log(Logger::LOG_DEBUG) <<
-                  "RK45: Update state vector";
+          if (hNext > hmax) { hNext = hmax; }
 
-            // y = y + (1408*h/2565) k_3
+          if (error <= epsilon) {
+            // ynew = y + (25/216)*h k_1 + (1408/2565)*h k_3 + (2197/4104)*h k_4 - (1/5)*h k_5
+            dcopy_(&n, y, &inc, ynew, &inc);
+            alpha = (25./216)*h;
+            daxpy_(&n, &alpha, k1, &inc, ynew, &inc);
             alpha = 1408.*h/2565;
-            daxpy_(&n, &alpha, k3, &inc, y, &inc);
-
-            // y = y + (1408/2565)*h k_3) + (2197/4104)*h k_4
+            daxpy_(&n, &alpha, k3, &inc, ynew, &inc);
             alpha = (2197./4104)*h;
-            daxpy_(&n, &alpha, k4, &inc, y, &inc);
-
-
-            // y = (y + (1408/2565)*h k_3 + (2197/4104)*h k_4) - (1/5)*h k_5
+            daxpy_(&n, &alpha, k4, &inc, ynew, &inc);
             alpha = (-1./5)*h;
-            daxpy_(&n, &alpha, k5, &inc, y, &inc);
+            daxpy_(&n, &alpha, k5, &inc, ynew, &inc);
 
-            // y = y + (25/216)*h k_1 + (1408/2565)*h k_3 + (2197/4104)*h k_4 - (1/5)*h k_5
-            alpha = (25./216)*h;
-            daxpy_(&n, &alpha, k1, &inc, y, &inc);
+            tStep = t;
+            hStep = h;
 
-            model->setTime(t + h);
-            model->setStateVector(y);
-            t = t + h;
+            // rate at the end of the step, for the dense output, and the
+            // first stage of the next step.
+            double t1 = last ? tLimit : t + h;
+            model->getStateVectorRate(t1, ynew, fnew);
 
-            for(int i=0; i<stateVectorSize; ++i) {
-              Log(Logger::LOG_DEBUG) << "  " << y[i];
+            // a step cut short to land on tLimit says nothing about
+            // the step size the error control would take.
+            if (!last || hNext < hCurrent) {
+              hCurrent = hNext;
             }
+
+            return t1;
           }
 
-          if (q <= 0.1) {
-            h = 0.1*h;
-          } else if (q > 4) {
-            h = 4*h;
-          } else {
-            h = q*h;
+          if (h <= hmin) {
+            throw IntegratorException("RK45Integrator: the step size required "
+                "to meet epsilon is less than the minimum time step", "RK45Integrator::step");
           }
 
-          if (h > hmax) { h = hmax; }
+          h = hNext < hmin ? hmin : hNext;
+        }
+    }
 
-        } while ( error > getValueAsDouble("epsilon") && h > hmin );
+    bool RK45Integrator::canResume(double t)
+    {
+        if (!stepPending) {
+            return false;
+        }
 
-        hCurrent = h;
-        if (tEnd - t < hCurrent)
-          hCurrent = tEnd - t;
+        // RoadRunner recomputes the output times, so they may differ by
+        // round off from the ones returned.
+        const double tol = 100 * std::numeric_limits<double>::epsilon()
+                * std::max(1., std::fabs(tOutput));
 
-          Log(Logger::LOG_DEBUG) <<
-                "RK45: end of step";
-        return t;
+        if (std::fabs(t - tOutput) > tol || std::fabs(model->getTime() - tOutput) > tol) {
+            return false;
+        }
+
+        model->getStateVector(err);
+        if (std::memcmp(err, yout, stateVectorSize * sizeof(double)) != 0) {
+            return false;
+        }
+
+        getModelInputs(currentInputs);
+        return currentInputs == outputInputs;
+    }
+
+    void RK45Integrator::getModelInputs(std::vector<double>& values)
+    {
+        const int numParameters = model->getNumGlobalParameters();
+        const int numBoundary = model->getNumBoundarySpecies();
+        const int numCompartments = model->getNumCompartments();
+
+        values.resize(numParameters + numBoundary + numCompartments);
+
+        if (numParameters) {
+            model->getGlobalParameterValues(numParameters, 0, &values[0]);
+        }
+        if (numBoundary) {
+            model->getBoundarySpeciesAmounts(numBoundary, 0, &values[numParameters]);
+        }
+        if (numCompartments) {
+            model->getCompartmentVolumes(numCompartments, 0,
+                    &values[numParameters + numBoundary]);
+        }
+    }
+
+    void RK45Integrator::evaluate(double t, double* yt) const
+    {
+        // cubic Hermite interpolation between (y, k1) at the start and
+        // (ynew, fnew) at the end of the step.
+        double theta = (t - tStep) / hStep;
+        double theta2 = theta * theta;
+        double theta3 = theta2 * theta;
+
+        double h00 = 2. * theta3 - 3. * theta2 + 1.;
+        double h10 = (theta3 - 2. * theta2 + theta) * hStep;
+        double h01 = -2. * theta3 + 3. * theta2;
+        double h11 = (theta3 - theta2) * hStep;
+
+        for (unsigned i = 0; i < stateVectorSize; ++i) {
+            yt[i] = h00 * y[i] + h10 * k1[i] + h01 * ynew[i] + h11 * fnew[i];
+        }
     }
 
     void RK45Integrator::testRootsAtInitialTime()
@@ -258,6 +419,9 @@ namespace rr
             return;
         }
 
+        stepPending = false;
+        hCurrent = 0.;
+
         if (t0 <= 0.0) {
             if (y)
             {
@@ -311,7 +475,10 @@ namespace rr
     }
 
     std::string RK45Integrator::getRK45Description() {
-        return "Kiri, please fill in";
+        return "The Runge-Kutta-Fehlberg method is an adaptive step, "
+            "4th order Runge-Kutta method, which uses an embedded 5th "
+            "order method to estimate the local error. Output at the "
+            "requested times is interpolated from the internal steps.";
     }
 
     std::string RK45Integrator::getHint() const {
@@ -322,14 +489,6 @@ namespace rr
         return "Internal RK45 ODE solver";
     }
 
-    Variant RK45Integrator::getValue(std::string key)
-    {
-        if (key == "variable_step_size")
-            return true;
-        else
-            return Integrator::getValue(key);
-    }
-
     Integrator::IntegrationMethod RK45Integrator::getIntegrationMethod() const
     {
         return Integrator::Deterministic;
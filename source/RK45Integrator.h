@@ -16,6 +16,7 @@
 
 #include <Integrator.h>
 #include <rrRoadRunnerOptions.h>
+#include <RKEventLocator.h>
 
 namespace rr
 {
@@ -26,8 +27,14 @@ namespace rr
      * @brief A Runge-Kutta Fehlberg method for roadrunner
      * @details Uses the Fehlberg method, an adaptive step
      * method, to integrate models.
+     *
+     * Each step has a cubic Hermite dense output, built from the states
+     * and rates at both ends of the step. It is used to locate events
+     * within a step, and, in fixed step mode, to sample the solution at
+     * the requested output times, so the internal step size is chosen by
+     * the error control alone and is not cut down to the output interval.
      */
-    class RK45Integrator: public Integrator
+    class RK45Integrator: public Integrator, private RKEventLocator::DenseOutput
     {
     public:
         /**
@@ -58,13 +65,19 @@ namespace rr
         /**
          * @author CC
          * @brief Integrates the model from t to t + h.
-         * @details Attempts to find the state vector at
-         * t + h, and returns time t + h if successful.
-         * If the integrator does not find a convergent
-         * solution, the state vector is not updated and 
-         * t is returned.
-         * Also calculates a new timestep and saves it 
-         * to a member variable for future use.
+         * @details In fixed step mode, finds the state vector at
+         * t + h and returns t + h. The state at t + h is interpolated
+         * from the internal step which covers it, and the next call
+         * continues from that step, provided the model state has not
+         * been changed in between.
+         *
+         * In variable step mode, h is the end time of the simulation,
+         * a single step is taken and the time reached is returned.
+         *
+         * In either mode, a step is broken at any event trigger or
+         * delayed event within it, and the events are applied.
+         * Throws an IntegratorException if the step size required
+         * falls below the minimum time step.
          */
         virtual double integrate(double t, double h);
 
@@ -126,8 +139,6 @@ namespace rr
 
         // ** Getters / Setters ************************************************
 
-        virtual Variant getValue(std::string key);
-
         /**
          * @author JKM
          * @brief Always deterministic for RK45
@@ -171,9 +182,59 @@ namespace rr
 
         double *k5, *k6, *err;
 
+        /**
+        * state and rate at the end of the last step, and the last
+        * interpolated output state.
+        */
+        double *ynew, *fnew, *yout;
+
+        /**
+        * start time and size of the last step taken.
+        */
+        double tStep, hStep;
+
+        /**
+        * the last step has been taken past the last output time, tOutput,
+        * and y, k1, ynew and fnew still hold it.
+        */
+        bool stepPending;
+        double tOutput;
+
+        /**
+        * the parameters, boundary species and compartment volumes at the
+        * last output time, and space to compare the current ones with.
+        */
+        std::vector<double> outputInputs, currentInputs;
+
+        RKEventLocator events;
+
         void testRootsAtInitialTime();
         void applyEvents(double timeEnd, std::vector<unsigned char> &previousEventStatus);
 
+        /**
+        * take a single accepted step from (t, y) with the rate k1, no
+        * further than tLimit. The result is stored in ynew and fnew.
+        * @return the end time of the step, exactly tLimit if it was reached.
+        */
+        double step(double t, double tLimit);
+
+        /**
+        * the pending step may be continued if the model is still at the
+        * last output time and state, and nothing else it depends on was
+        * changed from outside, i.e. a parameter by setValue.
+        */
+        bool canResume(double t);
+
+        /**
+        * the values the rates depend on which are not in the state vector.
+        */
+        void getModelInputs(std::vector<double>& values);
+
+        /**
+        * dense output of the last step.
+        */
+        virtual void evaluate(double t, double* yt) const;
+
     };
 
 
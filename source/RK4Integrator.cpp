@@ -9,6 +9,7 @@
 #include <rrExecutableModel.h>
 
 #include <cassert>
+#include <algorithm>
 
 extern "C" {
 #include <clapack/f2c.h>
@@ -22,7 +23,8 @@ namespace rr
     {
         Log(Logger::LOG_NOTICE) << "creating runge-kutta integrator";
         stateVectorSize = 0;
-        k1 = k2 = k3 = k4 = y = ytmp = NULL;
+        tStep = hStep = 0;
+        k1 = k2 = k3 = k4 = y = ytmp = ynew = NULL;
         syncWithModel(m);
     }
 
@@ -35,6 +37,7 @@ namespace rr
         delete []k4;
         delete []y;
         delete []ytmp;
+        delete []ynew;
 
         model = m;
 
@@ -46,11 +49,14 @@ namespace rr
             k4 = new double[stateVectorSize];
             y = new double[stateVectorSize];
             ytmp = new double[stateVectorSize];
+            ynew = new double[stateVectorSize];
         } else {
             stateVectorSize = 0;
-            k1 = k2 = k3 = k4 = y = NULL;
+            k1 = k2 = k3 = k4 = y = ytmp = ynew = NULL;
         }
 
+        events.syncWithModel(model);
+
         resetSettings();
     }
 
@@ -62,17 +68,16 @@ namespace rr
         delete []k4;
         delete []y;
         delete []ytmp;
+        delete []ynew;
     }
 
     double RK4Integrator::integrate(double t, double h)
     {
-        static const double epsilon = 1e-12;
         double tf = 0;
-        bool singleStep;
+        double tRoot = 0;
 
         assert(h > 0 && "h must be > 0");
         tf = t + h;
-        singleStep = false;
 
         if (!model) {
             throw std::runtime_error("RK4Integrator::integrate: No model");
@@ -81,14 +86,50 @@ namespace rr
         Log(Logger::LOG_DEBUG) <<
                 "RK4Integrator::integrate(" << t << ", " << h << ")";
 
+        model->setTime(t);
+
+        model->getStateVector(y);
+
+        if (events.getNumEvents() == 0) {
+            step(t, h);
+            std::swap(y, ynew);
+        } else {
+            while (t < tf) {
+                events.beginStep(t, y);
+
+                // break the step at delayed events
+                double tNext = events.getStopTime(tf);
+
+                step(t, tNext - t);
+
+                if (events.findRoot(tNext, ynew, *this, tRoot, ytmp)) {
+                    std::swap(y, ytmp);
+                    t = tRoot;
+                    events.applyTriggeredEvents(t, y);
+                } else {
+                    std::swap(y, ynew);
+                    t = tNext;
+                }
+
+                events.applyPendingEvents(t, y);
+            }
+        }
+
+        model->setTime(tf);
+        model->setStateVector(y);
+
+        return tf;
+    }
+
+    void RK4Integrator::step(double t, double h)
+    {
         // blas daxpy: y -> y + \alpha x
         integer n = stateVectorSize;
         integer inc = 1;
         double alpha = 0;
 
-        model->setTime(t);
-
-        model->getStateVector(y);
+        tStep = t;
+        hStep = h;
 
         // k1 = f(t_n, y_n)
         model->getStateVectorRate(t, y, k1);
@@ -111,27 +152,36 @@ namespace rr
         daxpy_(&n, &alpha, k3, &inc, ytmp, &inc);
         model->getStateVectorRate(t + alpha, ytmp, k4);
 
-        // k_1 = k_1 + 2 k_2
-        alpha = 2.;
-        daxpy_(&n, &alpha, k2, &inc, k1, &inc);
+        // y_{n+1} = y_n + (h/6)(k_1 + 2 k_2 + 2 k_3 + k_4),
+        // the stages are left intact for the dense output.
+        dcopy_(&n, y, &inc, ynew, &inc);
 
-        // k_1 = (k_1 + 2 k_2) + 2 k_3
-        alpha = 2.;
-        daxpy_(&n, &alpha, k3, &inc, k1, &inc);
-
-        // k_1 = (k_1 + 2 k_2 + 2 k_3) + k_4
-        alpha = 1.;
-        daxpy_(&n, &alpha, k4, &inc, k1, &inc);
-
-        // y_{n+1} = (h/6)(k_1 + 2 k_2 + 2 k_3 + k_4);
         alpha = h/6.;
+        daxpy_(&n, &alpha, k1, &inc, ynew, &inc);
 
-        daxpy_(&n, &alpha, k1, &inc, y, &inc);
+        alpha = h/3.;
+        daxpy_(&n, &alpha, k2, &inc, ynew, &inc);
+        daxpy_(&n, &alpha, k3, &inc, ynew, &inc);
 
-        model->setTime(t + h);
-        model->setStateVector(y);
+        alpha = h/6.;
+        daxpy_(&n, &alpha, k4, &inc, ynew, &inc);
+    }
 
-        return t + h;
+    void RK4Integrator::evaluate(double t, double* yout) const
+    {
+        // third order continuous extension of the classic RK4 method,
+        // Hairer, Norsett and Wanner, Solving ODEs I, II.6.
+        double theta = (t - tStep) / hStep;
+        double theta2 = theta * theta;
+        double theta3 = theta2 * theta;
+
+        double b1 = theta - 3. * theta2 / 2. + 2. * theta3 / 3.;
+        double b23 = theta2 - 2. * theta3 / 3.;
+        double b4 = -theta2 / 2. + 2. * theta3 / 3.;
+
+        for (unsigned i = 0; i < stateVectorSize; ++i) {
+            yout[i] = y[i] + hStep * (b1 * k1[i] + b23 * (k2[i] + k3[i]) + b4 * k4[i]);
+        }
     }
 
     void RK4Integrator::testRootsAtInitialTime()
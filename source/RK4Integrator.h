@@ -10,6 +10,7 @@
 
 #include <Integrator.h>
 #include <rrRoadRunnerOptions.h>
+#include <RKEventLocator.h>
 
 namespace rr
 {
@@ -24,8 +25,12 @@ namespace rr
     *
     * This object is mainly here as an example of creating a new Integrator.
     *
+    * Events are supported, trigger changes are located within a step with
+    * the third order continuous extension of the classic RK4 method, the
+    * step is then cut short at the event time, the events are applied and
+    * integration continues from there.
     */
-    class RK4Integrator: public Integrator
+    class RK4Integrator: public Integrator, private RKEventLocator::DenseOutput
     {
     public:
 
@@ -66,9 +71,12 @@ namespace rr
     public:
 
         /**
-        * integrates the model from t0 to tf.
+        * integrates the model from t to t + h.
+        *
+        * This is a single step, unless an event triggers or a delayed event
+        * is due within it, in which case the step is broken at the event time.
         */
-        virtual double integrate(double t0, double tf);
+        virtual double integrate(double t, double h);
 
         /**
         * copies the state vector out of the model and into cvode vector,
@@ -192,11 +200,29 @@ namespace rr
         /**
         * arrays to store function eval values.
         */
-        double *k1, *k2, *k3, *k4, *y, *ytmp;
+        double *k1, *k2, *k3, *k4, *y, *ytmp, *ynew;
+
+        /**
+        * start time and size of the last step taken.
+        */
+        double tStep, hStep;
+
+        RKEventLocator events;
 
         void testRootsAtInitialTime();
         void applyEvents(double timeEnd, std::vector<unsigned char> &previousEventStatus);
 
+        /**
+        * take a single RK4 step of size h from (t, y), the result is stored
+        * in ynew, y and the stages are kept for the dense output.
+        */
+        void step(double t, double h);
+
+        /**
+        * dense output of the last step.
+        */
+        virtual void evaluate(double t, double* yout) const;
+
     };
 
 
@@ -0,0 +1,155 @@
+/*
+ * RKEventLocator.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "RKEventLocator.h"
+#include "rrExecutableModel.h"
+#include "rrLogger.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace rr
+{
+
+RKEventLocator::RKEventLocator() :
+        model(0),
+        numEvents(0),
+        t0(0)
+{
+}
+
+void RKEventLocator::syncWithModel(ExecutableModel* m)
+{
+    model = m;
+    numEvents = model ? model->getEventTriggers(0, 0, 0) : 0;
+    eventStatus.resize(numEvents);
+    g0.resize(numEvents);
+    g.resize(numEvents);
+}
+
+unsigned RKEventLocator::getNumEvents() const
+{
+    return numEvents;
+}
+
+void RKEventLocator::beginStep(double t, const double* y)
+{
+    if (numEvents == 0)
+    {
+        return;
+    }
+
+    t0 = t;
+    model->setTime(t);
+    model->setStateVector(y);
+    model->getEventTriggers(numEvents, 0, &eventStatus[0]);
+    model->getEventRoots(t, y, &g0[0]);
+}
+
+double RKEventLocator::getStopTime(double tEnd)
+{
+    if (model && model->getPendingEventSize() > 0)
+    {
+        double next = model->getNextPendingEventTime(false);
+        if (next > t0 && next < tEnd)
+        {
+            return next;
+        }
+    }
+    return tEnd;
+}
+
+bool RKEventLocator::rootChanged() const
+{
+    for (unsigned i = 0; i < numEvents; ++i)
+    {
+        if ((g0[i] > 0) != (g[i] > 0))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool RKEventLocator::findRoot(double t1, const double* y1,
+        const DenseOutput& dense, double& tRoot, double* yRoot)
+{
+    if (numEvents == 0)
+    {
+        return false;
+    }
+
+    model->getEventRoots(t1, y1, &g[0]);
+
+    if (!rootChanged())
+    {
+        return false;
+    }
+
+    // same root tolerance CVODE uses.
+    const double tol = 100 * std::numeric_limits<double>::epsilon()
+            * (std::fabs(t1) + std::fabs(t1 - t0));
+
+    // invariant: no trigger changed at ta, some trigger changed at tb.
+    double ta = t0;
+    double tb = t1;
+    bool yRootIsTb = false;
+
+    while (tb - ta > tol)
+    {
+        double tm = 0.5 * (ta + tb);
+        dense.evaluate(tm, yRoot);
+        model->getEventRoots(tm, yRoot, &g[0]);
+
+        if (rootChanged())
+        {
+            tb = tm;
+            yRootIsTb = true;
+        }
+        else
+        {
+            ta = tm;
+            yRootIsTb = false;
+        }
+    }
+
+    if (tb == t1)
+    {
+        std::memcpy(yRoot, y1, model->getStateVector(0) * sizeof(double));
+    }
+    else if (!yRootIsTb)
+    {
+        dense.evaluate(tb, yRoot);
+    }
+
+    Log(Logger::LOG_DEBUG) << "RKEventLocator: located event root at "
+            << tb << " in step [" << t0 << ", " << t1 << "]";
+
+    tRoot = tb;
+    return true;
+}
+
+int RKEventLocator::applyTriggeredEvents(double t, double* y)
+{
+    model->setTime(t);
+    return model->applyEvents(t, &eventStatus[0], y, y);
+}
+
+int RKEventLocator::applyPendingEvents(double t, double* y)
+{
+    if (numEvents == 0 || model->getPendingEventSize() == 0)
+    {
+        return 0;
+    }
+
+    model->setTime(t);
+    model->setStateVector(y);
+    model->getEventTriggers(numEvents, 0, &eventStatus[0]);
+    return model->applyEvents(t, &eventStatus[0], 0, y);
+}
+
+} /* namespace rr */
@@ -0,0 +1,125 @@
+/*
+ * RKEventLocator.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef RKEVENTLOCATOR_H_
+#define RKEVENTLOCATOR_H_
+
+#include <vector>
+
+namespace rr
+{
+
+class ExecutableModel;
+
+/**
+ * Event detection and application for the explicit Runge-Kutta integrators.
+ *
+ * The integrators call beginStep before each step, then findRoot once the
+ * step is taken. If the trigger of any event changed value over the step,
+ * the time of the earliest change is located by bisection on the dense
+ * output of the step. This only costs event trigger evaluations, the model
+ * rates are not evaluated again.
+ *
+ * The event roots of ExecutableModel::getEventRoots are +1 / -1 trigger
+ * values rather than smooth functions, so bisection is the only bracketing
+ * method that applies. As with CVODE, a trigger that changes value twice
+ * in a single step is not seen.
+ *
+ * Events are applied the same way the CVODEIntegrator applies them, with
+ * ExecutableModel::applyEvents and the trigger status from the start of
+ * the step. Delayed events are handled by stopping each step at the next
+ * pending event time.
+ */
+class RKEventLocator
+{
+public:
+
+    /**
+     * The continuous extension of a single step, supplied by the integrator.
+     */
+    class DenseOutput
+    {
+    public:
+        virtual ~DenseOutput() {};
+
+        /**
+         * evaluate the state at time t, which is within the current step.
+         */
+        virtual void evaluate(double t, double* y) const = 0;
+    };
+
+    RKEventLocator();
+
+    /**
+     * resize the trigger buffers for a new model, the model may be NULL.
+     */
+    void syncWithModel(ExecutableModel* m);
+
+    /**
+     * number of events in the model, the integrators skip all event
+     * handling when there are none.
+     */
+    unsigned getNumEvents() const;
+
+    /**
+     * record the trigger status and roots at the start of a step, this
+     * also sets the model time and state to (t, y).
+     */
+    void beginStep(double t, const double* y);
+
+    /**
+     * the time the next step must not go past, the earlier of tEnd and the
+     * next pending (delayed) event time.
+     */
+    double getStopTime(double tEnd);
+
+    /**
+     * check the step which ended at (t1, y1) for trigger changes.
+     *
+     * If any changed, sets tRoot to the earliest time at which a trigger
+     * has its new value, to within round off, evaluates the state there
+     * into yRoot and returns true.
+     */
+    bool findRoot(double t1, const double* y1, const DenseOutput& dense,
+            double& tRoot, double* yRoot);
+
+    /**
+     * apply the events triggered in the step at time t. y holds the state
+     * on input, and the state after the event assignments on output.
+     *
+     * @return the number of events applied.
+     */
+    int applyTriggeredEvents(double t, double* y);
+
+    /**
+     * apply any pending events which are due at time t, y as above.
+     *
+     * @return the number of events applied.
+     */
+    int applyPendingEvents(double t, double* y);
+
+private:
+    ExecutableModel* model;
+    unsigned numEvents;
+
+    /**
+     * start time of the current step.
+     */
+    double t0;
+
+    std::vector<unsigned char> eventStatus;
+
+    /**
+     * roots at the start of the step, and scratch space.
+     */
+    std::vector<double> g0, g;
+
+    bool rootChanged() const;
+};
+
+} /* namespace rr */
+
+#endif /* RKEVENTLOCATOR_H_ */
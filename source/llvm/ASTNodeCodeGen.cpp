@@ -11,6 +11,7 @@
 
 #pragma hdrstop
 #include "ASTNodeCodeGen.h"
+#include "CodeGenBase.h"
 #include "LLVMException.h"
 #include "rrOSSpecifics.h"
 #include "LLVMIncludes.h"
@@ -23,6 +24,8 @@
 #include <sbml/SBase.h>
 #include <Poco/Logger.h>
 #include <cmath>
+#include <cstring>
+#include <algorithm>
 
 using namespace libsbml;
 using namespace llvm;
@@ -809,6 +812,11 @@ llvm::Value* ASTNodeCodeGen::piecewiseCodeGen(const libsbml::ASTNode* ast)
     // the next piece is the 'else' part.  This is terminated with the
     // otherwise block.
 
+    if (Value *table = piecewiseTableCodeGen(ast))
+    {
+        return table;
+    }
+
     LLVMContext &context = builder.getContext();
 
     Function *func = builder.GetInsertBlock()->getParent();
@@ -836,9 +844,14 @@ llvm::Value* ASTNodeCodeGen::piecewiseCodeGen(const libsbml::ASTNode* ast)
         // the conditional
         const ASTNode *condNode = ast->getChild(i++);
 
-        resolver.pushCacheBlock();
-        Value *cond = toBoolean(codeGen(condNode));
-        resolver.popCacheBlock();
+        // the condition is compared exactly, even under fast math
+        Value *cond = 0;
+        {
+            StrictMathScope strict(builder);
+            resolver.pushCacheBlock();
+            cond = toBoolean(codeGen(condNode));
+            resolver.popCacheBlock();
+        }
 
         builder.CreateCondBr(cond, thenBB, elseBB);
 
@@ -915,6 +928,523 @@ llvm::Value* ASTNodeCodeGen::piecewiseCodeGen(const libsbml::ASTNode* ast)
     return pn;
 }
 
+/**
+ * A piecewise which is a lookup in a sorted table of pieces.
+ *
+ * The piece which is selected is the first one whose bound satisfies
+ * 'x pred bounds[i]', these are sorted so the comparison is false for all
+ * the pieces before it, and true for all the ones after, which is what
+ * the binary search needs. If the pieces are intervals, the piece is only
+ * selected if 'x lowerPred lowers[i]' also holds, the intervals are
+ * disjoint, so no later piece can match either. Otherwise the otherwise
+ * value is used.
+ *
+ * The value of piece i is values[i] + slopes[i] * (x - refs[i]), so a
+ * linearly interpolated time series is also a table.
+ */
+struct PiecewiseTable
+{
+    PiecewiseTable() : x(0), pred(CmpInst::FCMP_ULT), intervals(false),
+            lowerPred(CmpInst::FCMP_UGE), linear(false), uniform(false) {}
+
+    const ASTNode *x;
+    CmpInst::Predicate pred;
+    bool intervals;
+    CmpInst::Predicate lowerPred;
+    bool linear;
+    bool uniform;
+    vector<double> bounds;
+    vector<double> lowers;
+    vector<double> values;
+    vector<double> slopes;
+    vector<double> refs;
+};
+
+static bool getNumber(const ASTNode *ast, double &value)
+{
+    if (ast->getType() == AST_INTEGER)
+    {
+        value = ast->getInteger();
+        return true;
+    }
+    else if (ast->isReal())
+    {
+        value = ast->getReal();
+        return true;
+    }
+    else if (ast->getType() == AST_MINUS && ast->getNumChildren() == 1
+            && getNumber(ast->getChild(0), value))
+    {
+        value = -value;
+        return true;
+    }
+    return false;
+}
+
+static bool isVariable(const ASTNode *ast)
+{
+    return ast->getType() == AST_NAME_TIME ||
+            (ast->getType() == AST_NAME && ast->getName());
+}
+
+static bool isSameVariable(const ASTNode *a, const ASTNode *b)
+{
+    if (a->getType() != b->getType())
+    {
+        return false;
+    }
+
+    // the time csymbol may be given any name.
+    return a->getType() == AST_NAME_TIME || (a->getName() && b->getName()
+            && strcmp(a->getName(), b->getName()) == 0);
+}
+
+/**
+ * a comparison of the table variable with a number, as 'x pred bound'. The
+ * predicates are the same unordered ones applyRelationalCodeGen uses, so
+ * NaNs select the same piece as the chain of comparisons would.
+ */
+static bool getComparison(const ASTNode *ast, PiecewiseTable &table,
+        CmpInst::Predicate &pred, double &bound)
+{
+    if (!ast->isRelational() || ast->getNumChildren() != 2)
+    {
+        return false;
+    }
+
+    const ASTNode *lhs = ast->getChild(0);
+    const ASTNode *rhs = ast->getChild(1);
+    bool varLeft;
+
+    if (isVariable(lhs) && getNumber(rhs, bound))
+    {
+        varLeft = true;
+        if (!table.x)
+        {
+            table.x = lhs;
+        }
+        if (!isSameVariable(table.x, lhs))
+        {
+            return false;
+        }
+    }
+    else if (isVariable(rhs) && getNumber(lhs, bound))
+    {
+        varLeft = false;
+        if (!table.x)
+        {
+            table.x = rhs;
+        }
+        if (!isSameVariable(table.x, rhs))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        return false;
+    }
+
+    switch (ast->getType())
+    {
+    case AST_RELATIONAL_LT:
+        pred = varLeft ? CmpInst::FCMP_ULT : CmpInst::FCMP_UGT;
+        return true;
+    case AST_RELATIONAL_LEQ:
+        pred = varLeft ? CmpInst::FCMP_ULE : CmpInst::FCMP_UGE;
+        return true;
+    case AST_RELATIONAL_GT:
+        pred = varLeft ? CmpInst::FCMP_UGT : CmpInst::FCMP_ULT;
+        return true;
+    case AST_RELATIONAL_GEQ:
+        pred = varLeft ? CmpInst::FCMP_UGE : CmpInst::FCMP_ULE;
+        return true;
+    default:
+        return false;
+    }
+}
+
+static bool isUpper(CmpInst::Predicate pred)
+{
+    return pred == CmpInst::FCMP_ULT || pred == CmpInst::FCMP_ULE;
+}
+
+/**
+ * a condition, either 'x < bound' or 'x >= lower && x < bound', with any
+ * of the strict or non strict comparisons, which must be the same for all
+ * the pieces.
+ */
+static bool getCondition(const ASTNode *ast, PiecewiseTable &table, bool first)
+{
+    CmpInst::Predicate pred;
+    double bound;
+
+    if (ast->getType() == AST_LOGICAL_AND && ast->getNumChildren() == 2)
+    {
+        CmpInst::Predicate pred2;
+        double bound2;
+
+        if (!getComparison(ast->getChild(0), table, pred, bound) ||
+                !getComparison(ast->getChild(1), table, pred2, bound2))
+        {
+            return false;
+        }
+
+        if (!isUpper(pred))
+        {
+            std::swap(pred, pred2);
+            std::swap(bound, bound2);
+        }
+
+        if (!isUpper(pred) || isUpper(pred2))
+        {
+            return false;
+        }
+
+        if (first)
+        {
+            table.intervals = true;
+            table.pred = pred;
+            table.lowerPred = pred2;
+        }
+
+        if (!table.intervals || pred != table.pred || pred2 != table.lowerPred)
+        {
+            return false;
+        }
+
+        table.bounds.push_back(bound);
+        table.lowers.push_back(bound2);
+        return true;
+    }
+
+    if (!getComparison(ast, table, pred, bound) || !isUpper(pred))
+    {
+        return false;
+    }
+
+    if (first)
+    {
+        table.pred = pred;
+    }
+
+    if (table.intervals || pred != table.pred)
+    {
+        return false;
+    }
+
+    table.bounds.push_back(bound);
+    return true;
+}
+
+/**
+ * a piece value, a number, 'a + b * x' or 'a + b * (x - c)'.
+ */
+static bool getPieceValue(const ASTNode *ast, PiecewiseTable &table)
+{
+    double a, b, c = 0;
+
+    if (getNumber(ast, a))
+    {
+        table.values.push_back(a);
+        table.slopes.push_back(0);
+        table.refs.push_back(0);
+        return true;
+    }
+
+    if (ast->getType() != AST_PLUS || ast->getNumChildren() != 2)
+    {
+        return false;
+    }
+
+    const ASTNode *times = ast->getChild(1);
+    if (!getNumber(ast->getChild(0), a))
+    {
+        times = ast->getChild(0);
+        if (!getNumber(ast->getChild(1), a))
+        {
+            return false;
+        }
+    }
+
+    if (times->getType() != AST_TIMES || times->getNumChildren() != 2)
+    {
+        return false;
+    }
+
+    const ASTNode *dx = times->getChild(1);
+    if (!getNumber(times->getChild(0), b))
+    {
+        dx = times->getChild(0);
+        if (!getNumber(times->getChild(1), b))
+        {
+            return false;
+        }
+    }
+
+    if (dx->getType() == AST_MINUS && dx->getNumChildren() == 2)
+    {
+        if (!getNumber(dx->getChild(1), c))
+        {
+            return false;
+        }
+        dx = dx->getChild(0);
+    }
+
+    if (!isVariable(dx) || !isSameVariable(table.x, dx))
+    {
+        return false;
+    }
+
+    table.values.push_back(a);
+    table.slopes.push_back(b);
+    table.refs.push_back(c);
+    table.linear = true;
+    return true;
+}
+
+static bool getPiecewiseTable(const ASTNode *ast, PiecewiseTable &table)
+{
+    const uint nchild = ast->getNumChildren();
+
+    // conditions first, they determine the variable.
+    for (uint i = 1; i < nchild; i += 2)
+    {
+        if (!getCondition(ast->getChild(i), table, i == 1))
+        {
+            return false;
+        }
+    }
+
+    for (uint i = 0; i + 1 < nchild; i += 2)
+    {
+        if (!getPieceValue(ast->getChild(i), table))
+        {
+            return false;
+        }
+    }
+
+    const vector<double> &bounds = table.bounds;
+    const uint n = bounds.size();
+
+    for (uint i = 0; i < n; ++i)
+    {
+        if (i > 0 && !(bounds[i] > bounds[i - 1]))
+        {
+            return false;
+        }
+
+        if (table.intervals && (!(table.lowers[i] <= bounds[i]) ||
+                (i > 0 && !(table.lowers[i] >= bounds[i - 1]))))
+        {
+            return false;
+        }
+    }
+
+    // a uniform grid is indexed directly, rounding is corrected by
+    // comparing with the neighbouring bounds, so nearly uniform is enough.
+    double h = (bounds[n - 1] - bounds[0]) / (n - 1);
+    table.uniform = true;
+    for (uint i = 0; i < n && table.uniform; ++i)
+    {
+        table.uniform = std::fabs(bounds[i] - (bounds[0] + i * h)) <= 1e-9 * h;
+    }
+
+    return true;
+}
+
+static GlobalVariable *createTableArray(Module *module,
+        const vector<double> &data, const char* name)
+{
+    Constant *init = ConstantDataArray::get(module->getContext(),
+            ArrayRef<double>(data));
+    return new GlobalVariable(*module, init->getType(), true,
+            GlobalValue::InternalLinkage, init, name);
+}
+
+static Value *createTableLoad(IRBuilder<> &builder, GlobalVariable *array,
+        Value *index, const Twine &name)
+{
+    Value *idxs[] = {
+        ConstantInt::get(Type::getInt32Ty(builder.getContext()), 0),
+        index
+    };
+    return builder.CreateLoad(builder.CreateInBoundsGEP(array, idxs,
+            name + "_gep"), name);
+}
+
+llvm::Value* ASTNodeCodeGen::piecewiseTableCodeGen(const libsbml::ASTNode* ast)
+{
+    const int minSize = rr::Config::getInt(rr::Config::LLVM_PIECEWISE_TABLE_MIN_SIZE);
+    const uint nchild = ast->getNumChildren();
+    const uint n = nchild / 2;
+    PiecewiseTable table;
+
+    if (minSize <= 0 || n < 2 || n < (uint)minSize || !getPiecewiseTable(ast, table))
+    {
+        return 0;
+    }
+
+    Log(Logger::LOG_DEBUG) << "generating piecewise with " << n << " pieces "
+            << (table.intervals ? "on intervals" : "on thresholds") << " of "
+            << to_string(table.x) << " as a "
+            << (table.uniform ? "direct" : "binary search") << " table lookup";
+
+    LLVMContext &context = builder.getContext();
+    Module *module = getModule();
+    Function *func = builder.GetInsertBlock()->getParent();
+    Type *int32Ty = Type::getInt32Ty(context);
+    Type *doubleTy = Type::getDoubleTy(context);
+    Value *zero = ConstantInt::get(int32Ty, 0);
+    Value *one = ConstantInt::get(int32Ty, 1);
+    Value *size = ConstantInt::get(int32Ty, n);
+
+    GlobalVariable *bounds = createTableArray(module, table.bounds, "piecewise_bounds");
+
+    // the lookup is the condition, compared exactly even under fast math,
+    // the table values and the otherwise value are generated strict too.
+    StrictMathScope strict(builder);
+
+    resolver.pushCacheBlock();
+    Value *x = toDouble(codeGen(table.x));
+    resolver.popCacheBlock();
+
+    // index of the first piece where 'x pred bounds[i]' holds, n if none.
+    Value *index = 0;
+
+    if (table.uniform)
+    {
+        // bounds[0] + i * h, so the piece is floor((x - bounds[0]) / h) + 1,
+        // clamped to [0, n] before the conversion, NaN goes to 0.
+        double h = (table.bounds[n - 1] - table.bounds[0]) / (n - 1);
+        Value *g = builder.CreateFDiv(builder.CreateFSub(x,
+                ConstantFP::get(context, APFloat(table.bounds[0]))),
+                ConstantFP::get(context, APFloat(h)), "pw_grid");
+        g = builder.CreateFAdd(g, ConstantFP::get(context, APFloat(1.0)));
+        Value *max = ConstantFP::get(context, APFloat((double)n));
+        Value *min = ConstantFP::get(context, APFloat(0.0));
+        g = builder.CreateSelect(builder.CreateFCmpOGT(g, max), max, g);
+        g = builder.CreateSelect(builder.CreateFCmpOGE(g, min), g, min);
+        index = builder.CreateFPToUI(g, int32Ty, "pw_guess");
+
+        // off by at most one, move down if the bound below already holds,
+        // up if the bound at the guess does not.
+        Value *below = builder.CreateSelect(builder.CreateICmpEQ(index, zero),
+                zero, builder.CreateSub(index, one));
+        Value *down = builder.CreateAnd(builder.CreateICmpUGT(index, zero),
+                builder.CreateFCmp(table.pred, x,
+                        createTableLoad(builder, bounds, below, "pw_below")));
+        index = builder.CreateSelect(down, below, index);
+
+        Value *at = builder.CreateSelect(builder.CreateICmpULT(index, size),
+                index, builder.CreateSub(size, one));
+        Value *up = builder.CreateAnd(builder.CreateICmpULT(index, size),
+                builder.CreateNot(builder.CreateFCmp(table.pred, x,
+                        createTableLoad(builder, bounds, at, "pw_at"))));
+        index = builder.CreateSelect(up, builder.CreateAdd(index, one), index,
+                "pw_index");
+    }
+    else
+    {
+        BasicBlock *entryBB = builder.GetInsertBlock();
+        BasicBlock *headBB = BasicBlock::Create(context, "pw_search", func);
+        BasicBlock *bodyBB = BasicBlock::Create(context, "pw_search_body", func);
+        BasicBlock *doneBB = BasicBlock::Create(context, "pw_search_done", func);
+
+        builder.CreateBr(headBB);
+        builder.SetInsertPoint(headBB);
+
+        PHINode *lo = builder.CreatePHI(int32Ty, 2, "pw_lo");
+        PHINode *hi = builder.CreatePHI(int32Ty, 2, "pw_hi");
+        lo->addIncoming(zero, entryBB);
+        hi->addIncoming(size, entryBB);
+
+        builder.CreateCondBr(builder.CreateICmpULT(lo, hi), bodyBB, doneBB);
+
+        builder.SetInsertPoint(bodyBB);
+        Value *mid = builder.CreateLShr(builder.CreateAdd(lo, hi), one, "pw_mid");
+        Value *holds = builder.CreateFCmp(table.pred, x,
+                createTableLoad(builder, bounds, mid, "pw_bound"));
+        lo->addIncoming(builder.CreateSelect(holds, lo,
+                builder.CreateAdd(mid, one)), bodyBB);
+        hi->addIncoming(builder.CreateSelect(holds, mid, hi), bodyBB);
+        builder.CreateBr(headBB);
+
+        builder.SetInsertPoint(doneBB);
+        index = lo;
+    }
+
+    BasicBlock *pieceBB = BasicBlock::Create(context, "pw_piece", func);
+    BasicBlock *owBB = BasicBlock::Create(context, "pw_otherwise");
+    BasicBlock *mergeBB = BasicBlock::Create(context, "pw_merge");
+
+    builder.CreateCondBr(builder.CreateICmpULT(index, size), pieceBB, owBB);
+    builder.SetInsertPoint(pieceBB);
+
+    if (table.intervals)
+    {
+        GlobalVariable *lowers = createTableArray(module, table.lowers,
+                "piecewise_lowers");
+        Value *inside = builder.CreateFCmp(table.lowerPred, x,
+                createTableLoad(builder, lowers, index, "pw_lower"));
+
+        BasicBlock *valueBB = BasicBlock::Create(context, "pw_value", func);
+        builder.CreateCondBr(inside, valueBB, owBB);
+        builder.SetInsertPoint(valueBB);
+    }
+
+    Value *value = createTableLoad(builder, createTableArray(module,
+            table.values, "piecewise_values"), index, "pw_value");
+
+    if (table.linear)
+    {
+        Value *slope = createTableLoad(builder, createTableArray(module,
+                table.slopes, "piecewise_slopes"), index, "pw_slope");
+        Value *ref = createTableLoad(builder, createTableArray(module,
+                table.refs, "piecewise_refs"), index, "pw_ref");
+        value = builder.CreateFAdd(value, builder.CreateFMul(slope,
+                builder.CreateFSub(x, ref)), "pw_interp");
+    }
+
+    builder.CreateBr(mergeBB);
+    BasicBlock *valueBB = builder.GetInsertBlock();
+
+    func->getBasicBlockList().push_back(owBB);
+    builder.SetInsertPoint(owBB);
+
+    Value *owVal = 0;
+
+    if (nchild % 2)
+    {
+        // turn on scalar mode since this is a scalar expression
+        ASTNodeCodeGenScalarTicket t(*this, true);
+
+        resolver.pushCacheBlock();
+        owVal = toDouble(codeGen(ast->getChild(nchild - 1)));
+        resolver.popCacheBlock();
+    }
+    else
+    {
+        Log(Logger::LOG_WARNING) << "No \"otherwise\" element in MathML "
+                "piecewise, returning NaN as \"otherwise\" value";
+
+        owVal = ConstantFP::get(builder.getContext(),
+                APFloat::getQNaN(APFloat::IEEEdouble));
+    }
+
+    builder.CreateBr(mergeBB);
+    BasicBlock *owBlock = builder.GetInsertBlock();
+
+    func->getBasicBlockList().push_back(mergeBB);
+    builder.SetInsertPoint(mergeBB);
+
+    PHINode *pn = builder.CreatePHI(doubleTy, 2, "iftmp");
+    pn->addIncoming(value, valueBB);
+    pn->addIncoming(owVal, owBlock);
+
+    return pn;
+}
+
 static bool isNegative(const libsbml::ASTNode *ast)
 {
     if (ast->getNumChildren() > 0)
@@ -75,6 +75,15 @@ private:
 
     llvm::Value *piecewiseCodeGen(const libsbml::ASTNode *ast);
 
+    /**
+     * generate a piecewise with many pieces of a single variable as a
+     * search in a constant table, see Config::LLVM_PIECEWISE_TABLE_MIN_SIZE.
+     *
+     * @returns the value, or NULL if the piecewise is not of a form which
+     * can be looked up in a table, then nothing is generated.
+     */
+    llvm::Value *piecewiseTableCodeGen(const libsbml::ASTNode *ast);
+
     /**
      * coerces a value to a boolean single bit.
      *
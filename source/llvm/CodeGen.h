@@ -28,6 +28,13 @@ protected:
  */
 #define SBML_TIME_SYMBOL "\\time"
 
+/**
+ * prefix of the special names LLVMModelSymbols gives to the literal initial
+ * values, followed by the element id, see
+ * LLVMModelDataSymbols::getLiteralInitialValues.
+ */
+#define SBML_LITERAL_SYMBOL_PREFIX "\\literal:"
+
 class LoadSymbolResolver
 {
 public:
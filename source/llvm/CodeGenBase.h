@@ -12,6 +12,7 @@
 #include "CodeGen.h"
 #include "LLVMException.h"
 #include "rrLogger.h"
+#include "rrRoadRunnerOptions.h"
 #include <Poco/Logger.h>
 
 using rr::Logger;
@@ -24,6 +25,76 @@ typedef std::vector<std::string> StringVector;
 typedef std::pair<std::string, int> StringIntPair;
 typedef std::vector<StringIntPair> StringIntVector;
 
+/**
+ * sets the fast math flags of the builder for the code generated whilst it
+ * is in scope, if the model was loaded with LoadSBMLOptions::FAST_MATH, and
+ * restores them after. Used for the kinetic laws and rate rules, where
+ * contraction and re-association pay off. Events are generated outside of
+ * it, and piecewise conditions inside it suspend it with a StrictMathScope,
+ * as they depend on exact comparisons.
+ */
+class FastMathScope
+{
+public:
+    FastMathScope(llvm::IRBuilder<> &builder, unsigned options) :
+            builder(builder)
+    {
+#if (LLVM_VERSION_MAJOR == 3) && (LLVM_VERSION_MINOR >= 3)
+        saved = builder.getFastMathFlags();
+        if (options & rr::LoadSBMLOptions::FAST_MATH)
+        {
+            llvm::FastMathFlags flags;
+            flags.setUnsafeAlgebra();
+            builder.SetFastMathFlags(flags);
+        }
+#endif
+    }
+
+    ~FastMathScope()
+    {
+#if (LLVM_VERSION_MAJOR == 3) && (LLVM_VERSION_MINOR >= 3)
+        builder.SetFastMathFlags(saved);
+#endif
+    }
+
+private:
+    llvm::IRBuilder<> &builder;
+#if (LLVM_VERSION_MAJOR == 3) && (LLVM_VERSION_MINOR >= 3)
+    llvm::FastMathFlags saved;
+#endif
+};
+
+/**
+ * clears the fast math flags of the builder for the code generated whilst it
+ * is in scope, and restores them after. Used for the piecewise conditions,
+ * which must compare the exact values even inside a FastMathScope.
+ */
+class StrictMathScope
+{
+public:
+    StrictMathScope(llvm::IRBuilder<> &builder) :
+            builder(builder)
+    {
+#if (LLVM_VERSION_MAJOR == 3) && (LLVM_VERSION_MINOR >= 3)
+        saved = builder.getFastMathFlags();
+        builder.SetFastMathFlags(llvm::FastMathFlags());
+#endif
+    }
+
+    ~StrictMathScope()
+    {
+#if (LLVM_VERSION_MAJOR == 3) && (LLVM_VERSION_MINOR >= 3)
+        builder.SetFastMathFlags(saved);
+#endif
+    }
+
+private:
+    llvm::IRBuilder<> &builder;
+#if (LLVM_VERSION_MAJOR == 3) && (LLVM_VERSION_MINOR >= 3)
+    llvm::FastMathFlags saved;
+#endif
+};
+
 /**
  * a convenience class to pull the vars out of a context, and
  * store them as ivars. It can get tedious alwasy typing mgc.getThis
@@ -35,6 +106,16 @@ class CodeGenBase
 {
 public:
     FunctionPtrType createFunction()
+    {
+        return (FunctionPtrType)engine.getPointerToFunction(createFunctionIR());
+    }
+
+    /**
+     * generate (and optimize if requested) the IR for this function, but do
+     * not JIT it. Used when the module is written out as an object file
+     * rather than executed in process.
+     */
+    llvm::Function *createFunctionIR()
     {
         llvm::Function *func = (llvm::Function*)codeGen();
 
@@ -43,7 +124,7 @@ public:
             functionPassManager->run(*func);
         }
 
-        return (FunctionPtrType)engine.getPointerToFunction(func);
+        return func;
     }
 
     typedef FunctionPtrType FunctionPtr;
@@ -38,6 +38,8 @@ EvalRateRuleRatesCodeGen::~EvalRateRuleRatesCodeGen()
 
 Value* EvalRateRuleRatesCodeGen::codeGen()
 {
+    FastMathScope fastMath(builder, options);
+
     Value *modelData = 0;
 
     codeGenVoidModelDataHeader(FunctionName, modelData);
@@ -39,6 +39,8 @@ EvalReactionRatesCodeGen::~EvalReactionRatesCodeGen()
 
 Value* EvalReactionRatesCodeGen::codeGen()
 {
+    FastMathScope fastMath(builder, options);
+
     // single arg type of LLVMModelData*
     llvm::Type *argTypes[] = {
         llvm::PointerType::get(
@@ -0,0 +1,275 @@
+/*
+ * EvalStateVectorRateCodeGen.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+#pragma hdrstop
+#include "EvalStateVectorRateCodeGen.h"
+#include "LLVMException.h"
+#include "ModelDataSymbolResolver.h"
+#include "SymbolForest.h"
+#include "rrLogger.h"
+#include <sbml/math/ASTNode.h>
+#include <Poco/Logger.h>
+
+
+using namespace libsbml;
+using namespace llvm;
+using namespace std;
+
+
+namespace rrllvm
+{
+
+const char* EvalStateVectorRateCodeGen::FunctionName = "evalStateVectorRate";
+
+EvalStateVectorRateCodeGen::EvalStateVectorRateCodeGen(
+        const ModelGeneratorContext &mgc) :
+        CodeGenBase<EvalStateVectorRate_FunctionPtr>(mgc),
+        coefficients(dataSymbols.getIndependentFloatingSpeciesSize()),
+        constantStoichiometry(model != 0)
+{
+    list<LLVMModelDataSymbols::SpeciesReferenceInfo> stoichEntries =
+            dataSymbols.getStoichiometryIndx();
+
+    for (list<LLVMModelDataSymbols::SpeciesReferenceInfo>::const_iterator i =
+            stoichEntries.begin(); constantStoichiometry && i != stoichEntries.end(); ++i)
+    {
+        const ASTNode *node = modelSymbols.createStoichiometryNode(i->row, i->column);
+
+        double value = 0;
+        constantStoichiometry = getConstantValue(node, value);
+
+        delete node;
+
+        if (constantStoichiometry && i->row < coefficients.size())
+        {
+            coefficients[i->row].push_back(make_pair(i->column, value));
+        }
+    }
+
+    if (!constantStoichiometry)
+    {
+        Log(Logger::LOG_DEBUG) << "stoichiometry is not constant, using the "
+                "stoichiometry matrix to evaluate the state vector rate";
+    }
+}
+
+EvalStateVectorRateCodeGen::~EvalStateVectorRateCodeGen()
+{
+}
+
+bool EvalStateVectorRateCodeGen::hasConstantStoichiometry() const
+{
+    return constantStoichiometry;
+}
+
+Value* EvalStateVectorRateCodeGen::codeGen()
+{
+    assert(constantStoichiometry && "stoichiometry is not constant");
+
+    FastMathScope fastMath(builder, options);
+
+    // single arg type of LLVMModelData*
+    llvm::Type *argTypes[] = {
+        llvm::PointerType::get(
+            ModelDataIRBuilder::getStructType(module), 0)
+    };
+
+    const char *argNames[] = { "modelData" };
+
+    llvm::Value *args[] = { 0 };
+
+    codeGenHeader(FunctionName, llvm::Type::getDoubleTy(context),
+                argTypes, argNames, args);
+
+    Value *modelData = args[0];
+
+    ModelDataLoadSymbolResolver resolver(modelData, modelGenContext);
+    ModelDataIRBuilder mdbuilder(modelData, dataSymbols, builder);
+
+    // the rates only live in registers, each one is evaluated once and
+    // used by every species the reaction changes.
+    const ListOfReactions *reactions = model->getListOfReactions();
+    vector<Value*> rates(reactions->size());
+
+    for (uint i = 0; i < reactions->size(); ++i)
+    {
+        rates[i] = resolver.loadReactionRate(reactions->get(i));
+    }
+
+    string mcfName = model->isSetConversionFactor() ?
+            model->getConversionFactor() : "";
+
+    Value *mcfVal = mcfName.empty() ?
+            ConstantFP::get(Type::getDoubleTy(context), 1.0) :
+            resolver.loadSymbolValue(mcfName);
+
+    vector<string> floatingSpecies = dataSymbols.getFloatingSpeciesIds();
+
+    for (uint row = 0; row < coefficients.size(); ++row)
+    {
+        const string &id = floatingSpecies[row];
+        const CoefficientVector &coef = coefficients[row];
+
+        Value *sum = 0;
+
+        for (CoefficientVector::const_iterator i = coef.begin();
+                i != coef.end(); ++i)
+        {
+            Value *rate = rates[i->first];
+
+            if (i->second == 0.0)
+            {
+                continue;
+            }
+            else if (sum == 0)
+            {
+                sum = i->second == 1.0 ? rate : builder.CreateFMul(
+                        ConstantFP::get(context, APFloat(i->second)), rate);
+            }
+            else if (i->second == 1.0)
+            {
+                sum = builder.CreateFAdd(sum, rate);
+            }
+            else if (i->second == -1.0)
+            {
+                sum = builder.CreateFSub(sum, rate);
+            }
+            else
+            {
+                sum = builder.CreateFAdd(sum, builder.CreateFMul(
+                        ConstantFP::get(context, APFloat(i->second)), rate));
+            }
+        }
+
+        if (sum == 0)
+        {
+            mdbuilder.createFloatSpeciesAmtRateStore(id,
+                    ConstantFP::get(Type::getDoubleTy(context), 0.0));
+            continue;
+        }
+
+        // species conversion factors replace the model one.
+        const Species *s = model->getSpecies(id);
+        Value *cfVal = mcfVal;
+
+        if (s && s->isSetConversionFactor()
+                && s->getConversionFactor().compare(mcfName) != 0)
+        {
+            cfVal = resolver.loadSymbolValue(s->getConversionFactor());
+        }
+
+        mdbuilder.createFloatSpeciesAmtRateStore(id,
+                builder.CreateFMul(cfVal, sum, id + "_amtRate"));
+    }
+
+    builder.CreateRet(mcfVal);
+
+    return verifyFunction();
+}
+
+bool EvalStateVectorRateCodeGen::getConstantValue(const ASTNode *ast,
+        double &value) const
+{
+    const uint n = ast->getNumChildren();
+    double child = 0;
+
+    switch (ast->getType())
+    {
+    case AST_INTEGER:
+        value = ast->getInteger();
+        return true;
+    case AST_REAL:
+    case AST_REAL_E:
+    case AST_RATIONAL:
+        value = ast->getReal();
+        return true;
+    case AST_PLUS:
+        value = 0;
+        for (uint i = 0; i < n; ++i)
+        {
+            if (!getConstantValue(ast->getChild(i), child))
+            {
+                return false;
+            }
+            value += child;
+        }
+        return true;
+    case AST_TIMES:
+        value = 1;
+        for (uint i = 0; i < n; ++i)
+        {
+            if (!getConstantValue(ast->getChild(i), child))
+            {
+                return false;
+            }
+            value *= child;
+        }
+        return true;
+    case AST_MINUS:
+        if (n == 1 && getConstantValue(ast->getChild(0), value))
+        {
+            value = -value;
+            return true;
+        }
+        else if (n == 2 && getConstantValue(ast->getChild(0), value)
+                && getConstantValue(ast->getChild(1), child))
+        {
+            value -= child;
+            return true;
+        }
+        return false;
+    case AST_DIVIDE:
+        if (n == 2 && getConstantValue(ast->getChild(0), value)
+                && getConstantValue(ast->getChild(1), child))
+        {
+            value /= child;
+            return true;
+        }
+        return false;
+    case AST_NAME:
+        if (isFixedSpeciesReference(ast->getName()))
+        {
+            const SymbolForest::Map &refs =
+                    modelSymbols.getInitialValues().speciesReferences;
+            SymbolForest::Map::const_iterator i = refs.find(ast->getName());
+            return i != refs.end() && getConstantValue(i->second, value);
+        }
+        return false;
+    default:
+        return false;
+    }
+}
+
+bool EvalStateVectorRateCodeGen::isFixedSpeciesReference(
+        const std::string &id) const
+{
+    if (!dataSymbols.isNamedSpeciesReference(id)
+            || dataSymbols.hasRateRule(id)
+            || dataSymbols.hasAssignmentRule(id)
+            || model->getInitialAssignment(id) != 0)
+    {
+        return false;
+    }
+
+    const ListOfEvents *events = model->getListOfEvents();
+
+    for (uint i = 0; i < events->size(); ++i)
+    {
+        const ListOfEventAssignments *assignments =
+                events->get(i)->getListOfEventAssignments();
+
+        for (uint j = 0; j < assignments->size(); ++j)
+        {
+            if (assignments->get(j)->getVariable() == id)
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+} /* namespace rrllvm */
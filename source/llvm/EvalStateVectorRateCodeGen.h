@@ -0,0 +1,81 @@
+/*
+ * EvalStateVectorRateCodeGen.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef EVALSTATEVECTORRATECODEGEN_H_
+#define EVALSTATEVECTORRATECODEGEN_H_
+
+#include "ModelGeneratorContext.h"
+#include "CodeGenBase.h"
+#include "ModelDataIRBuilder.h"
+#include <sbml/Model.h>
+#include <vector>
+
+namespace rrllvm
+{
+
+typedef double (*EvalStateVectorRate_FunctionPtr)(LLVMModelData*);
+
+/**
+ * evaluate the reaction rates and accumulate them directly into
+ * ModelData.floatingSpeciesAmountRates, with the stoichiometric
+ * coefficients and conversion factors compiled in as constants.
+ *
+ * This does the work of evalReactionRates, the stoichiometry matrix
+ * vector product and evalConversionFactor in a single function, the
+ * reaction rates are kept in registers and are NOT stored in
+ * ModelData.reactionRates.
+ *
+ * It can only be generated if every stoichiometric coefficient is a
+ * constant, i.e. no species references which are defined by rules,
+ * events, initial assignments or stoichiometry math. Otherwise the
+ * function is not generated, its pointer is NULL, and the model falls back
+ * to the CSR stoichiometry matrix.
+ *
+ * Returns the model conversion factor, same as evalReactionRates.
+ */
+class EvalStateVectorRateCodeGen:
+    public CodeGenBase<EvalStateVectorRate_FunctionPtr>
+{
+public:
+    EvalStateVectorRateCodeGen(const ModelGeneratorContext &mgc);
+    virtual ~EvalStateVectorRateCodeGen();
+
+    llvm::Value *codeGen();
+
+    /**
+     * are all of the stoichiometric coefficients known at compile time,
+     * codeGen may only be called if this is true.
+     */
+    bool hasConstantStoichiometry() const;
+
+    static const char* FunctionName;
+    typedef EvalStateVectorRate_FunctionPtr FunctionPtr;
+
+private:
+    /**
+     * reaction index and coefficient of each non-zero stoichiometry entry,
+     * one list for each independent floating species.
+     */
+    typedef std::vector<std::pair<uint, double> > CoefficientVector;
+    std::vector<CoefficientVector> coefficients;
+
+    bool constantStoichiometry;
+
+    /**
+     * evaluate a stoichiometry node, returns false if it depends on
+     * anything that can change after the model is created.
+     */
+    bool getConstantValue(const libsbml::ASTNode *ast, double &value) const;
+
+    /**
+     * named species references can be modified by rules, events and
+     * initial assignments.
+     */
+    bool isFixedSpeciesReference(const std::string &id) const;
+};
+
+} /* namespace rrllvm */
+#endif /* EVALSTATEVECTORRATECODEGEN_H_ */
@@ -7,6 +7,7 @@
 #pragma hdrstop
 #include "EventQueue.h"
 #include "LLVMExecutableModel.h"
+#include "Random.h"
 #include "rrLogger.h"
 #include <algorithm>
 #include <cstring>
@@ -205,7 +206,7 @@ bool EventQueue::hasCurrentEvents()
 
 
 
-bool EventQueue::applyEvents()
+bool EventQueue::applyEvents(Random* random)
 {
     bool applied = false;
     if (c.size())
@@ -237,7 +238,7 @@ bool EventQueue::applyEvents()
 
         if (ripe.size())
         {
-            uint index = std::rand() % ripe.size();
+            uint index = random->selectEvent(ripe.size());
             iterator i = ripe[index];
 
             Log(Logger::LOG_DEBUG) << "assigning the " << index << "\'th item";
@@ -18,6 +18,7 @@
 namespace rrllvm {
 
 class LLVMExecutableModel;
+class Random;
 
 class Event
 {
@@ -99,9 +100,10 @@ public:
      * assign all of the top most events with the same priority
      * and remove them from the queue.
      *
+     * @param random chooses between ripe events with the same priority.
      * @returns true if any events were assigned, false otherwise.
      */
-    bool applyEvents();
+    bool applyEvents(Random* random);
 
     /**
      * number of events in the queue
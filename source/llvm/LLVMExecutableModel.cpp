@@ -10,6 +10,7 @@
 #include "ModelResources.h"
 #include "LLVMIncludes.h"
 #include "rrSparse.h"
+#include "rrSparseMatrix.h"
 #include "rrLogger.h"
 #include "rrException.h"
 #include "LLVMException.h"
@@ -26,6 +27,7 @@ using rr::EventListener;
 using rr::EventListenerPtr;
 using rr::EventListenerException;
 using rr::Config;
+using rr::ValueHandle;
 
 #if defined (_WIN32)
 #define isnan _isnan
@@ -170,6 +172,7 @@ LLVMExecutableModel::LLVMExecutableModel() :
     conversionFactor(1.0),
     evalInitialConditionsPtr(0),
     evalReactionRatesPtr(0),
+    evalStateVectorRatePtr(0),
     getBoundarySpeciesAmountPtr(0),
     getFloatingSpeciesAmountPtr(0),
     getBoundarySpeciesConcentrationPtr(0),
@@ -212,6 +215,7 @@ LLVMExecutableModel::LLVMExecutableModel(
     conversionFactor(1.0),
     evalInitialConditionsPtr(rc->evalInitialConditionsPtr),
     evalReactionRatesPtr(rc->evalReactionRatesPtr),
+    evalStateVectorRatePtr(rc->evalStateVectorRatePtr),
     getBoundarySpeciesAmountPtr(rc->getBoundarySpeciesAmountPtr),
     getFloatingSpeciesAmountPtr(rc->getFloatingSpeciesAmountPtr),
     getBoundarySpeciesConcentrationPtr(rc->getBoundarySpeciesConcentrationPtr),
@@ -326,8 +330,37 @@ void LLVMExecutableModel::getRateRuleValues(double *rateRuleValues)
     memcpy(rateRuleValues, modelData->rateRuleValuesAlias, modelData->numRateRules * sizeof(double));
 }
 
+bool LLVMExecutableModel::evalFloatingSpeciesAmountRates(double *amountRates)
+{
+    // floatingSpeciesAmountRates only valid for the following
+    // functions, this will move to a parameter shortly...
+    modelData->floatingSpeciesAmountRates = amountRates;
+
+    if (evalStateVectorRatePtr)
+    {
+        conversionFactor = evalStateVectorRatePtr(modelData);
+        modelData->floatingSpeciesAmountRates = 0;
+        return false;
+    }
+
+    evalVolatileStoichPtr(modelData);
+
+    conversionFactor = evalReactionRatesPtr(modelData);
+
+    csr_matrix_dgemv(conversionFactor, modelData->stoichiometry,
+            modelData->reactionRatesAlias, 0.0, modelData->floatingSpeciesAmountRates);
+
+    evalConversionFactorPtr(modelData);
+
+    modelData->floatingSpeciesAmountRates = 0;
+    return true;
+}
+
 void LLVMExecutableModel::getStateVectorRate(double time, const double *y, double *dydt)
 {
+    RR_PERF_TIMER(&perfCounters, STATE_VECTOR_RATE_TIME);
+    RR_PERF_COUNT(&perfCounters, STATE_VECTOR_RATE_EVALS, 1);
+
     modelData->time = time;
 
     if (y && dydt)
@@ -338,23 +371,11 @@ void LLVMExecutableModel::getStateVectorRate(double time, const double *y, doubl
 
         modelData->rateRuleValuesAlias = const_cast<double*>(y);
         modelData->floatingSpeciesAmountsAlias = const_cast<double*>(y + modelData->numRateRules);
-        evalVolatileStoichPtr(modelData);
 
         // not setting state vector, react rates get dirty
-        conversionFactor = evalReactionRatesPtr(modelData);
         dirty |= DIRTY_REACTION_RATES;
 
-        // floatingSpeciesAmountRates only valid for the following two
-        // functions, this will move to a parameter shortly...
-
-        modelData->floatingSpeciesAmountRates = dydt + modelData->numRateRules;
-
-        csr_matrix_dgemv(conversionFactor, modelData->stoichiometry,
-                modelData->reactionRatesAlias, 0.0, modelData->floatingSpeciesAmountRates);
-
-        evalConversionFactorPtr(modelData);
-
-        modelData->floatingSpeciesAmountRates = 0;
+        evalFloatingSpeciesAmountRates(dydt + modelData->numRateRules);
 
         // this will also move to a parameter for the evalRateRules func...
         modelData->rateRuleRates = dydt;
@@ -373,22 +394,15 @@ void LLVMExecutableModel::getStateVectorRate(double time, const double *y, doubl
     {
         // evaluate dydt using current state
 
-        evalVolatileStoichPtr(modelData);
-
-        conversionFactor = evalReactionRatesPtr(modelData);
-        dirty &= ~DIRTY_REACTION_RATES;
-
-        // floatingSpeciesAmountRates only valid for the following two
-        // functions, this will move to a parameter shortly...
-
-        modelData->floatingSpeciesAmountRates = dydt + modelData->numRateRules;
-
-        csr_matrix_dgemv(conversionFactor, modelData->stoichiometry,
-                modelData->reactionRatesAlias, 0.0, modelData->floatingSpeciesAmountRates);
-
-        evalConversionFactorPtr(modelData);
-
-        modelData->floatingSpeciesAmountRates = 0;
+        // the fused function does not store the reaction rates.
+        if (evalFloatingSpeciesAmountRates(dydt + modelData->numRateRules))
+        {
+            dirty &= ~DIRTY_REACTION_RATES;
+        }
+        else
+        {
+            dirty |= DIRTY_REACTION_RATES;
+        }
 
         // this will also move to a parameter for the evalRateRules func...
         modelData->rateRuleRates = dydt;
@@ -1296,6 +1310,50 @@ void LLVMExecutableModel::setValue(const std::string& id, double value)
     }
 }
 
+ValueHandle LLVMExecutableModel::createValueHandle(
+        const std::vector<std::string>& ids)
+{
+    ValueHandle handle(this);
+    for (unsigned i = 0; i < ids.size(); ++i)
+    {
+        const SelectionRecord &sel = getSelection(ids[i]);
+        handle.add(ids[i], sel.selectionType, sel.index);
+    }
+    return handle;
+}
+
+bool LLVMExecutableModel::getValueGroup(SelectionRecord::SelectionType type,
+        int len, const int* indx, double* values)
+{
+    switch(type)
+    {
+    case SelectionRecord::GLOBAL_PARAMETER_RATE:
+        getRateRueRates(len, indx, values);
+        return true;
+    case SelectionRecord::INITIAL_GLOBAL_PARAMETER:
+        getGlobalParameterInitValues(len, indx, values);
+        return true;
+    default:
+        return ExecutableModel::getValueGroup(type, len, indx, values);
+    }
+}
+
+bool LLVMExecutableModel::setValueGroup(SelectionRecord::SelectionType type,
+        int len, const int* indx, const double* values)
+{
+    switch(type)
+    {
+    case SelectionRecord::BOUNDARY_AMOUNT:
+        setBoundarySpeciesAmounts(len, indx, values);
+        return true;
+    case SelectionRecord::INITIAL_GLOBAL_PARAMETER:
+        setGlobalParameterInitValues(len, indx, values);
+        return true;
+    default:
+        return ExecutableModel::setValueGroup(type, len, indx, values);
+    }
+}
+
 int LLVMExecutableModel::getFloatingSpeciesConcentrationRates(int len,
         const int* indx, double* values)
 {
@@ -1437,6 +1495,18 @@ int LLVMExecutableModel::getNumRateRules()
     return modelData->numRateRules;
 }
 
+bool LLVMExecutableModel::getStateVectorJacobianPattern(
+        std::vector<std::vector<unsigned> >& cols)
+{
+    cols = symbols->getStateJacobianPattern();
+    return cols.size() == (unsigned)getStateVector(0);
+}
+
+rr::PerfCounters* LLVMExecutableModel::getPerfCounters()
+{
+    return &perfCounters;
+}
+
 std::vector<std::string> LLVMExecutableModel::getRateRuleSymbols() const {
     std::vector<std::string> result;
 
@@ -1839,6 +1909,22 @@ int LLVMExecutableModel::getStoichiometryMatrix(int* pRows, int* pCols,
     throw_llvm_exception("invalid args");
 }
 
+void LLVMExecutableModel::getSparseStoichiometryMatrix(rr::SparseMatrix& mat)
+{
+    const csr_matrix *stoich = modelData->stoichiometry;
+
+    mat = rr::SparseMatrix(0, stoich->n);
+
+    for (unsigned row = 0; row < stoich->m; ++row)
+    {
+        for (unsigned i = stoich->rowptr[row]; i < stoich->rowptr[row + 1]; ++i)
+        {
+            mat.addEntry(stoich->colidx[i], stoich->values[i]);
+        }
+        mat.endRow();
+    }
+}
+
 
 
 /******************************* Events Section *******************************/
@@ -1878,6 +1964,8 @@ int LLVMExecutableModel::applyEvents(double timeEnd,
         const unsigned char* previousEventStatus, const double *initialState,
         double* finalState)
 {
+    RR_PERF_TIMER(&perfCounters, EVENT_TIME);
+
     int assignedEvents = 0;
     modelData->time = timeEnd;
 
@@ -1909,12 +1997,17 @@ int LLVMExecutableModel::applyEvents(double timeEnd,
         getStateVector(finalState);
     }
 
+    RR_PERF_COUNT(&perfCounters, EVENT_APPLICATIONS, assignedEvents);
+
     return assignedEvents;
 }
 
 
 void  LLVMExecutableModel::getEventRoots(double time, const double* y, double* gdot)
 {
+    RR_PERF_TIMER(&perfCounters, EVENT_ROOT_TIME);
+    RR_PERF_COUNT(&perfCounters, EVENT_ROOT_EVALS, 1);
+
     modelData->time = time;
 
     double *savedRateRules = modelData->rateRuleValuesAlias;
@@ -1990,7 +2083,7 @@ bool LLVMExecutableModel::applyEvents(unsigned char* prevEventState,
 
     // fire the highest priority event, this causes state change
     // return true if we incured a state change
-    return pendingEvents.applyEvents();
+    return pendingEvents.applyEvents(getRandomEngine());
 }
 
 bool LLVMExecutableModel::getEventTieBreak(uint eventA, uint eventB)
@@ -2015,7 +2108,7 @@ bool LLVMExecutableModel::getEventTieBreak(uint eventA, uint eventB)
     }
     */
 
-    bool result = (std::rand() % 2) == 0;
+    bool result = getRandomEngine()->selectEvent(2) == 0;
 
 
 
@@ -2156,14 +2249,7 @@ int LLVMExecutableModel::getGlobalParameterInitValues(int len, const int *indx,
  */
 void LLVMExecutableModel::setRandomSeed(int64_t seed)
 {
-    // if this does not exist, can create it, this will be freed
-    // by LLVMModelData_free
-    if (modelData->random == 0)
-    {
-        modelData->random = new Random();
-    }
-    modelData->random->setRandomSeed(seed);
-
+    getRandomEngine()->setRandomSeed(seed);
 }
 
 /**
@@ -2171,13 +2257,7 @@ void LLVMExecutableModel::setRandomSeed(int64_t seed)
  */
 int64_t LLVMExecutableModel::getRandomSeed()
 {
-    // if this does not exist, can create it, this will be freed
-    // by LLVMModelData_free
-    if (modelData->random == 0)
-    {
-        modelData->random = new Random();
-    }
-    return modelData->random->getRandomSeed();
+    return getRandomEngine()->getRandomSeed();
 }
 
 /**
@@ -2187,6 +2267,21 @@ int64_t LLVMExecutableModel::getRandomSeed()
  * RANDOM_GENERATOR_TYPE key.
  */
 double LLVMExecutableModel::getRandom()
+{
+    return (*getRandomEngine())();
+}
+
+void LLVMExecutableModel::setRandomReplicate(uint32_t replicate)
+{
+    getRandomEngine()->setReplicate(replicate);
+}
+
+uint32_t LLVMExecutableModel::getRandomReplicate()
+{
+    return getRandomEngine()->getReplicate();
+}
+
+Random* LLVMExecutableModel::getRandomEngine()
 {
     // if this does not exist, can create it, this will be freed
     // by LLVMModelData_free
@@ -2194,7 +2289,7 @@ double LLVMExecutableModel::getRandom()
     {
         modelData->random = new Random();
     }
-    return (*modelData->random)();
+    return modelData->random;
 }
 
 /******************************* End Random Section ***************************/
@@ -26,6 +26,7 @@
 
 #include "EvalInitialConditionsCodeGen.h"
 #include "EvalReactionRatesCodeGen.h"
+#include "EvalStateVectorRateCodeGen.h"
 #include "EvalRateRuleRatesCodeGen.h"
 #include "GetValuesCodeGen.h"
 #include "GetInitialValuesCodeGen.h"
@@ -38,6 +39,7 @@
 #include "SetInitialValuesCodeGen.h"
 #include "EventQueue.h"
 #include "rrSelectionRecord.h"
+#include "rrPerfCounters.h"
 
 #include "tr1proxy/rr_memory.h"
 #include "tr1proxy/rr_unordered_map.h"
@@ -208,6 +210,9 @@ public:
      */
     virtual void getStateVectorRate(double time, const double *y, double* dydt=0);
 
+    virtual bool getStateVectorJacobianPattern(std::vector<std::vector<unsigned> >& cols);
+
+    virtual rr::PerfCounters* getPerfCounters();
 
     virtual void testConstraints();
 
@@ -342,6 +347,12 @@ public:
      */
     virtual int getStoichiometryMatrix(int* rows, int* cols, double** data);
 
+    /**
+     * copies the stoichiometry directly from the CSR matrix in the model
+     * data, the dense matrix is never created.
+     */
+    virtual void getSparseStoichiometryMatrix(rr::SparseMatrix& mat);
+
 
     /******************************* Initial Conditions Section *******************/
     #if (1) /**********************************************************************/
@@ -401,6 +412,11 @@ public:
      */
     virtual void setValue(const std::string& id, double value);
 
+    /**
+     * resolves the ids with the same selection cache as getValue.
+     */
+    virtual rr::ValueHandle createValueHandle(const std::vector<std::string>& ids);
+
     /************************ End Selection Ids Species Section *******************/
     #endif /***********************************************************************/
     /******************************************************************************/
@@ -428,6 +444,16 @@ public:
      */
     virtual double getRandom();
 
+    /**
+     * set the replicate number used by the RNG, this will reset the RNG.
+     */
+    virtual void setRandomReplicate(uint32_t);
+
+    /**
+     * get the replicate number used by the RNG.
+     */
+    virtual uint32_t getRandomReplicate();
+
     /******************************* End Random Section ***************************/
     #endif  /**********************************************************************/
     /******************************************************************************/
@@ -570,6 +596,17 @@ public:
      */
     virtual void setFlags(uint32_t val) { flags = val; }
 
+protected:
+
+    /**
+     * adds the accessors which are not part of the ExecutableModel interface.
+     */
+    virtual bool getValueGroup(rr::SelectionRecord::SelectionType type,
+            int len, const int* indx, double* values);
+
+    virtual bool setValueGroup(rr::SelectionRecord::SelectionType type,
+            int len, const int* indx, const double* values);
+
 private:
 
     /**
@@ -580,6 +617,21 @@ private:
      */
     const rr::SelectionRecord& getSelection(const std::string& sel);
 
+    /**
+     * evaluate the floating species amount rates of the current state into
+     * the given buffer, with the fused function if the model has one,
+     * otherwise with the reaction rates and the stoichiometry matrix.
+     *
+     * @return true if the reaction rates were stored in the model data.
+     */
+    bool evalFloatingSpeciesAmountRates(double *amountRates);
+
+    /**
+     * the model's RNG, created if it does not exist yet, this will be freed
+     * by LLVMModelData_free
+     */
+    class Random* getRandomEngine();
+
     /**
      * previous state
      * get current state
@@ -616,6 +668,13 @@ private:
 
     EvalInitialConditionsCodeGen::FunctionPtr evalInitialConditionsPtr;
     EvalReactionRatesCodeGen::FunctionPtr evalReactionRatesPtr;
+
+    /**
+     * fused reaction rates and stoichiometry, NULL if the stoichiometry
+     * is not constant.
+     */
+    EvalStateVectorRateCodeGen::FunctionPtr evalStateVectorRatePtr;
+
     GetBoundarySpeciesAmountCodeGen::FunctionPtr getBoundarySpeciesAmountPtr;
     GetFloatingSpeciesAmountCodeGen::FunctionPtr getFloatingSpeciesAmountPtr;
     GetBoundarySpeciesConcentrationCodeGen::FunctionPtr getBoundarySpeciesConcentrationPtr;
@@ -714,6 +773,8 @@ private:
 
 
     uint32_t flags;
+
+    rr::PerfCounters perfCounters;
 };
 
 } /* namespace rr */
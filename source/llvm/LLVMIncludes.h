@@ -78,6 +78,9 @@
 #include <llvm/Target/TargetLibraryInfo.h>
 #include <llvm/Support/raw_ostream.h>
 #include <llvm/Support/Host.h>
+#include <llvm/Target/TargetOptions.h>
+#include <llvm/Transforms/Vectorize.h>
+#include <llvm/ADT/StringMap.h>
 
 #ifdef _MSC_VER
 #pragma warning( pop )
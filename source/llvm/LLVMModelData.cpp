@@ -13,7 +13,12 @@
 #include "rrExecutableModel.h"
 #include "rrSparse.h"
 #include "Random.h"
+#include <Poco/Mutex.h>
 #include <iomanip>
+#include <map>
+#include <vector>
+#include <new>
+#include <cassert>
 
 using namespace std;
 
@@ -96,13 +101,170 @@ std::ostream& operator <<(std::ostream& os, const LLVMModelData& data)
     return os;
 }
 
+/**
+ * the data section starts right after the struct, and the generated code
+ * assumes it starts on a cache line, so the struct must fill whole lines,
+ * three with 64 bit pointers. A compile time check, an array of negative
+ * size if not.
+ */
+typedef char LLVMModelData_sizeCheck[
+        (sizeof(LLVMModelData) % LLVMModelData_Alignment == 0
+        && (sizeof(void*) != 8
+        || sizeof(LLVMModelData) == 3 * LLVMModelData_Alignment)) ? 1 : -1];
+
+/**
+ * arenas of the same size are kept for re-use, up to this many of each size.
+ */
+static const unsigned maxPooledArenas = 32;
+
+typedef std::map<size_t, std::vector<void*> > ArenaPool;
+
+static Poco::Mutex arenaPoolMutex;
+
+/**
+ * never deleted, models can be freed during static destruction.
+ */
+static ArenaPool *arenaPool = new ArenaPool();
+
+static size_t alignUp(size_t bytes)
+{
+    return (bytes + LLVMModelData_Alignment - 1) / LLVMModelData_Alignment
+            * LLVMModelData_Alignment;
+}
+
+/**
+ * aligned malloc, the original pointer is stored just before the
+ * aligned block.
+ */
+static void* alignedAlloc(size_t bytes)
+{
+    char *p = (char*)malloc(bytes + LLVMModelData_Alignment + sizeof(void*));
+
+    if (!p)
+    {
+        throw std::bad_alloc();
+    }
+
+    char *aligned = (char*)alignUp((size_t)(p + sizeof(void*)));
+    ((void**)aligned)[-1] = p;
+    return aligned;
+}
+
+static void alignedFree(void *p)
+{
+    if (p)
+    {
+        free(((void**)p)[-1]);
+    }
+}
+
+/**
+ * createModelData places the stoichiometry matrix on the first cache
+ * line after the data section, and the random engine, if any, on the
+ * first line after that.
+ */
+static size_t stoichiometryOffset(const LLVMModelData *data)
+{
+    return alignUp(data->size);
+}
+
+static bool isStoichiometryInArena(const LLVMModelData *data)
+{
+    return data->stoichiometry && (const char*)data->stoichiometry ==
+            (const char*)data + stoichiometryOffset(data);
+}
+
+static size_t randomOffset(const LLVMModelData *data)
+{
+    size_t offset = stoichiometryOffset(data);
+
+    if (isStoichiometryInArena(data))
+    {
+        offset = alignUp(offset + csr_matrix_bytes(data->stoichiometry));
+    }
+
+    return offset;
+}
+
+static bool isRandomInArena(const LLVMModelData *data)
+{
+    return data->random && (const char*)data->random ==
+            (const char*)data + randomOffset(data);
+}
+
+void* LLVMModelData_allocArena(size_t bytes)
+{
+    void *p = 0;
+
+    {
+        Poco::Mutex::ScopedLock lock(arenaPoolMutex);
+        ArenaPool::iterator i = arenaPool->find(bytes);
+
+        if (i != arenaPool->end() && i->second.size())
+        {
+            p = i->second.back();
+            i->second.pop_back();
+        }
+    }
+
+    if (!p)
+    {
+        p = alignedAlloc(bytes);
+    }
+
+    memset(p, 0, bytes);
+    return p;
+}
+
+static void releaseArena(void *p, size_t bytes)
+{
+    {
+        Poco::Mutex::ScopedLock lock(arenaPoolMutex);
+        std::vector<void*> &blocks = (*arenaPool)[bytes];
+
+        if (blocks.size() < maxPooledArenas)
+        {
+            blocks.push_back(p);
+            return;
+        }
+    }
+
+    alignedFree(p);
+}
+
+size_t LLVMModelData_arenaSize(const LLVMModelData *data)
+{
+    size_t size = randomOffset(data);
+
+    if (isRandomInArena(data))
+    {
+        size = alignUp(size + sizeof(Random));
+    }
+
+    return size;
+}
+
 void  LLVMModelData_free(LLVMModelData *data)
 {
     if (data)
     {
-        csr_matrix_delete(data->stoichiometry);
-        delete data->random;
-        ::free(data);
+        const size_t size = LLVMModelData_arenaSize(data);
+
+        if (!isStoichiometryInArena(data))
+        {
+            csr_matrix_delete(data->stoichiometry);
+        }
+
+        if (isRandomInArena(data))
+        {
+            data->random->~Random();
+        }
+        else
+        {
+            delete data->random;
+        }
+
+        releaseArena(data, size);
     }
 }
 
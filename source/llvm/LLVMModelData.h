@@ -11,6 +11,7 @@
 #include "rrSparse.h"
 #include <string>
 #include <ostream>
+#include <stddef.h>
 
 namespace rrllvm
 {
@@ -212,23 +213,60 @@ struct LLVMModelData
     double*                             floatingSpeciesAmountsAlias;      // 30
 
     /**
-     * binary data layout:
+     * binary data layout, hot first, the state vector and the values used
+     * by every model evaluation, then the initial values. Each array is
+     * padded to a whole number of cache lines, see LLVMModelData_paddedLength:
      *
-     * compartmentVolumes                [numIndCompartmentVolumes]       // 31
-     * initCompartmentVolumes            [numInitCompartmentVolumes]      // 32
-     * initFloatingSpeciesAmounts        [numInitFloatingSpecies]         // 33
-     * boundarySpeciesAmounts            [numIndBoundarySpecies]          // 34
-     * initBoundarySpeciesAmounts        [numInitBoundarySpecies]         // 35
+     * rateRuleValues                    [numRateRules]                   // 31
+     * floatingSpeciesAmounts            [numIndFloatingSpecies]          // 32
+     * reactionRates                     [numReactions]                   // 33
+     * compartmentVolumes                [numIndCompartmentVolumes]       // 34
+     * boundarySpeciesAmounts            [numIndBoundarySpecies]          // 35
      * globalParameters                  [numIndGlobalParameters]         // 36
-     * initGlobalParameters              [numInitGlobalParameters]        // 37
-     * reactionRates                     [numReactions]                   // 38
+     * initCompartmentVolumes            [numInitCompartmentVolumes]      // 37
+     * initFloatingSpeciesAmounts        [numInitFloatingSpecies]         // 38
+     * initBoundarySpeciesAmounts        [numInitBoundarySpecies]         // 39
+     * initGlobalParameters              [numInitGlobalParameters]        // 40
+     * literalInitialValues              [getLiteralInitialValueSize()]   // 41
      *
-     * rateRuleValues                    [numRateRules]                   // 39
-     * floatingSpeciesAmounts            [numIndFloatingSpecies]          // 40
+     * The struct is the start of a single cache line aligned arena, the
+     * stoichiometry matrix and the random engine follow the data section
+     * in the same block, see createModelData.
      */
     double                              data[0];                          // not listed
 };
 
+/**
+ * alignment of the model data arena, and of each array in its data section.
+ */
+const unsigned LLVMModelData_Alignment = 64;
+
+/**
+ * length of a data section array of n doubles including the padding to the
+ * next cache line.
+ */
+inline unsigned LLVMModelData_paddedLength(unsigned n)
+{
+    const unsigned lineLength = LLVMModelData_Alignment / sizeof(double);
+    return (n + lineLength - 1) / lineLength * lineLength;
+}
+
+/**
+ * allocate a zeroed, LLVMModelData_Alignment aligned block for a model data
+ * arena. Freed blocks are kept in a pool by size, so creating many
+ * instances of the same model re-uses the same blocks.
+ */
+void* LLVMModelData_allocArena(size_t bytes);
+
+/**
+ * total size of the arena holding the model data, the struct, the data
+ * section, the stoichiometry matrix and the random engine.
+ */
+size_t LLVMModelData_arenaSize(const LLVMModelData*);
+
+/**
+ * destroy the model data and return its arena to the pool.
+ */
 void LLVMModelData_free(LLVMModelData*);
 
 #ifdef _MSC_VER
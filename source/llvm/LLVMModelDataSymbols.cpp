@@ -17,6 +17,7 @@
 #include <Poco/LogStream.h>
 #include <sbml/Model.h>
 #include <sbml/SBMLDocument.h>
+#include <sbml/math/ASTNode.h>
 
 #include <string>
 #include <vector>
@@ -76,16 +77,17 @@ static const char* modelDataFieldsNames[] =  {
         "RateRuleValuesAlias",                  // 29
         "FloatingSpeciesAmountsAlias",          // 30
 
-        "CompartmentVolumes",                   // 31
-        "InitCompartmentVolumes",               // 32
-        "InitFloatingSpeciesAmounts",           // 33
-        "BoundarySpeciesAmounts",               // 34
-        "InitBoundarySpeciesAmounts",           // 35
+        "NotSafe_RateRuleValues",               // 31
+        "NotSafe_FloatingSpeciesAmounts",       // 32
+        "ReactionRates",                        // 33
+        "CompartmentVolumes",                   // 34
+        "BoundarySpeciesAmounts",               // 35
         "GlobalParameters",                     // 36
-        "InitGlobalParameters",                 // 37
-        "ReactionRates",                        // 38
-        "NotSafe_RateRuleValues",               // 39
-        "NotSafe_FloatingSpeciesAmounts"        // 40
+        "InitCompartmentVolumes",               // 37
+        "InitFloatingSpeciesAmounts",           // 38
+        "InitBoundarySpeciesAmounts",           // 39
+        "InitGlobalParameters",                 // 40
+        "LiteralInitialValues"                  // 41
 };
 
 
@@ -115,7 +117,7 @@ LLVMModelDataSymbols::LLVMModelDataSymbols() :
     independentInitCompartmentSize(0)
 {
     assert(sizeof(modelDataFieldsNames) / sizeof(const char*)
-            == NotSafe_FloatingSpeciesAmounts + 1
+            == LiteralInitialValues + 1
             && "wrong number of items in modelDataFieldsNames");
 }
 
@@ -131,7 +133,7 @@ LLVMModelDataSymbols::LLVMModelDataSymbols(const libsbml::Model *model,
     independentInitCompartmentSize(0)
 {
     assert(sizeof(modelDataFieldsNames) / sizeof(const char*)
-            == NotSafe_FloatingSpeciesAmounts + 1
+            == LiteralInitialValues + 1
             && "wrong number of items in modelDataFieldsNames");
 
     modelName = model->getName();
@@ -196,6 +198,15 @@ LLVMModelDataSymbols::LLVMModelDataSymbols(const libsbml::Model *model,
     initReactions(model);
 
     initEvents(model);
+
+    initStateJacobianPattern(model);
+
+    std::vector<std::string> literalIds;
+    getLiteralInitialValues(model, literalIds, literalInitialValues);
+    for (uint i = 0; i < literalIds.size(); ++i)
+    {
+        literalInitialValuesMap[literalIds[i]] = i;
+    }
 }
 
 LLVMModelDataSymbols::~LLVMModelDataSymbols()
@@ -314,47 +325,6 @@ uint LLVMModelDataSymbols::getGlobalParameterIndex(
     }
 }
 
-/*
-void LLVMModelDataSymbols::initAllocModelDataBuffers(LLVMModelData& m) const
-{
-    // zero out the structure
-    LLVMModelData::init(m);
-
-    // set the buffer sizes
-    m.numIndFloatingSpecies         = independentFloatingSpeciesSize;
-
-    //mData.numDependentSpecies           = ms.mNumDependentSpecies;
-    m.numIndGlobalParameters        = independentGlobalParameterSize;
-    m.numReactions                  = reactionsMap.size();
-    m.numEvents                     = eventAttributes.size();
-    m.numRateRules                  = rateRules.size();
-    m.numIndCompartments               = independentCompartmentSize;
-    m.numIndBoundarySpecies            = independentBoundarySpeciesSize;
-
-    // in certain cases, the data returned by c++ new may be alligned differently than
-    // malloc, so just use calloc here just to be safe, plus calloc returns zero
-    // initialized memory.
-
-    m.floatingSpeciesAmountsAlias = (double*)calloc(m.numIndFloatingSpecies, sizeof(double));
-    m.floatingSpeciesAmountRates = 0;
-    m.rateRuleValuesAlias = (double*)calloc(m.numRateRules, sizeof(double));
-    m.rateRuleRates = 0;
-
-    m.reactionRatesAlias = (double*)calloc(m.numReactions, sizeof(double));
-
-    m.globalParametersAlias = (double*)calloc(m.numIndGlobalParameters, sizeof(double));
-    m.compartmentVolumesAlias = (double*)calloc(m.numIndCompartments, sizeof(double));
-
-    m.boundarySpeciesAmountsAlias = (double*)calloc(m.numIndBoundarySpecies, sizeof(double));
-
-
-    // allocate the stoichiometry matrix
-    m.stoichiometry = rr::csr_matrix_new(m.numIndFloatingSpecies, getReactionSize(),
-            stoichRowIndx, stoichColIndx, vector<double>(stoichRowIndx.size(), 0));
-}
-*/
-
-
 const std::vector<uint>& LLVMModelDataSymbols::getStoichRowIndx() const
 {
     return stoichRowIndx;
@@ -365,6 +335,11 @@ const std::vector<uint>& LLVMModelDataSymbols::getStoichColIndx() const
     return stoichColIndx;
 }
 
+const std::vector<std::vector<uint> >& LLVMModelDataSymbols::getStateJacobianPattern() const
+{
+    return stateJacobianPattern;
+}
+
 std::vector<std::string> LLVMModelDataSymbols::getCompartmentIds() const
 {
     return getIds(compartmentsMap);
@@ -529,7 +504,7 @@ bool LLVMModelDataSymbols::isIndependentCompartment(const std::string& id) const
 
 const char* LLVMModelDataSymbols::getFieldName(ModelDataFields field)
 {
-    if (field >= Size && field <= ReactionRates)
+    if (field >= Size && field <= LiteralInitialValues)
     {
         return modelDataFieldsNames[field];
     }
@@ -1518,6 +1493,79 @@ uint LLVMModelDataSymbols::getEventIndex(const std::string& id) const
     }
 }
 
+void LLVMModelDataSymbols::getLiteralInitialValues(const libsbml::Model *model,
+        std::vector<std::string>& ids, std::vector<double>& values)
+{
+    const ListOfCompartments *compartments = model->getListOfCompartments();
+    for (uint i = 0; i < compartments->size(); ++i)
+    {
+        const Compartment *c = compartments->get(i);
+        if (c->isSetVolume())
+        {
+            ids.push_back(c->getId());
+            values.push_back(c->getVolume());
+        }
+    }
+
+    const ListOfSpecies *species = model->getListOfSpecies();
+    for (uint i = 0; i < species->size(); ++i)
+    {
+        const Species *s = species->get(i);
+        if (s->isSetInitialConcentration())
+        {
+            ids.push_back(s->getId());
+            values.push_back(s->getInitialConcentration());
+        }
+        else if (s->isSetInitialAmount())
+        {
+            ids.push_back(s->getId());
+            values.push_back(s->getInitialAmount());
+        }
+    }
+
+    // only the global parameters, not the kinetic law parameters, these
+    // are compiled into the rate functions.
+    const ListOfParameters *parameters = model->getListOfParameters();
+    for (uint i = 0; i < parameters->size(); ++i)
+    {
+        const Parameter *p = parameters->get(i);
+        if (p->isSetValue())
+        {
+            ids.push_back(p->getId());
+            values.push_back(p->getValue());
+        }
+    }
+}
+
+uint LLVMModelDataSymbols::getLiteralInitialValueSize() const
+{
+    return literalInitialValues.size();
+}
+
+bool LLVMModelDataSymbols::hasLiteralInitialValue(const std::string& id) const
+{
+    return literalInitialValuesMap.find(id) != literalInitialValuesMap.end();
+}
+
+uint LLVMModelDataSymbols::getLiteralInitialValueIndex(const std::string& id) const
+{
+    StringUIntMap::const_iterator i = literalInitialValuesMap.find(id);
+    if (i != literalInitialValuesMap.end())
+    {
+        return i->second;
+    }
+    else
+    {
+        throw LLVMException("could not find literal initial value with id "
+                + id, __FUNC__);
+    }
+}
+
+const std::vector<double>& LLVMModelDataSymbols::getLiteralInitialValues() const
+{
+    return literalInitialValues;
+}
+
 uint LLVMModelDataSymbols::getConservedMoietySize() const
 {
     return conservedMoietyGlobalParameterIndex.size();
@@ -1561,4 +1609,553 @@ uint LLVMModelDataSymbols::getConservedMoietyIndex(
     throw std::out_of_range("The symbol \"" + name + "\" is not a conserved moeity");
 }
 
+int LLVMModelDataSymbols::getStateVectorIndex(const std::string& id) const
+{
+    StringUIntMap::const_iterator i;
+
+    if ((i = rateRules.find(id)) != rateRules.end())
+    {
+        return i->second;
+    }
+
+    if ((i = floatingSpeciesMap.find(id)) != floatingSpeciesMap.end() &&
+            i->second < independentFloatingSpeciesSize)
+    {
+        return rateRules.size() + i->second;
+    }
+
+    return -1;
+}
+
+void LLVMModelDataSymbols::collectStateDependencies(const libsbml::Model *model,
+        const std::string& id, std::set<uint>& deps,
+        std::set<std::string>& visited) const
+{
+    if (!visited.insert(id).second)
+    {
+        return;
+    }
+
+    int stateIndex = getStateVectorIndex(id);
+    if (stateIndex >= 0)
+    {
+        deps.insert(stateIndex);
+    }
+
+    // species values may be concentrations, so they also depend on the
+    // volume of their compartment.
+    const Species *species = model->getSpecies(id);
+    if (species)
+    {
+        collectStateDependencies(model, species->getCompartment(), deps, visited);
+    }
+
+    const AssignmentRule *rule = model->getAssignmentRule(id);
+    if (rule)
+    {
+        collectStateDependencies(model, rule->getMath(), deps, visited);
+    }
+
+    // reaction ids may be used in rules, their value is the rate.
+    const Reaction *reaction = model->getReaction(id);
+    if (reaction && reaction->isSetKineticLaw())
+    {
+        collectStateDependencies(model, reaction->getKineticLaw()->getMath(),
+                deps, visited);
+    }
+}
+
+void LLVMModelDataSymbols::collectStateDependencies(const libsbml::Model *model,
+        const libsbml::ASTNode *math, std::set<uint>& deps,
+        std::set<std::string>& visited) const
+{
+    if (!math)
+    {
+        return;
+    }
+
+    if (math->getType() == AST_NAME)
+    {
+        collectStateDependencies(model, string(math->getName()), deps, visited);
+    }
+
+    for (unsigned i = 0; i < math->getNumChildren(); ++i)
+    {
+        collectStateDependencies(model, math->getChild(i), deps, visited);
+    }
+}
+
+void LLVMModelDataSymbols::initStateJacobianPattern(const libsbml::Model *model)
+{
+    const uint stateSize = rateRules.size() + independentFloatingSpeciesSize;
+
+    // row major while building, dependencies of each state rate.
+    std::vector<std::set<uint> > rows(stateSize);
+
+    const ListOfReactions *reactions = model->getListOfReactions();
+    for (uint i = 0; i < reactions->size(); ++i)
+    {
+        const Reaction *reaction = reactions->get(i);
+
+        std::set<uint> rateDeps;
+        std::set<std::string> visited;
+        collectStateDependencies(model, reaction->getId(), rateDeps, visited);
+
+        const ListOf *refLists[] = {reaction->getListOfReactants(),
+                reaction->getListOfProducts()};
+
+        for (uint j = 0; j < 2; ++j)
+        {
+            for (uint k = 0; k < refLists[j]->size(); ++k)
+            {
+                const SpeciesReference *ref =
+                        static_cast<const SpeciesReference*>(refLists[j]->get(k));
+
+                int row = getStateVectorIndex(ref->getSpecies());
+                if (row < (int)rateRules.size())
+                {
+                    continue;
+                }
+
+                rows[row].insert(rateDeps.begin(), rateDeps.end());
+
+                // variable stoichiometry and conversion factors scale the
+                // reaction rate.
+                std::set<std::string> refVisited;
+                if (ref->isSetId())
+                {
+                    collectStateDependencies(model, ref->getId(), rows[row],
+                            refVisited);
+                }
+
+                if (ref->isSetStoichiometryMath())
+                {
+                    collectStateDependencies(model,
+                            ref->getStoichiometryMath()->getMath(), rows[row],
+                            refVisited);
+                }
+
+                const Species *species = model->getSpecies(ref->getSpecies());
+                if (species && species->isSetConversionFactor())
+                {
+                    collectStateDependencies(model,
+                            species->getConversionFactor(), rows[row], refVisited);
+                }
+                else if (model->isSetConversionFactor())
+                {
+                    collectStateDependencies(model, model->getConversionFactor(),
+                            rows[row], refVisited);
+                }
+            }
+        }
+    }
+
+    const ListOfRules *rules = model->getListOfRules();
+    for (uint i = 0; i < rules->size(); ++i)
+    {
+        const RateRule *rule = dynamic_cast<const RateRule*>(rules->get(i));
+        if (!rule)
+        {
+            continue;
+        }
+
+        int row = getStateVectorIndex(rule->getVariable());
+        if (row < 0)
+        {
+            continue;
+        }
+
+        std::set<std::string> visited;
+        collectStateDependencies(model, rule->getMath(), rows[row], visited);
+
+        // rate rules for species concentrations are scaled by the volume.
+        const Species *species = model->getSpecies(rule->getVariable());
+        if (species)
+        {
+            collectStateDependencies(model, species->getCompartment(),
+                    rows[row], visited);
+        }
+    }
+
+    stateJacobianPattern.clear();
+    stateJacobianPattern.resize(stateSize);
+
+    uint nnz = 0;
+    for (uint row = 0; row < stateSize; ++row)
+    {
+        for (std::set<uint>::const_iterator i = rows[row].begin();
+                i != rows[row].end(); ++i)
+        {
+            stateJacobianPattern[*i].push_back(row);
+            ++nnz;
+        }
+    }
+
+    Log(Logger::LOG_DEBUG) << "state Jacobian pattern: " << stateSize
+            << " states, " << nnz << " structural non-zeros";
+}
+
+/************************ Serialization Section ******************************/
+
+/**
+ * magic number and version at the start of a saved symbol table,
+ * bump the version whenever the layout of the saved state changes.
+ */
+static const uint symbolsMagic = 0x52525359;
+static const uint symbolsVersion = 3;
+
+static void saveBinary(std::ostream& out, uint v)
+{
+    out.write((const char*)&v, sizeof(v));
+}
+
+static void loadBinary(std::istream& in, uint& v)
+{
+    in.read((char*)&v, sizeof(v));
+    if (!in)
+    {
+        throw_llvm_exception("unexpected end of stream reading model symbols");
+    }
+}
+
+static void saveBinary(std::ostream& out, const std::string& s)
+{
+    saveBinary(out, (uint)s.size());
+    out.write(s.c_str(), s.size());
+}
+
+static void loadBinary(std::istream& in, std::string& s)
+{
+    uint size;
+    loadBinary(in, size);
+    s.resize(size);
+    if (size)
+    {
+        in.read(&s[0], size);
+    }
+    if (!in)
+    {
+        throw_llvm_exception("unexpected end of stream reading model symbols");
+    }
+}
+
+template <typename T>
+static void saveBinary(std::ostream& out, const std::vector<T>& v)
+{
+    saveBinary(out, (uint)v.size());
+    for (typename std::vector<T>::const_iterator i = v.begin(); i != v.end(); ++i)
+    {
+        saveBinary(out, (uint)*i);
+    }
+}
+
+static void loadBinary(std::istream& in, std::vector<uint>& v)
+{
+    uint size;
+    loadBinary(in, size);
+    v.resize(size);
+    for (uint i = 0; i < size; ++i)
+    {
+        loadBinary(in, v[i]);
+    }
+}
+
+static void loadBinary(std::istream& in, std::vector<bool>& v)
+{
+    uint size, val;
+    loadBinary(in, size);
+    v.resize(size);
+    for (uint i = 0; i < size; ++i)
+    {
+        loadBinary(in, val);
+        v[i] = val != 0;
+    }
+}
+
+static void loadBinary(std::istream& in, std::vector<unsigned char>& v)
+{
+    uint size, val;
+    loadBinary(in, size);
+    v.resize(size);
+    for (uint i = 0; i < size; ++i)
+    {
+        loadBinary(in, val);
+        v[i] = (unsigned char)val;
+    }
+}
+
+static void loadBinary(std::istream& in, std::vector<std::string>& v)
+{
+    uint size;
+    loadBinary(in, size);
+    v.resize(size);
+    for (uint i = 0; i < size; ++i)
+    {
+        loadBinary(in, v[i]);
+    }
+}
+
+static void saveBinary(std::ostream& out, const std::vector<std::string>& v)
+{
+    saveBinary(out, (uint)v.size());
+    for (uint i = 0; i < v.size(); ++i)
+    {
+        saveBinary(out, v[i]);
+    }
+}
+
+static void saveBinary(std::ostream& out, const std::vector<double>& v)
+{
+    saveBinary(out, (uint)v.size());
+    if (v.size())
+    {
+        out.write((const char*)&v[0], v.size() * sizeof(double));
+    }
+}
+
+static void loadBinary(std::istream& in, std::vector<double>& v)
+{
+    uint size;
+    loadBinary(in, size);
+    v.resize(size);
+    if (size)
+    {
+        in.read((char*)&v[0], size * sizeof(double));
+    }
+    if (!in)
+    {
+        throw_llvm_exception("unexpected end of stream reading model symbols");
+    }
+}
+
+static void saveBinary(std::ostream& out, const std::set<std::string>& s)
+{
+    saveBinary(out, (uint)s.size());
+    for (std::set<std::string>::const_iterator i = s.begin(); i != s.end(); ++i)
+    {
+        saveBinary(out, *i);
+    }
+}
+
+static void loadBinary(std::istream& in, std::set<std::string>& s)
+{
+    uint size;
+    std::string str;
+    loadBinary(in, size);
+    for (uint i = 0; i < size; ++i)
+    {
+        loadBinary(in, str);
+        s.insert(str);
+    }
+}
+
+static void saveBinary(std::ostream& out, const LLVMModelDataSymbols::StringUIntMap& m)
+{
+    saveBinary(out, (uint)m.size());
+    for (LLVMModelDataSymbols::StringUIntMap::const_iterator i = m.begin();
+            i != m.end(); ++i)
+    {
+        saveBinary(out, i->first);
+        saveBinary(out, i->second);
+    }
+}
+
+static void loadBinary(std::istream& in, LLVMModelDataSymbols::StringUIntMap& m)
+{
+    uint size, val;
+    std::string str;
+    loadBinary(in, size);
+    for (uint i = 0; i < size; ++i)
+    {
+        loadBinary(in, str);
+        loadBinary(in, val);
+        m[str] = val;
+    }
+}
+
+static void saveBinary(std::ostream& out, const LLVMModelDataSymbols::UIntUIntMap& m)
+{
+    saveBinary(out, (uint)m.size());
+    for (LLVMModelDataSymbols::UIntUIntMap::const_iterator i = m.begin();
+            i != m.end(); ++i)
+    {
+        saveBinary(out, i->first);
+        saveBinary(out, i->second);
+    }
+}
+
+static void loadBinary(std::istream& in, LLVMModelDataSymbols::UIntUIntMap& m)
+{
+    uint size, key, val;
+    loadBinary(in, size);
+    for (uint i = 0; i < size; ++i)
+    {
+        loadBinary(in, key);
+        loadBinary(in, val);
+        m[key] = val;
+    }
+}
+
+void LLVMModelDataSymbols::saveState(std::ostream& out) const
+{
+    saveBinary(out, symbolsMagic);
+    saveBinary(out, symbolsVersion);
+
+    saveBinary(out, modelName);
+    saveBinary(out, floatingSpeciesMap);
+    saveBinary(out, boundarySpeciesMap);
+    saveBinary(out, compartmentsMap);
+    saveBinary(out, globalParametersMap);
+
+    saveBinary(out, (uint)namedSpeciesReferenceInfo.size());
+    for (StringRefInfoMap::const_iterator i = namedSpeciesReferenceInfo.begin();
+            i != namedSpeciesReferenceInfo.end(); ++i)
+    {
+        saveBinary(out, i->first);
+        saveBinary(out, i->second.row);
+        saveBinary(out, i->second.column);
+        saveBinary(out, (uint)i->second.type);
+        saveBinary(out, i->second.id);
+    }
+
+    saveBinary(out, reactionsMap);
+    saveBinary(out, stoichColIndx);
+    saveBinary(out, stoichRowIndx);
+    saveBinary(out, stoichIds);
+    saveBinary(out, stoichTypes);
+    saveBinary(out, assigmentRules);
+    saveBinary(out, rateRules);
+    saveBinary(out, globalParameterRateRules);
+
+    saveBinary(out, independentFloatingSpeciesSize);
+    saveBinary(out, independentBoundarySpeciesSize);
+    saveBinary(out, independentGlobalParameterSize);
+    saveBinary(out, independentCompartmentSize);
+
+    saveBinary(out, eventAssignmentsSize);
+    saveBinary(out, eventAttributes);
+    saveBinary(out, eventIds);
+
+    // initial conditions
+    saveBinary(out, initAssignmentRules);
+    saveBinary(out, initFloatingSpeciesMap);
+    saveBinary(out, initBoundarySpeciesMap);
+    saveBinary(out, initCompartmentsMap);
+    saveBinary(out, initGlobalParametersMap);
+    saveBinary(out, independentInitFloatingSpeciesSize);
+    saveBinary(out, independentInitBoundarySpeciesSize);
+    saveBinary(out, independentInitGlobalParameterSize);
+    saveBinary(out, independentInitCompartmentSize);
+    saveBinary(out, floatingSpeciesCompartmentIndices);
+    saveBinary(out, literalInitialValuesMap);
+    saveBinary(out, literalInitialValues);
+
+    // conserved moieties
+    saveBinary(out, conservedMoietySpeciesSet);
+    saveBinary(out, conservedMoietyGlobalParameter);
+    saveBinary(out, conservedMoietyGlobalParameterIndex);
+    saveBinary(out, floatingSpeciesToConservedMoietyIdMap);
+
+    saveBinary(out, (uint)stateJacobianPattern.size());
+    for (uint i = 0; i < stateJacobianPattern.size(); ++i)
+    {
+        saveBinary(out, stateJacobianPattern[i]);
+    }
+}
+
+LLVMModelDataSymbols::LLVMModelDataSymbols(std::istream& in) :
+    independentFloatingSpeciesSize(0),
+    independentBoundarySpeciesSize(0),
+    independentGlobalParameterSize(0),
+    independentCompartmentSize(0),
+    independentInitFloatingSpeciesSize(0),
+    independentInitBoundarySpeciesSize(0),
+    independentInitGlobalParameterSize(0),
+    independentInitCompartmentSize(0)
+{
+    uint magic, version, size, val;
+
+    loadBinary(in, magic);
+    loadBinary(in, version);
+
+    if (magic != symbolsMagic || version != symbolsVersion)
+    {
+        throw_llvm_exception("invalid or incompatible saved model symbols, "
+                "version " + rr::toString(version) + ", expected version "
+                + rr::toString(symbolsVersion));
+    }
+
+    loadBinary(in, modelName);
+    loadBinary(in, floatingSpeciesMap);
+    loadBinary(in, boundarySpeciesMap);
+    loadBinary(in, compartmentsMap);
+    loadBinary(in, globalParametersMap);
+
+    loadBinary(in, size);
+    for (uint i = 0; i < size; ++i)
+    {
+        std::string key;
+        SpeciesReferenceInfo info;
+        loadBinary(in, key);
+        loadBinary(in, info.row);
+        loadBinary(in, info.column);
+        loadBinary(in, val);
+        info.type = (SpeciesReferenceType)val;
+        loadBinary(in, info.id);
+        namedSpeciesReferenceInfo[key] = info;
+    }
+
+    loadBinary(in, reactionsMap);
+    loadBinary(in, stoichColIndx);
+    loadBinary(in, stoichRowIndx);
+    loadBinary(in, stoichIds);
+
+    std::vector<uint> types;
+    loadBinary(in, types);
+    for (std::vector<uint>::const_iterator i = types.begin(); i != types.end(); ++i)
+    {
+        stoichTypes.push_back((SpeciesReferenceType)*i);
+    }
+
+    loadBinary(in, assigmentRules);
+    loadBinary(in, rateRules);
+    loadBinary(in, globalParameterRateRules);
+
+    loadBinary(in, independentFloatingSpeciesSize);
+    loadBinary(in, independentBoundarySpeciesSize);
+    loadBinary(in, independentGlobalParameterSize);
+    loadBinary(in, independentCompartmentSize);
+
+    loadBinary(in, eventAssignmentsSize);
+    loadBinary(in, eventAttributes);
+    loadBinary(in, eventIds);
+
+    // initial conditions
+    loadBinary(in, initAssignmentRules);
+    loadBinary(in, initFloatingSpeciesMap);
+    loadBinary(in, initBoundarySpeciesMap);
+    loadBinary(in, initCompartmentsMap);
+    loadBinary(in, initGlobalParametersMap);
+    loadBinary(in, independentInitFloatingSpeciesSize);
+    loadBinary(in, independentInitBoundarySpeciesSize);
+    loadBinary(in, independentInitGlobalParameterSize);
+    loadBinary(in, independentInitCompartmentSize);
+    loadBinary(in, floatingSpeciesCompartmentIndices);
+    loadBinary(in, literalInitialValuesMap);
+    loadBinary(in, literalInitialValues);
+
+    // conserved moieties
+    loadBinary(in, conservedMoietySpeciesSet);
+    loadBinary(in, conservedMoietyGlobalParameter);
+    loadBinary(in, conservedMoietyGlobalParameterIndex);
+    loadBinary(in, floatingSpeciesToConservedMoietyIdMap);
+
+    loadBinary(in, size);
+    stateJacobianPattern.resize(size);
+    for (uint i = 0; i < size; ++i)
+    {
+        loadBinary(in, stateJacobianPattern[i]);
+    }
+}
+
 } /* namespace rr */
@@ -21,6 +21,8 @@
 #include <map>
 #include <set>
 #include <list>
+#include <istream>
+#include <ostream>
 
 namespace libsbml
 {
@@ -69,16 +71,17 @@ enum ModelDataFields {
     RateRuleValuesAlias,                      // 29
     FloatingSpeciesAmountsAlias,              // 30
 
-    CompartmentVolumes,                       // 31
-    InitCompartmentVolumes,                   // 32
-    InitFloatingSpeciesAmounts,               // 33
-    BoundarySpeciesAmounts,                   // 34
-    InitBoundarySpeciesAmounts,               // 35
+    NotSafe_RateRuleValues,                   // 31
+    NotSafe_FloatingSpeciesAmounts,           // 32
+    ReactionRates,                            // 33
+    CompartmentVolumes,                       // 34
+    BoundarySpeciesAmounts,                   // 35
     GlobalParameters,                         // 36
-    InitGlobalParameters,                     // 37
-    ReactionRates,                            // 38
-    NotSafe_RateRuleValues,                   // 39
-    NotSafe_FloatingSpeciesAmounts,           // 40
+    InitCompartmentVolumes,                   // 37
+    InitFloatingSpeciesAmounts,               // 38
+    InitBoundarySpeciesAmounts,               // 39
+    InitGlobalParameters,                     // 40
+    LiteralInitialValues,                     // 41
 };
 
 enum EventAtributes
@@ -164,6 +167,14 @@ public:
 
     LLVMModelDataSymbols(libsbml::Model const* model, unsigned options);
 
+    /**
+     * re-create the symbols from a stream previously written by saveState.
+     *
+     * This is how ahead of time compiled models restore their symbol tables
+     * without needing the original sbml document.
+     */
+    LLVMModelDataSymbols(std::istream& in);
+
     virtual ~LLVMModelDataSymbols();
 
     const std::string& getModelName() const;
@@ -285,13 +296,15 @@ public:
      */
     std::list<SpeciesReferenceInfo> getStoichiometryIndx() const;
 
+    void print() const;
+
     /**
-     * initialize and allocate the buffers (including the stoich matrix)
-     * for an existing ModelData struct.
+     * write all of the symbol tables to a binary stream.
+     *
+     * The format is only intended to be read back by the
+     * LLVMModelDataSymbols(std::istream&) ctor on the same platform.
      */
-    //void initAllocModelDataBuffers(LLVMModelData& m) const;
-
-    void print() const;
+    void saveState(std::ostream& out) const;
 
     /**
      * if there are no rules for an element, then they are considered
@@ -448,6 +461,16 @@ public:
      */
     const std::vector<uint>& getStoichColIndx() const;
 
+    /**
+     * structural sparsity pattern of the Jacobian of the state vector rate.
+     *
+     * For each state vector element (column), the sorted indices of the
+     * state vector rates (rows) which may depend on it. This is a
+     * conservative estimate from the symbols referenced by the kinetic laws,
+     * rate rules and the assignment rules they use.
+     */
+    const std::vector<std::vector<uint> >& getStateJacobianPattern() const;
+
 
 /************************ Initial Conditions Section *************************/
 #if (1) /*********************************************************************/
@@ -526,10 +549,53 @@ public:
 
     uint getEventIndex(const std::string& id) const;
 
+    /**
+     * The literal initial values are the numbers in the sbml which only
+     * determine the initial state: compartment sizes, species initial
+     * amounts or concentrations and global parameter values. These are not
+     * compiled into evalInitialConditions as constants, they are loaded
+     * from the model data, so models which only differ in these numbers can
+     * share the same compiled code.
+     *
+     * get the ids and values of the elements with a literal initial value
+     * in an sbml model, in document order. Species which have an initial
+     * concentration give their concentration, otherwise their amount.
+     */
+    static void getLiteralInitialValues(const libsbml::Model *model,
+            std::vector<std::string>& ids, std::vector<double>& values);
+
+    /**
+     * the number of literal initial values.
+     */
+    uint getLiteralInitialValueSize() const;
+
+    /**
+     * does this element have a literal initial value.
+     */
+    bool hasLiteralInitialValue(const std::string& id) const;
+
+    /**
+     * index of the literal initial value of an element.
+     */
+    uint getLiteralInitialValueIndex(const std::string& id) const;
+
+    /**
+     * the literal initial values of the sbml these symbols were created
+     * from, the default values of a new model data.
+     */
+    const std::vector<double>& getLiteralInitialValues() const;
+
 private:
 
     std::set<std::string> initAssignmentRules;
 
+    /**
+     * literal initial value ids to their index in the model data, and the
+     * values from the original sbml.
+     */
+    StringUIntMap literalInitialValuesMap;
+    std::vector<double> literalInitialValues;
+
     /**
      * map of floating species init value symbols to thier
      * index in the array.
@@ -693,6 +759,35 @@ private:
 
     void initEvents(const libsbml::Model *model);
 
+    /**
+     * build the state Jacobian pattern, must be called after all of the
+     * other symbols are initialized.
+     */
+    void initStateJacobianPattern(const libsbml::Model *model);
+
+    /**
+     * index in the state vector of the given symbol, -1 if it is not
+     * a state vector element.
+     */
+    int getStateVectorIndex(const std::string& id) const;
+
+    /**
+     * add the state vector indices that the value of a symbol depends on,
+     * following assignment rules, species compartments and reaction rates.
+     */
+    void collectStateDependencies(const libsbml::Model *model,
+            const std::string& id, std::set<uint>& deps,
+            std::set<std::string>& visited) const;
+
+    void collectStateDependencies(const libsbml::Model *model,
+            const libsbml::ASTNode *math, std::set<uint>& deps,
+            std::set<std::string>& visited) const;
+
+    /**
+     * column major state Jacobian pattern.
+     */
+    std::vector<std::vector<uint> > stateJacobianPattern;
+
     /**
      * determine is this species can be used as a species reference,
      * in the sense that it will add a column to the stochiometry
@@ -0,0 +1,499 @@
+/*
+ * LLVMModelExporter.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+#pragma hdrstop
+#include "LLVMModelExporter.h"
+#include "LLVMExecutableModel.h"
+#include "ModelGeneratorContext.h"
+#include "ModelResources.h"
+#include "LLVMIncludes.h"
+#include "LLVMException.h"
+#include "Random.h"
+#include "rrRoadRunnerOptions.h"
+#include "rrLogger.h"
+#include "rrConfig.h"
+
+#include <llvm/Support/TargetRegistry.h>
+#include <llvm/Support/FormattedStream.h>
+#include <llvm/Target/TargetMachine.h>
+#include <llvm/Target/TargetOptions.h>
+#if (LLVM_VERSION_MAJOR == 3) && (LLVM_VERSION_MINOR >= 4)
+#include <llvm/Support/FileSystem.h>
+#endif
+
+#include <Poco/SharedLibrary.h>
+
+#include <sstream>
+#include <vector>
+
+using rr::Logger;
+using rr::LoadSBMLOptions;
+using rr::ExecutableModel;
+
+using namespace llvm;
+
+namespace rrllvm
+{
+
+typedef cxx11_ns::shared_ptr<ModelResources> SharedModelPtr;
+
+/**
+ * exported function names are prefixed so they do not collide with
+ * anything else in the process.
+ */
+static const char* exportPrefix = "rr_aot_";
+
+/**
+ * each runtime support function gets a function pointer slot with this prefix,
+ * the loader fills these in.
+ */
+static const char* importPrefix = "rr_aot_import_";
+
+/**
+ * the serialized model info: options, imports and symbols.
+ */
+static const char* modelInfoName = "rr_aot_model_info";
+static const char* modelInfoSizeName = "rr_aot_model_info_size";
+
+static std::string exportName(const char* functionName)
+{
+    return std::string(exportPrefix) + functionName;
+}
+
+/**
+ * generates the IR of the functions a model has with its load options,
+ * with exported names.
+ */
+class ExportModelFunctions
+{
+public:
+    ExportModelFunctions(const ModelGeneratorContext& context, uint options) :
+        context(context), options(options)
+    {
+    }
+
+    template <typename CodeGenType>
+    void visit(typename CodeGenType::FunctionPtr&, ModelFunctionKind kind)
+    {
+        if (hasModelFunctions(kind, options))
+        {
+            CodeGenType codeGen(context);
+            if (hasModelFunction(codeGen))
+            {
+                llvm::Function *func = codeGen.createFunctionIR();
+                func->setName(exportName(CodeGenType::FunctionName));
+                func->setLinkage(llvm::Function::ExternalLinkage);
+            }
+        }
+    }
+
+private:
+    const ModelGeneratorContext& context;
+    uint options;
+};
+
+template <typename CodeGenType>
+static typename CodeGenType::FunctionPtr resolveFunction(
+        Poco::SharedLibrary& lib, bool required)
+{
+    std::string name = exportName(CodeGenType::FunctionName);
+
+    if (!required && !lib.hasSymbol(name))
+    {
+        return 0;
+    }
+
+    if (!lib.hasSymbol(name))
+    {
+        throw_llvm_exception("exported model " + lib.getPath() +
+                " does not contain function " + name);
+    }
+
+    return (typename CodeGenType::FunctionPtr)lib.getSymbol(name);
+}
+
+/**
+ * resolves the function pointers of an exported model, the ones which are
+ * not required are NULL if the model was exported without them, same as
+ * for JIT models.
+ */
+class ResolveModelFunctions
+{
+public:
+    ResolveModelFunctions(Poco::SharedLibrary& lib) : lib(lib)
+    {
+    }
+
+    template <typename CodeGenType>
+    void visit(typename CodeGenType::FunctionPtr& func, ModelFunctionKind kind)
+    {
+        func = resolveFunction<CodeGenType>(lib, kind == MODEL_FUNCTION_REQUIRED);
+    }
+
+private:
+    Poco::SharedLibrary& lib;
+};
+
+/**
+ * The JIT engine resolves calls to runtime support functions (the
+ * distrib functions, csr matrix accessors, sbml math functions) by global
+ * mappings, which do not exist in an object file.
+ *
+ * Replace every mapped function declaration with an exported function
+ * pointer slot, and every call to it with an indirect call through the slot.
+ * The loader fills in the slots, so the shared library does not need to
+ * link against roadrunner.
+ *
+ * @return the names of the imported functions.
+ */
+static std::vector<std::string> createImportSlots(const ModelGeneratorContext& context)
+{
+    Module *module = context.getModule();
+    ExecutionEngine &engine = context.getExecutionEngine();
+    std::vector<llvm::Function*> mapped;
+    std::vector<std::string> names;
+
+    for (Module::iterator f = module->begin(); f != module->end(); ++f)
+    {
+        if (f->isDeclaration() && engine.getPointerToGlobalIfAvailable(&*f))
+        {
+            mapped.push_back(&*f);
+        }
+    }
+
+    for (std::vector<llvm::Function*>::iterator i = mapped.begin();
+            i != mapped.end(); ++i)
+    {
+        llvm::Function *func = *i;
+        std::string name = func->getName().str();
+
+        if (!func->use_empty())
+        {
+            GlobalVariable *slot = new GlobalVariable(*module,
+                    func->getType(), false, GlobalValue::ExternalLinkage,
+                    ConstantPointerNull::get(func->getType()),
+                    std::string(importPrefix) + name);
+
+            while (!func->use_empty())
+            {
+#if (LLVM_VERSION_MAJOR == 3) && (LLVM_VERSION_MINOR >= 5)
+                CallInst *call = dyn_cast<CallInst>(func->user_back());
+#else
+                CallInst *call = dyn_cast<CallInst>(func->use_back());
+#endif
+                if (!call)
+                {
+                    throw_llvm_exception("runtime support function " + name +
+                            " is used by something other than a call, "
+                            "can not export model");
+                }
+
+                Value *funcPtr = new LoadInst(slot, name, call);
+                call->setCalledFunction(funcPtr);
+            }
+
+            names.push_back(name);
+        }
+
+        engine.updateGlobalMapping(func, 0);
+        func->eraseFromParent();
+    }
+
+    return names;
+}
+
+/**
+ * store the model info as a constant byte array in the module.
+ */
+static void createModelInfo(const ModelGeneratorContext& context,
+        const std::vector<std::string>& imports, const std::string& cpu,
+        const std::string& features)
+{
+    std::stringstream ss(std::ios::in | std::ios::out | std::ios::binary);
+
+    unsigned options = context.getOptions();
+    unsigned hasRandom = context.getRandom() ? 1 : 0;
+    unsigned numImports = imports.size();
+
+    ss.write((const char*)&options, sizeof(options));
+    ss.write((const char*)&hasRandom, sizeof(hasRandom));
+
+    // the target, null terminated
+    ss.write(cpu.c_str(), cpu.size() + 1);
+    ss.write(features.c_str(), features.size() + 1);
+
+    ss.write((const char*)&numImports, sizeof(numImports));
+
+    for (unsigned i = 0; i < imports.size(); ++i)
+    {
+        // null terminated
+        ss.write(imports[i].c_str(), imports[i].size() + 1);
+    }
+
+    context.getModelDataSymbols().saveState(ss);
+
+    std::string info = ss.str();
+    Module *module = context.getModule();
+    LLVMContext &ctx = module->getContext();
+
+    Constant *infoData = ConstantDataArray::getString(ctx, info, false);
+
+    new GlobalVariable(*module, infoData->getType(), true,
+            GlobalValue::ExternalLinkage, infoData, modelInfoName);
+
+    new GlobalVariable(*module, Type::getInt32Ty(ctx), true,
+            GlobalValue::ExternalLinkage,
+            ConstantInt::get(Type::getInt32Ty(ctx), info.size()),
+            modelInfoSizeName);
+}
+
+/**
+ * the CPU an exported model is compiled for, from Config::LLVM_TARGET_CPU.
+ * Exported models are meant to be moved to other machines, so unless a CPU
+ * is asked for, they are compiled for the generic CPU of the architecture.
+ * "host" is this machine's CPU, with the features it actually has in
+ * features.
+ */
+static std::string exportTargetCPU(std::string& features)
+{
+    std::string cpu = rr::Config::getString(rr::Config::LLVM_TARGET_CPU);
+    features.clear();
+
+    if (cpu.empty())
+    {
+        return "generic";
+    }
+
+    if (cpu == "host")
+    {
+        cpu = sys::getHostCPUName();
+
+        StringMap<bool> hostFeatures;
+        if (sys::getHostCPUFeatures(hostFeatures))
+        {
+            for (StringMap<bool>::const_iterator i = hostFeatures.begin();
+                    i != hostFeatures.end(); ++i)
+            {
+                if (i->second)
+                {
+                    features += (features.empty() ? "+" : ",+") + i->getKey().str();
+                }
+            }
+        }
+    }
+
+    return cpu;
+}
+
+/**
+ * check that this machine can run code compiled for the given CPU and
+ * features, throws if it can not.
+ */
+static void checkTargetCPU(const std::string& cpu, const std::string& features,
+        const std::string& fileName)
+{
+    if (cpu == "generic")
+    {
+        return;
+    }
+
+    StringMap<bool> hostFeatures;
+    if (!features.empty() && sys::getHostCPUFeatures(hostFeatures))
+    {
+        std::istringstream in(features);
+        std::string feature;
+        while (std::getline(in, feature, ','))
+        {
+            std::string name = feature.substr(1);
+            if (!hostFeatures.lookup(name))
+            {
+                throw_llvm_exception(fileName + " was compiled for cpu " + cpu +
+                        " with feature " + name + ", which this cpu does not "
+                        "have, export it with LLVM_TARGET_CPU empty for the "
+                        "generic cpu");
+            }
+        }
+        return;
+    }
+
+    // the features of a named cpu are not recorded, only the same cpu is
+    // known to run it.
+    if (cpu != sys::getHostCPUName())
+    {
+        throw_llvm_exception(fileName + " was compiled for cpu " + cpu +
+                ", but this cpu is " + sys::getHostCPUName().str() +
+                ", export it with LLVM_TARGET_CPU empty for the generic cpu");
+    }
+}
+
+static void emitObjectFile(Module *module, const std::string& fileName,
+        const std::string& cpu, const std::string& features)
+{
+    InitializeNativeTarget();
+    InitializeNativeTargetAsmPrinter();
+
+    std::string triple = sys::getDefaultTargetTriple();
+    std::string err;
+
+    const Target *target = TargetRegistry::lookupTarget(triple, err);
+
+    if (!target)
+    {
+        throw_llvm_exception("could not find target for " + triple + ", " + err);
+    }
+
+    // position independent, the object is linked into a shared library
+    TargetOptions targetOptions;
+    TargetMachine *targetMachine = target->createTargetMachine(triple,
+            cpu, features, targetOptions, Reloc::PIC_);
+
+    if (!targetMachine)
+    {
+        throw_llvm_exception("could not create target machine for " + triple);
+    }
+
+    try
+    {
+        module->setTargetTriple(triple);
+
+#if (LLVM_VERSION_MAJOR == 3) && (LLVM_VERSION_MINOR >= 5)
+        raw_fd_ostream out(fileName.c_str(), err, sys::fs::F_None);
+#elif (LLVM_VERSION_MAJOR == 3) && (LLVM_VERSION_MINOR == 4)
+        raw_fd_ostream out(fileName.c_str(), err, sys::fs::F_Binary);
+#else
+        raw_fd_ostream out(fileName.c_str(), err, raw_fd_ostream::F_Binary);
+#endif
+
+        if (!err.empty())
+        {
+            throw_llvm_exception("could not open " + fileName + ", " + err);
+        }
+
+        PassManager passManager;
+
+#if (LLVM_VERSION_MAJOR == 3) && (LLVM_VERSION_MINOR == 1)
+        passManager.add(new TargetData(*targetMachine->getTargetData()));
+#elif (LLVM_VERSION_MINOR <= 4)
+        passManager.add(new DataLayout(*targetMachine->getDataLayout()));
+#else
+        module->setDataLayout(targetMachine->getDataLayout());
+        passManager.add(new DataLayoutPass(module));
+#endif
+
+        formatted_raw_ostream formattedOut(out);
+
+        if (targetMachine->addPassesToEmitFile(passManager, formattedOut,
+                TargetMachine::CGFT_ObjectFile))
+        {
+            throw_llvm_exception("target " + triple +
+                    " can not emit object files");
+        }
+
+        passManager.run(*module);
+    }
+    catch(...)
+    {
+        delete targetMachine;
+        throw;
+    }
+
+    delete targetMachine;
+}
+
+void LLVMModelExporter::exportModel(const std::string& sbml, uint options,
+        const std::string& fileName)
+{
+    Log(Logger::LOG_INFORMATION) << "exporting model to " << fileName;
+
+    ModelGeneratorContext context(sbml, options);
+
+    // the resources are only needed for the list of functions.
+    ModelResources rc;
+    ExportModelFunctions exportFunctions(context, options);
+    visitModelFunctions(rc, exportFunctions);
+
+    std::vector<std::string> imports = createImportSlots(context);
+
+    std::string features;
+    std::string cpu = exportTargetCPU(features);
+
+    Log(Logger::LOG_INFORMATION) << "exporting model for cpu " << cpu;
+
+    createModelInfo(context, imports, cpu, features);
+
+    emitObjectFile(context.getModule(), fileName, cpu, features);
+}
+
+ExecutableModel* LLVMModelExporter::loadModel(const std::string& fileName)
+{
+    Log(Logger::LOG_INFORMATION) << "loading exported model from " << fileName;
+
+    // resources own the library, and clean it up if anything below throws.
+    SharedModelPtr rc(new ModelResources());
+    rc->library = new Poco::SharedLibrary(fileName);
+    Poco::SharedLibrary &lib = *rc->library;
+
+    if (!lib.hasSymbol(modelInfoName) || !lib.hasSymbol(modelInfoSizeName))
+    {
+        throw_llvm_exception(fileName + " is not an exported roadrunner model");
+    }
+
+    const char* infoData = (const char*)lib.getSymbol(modelInfoName);
+    unsigned infoSize = *(const unsigned*)lib.getSymbol(modelInfoSizeName);
+
+    std::istringstream in(std::string(infoData, infoSize),
+            std::ios::in | std::ios::binary);
+
+    unsigned options = 0, hasRandom = 0, numImports = 0;
+    std::string cpu, features;
+    in.read((char*)&options, sizeof(options));
+    in.read((char*)&hasRandom, sizeof(hasRandom));
+    std::getline(in, cpu, '\0');
+    std::getline(in, features, '\0');
+    in.read((char*)&numImports, sizeof(numImports));
+
+    if (!in)
+    {
+        throw_llvm_exception("corrupt model info in " + fileName);
+    }
+
+    // before running any of its code.
+    checkTargetCPU(cpu, features, fileName);
+
+    for (unsigned i = 0; i < numImports && in; ++i)
+    {
+        std::string name;
+        std::getline(in, name, '\0');
+
+        void* address = getSupportFunctionAddress(name);
+        std::string slotName = std::string(importPrefix) + name;
+
+        if (!address || !lib.hasSymbol(slotName))
+        {
+            throw_llvm_exception("could not bind runtime support function "
+                    + name + " for exported model " + fileName);
+        }
+
+        *(void**)lib.getSymbol(slotName) = address;
+    }
+
+    if (!in)
+    {
+        throw_llvm_exception("corrupt model info in " + fileName);
+    }
+
+    rc->symbols = new LLVMModelDataSymbols(in);
+    rc->random = hasRandom ? new Random() : 0;
+
+    ResolveModelFunctions resolveFunctions(lib);
+    visitModelFunctions(*rc, resolveFunctions);
+
+    Log(Logger::LOG_DEBUG) << "loaded exported model " << fileName <<
+            ", options: " << options;
+
+    return new LLVMExecutableModel(rc, createModelData(*rc->symbols, rc->random));
+}
+
+} /* namespace rrllvm */
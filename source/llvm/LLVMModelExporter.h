@@ -0,0 +1,69 @@
+/*
+ * LLVMModelExporter.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef RRLLVM_LLVMMODELEXPORTER_H_
+#define RRLLVM_LLVMMODELEXPORTER_H_
+
+#include "rrExecutableModel.h"
+#include <string>
+
+namespace rrllvm
+{
+
+/**
+ * Ahead of time (AOT) compilation of sbml models.
+ *
+ * The normal path, LLVMModelGenerator::createModel parses the sbml, generates
+ * the LLVM IR and JIT compiles it every time a model is loaded. This is fine
+ * for interactive use, but when the same model is run on a large number of
+ * nodes, the parse / codegen / JIT time can dominate.
+ *
+ * The exporter generates exactly the same set of functions as
+ * LLVMModelGenerator, but instead of JIT compiling them, writes them as
+ * exported symbols to a native object file, along with the serialized
+ * LLVMModelDataSymbols. The object file is turned into a shared library with
+ * the platform linker, i.e.
+ *
+ *     cc -shared -o model.so model.o -lm
+ *
+ * The loader then opens the shared library, binds the runtime support
+ * functions that the generated code calls (the same functions the JIT engine
+ * would have mapped), restores the symbol tables and creates an
+ * LLVMExecutableModel without libsbml or LLVM being involved.
+ *
+ * The exported library is only valid for the roadrunner version and platform
+ * which created it, the symbol table is versioned and the loader will reject
+ * incompatible libraries.
+ */
+class RR_DECLSPEC LLVMModelExporter
+{
+public:
+
+    /**
+     * generate the model code for the given sbml and write it as a
+     * native object file.
+     *
+     * @param sbml: an sbml string.
+     * @param options: LoadSBMLOptions::ModelGeneratorOpt bitfield, same as
+     * LLVMModelGenerator::createModel.
+     * @param fileName: path of the object file to write.
+     */
+    static void exportModel(const std::string& sbml, uint options,
+            const std::string& fileName);
+
+    /**
+     * load a shared library created from an exported model object file
+     * and create a new executable model from it.
+     *
+     * Multiple models may be loaded from the same library, each gets its
+     * own model data.
+     */
+    static rr::ExecutableModel *loadModel(const std::string& fileName);
+};
+
+} /* namespace rrllvm */
+
+#endif /* RRLLVM_LLVMMODELEXPORTER_H_ */
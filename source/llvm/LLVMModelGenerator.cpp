@@ -12,11 +12,19 @@
 #include "LLVMExecutableModel.h"
 #include "ModelGeneratorContext.h"
 #include "LLVMIncludes.h"
+#include <llvm/ExecutionEngine/JITEventListener.h>
 #include "ModelResources.h"
 #include "Random.h"
 #include <rrLogger.h>
 #include <rrUtils.h>
+#include <rrConfig.h>
 #include <Poco/Mutex.h>
+#include <sbml/SBMLReader.h>
+#include <sbml/SBMLWriter.h>
+#include <algorithm>
+#include <list>
+#include <sstream>
+#include <new>
 
 using rr::Logger;
 using rr::getLogger;
@@ -34,6 +42,145 @@ typedef cxx11_ns::unordered_map<std::string, WeakModelPtr> ModelPtrMap;
 static Poco::Mutex cachedModelsMutex;
 static ModelPtrMap cachedModels;
 
+typedef std::list<SharedModelPtr> ModelList;
+typedef cxx11_ns::unordered_map<const ModelResources*, ModelList::iterator> ModelListIndex;
+
+/**
+ * strong references to the most recently used models, most recent first,
+ * these stay compiled when no executable model uses them. Bounded by
+ * Config::LLVM_MODEL_CACHE_SIZE. All guarded by cachedModelsMutex.
+ */
+static ModelList recentModels;
+static ModelListIndex recentModelsIndex;
+static size_t recentModelsSize = 0;
+
+static unsigned long cacheHits = 0;
+static unsigned long cacheMisses = 0;
+static unsigned long cacheEvictions = 0;
+
+static size_t getCacheCapacity()
+{
+    int mb = rr::Config::getInt(rr::Config::LLVM_MODEL_CACHE_SIZE);
+    return mb > 0 ? (size_t)mb * 1024 * 1024 : 0;
+}
+
+/**
+ * release the least recently used models until the rest fit in the cache.
+ * The released ones are moved to evicted, so they are deleted after the
+ * mutex is unlocked.
+ */
+static void evictRecentModels(std::vector<SharedModelPtr>& evicted)
+{
+    size_t capacity = getCacheCapacity();
+
+    while (recentModels.size() && recentModelsSize > capacity)
+    {
+        SharedModelPtr sp = recentModels.back();
+
+        Log(Logger::LOG_DEBUG) << "evicting model resources of "
+                << sp->size << " bytes from the model cache";
+
+        recentModels.pop_back();
+        recentModelsIndex.erase(sp.get());
+        recentModelsSize -= sp->size;
+        ++cacheEvictions;
+        evicted.push_back(sp);
+    }
+}
+
+/**
+ * make a model the most recently used one.
+ */
+static void touchRecentModel(const SharedModelPtr& sp,
+        std::vector<SharedModelPtr>& evicted)
+{
+    ModelListIndex::iterator i = recentModelsIndex.find(sp.get());
+
+    if (i != recentModelsIndex.end())
+    {
+        recentModels.splice(recentModels.begin(), recentModels, i->second);
+        return;
+    }
+
+    if (getCacheCapacity() == 0)
+    {
+        return;
+    }
+
+    recentModels.push_front(sp);
+    recentModelsIndex[sp.get()] = recentModels.begin();
+    recentModelsSize += sp->size;
+
+    evictRecentModels(evicted);
+}
+
+/**
+ * sums the size of the machine code the JIT emits whilst it is registered
+ * with an execution engine.
+ */
+class CodeSizeListener : public llvm::JITEventListener
+{
+public:
+    CodeSizeListener(llvm::ExecutionEngine &engine) :
+        engine(engine), size(0)
+    {
+        engine.RegisterJITEventListener(this);
+    }
+
+    ~CodeSizeListener()
+    {
+        engine.UnregisterJITEventListener(this);
+    }
+
+    virtual void NotifyFunctionEmitted(const llvm::Function &f, void *code,
+            size_t codeSize, const EmittedFunctionDetails &details)
+    {
+        size += codeSize;
+    }
+
+    llvm::ExecutionEngine &engine;
+    size_t size;
+};
+
+/**
+ * memory of a compiled model: the machine code the JIT emitted, measured,
+ * and an estimate of the IR the execution engine keeps, of the engine and
+ * context, and of the symbol tables. Only the cache bound depends on it,
+ * so it only needs to be right within a factor of about two.
+ */
+static size_t estimateModelSize(const llvm::Module *module,
+        const LLVMModelDataSymbols& symbols, size_t codeSize)
+{
+    // an instruction and its operands.
+    const size_t instructionSize = 64;
+
+    // the LLVMContext and ExecutionEngine, and the declarations of the
+    // library functions every module has.
+    const size_t engineSize = 256 * 1024;
+
+    size_t instructions = 0;
+    for (llvm::Module::const_iterator f = module->begin(); f != module->end(); ++f)
+    {
+        for (llvm::Function::const_iterator b = f->begin(); b != f->end(); ++b)
+        {
+            instructions += b->size();
+        }
+    }
+
+    // the maps hold the names about twice over, plus their nodes.
+    std::stringstream ss(std::ios::in | std::ios::out | std::ios::binary);
+    symbols.saveState(ss);
+
+    // a JIT which does not report its functions, about as much code as IR.
+    if (codeSize == 0)
+    {
+        codeSize = instructions * instructionSize;
+    }
+
+    return engineSize + instructions * instructionSize + codeSize
+            + 3 * ss.str().size();
+}
+
 
 /**
  * copy the cached model fields between a cached model, and a
@@ -53,6 +200,7 @@ void copyCachedModel(a_type* src, b_type* dst)
 
     dst->evalInitialConditionsPtr = src->evalInitialConditionsPtr;
     dst->evalReactionRatesPtr = src->evalReactionRatesPtr;
+    dst->evalStateVectorRatePtr = src->evalStateVectorRatePtr;
     dst->getBoundarySpeciesAmountPtr = src->getBoundarySpeciesAmountPtr;
     dst->getFloatingSpeciesAmountPtr = src->getFloatingSpeciesAmountPtr;
     dst->getBoundarySpeciesConcentrationPtr = src->getBoundarySpeciesConcentrationPtr;
@@ -70,168 +218,267 @@ void copyCachedModel(a_type* src, b_type* dst)
 }
 
 
-ExecutableModel* LLVMModelGenerator::createModel(const std::string& sbml,
-        uint options)
+/**
+ * generates the functions of a model which it has with its load options,
+ * the others are NULL.
+ */
+class CreateModelFunctions
 {
-    bool forceReCompile = options & LoadSBMLOptions::RECOMPILE;
-
-    string md5;
+public:
+    CreateModelFunctions(const ModelGeneratorContext& context, uint options) :
+        context(context), options(options)
+    {
+    }
 
-    if (!forceReCompile)
+    template <typename CodeGenType>
+    void visit(typename CodeGenType::FunctionPtr& func, ModelFunctionKind kind)
     {
-        // check for a chached copy
-        md5 = rr::getMD5(sbml);
+        func = 0;
 
-        if (options & LoadSBMLOptions::CONSERVED_MOIETIES)
+        if (hasModelFunctions(kind, options))
         {
-            md5 += "_conserved";
+            CodeGenType codeGen(context);
+            if (hasModelFunction(codeGen))
+            {
+                func = codeGen.createFunction();
+            }
         }
+    }
 
-        ModelPtrMap::const_iterator i;
+private:
+    const ModelGeneratorContext& context;
+    uint options;
+};
+
+
+/**
+ * hash of the structure of an sbml model, the sbml with all of the literal
+ * initial values set to zero. Models which only differ in their parameter
+ * values, initial amounts or concentrations and compartment sizes have the
+ * same structure hash and share the same compiled code, the literal
+ * initial values are returned in ids and values.
+ *
+ * Whether an element has a literal initial value, and if a species has an
+ * initial amount or concentration, is part of the structure. Returns an
+ * empty string if the sbml can not be read.
+ *
+ * This is a full libsbml read and write of the document, done on every load
+ * which misses the hash of the exact sbml text, so a cold load parses the
+ * sbml twice. That is small next to the compile it may save, and it is
+ * skipped with LoadSBMLOptions::RECOMPILE.
+ */
+static std::string getStructureHash(const std::string& sbml,
+        std::vector<std::string>& ids, std::vector<double>& values)
+{
+    libsbml::SBMLDocument *doc = libsbml::readSBMLFromString(sbml.c_str());
+    libsbml::Model *model = doc ? doc->getModel() : 0;
 
-        SharedModelPtr sp;
+    if (!model)
+    {
+        delete doc;
+        return "";
+    }
 
-        cachedModelsMutex.lock();
+    LLVMModelDataSymbols::getLiteralInitialValues(model, ids, values);
 
-        if ((i = cachedModels.find(md5)) != cachedModels.end())
+    for (uint i = 0; i < model->getNumCompartments(); ++i)
+    {
+        libsbml::Compartment *c = model->getCompartment(i);
+        if (c->isSetVolume())
         {
-            sp = i->second.lock();
+            c->setVolume(0);
         }
+    }
 
-        cachedModelsMutex.unlock();
-
-        // we could have recieved a bad ptr, a model could have been deleted,
-        // in which case, we should have a bad ptr.
-
-        if (sp)
+    for (uint i = 0; i < model->getNumSpecies(); ++i)
+    {
+        libsbml::Species *s = model->getSpecies(i);
+        if (s->isSetInitialConcentration())
         {
-            Log(Logger::LOG_DEBUG) << "found a cached model for " << md5;
-            return new LLVMExecutableModel(sp, createModelData(*sp->symbols, sp->random));
+            s->setInitialConcentration(0);
         }
-        else
+        else if (s->isSetInitialAmount())
         {
-            Log(Logger::LOG_TRACE) << "no cached model found for " << md5
-                    << ", creating new one";
+            s->setInitialAmount(0);
         }
     }
 
-    SharedModelPtr rc(new ModelResources());
+    for (uint i = 0; i < model->getNumParameters(); ++i)
+    {
+        libsbml::Parameter *p = model->getParameter(i);
+        if (p->isSetValue())
+        {
+            p->setValue(0);
+        }
+    }
 
-    ModelGeneratorContext context(sbml, options);
+    char *str = libsbml::writeSBMLToString(doc);
+    std::string hash = str ? rr::getMD5(str) : std::string();
+    free(str);
+    delete doc;
+    return hash;
+}
 
-    rc->evalInitialConditionsPtr =
-            EvalInitialConditionsCodeGen(context).createFunction();
+static SharedModelPtr findCachedModel(const std::string& hash)
+{
+    std::vector<SharedModelPtr> evicted;
+    Poco::Mutex::ScopedLock lock(cachedModelsMutex);
 
-    rc->evalReactionRatesPtr =
-            EvalReactionRatesCodeGen(context).createFunction();
+    ModelPtrMap::const_iterator i = cachedModels.find(hash);
+    SharedModelPtr sp = i != cachedModels.end() ? i->second.lock() : SharedModelPtr();
 
-    rc->getBoundarySpeciesAmountPtr =
-            GetBoundarySpeciesAmountCodeGen(context).createFunction();
+    if (sp)
+    {
+        ++cacheHits;
+        touchRecentModel(sp, evicted);
+    }
 
-    rc->getFloatingSpeciesAmountPtr =
-            GetFloatingSpeciesAmountCodeGen(context).createFunction();
+    return sp;
+}
 
-    rc->getBoundarySpeciesConcentrationPtr =
-            GetBoundarySpeciesConcentrationCodeGen(context).createFunction();
+void LLVMModelGenerator::getCacheStatistics(rr::Dictionary& stats)
+{
+    Poco::Mutex::ScopedLock lock(cachedModelsMutex);
+
+    stats.setItem("hits", cacheHits);
+    stats.setItem("misses", cacheMisses);
+    stats.setItem("evictions", cacheEvictions);
+    stats.setItem("models", (unsigned long)recentModels.size());
+    stats.setItem("size", (unsigned long)recentModelsSize);
+    stats.setItem("capacity", (unsigned long)getCacheCapacity());
+}
 
-    rc->getFloatingSpeciesConcentrationPtr =
-            GetFloatingSpeciesConcentrationCodeGen(context).createFunction();
+void LLVMModelGenerator::clearCache()
+{
+    ModelList released;
 
-    rc->getCompartmentVolumePtr =
-            GetCompartmentVolumeCodeGen(context).createFunction();
+    {
+        Poco::Mutex::ScopedLock lock(cachedModelsMutex);
+        released.swap(recentModels);
+        recentModelsIndex.clear();
+        recentModelsSize = 0;
+    }
+}
+
+/**
+ * the part of the cache key from the options which change the generated
+ * code, models are only shared if they were compiled the same way.
+ */
+static string codeGenKey(uint options)
+{
+    string key;
 
-    rc->getGlobalParameterPtr =
-            GetGlobalParameterCodeGen(context).createFunction();
+    if (options & LoadSBMLOptions::CONSERVED_MOIETIES)
+    {
+        key += "_conserved";
+    }
 
-    rc->evalRateRuleRatesPtr =
-            EvalRateRuleRatesCodeGen(context).createFunction();
+    if (options & LoadSBMLOptions::OPTIMIZE_LEVEL_3)
+    {
+        key += "_O3";
+    }
+    else if (options & LoadSBMLOptions::OPTIMIZE_LEVEL_2)
+    {
+        key += "_O2";
+    }
 
-    rc->getEventTriggerPtr =
-            GetEventTriggerCodeGen(context).createFunction();
+    if (options & LoadSBMLOptions::FAST_MATH)
+    {
+        key += "_fastmath";
+    }
 
-    rc->getEventPriorityPtr =
-            GetEventPriorityCodeGen(context).createFunction();
+    string cpu = rr::Config::getString(rr::Config::LLVM_TARGET_CPU);
+    if (cpu.size())
+    {
+        key += "_" + cpu;
+    }
 
-    rc->getEventDelayPtr =
-            GetEventDelayCodeGen(context).createFunction();
+    // piecewise tables are generated from this many pieces on.
+    std::stringstream pw;
+    pw << "_pw" << rr::Config::getInt(rr::Config::LLVM_PIECEWISE_TABLE_MIN_SIZE);
+    key += pw.str();
 
-    rc->eventTriggerPtr =
-            EventTriggerCodeGen(context).createFunction();
+    return key;
+}
 
-    rc->eventAssignPtr =
-            EventAssignCodeGen(context).createFunction();
+ExecutableModel* LLVMModelGenerator::createModel(const std::string& sbml,
+        uint options)
+{
+    bool forceReCompile = options & LoadSBMLOptions::RECOMPILE;
 
-    rc->evalVolatileStoichPtr =
-            EvalVolatileStoichCodeGen(context).createFunction();
+    string md5;
 
-    rc->evalConversionFactorPtr =
-            EvalConversionFactorCodeGen(context).createFunction();
+    // the structure hash, and the literal initial values of this sbml.
+    string structureHash;
+    std::vector<std::string> literalIds;
+    std::vector<double> literalValues;
 
-    if (options & LoadSBMLOptions::READ_ONLY)
-    {
-        rc->setBoundarySpeciesAmountPtr = 0;
-        rc->setBoundarySpeciesConcentrationPtr = 0;
-        rc->setFloatingSpeciesConcentrationPtr = 0;
-        rc->setCompartmentVolumePtr = 0;
-        rc->setFloatingSpeciesAmountPtr = 0;
-        rc->setGlobalParameterPtr = 0;
-    }
-    else
+    if (!forceReCompile)
     {
-        rc->setBoundarySpeciesAmountPtr = SetBoundarySpeciesAmountCodeGen(
-                context).createFunction();
+        // check for a chached copy, first of this exact sbml, this is only
+        // the hash of the text, so is cheap.
+        md5 = rr::getMD5(sbml) + codeGenKey(options);
+
+        // we could have recieved a bad ptr, a model could have been deleted,
+        // in which case, we should have a bad ptr.
+        SharedModelPtr sp = findCachedModel(md5);
+
+        if (sp)
+        {
+            Log(Logger::LOG_DEBUG) << "found a cached model for " << md5;
+            return new LLVMExecutableModel(sp, createModelData(*sp->symbols, sp->random));
+        }
 
-        rc->setBoundarySpeciesConcentrationPtr =
-                SetBoundarySpeciesConcentrationCodeGen(context).createFunction();
+        // then a model with the same structure, which only differs in the
+        // literal initial values.
+        structureHash = getStructureHash(sbml, literalIds, literalValues);
 
-        rc->setFloatingSpeciesConcentrationPtr =
-                SetFloatingSpeciesConcentrationCodeGen(context).createFunction();
+        if (structureHash.size())
+        {
+            structureHash += codeGenKey(options);
+            sp = findCachedModel(structureHash);
+        }
 
-        rc->setCompartmentVolumePtr =
-                SetCompartmentVolumeCodeGen(context).createFunction();
+        if (sp)
+        {
+            Log(Logger::LOG_DEBUG) << "found a cached model with the same "
+                    "structure for " << md5 << ", structure hash "
+                    << structureHash;
 
-        rc->setFloatingSpeciesAmountPtr = SetFloatingSpeciesAmountCodeGen(
-                context).createFunction();
+            // start from the values the cached model was created with, the
+            // conserved moiety conversion may have added elements.
+            std::vector<double> values = sp->symbols->getLiteralInitialValues();
 
-        rc->setGlobalParameterPtr =
-                SetGlobalParameterCodeGen(context).createFunction();
-    }
+            for (uint i = 0; i < literalIds.size(); ++i)
+            {
+                values[sp->symbols->getLiteralInitialValueIndex(literalIds[i])] =
+                        literalValues[i];
+            }
 
-    if (options & LoadSBMLOptions::MUTABLE_INITIAL_CONDITIONS)
-    {
-        rc->getFloatingSpeciesInitConcentrationsPtr =
-                GetFloatingSpeciesInitConcentrationCodeGen(context).createFunction();
-        rc->setFloatingSpeciesInitConcentrationsPtr =
-                SetFloatingSpeciesInitConcentrationCodeGen(context).createFunction();
-
-        rc->getFloatingSpeciesInitAmountsPtr =
-                GetFloatingSpeciesInitAmountCodeGen(context).createFunction();
-        rc->setFloatingSpeciesInitAmountsPtr =
-                SetFloatingSpeciesInitAmountCodeGen(context).createFunction();
-
-        rc->getCompartmentInitVolumesPtr =
-                GetCompartmentInitVolumeCodeGen(context).createFunction();
-        rc->setCompartmentInitVolumesPtr =
-                SetCompartmentInitVolumeCodeGen(context).createFunction();
-
-        rc->getGlobalParameterInitValuePtr =
-                GetGlobalParameterInitValueCodeGen(context).createFunction();
-        rc->setGlobalParameterInitValuePtr =
-                SetGlobalParameterInitValueCodeGen(context).createFunction();
+            return new LLVMExecutableModel(sp, createModelData(*sp->symbols,
+                    sp->random, &values));
+        }
+        else
+        {
+            Log(Logger::LOG_TRACE) << "no cached model found for " << md5
+                    << ", creating new one";
+
+            Poco::Mutex::ScopedLock lock(cachedModelsMutex);
+            ++cacheMisses;
+        }
     }
-    else
-    {
-        rc->getFloatingSpeciesInitConcentrationsPtr = 0;
-        rc->setFloatingSpeciesInitConcentrationsPtr = 0;
 
-        rc->getFloatingSpeciesInitAmountsPtr = 0;
-        rc->setFloatingSpeciesInitAmountsPtr = 0;
+    SharedModelPtr rc(new ModelResources());
 
-        rc->getCompartmentInitVolumesPtr = 0;
-        rc->setCompartmentInitVolumesPtr = 0;
+    ModelGeneratorContext context(sbml, options);
 
-        rc->getGlobalParameterInitValuePtr = 0;
-        rc->setGlobalParameterInitValuePtr = 0;
+    size_t codeSize = 0;
+
+    {
+        CodeSizeListener listener(context.getExecutionEngine());
+        CreateModelFunctions createFunctions(context, options);
+        visitModelFunctions(*rc, createFunctions);
+        codeSize = listener.size;
     }
 
 
@@ -261,6 +508,9 @@ ExecutableModel* LLVMModelGenerator::createModel(const std::string& sbml,
         throw_llvm_exception(s.str());
     }
 
+    rc->size = estimateModelSize(context.getModule(),
+            context.getModelDataSymbols(), codeSize);
+
     // * MOVE * the bits over from the context to the exe model.
     context.stealThePeach(&rc->symbols, &rc->context,
             &rc->executionEngine, &rc->random, &rc->errStr);
@@ -273,9 +523,9 @@ ExecutableModel* LLVMModelGenerator::createModel(const std::string& sbml,
 
         ModelPtrMap::const_iterator i;
 
-        SharedModelPtr sp;
+        std::vector<SharedModelPtr> evicted;
 
-        cachedModelsMutex.lock();
+        Poco::Mutex::ScopedLock lock(cachedModelsMutex);
 
         // whilst we have it locked, clear any expired ptrs
         for (ModelPtrMap::const_iterator j = cachedModels.begin();
@@ -303,7 +553,13 @@ ExecutableModel* LLVMModelGenerator::createModel(const std::string& sbml,
             cachedModels[md5] = rc;
         }
 
-        cachedModelsMutex.unlock();
+        if (structureHash.size() &&
+                cachedModels.find(structureHash) == cachedModels.end())
+        {
+            cachedModels[structureHash] = rc;
+        }
+
+        touchRecentModel(rc, evicted);
     }
 
     return new LLVMExecutableModel(rc, modelData);
@@ -325,7 +581,7 @@ std::string to_string(const llvm::Value *value)
 }
 
 LLVMModelData *createModelData(const rrllvm::LLVMModelDataSymbols &symbols,
-        const Random *random)
+        const Random *random, const std::vector<double>* literalInitialValues)
 {
     uint modelDataBaseSize = sizeof(LLVMModelData);
 
@@ -339,26 +595,77 @@ LLVMModelData *createModelData(const rrllvm::LLVMModelDataSymbols &symbols,
     uint numInitBoundarySpecies = symbols.getInitBoundarySpeciesSize();
     uint numInitGlobalParameters = symbols.getInitGlobalParameterSize();
 
+    uint numLiteralInitialValues = symbols.getLiteralInitialValueSize();
+
+    if (!literalInitialValues)
+    {
+        literalInitialValues = &symbols.getLiteralInitialValues();
+    }
+
+    assert(literalInitialValues->size() == numLiteralInitialValues &&
+            "wrong number of literal initial values");
+
     // no initial conditions for these
     uint numRateRules = symbols.getRateRuleSize();
     uint numReactions = symbols.getReactionSize();
 
-    uint modelDataSize = modelDataBaseSize +
-        sizeof(double) * (
-            numIndCompartments +
-            numInitCompartments +
-            numInitFloatingSpecies +
-            numIndBoundarySpecies +
-            numInitBoundarySpecies +
-            numIndGlobalParameters +
-            numInitGlobalParameters +
-            numReactions +
-            numRateRules +
-            numIndFloatingSpecies
-            );
-
-    LLVMModelData *modelData = (LLVMModelData*)calloc(
-            modelDataSize, sizeof(unsigned char));
+    // data section arrays, in order, hot first. This must be the same
+    // layout as ModelDataIRBuilder::createModelDataStructType. The arena is
+    // cache line aligned, and on 64 bit platforms the struct header is
+    // exactly three lines, so each padded array starts on its own line.
+    uint lengths[] = {
+        numRateRules,
+        numIndFloatingSpecies,
+        numReactions,
+        numIndCompartments,
+        numIndBoundarySpecies,
+        numIndGlobalParameters,
+        numInitCompartments,
+        numInitFloatingSpecies,
+        numInitBoundarySpecies,
+        numInitGlobalParameters,
+        numLiteralInitialValues
+    };
+
+    const uint numArrays = sizeof(lengths) / sizeof(lengths[0]);
+
+    uint dataLength = 0;
+    for (uint i = 0; i < numArrays; ++i)
+    {
+        dataLength += LLVMModelData_paddedLength(lengths[i]);
+    }
+
+    uint modelDataSize = modelDataBaseSize + sizeof(double) * dataLength;
+
+    // the stoichiometry matrix and the random engine are copied into the
+    // same arena, each on its own cache line.
+    const std::vector<uint> &stoichRowIndx = symbols.getStoichRowIndx();
+    const std::vector<uint> &stoichColIndx = symbols.getStoichColIndx();
+    std::vector<double> stoichValues(stoichRowIndx.size(), 0);
+
+    rr::csr_matrix *stoichiometry = rr::csr_matrix_new(numIndFloatingSpecies,
+            numReactions, stoichRowIndx, stoichColIndx, stoichValues);
+
+    const size_t align = LLVMModelData_Alignment;
+    size_t stoichOffset = (modelDataSize + align - 1) / align * align;
+    size_t randomOffset = (stoichOffset + rr::csr_matrix_bytes(stoichiometry)
+            + align - 1) / align * align;
+    size_t arenaSize = random ? (randomOffset + sizeof(Random) + align - 1)
+            / align * align : randomOffset;
+
+    char *arena = 0;
+
+    try
+    {
+        arena = (char*)LLVMModelData_allocArena(arenaSize);
+    }
+    catch(...)
+    {
+        rr::csr_matrix_delete(stoichiometry);
+        throw;
+    }
+
+    LLVMModelData *modelData = (LLVMModelData*)arena;
 
     modelData->size = modelDataSize;
     modelData->numIndCompartments = numIndCompartments;
@@ -369,58 +676,52 @@ LLVMModelData *createModelData(const rrllvm::LLVMModelDataSymbols &symbols,
     modelData->numInitCompartments = numInitCompartments;
     modelData->numInitFloatingSpecies = numInitFloatingSpecies;
     modelData->numInitBoundarySpecies = numInitBoundarySpecies;
-    modelData->numInitBoundarySpecies = numInitGlobalParameters;
+    modelData->numInitGlobalParameters = numInitGlobalParameters;
 
     modelData->numRateRules = numRateRules;
     modelData->numReactions = numReactions;
     modelData->numEvents = symbols.getEventAttributes().size();
 
-    // set the aliases to the offsets
-    uint offset = 0;
-
-    modelData->compartmentVolumesAlias = &modelData->data[offset];
-    offset += numIndCompartments;
-
-    modelData->initCompartmentVolumesAlias = &modelData->data[offset];
-    offset += numInitCompartments;
-
-    modelData->initFloatingSpeciesAmountsAlias = &modelData->data[offset];
-    offset += numInitFloatingSpecies;
-
-    modelData->boundarySpeciesAmountsAlias = &modelData->data[offset];
-    offset += numIndBoundarySpecies;
+    // set the aliases to the offsets, the literal initial values have no
+    // alias, they are only read by the generated code.
+    double *literals = 0;
+    double **aliases[] = {
+        &modelData->rateRuleValuesAlias,
+        &modelData->floatingSpeciesAmountsAlias,
+        &modelData->reactionRatesAlias,
+        &modelData->compartmentVolumesAlias,
+        &modelData->boundarySpeciesAmountsAlias,
+        &modelData->globalParametersAlias,
+        &modelData->initCompartmentVolumesAlias,
+        &modelData->initFloatingSpeciesAmountsAlias,
+        &modelData->initBoundarySpeciesAmountsAlias,
+        &modelData->initGlobalParametersAlias,
+        &literals
+    };
 
-    modelData->initBoundarySpeciesAmountsAlias = &modelData->data[offset];
-    offset += numInitBoundarySpecies;
-
-    modelData->globalParametersAlias = &modelData->data[offset];
-    offset += numIndGlobalParameters;
-
-    modelData->initGlobalParametersAlias = &modelData->data[offset];
-    offset += numInitGlobalParameters;
-
-    modelData->reactionRatesAlias = &modelData->data[offset];
-    offset += numReactions;
-
-    modelData->rateRuleValuesAlias = &modelData->data[offset];
-    offset += numRateRules;
+    uint offset = 0;
 
-    modelData->floatingSpeciesAmountsAlias = &modelData->data[offset];
-    offset += numIndFloatingSpecies;
+    for (uint i = 0; i < numArrays; ++i)
+    {
+        *aliases[i] = &modelData->data[offset];
+        offset += LLVMModelData_paddedLength(lengths[i]);
+    }
 
     assert (modelDataBaseSize + offset * sizeof(double) == modelDataSize  &&
             "LLVMModelData size not equal to base size + data");
 
-    // allocate the stoichiometry matrix
-    const std::vector<uint> &stoichRowIndx = symbols.getStoichRowIndx();
-    const std::vector<uint> &stoichColIndx = symbols.getStoichColIndx();
-    std::vector<double> stoichValues(stoichRowIndx.size(), 0);
+    if (numLiteralInitialValues)
+    {
+        std::copy(literalInitialValues->begin(), literalInitialValues->end(),
+                literals);
+    }
 
-    modelData->stoichiometry = rr::csr_matrix_new(numIndFloatingSpecies, numReactions,
-            stoichRowIndx, stoichColIndx, stoichValues);
+    modelData->stoichiometry = rr::csr_matrix_copy_to(stoichiometry,
+            arena + stoichOffset);
+    rr::csr_matrix_delete(stoichiometry);
 
     // make a copy of the random object
-    modelData->random = random ? new Random(*random) : 0;
+    modelData->random = random ? new (arena + randomOffset) Random(*random) : 0;
 
     return modelData;
 }
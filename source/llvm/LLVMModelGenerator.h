@@ -36,6 +36,17 @@ public:
      */
     static rr::ExecutableModel *createModel(const std::string& sbml, uint options);
 
+    /**
+     * fill a dictionary with the statistics of the compiled model cache,
+     * see ExecutableModelFactory::getModelCacheStatistics.
+     */
+    static void getCacheStatistics(rr::Dictionary& stats);
+
+    /**
+     * release the strong references to the recently used models.
+     */
+    static void clearCache();
+
 };
 
 } /* namespace rr */
@@ -58,7 +58,7 @@ LLVMModelSymbols::LLVMModelSymbols(const libsbml::Model *m, LLVMModelDataSymbols
 
         if (param->isSetValue())
         {
-            value->setValue(param->getValue());
+            setLiteralInitialValue(value, param->getId(), param->getValue());
         }
         else
         {
@@ -107,7 +107,7 @@ bool LLVMModelSymbols::visit(const libsbml::Compartment& x)
     ASTNode *node = nodes.create(AST_REAL);
     if (x.isSetVolume())
     {
-        node->setValue(x.getVolume());
+        setLiteralInitialValue(node, x.getId(), x.getVolume());
     } else
     {
         string compid = x.getId();
@@ -320,7 +320,8 @@ void LLVMModelSymbols::processSpecies(SymbolForest &currentSymbols,
                 // need to convert conc to amount,
                 // these two nodes are owned by the parent
                 ASTNode *conc = new ASTNode(AST_REAL);
-                conc->setValue(species->getInitialConcentration());
+                setLiteralInitialValue(conc, species->getId(),
+                        species->getInitialConcentration());
                 ASTNode *comp = new ASTNode(AST_NAME);
                 comp->setName(species->getCompartment().c_str());
 
@@ -333,7 +334,8 @@ void LLVMModelSymbols::processSpecies(SymbolForest &currentSymbols,
             {
                 // we got an amount, all good
                 ASTNode *amt = nodes.create(AST_REAL);
-                amt->setValue(species->getInitialAmount());
+                setLiteralInitialValue(amt, species->getId(),
+                        species->getInitialAmount());
                 math = amt;
             }
             else
@@ -361,7 +363,8 @@ void LLVMModelSymbols::processSpecies(SymbolForest &currentSymbols,
             {
                 // we got an conc, all good
                 ASTNode *conc = nodes.create(AST_REAL);
-                conc->setValue(species->getInitialConcentration());
+                setLiteralInitialValue(conc, species->getId(),
+                        species->getInitialConcentration());
                 math = conc;
             }
             else if (species->isSetInitialAmount())
@@ -369,7 +372,8 @@ void LLVMModelSymbols::processSpecies(SymbolForest &currentSymbols,
                 // need to convert amt to concentraion,
                 // these two nodes are owned by the parent
                 ASTNode *amt = new ASTNode(AST_REAL);
-                amt->setValue(species->getInitialAmount());
+                setLiteralInitialValue(amt, species->getId(),
+                        species->getInitialAmount());
                 ASTNode *comp = new ASTNode(AST_NAME);
                 comp->setName(species->getCompartment().c_str());
 
@@ -409,6 +413,20 @@ void LLVMModelSymbols::processSpecies(SymbolForest &currentSymbols,
     }
 }
 
+void LLVMModelSymbols::setLiteralInitialValue(ASTNode *node,
+        const std::string& id, double value)
+{
+    if (symbols.hasLiteralInitialValue(id))
+    {
+        node->setType(AST_NAME);
+        node->setName((SBML_LITERAL_SYMBOL_PREFIX + id).c_str());
+    }
+    else
+    {
+        node->setValue(value);
+    }
+}
+
 const ASTNode* LLVMModelSymbols::getSpeciesReferenceStoichMath(
         const libsbml::SpeciesReference* reference)
 {
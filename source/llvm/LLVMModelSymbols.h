@@ -189,6 +189,14 @@ protected:
      */
     const libsbml::ASTNode *getSpeciesReferenceStoichMath(const libsbml::SpeciesReference *reference);
 
+    /**
+     * set a node to the literal initial value of an element. If the data
+     * symbols have a slot for it, the node becomes a name which loads the
+     * value from the model data, otherwise it is the number itself.
+     */
+    void setLiteralInitialValue(libsbml::ASTNode *node, const std::string& id,
+            double value);
+
     SymbolForest initialValues;
 
     SymbolForest assigmentRules;
@@ -65,20 +65,29 @@ static bool isArray(ModelDataFields f)
 {
     /* arrays are the last elements in the model data struct */
     /*
-     CompartmentVolumes,                       // 28
-     CompartmentVolumesInit,                   // 29
-     FloatingSpeciesAmounts,                   // 30
-     FloatingSpeciesAmountsInit,               // 31
-     ConservedSpeciesAmountsInit,              // 32
-     BoundarySpeciesAmounts,                   // 33
-     BoundarySpeciesAmountsInit,               // 34
-     GlobalParameters,                         // 35
-     GlobalParametersInit,                     // 36
-     RateRuleValues,                           // 37
-     ReactionRates,                            // 38
+     NotSafe_RateRuleValues,                   // 31
+     NotSafe_FloatingSpeciesAmounts,           // 32
+     ReactionRates,                            // 33
+     CompartmentVolumes,                       // 34
+     BoundarySpeciesAmounts,                   // 35
+     GlobalParameters,                         // 36
+     InitCompartmentVolumes,                   // 37
+     InitFloatingSpeciesAmounts,               // 38
+     InitBoundarySpeciesAmounts,               // 39
+     InitGlobalParameters,                     // 40
+     LiteralInitialValues,                     // 41
      */
 
-    return f >= CompartmentVolumes && f <= NotSafe_FloatingSpeciesAmounts;
+    return f >= NotSafe_RateRuleValues && f <= LiteralInitialValues;
+}
+
+/**
+ * array type for a data section array of n doubles, including the padding
+ * to the next cache line.
+ */
+static llvm::ArrayType *paddedArrayType(llvm::Type *elementType, unsigned n)
+{
+    return llvm::ArrayType::get(elementType, LLVMModelData_paddedLength(n));
 }
 
 
@@ -495,6 +504,15 @@ llvm::Value* ModelDataIRBuilder::createInitGlobalParamStore(
     return builder.CreateStore(value, gep);
 }
 
+llvm::Value* ModelDataIRBuilder::createLiteralInitialValueLoad(
+        const std::string& id, const llvm::Twine& name)
+{
+    uint index = symbols.getLiteralInitialValueIndex(id);
+    assert(index < symbols.getLiteralInitialValueSize());
+    return createLoad(LiteralInitialValues, index,
+            name.isTriviallyEmpty() ? id : name);
+}
+
 llvm::Value* ModelDataIRBuilder::createReactionRateLoad(const std::string& id, const llvm::Twine& name)
 {
     int idx = symbols.getReactionIndex(id);
@@ -581,6 +599,8 @@ llvm::StructType *ModelDataIRBuilder::createModelDataStructType(llvm::Module *mo
         uint numInitBoundarySpecies = symbols.getInitBoundarySpeciesSize();
         uint numInitGlobalParameters = symbols.getInitGlobalParameterSize();
 
+        uint numLiteralInitialValues = symbols.getLiteralInitialValueSize();
+
         // no initial conditions for these
         uint numRateRules = symbols.getRateRuleSize();
         uint numReactions = symbols.getReactionSize();
@@ -638,16 +658,19 @@ llvm::StructType *ModelDataIRBuilder::createModelDataStructType(llvm::Module *mo
         elements.push_back(doublePtrType);    // 29     double*                  rateRuleValuesAlias
         elements.push_back(doublePtrType);    // 30     double*                  floatingSpeciesAmountsAlias
 
-        elements.push_back(ArrayType::get(doubleType, numIndCompartments));     // 31 CompartmentVolumes
-        elements.push_back(ArrayType::get(doubleType, numInitCompartments));    // 32 initCompartmentVolumes
-        elements.push_back(ArrayType::get(doubleType, numInitFloatingSpecies)); // 33 initFloatingSpeciesAmounts
-        elements.push_back(ArrayType::get(doubleType, numIndBoundarySpecies));  // 34 boundarySpeciesAmounts
-        elements.push_back(ArrayType::get(doubleType, numInitBoundarySpecies)); // 35 initBoundarySpeciesAmounts
-        elements.push_back(ArrayType::get(doubleType, numIndGlobalParameters)); // 36 globalParameters
-        elements.push_back(ArrayType::get(doubleType, numInitGlobalParameters));// 37 initGlobalParameters
-        elements.push_back(ArrayType::get(doubleType, numReactions));           // 38 reactionRates
-        elements.push_back(ArrayType::get(doubleType, numRateRules));           // 39 rateRuleValues
-        elements.push_back(ArrayType::get(doubleType, numIndFloatingSpecies));  // 40 floatingSpeciesAmounts
+        // data section, hot first, each array is padded to a whole number
+        // of cache lines, same as createModelData.
+        elements.push_back(paddedArrayType(doubleType, numRateRules));           // 31 rateRuleValues
+        elements.push_back(paddedArrayType(doubleType, numIndFloatingSpecies));  // 32 floatingSpeciesAmounts
+        elements.push_back(paddedArrayType(doubleType, numReactions));           // 33 reactionRates
+        elements.push_back(paddedArrayType(doubleType, numIndCompartments));     // 34 CompartmentVolumes
+        elements.push_back(paddedArrayType(doubleType, numIndBoundarySpecies));  // 35 boundarySpeciesAmounts
+        elements.push_back(paddedArrayType(doubleType, numIndGlobalParameters)); // 36 globalParameters
+        elements.push_back(paddedArrayType(doubleType, numInitCompartments));    // 37 initCompartmentVolumes
+        elements.push_back(paddedArrayType(doubleType, numInitFloatingSpecies)); // 38 initFloatingSpeciesAmounts
+        elements.push_back(paddedArrayType(doubleType, numInitBoundarySpecies)); // 39 initBoundarySpeciesAmounts
+        elements.push_back(paddedArrayType(doubleType, numInitGlobalParameters));// 40 initGlobalParameters
+        elements.push_back(paddedArrayType(doubleType, numLiteralInitialValues));// 41 literalInitialValues
 
         // creates a named struct,
         // the act of creating a named struct should
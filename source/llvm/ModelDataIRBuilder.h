@@ -134,6 +134,13 @@ public:
     llvm::Value *createInitGlobalParamStore(const std::string &id,
             llvm::Value *value);
 
+    /**
+     * load the literal initial value of an element, the number given in
+     * the sbml.
+     */
+    llvm::Value *createLiteralInitialValueLoad(const std::string& id,
+            const llvm::Twine& name ="");
+
     /**
      * load the global param value
      */
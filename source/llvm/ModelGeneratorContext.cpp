@@ -75,6 +75,110 @@ double atanh(double value)
 
 #endif
 
+/**
+ * the target CPU and code generator options of the execution engine, from
+ * Config::LLVM_TARGET_CPU and the load options.
+ */
+static void setTargetOptions(EngineBuilder &engineBuilder, unsigned options)
+{
+    string cpu = Config::getString(Config::LLVM_TARGET_CPU);
+
+    if (cpu == "host")
+    {
+        cpu = sys::getHostCPUName();
+
+        // the cpu name implies its features, but it may be one LLVM does
+        // not know about, or a virtual machine may have some disabled.
+        StringMap<bool> features;
+        if (sys::getHostCPUFeatures(features))
+        {
+            vector<string> attrs;
+            for (StringMap<bool>::const_iterator i = features.begin();
+                    i != features.end(); ++i)
+            {
+                attrs.push_back((i->second ? "+" : "-") + i->getKey().str());
+            }
+            engineBuilder.setMAttrs(attrs);
+        }
+    }
+
+    if (cpu.size())
+    {
+        Log(Logger::LOG_INFORMATION) << "generating code for cpu " << cpu;
+        engineBuilder.setMCPU(cpu);
+    }
+
+    if (options & LoadSBMLOptions::OPTIMIZE_LEVEL_3)
+    {
+        engineBuilder.setOptLevel(CodeGenOpt::Aggressive);
+    }
+
+#if (LLVM_VERSION_MAJOR == 3) && (LLVM_VERSION_MINOR >= 2)
+    if (options & LoadSBMLOptions::FAST_MATH)
+    {
+        // fused multiply adds are formed by the code generator, the rest of
+        // fast math is the IR flags on the kinetic code.
+        TargetOptions targetOptions;
+        targetOptions.AllowFPOpFusion = FPOpFusion::Fast;
+        engineBuilder.setTargetOptions(targetOptions);
+    }
+#endif
+}
+
+/**
+ * the function level part of the standard -O2 and -O3 pipelines, as
+ * PassManagerBuilder sets them up, the levels differ in the code generator
+ * optimization level. The generated functions are compiled one
+ * at a time as they are created, so the interprocedural passes would have
+ * nothing to work on.
+ */
+static void addStandardFunctionPasses(FunctionPassManager *fpm)
+{
+    fpm->add(createTypeBasedAliasAnalysisPass());
+    fpm->add(createBasicAliasAnalysisPass());
+
+#if (LLVM_VERSION_MAJOR == 3) && (LLVM_VERSION_MINOR >= 2)
+    fpm->add(createSROAPass());
+#else
+    fpm->add(createScalarReplAggregatesPass());
+#endif
+    fpm->add(createEarlyCSEPass());
+    fpm->add(createInstructionCombiningPass());
+    fpm->add(createJumpThreadingPass());
+    fpm->add(createCorrelatedValuePropagationPass());
+    fpm->add(createCFGSimplificationPass());
+    fpm->add(createInstructionCombiningPass());
+    fpm->add(createReassociatePass());
+
+    fpm->add(createLoopRotatePass());
+    fpm->add(createLICMPass());
+    fpm->add(createLoopUnswitchPass());
+    fpm->add(createInstructionCombiningPass());
+    fpm->add(createIndVarSimplifyPass());
+    fpm->add(createLoopIdiomPass());
+    fpm->add(createLoopDeletionPass());
+    fpm->add(createLoopUnrollPass());
+
+    fpm->add(createGVNPass());
+    fpm->add(createMemCpyOptPass());
+    fpm->add(createSCCPPass());
+    fpm->add(createInstructionCombiningPass());
+    fpm->add(createJumpThreadingPass());
+    fpm->add(createCorrelatedValuePropagationPass());
+    fpm->add(createDeadStoreEliminationPass());
+
+#if (LLVM_VERSION_MAJOR == 3) && (LLVM_VERSION_MINOR >= 3)
+    // the kinetic laws are long straight line code, which is where the SLP
+    // vectorizer finds its work, the loops are the table lookups.
+    fpm->add(createLoopVectorizePass());
+    fpm->add(createSLPVectorizerPass());
+#endif
+
+    fpm->add(createAggressiveDCEPass());
+    fpm->add(createCFGSimplificationPass());
+    fpm->add(createInstructionCombiningPass());
+}
+
 ModelGeneratorContext::ModelGeneratorContext(std::string const &sbml,
     unsigned options) :
         ownedDoc(0),
@@ -163,6 +267,7 @@ ModelGeneratorContext::ModelGeneratorContext(std::string const &sbml,
         EngineBuilder engineBuilder(module);
 
         engineBuilder.setErrorStr(errString);
+        setTargetOptions(engineBuilder, options);
         executionEngine = engineBuilder.create();
 
         addGlobalMappings();
@@ -276,6 +381,7 @@ ModelGeneratorContext::ModelGeneratorContext(libsbml::SBMLDocument const *doc,
 
         //engineBuilder.setEngineKind(EngineKind::JIT);
         engineBuilder.setErrorStr(errString);
+        setTargetOptions(engineBuilder, options);
         executionEngine = engineBuilder.create();
 
         addGlobalMappings();
@@ -440,7 +546,10 @@ llvm::FunctionPassManager* ModelGeneratorContext::getFunctionPassManager() const
 
 void ModelGeneratorContext::initFunctionPassManager()
 {
-    if (options & LoadSBMLOptions::OPTIMIZE)
+    const unsigned preset = LoadSBMLOptions::OPTIMIZE_LEVEL_2 |
+            LoadSBMLOptions::OPTIMIZE_LEVEL_3;
+
+    if (options & (LoadSBMLOptions::OPTIMIZE | preset))
     {
         functionPassManager = new FunctionPassManager(module);
 
@@ -458,6 +567,16 @@ void ModelGeneratorContext::initFunctionPassManager()
     functionPassManager->add(new DataLayoutPass(module));
 #endif
 
+        if (options & preset)
+        {
+            Log(Logger::LOG_INFORMATION) << "using the -O"
+                    << (options & LoadSBMLOptions::OPTIMIZE_LEVEL_3 ? 3 : 2)
+                    << " function passes";
+            addStandardFunctionPasses(functionPassManager);
+            functionPassManager->doInitialization();
+            return;
+        }
+
          // Provide basic AliasAnalysis support for GVN.
         functionPassManager->add(createBasicAliasAnalysisPass());
 
@@ -520,139 +639,166 @@ static void dispChar(char c) {
 
 /*************************************************************************************/
 
-void ModelGeneratorContext::addGlobalMappings()
+/**
+ * the signature of a runtime support function.
+ */
+enum SupportFunctionType
 {
-    LLVMContext& context = module->getContext();
-    Type *double_type = Type::getDoubleTy(context);
-    Type *int_type = Type::getInt32Ty(context);
-    Type* args_i1[] = { int_type };
-    Type* args_d1[] = { double_type };
-    Type* args_d2[] = { double_type, double_type };
+    /**
+     * double f(double)
+     */
+    SUPPORT_D1,
+
+    /**
+     * double f(double, double)
+     */
+    SUPPORT_D2,
+
+    /**
+     * int f(int)
+     */
+    SUPPORT_I1,
+
+    /**
+     * declared by the IR builder, with the declare function.
+     */
+    SUPPORT_DECL
+};
+
+struct SupportFunction
+{
+    const char* name;
+    void* address;
+    SupportFunctionType type;
+    llvm::Function* (*declare)(llvm::Module*);
+};
 
-    executionEngine->addGlobalMapping(ModelDataIRBuilder::getCSRMatrixSetNZDecl(module), (void*)rr::csr_matrix_set_nz);
-    executionEngine->addGlobalMapping(ModelDataIRBuilder::getCSRMatrixGetNZDecl(module), (void*)rr::csr_matrix_get_nz);
-    executionEngine->addGlobalMapping(LLVMModelDataIRBuilderTesting::getDispIntDecl(module), (void*)dispInt);
-    executionEngine->addGlobalMapping(LLVMModelDataIRBuilderTesting::getDispDoubleDecl(module), (void*)dispDouble);
-    executionEngine->addGlobalMapping(LLVMModelDataIRBuilderTesting::getDispCharDecl(module), (void*)dispChar);
+/**
+ * The runtime support functions which the generated code calls by name.
+ * JIT models get a global mapping for each of them in addGlobalMappings,
+ * exported models bind them by name with getSupportFunctionAddress.
+ */
+static const SupportFunction supportFunctions[] = {
+    { ModelDataIRBuilder::csr_matrix_set_nzName, (void*)rr::csr_matrix_set_nz,
+            SUPPORT_DECL, ModelDataIRBuilder::getCSRMatrixSetNZDecl },
+    { ModelDataIRBuilder::csr_matrix_get_nzName, (void*)rr::csr_matrix_get_nz,
+            SUPPORT_DECL, ModelDataIRBuilder::getCSRMatrixGetNZDecl },
+    { "dispInt",            (void*)dispInt,
+            SUPPORT_DECL, LLVMModelDataIRBuilderTesting::getDispIntDecl },
+    { "dispDouble",         (void*)dispDouble,
+            SUPPORT_DECL, LLVMModelDataIRBuilderTesting::getDispDoubleDecl },
+    { "dispChar",           (void*)dispChar,
+            SUPPORT_DECL, LLVMModelDataIRBuilderTesting::getDispCharDecl },
 
     // AST_FUNCTION_ARCCOT:
-    executionEngine->addGlobalMapping(
-            createGlobalMappingFunction("arccot",
-                    FunctionType::get(double_type, args_d1, false), module),
-                        (void*) sbmlsupport::arccot);
-
-    executionEngine->addGlobalMapping(
-            createGlobalMappingFunction("rr_arccot_negzero",
-                    FunctionType::get(double_type, args_d1, false), module),
-                        (void*) sbmlsupport::arccot_negzero);
+    { "arccot",             (void*)sbmlsupport::arccot,         SUPPORT_D1, 0 },
+    { "rr_arccot_negzero",  (void*)sbmlsupport::arccot_negzero, SUPPORT_D1, 0 },
 
     // AST_FUNCTION_ARCCOTH:
-    executionEngine->addGlobalMapping(
-            createGlobalMappingFunction("arccoth",
-                    FunctionType::get(double_type, args_d1, false), module),
-                        (void*) sbmlsupport::arccoth);
+    { "arccoth",            (void*)sbmlsupport::arccoth,        SUPPORT_D1, 0 },
 
     // AST_FUNCTION_ARCCSC:
-    executionEngine->addGlobalMapping(
-            createGlobalMappingFunction("arccsc",
-                    FunctionType::get(double_type, args_d1, false), module),
-                        (void*) sbmlsupport::arccsc);
+    { "arccsc",             (void*)sbmlsupport::arccsc,         SUPPORT_D1, 0 },
 
     // AST_FUNCTION_ARCCSCH:
-    executionEngine->addGlobalMapping(
-            createGlobalMappingFunction("arccsch",
-                    FunctionType::get(double_type, args_d1, false), module),
-                        (void*) sbmlsupport::arccsch);
+    { "arccsch",            (void*)sbmlsupport::arccsch,        SUPPORT_D1, 0 },
 
     // AST_FUNCTION_ARCSEC:
-    executionEngine->addGlobalMapping(
-            createGlobalMappingFunction("arcsec",
-                    FunctionType::get(double_type, args_d1, false), module),
-                        (void*) sbmlsupport::arcsec);
+    { "arcsec",             (void*)sbmlsupport::arcsec,         SUPPORT_D1, 0 },
 
     // AST_FUNCTION_ARCSECH:
-    executionEngine->addGlobalMapping(
-            createGlobalMappingFunction("arcsech",
-                    FunctionType::get(double_type, args_d1, false), module),
-                        (void*) sbmlsupport::arcsech);
+    { "arcsech",            (void*)sbmlsupport::arcsech,        SUPPORT_D1, 0 },
 
     // AST_FUNCTION_COT:
-    executionEngine->addGlobalMapping(
-            createGlobalMappingFunction("cot",
-                    FunctionType::get(double_type, args_d1, false), module),
-                        (void*) sbmlsupport::cot);
+    { "cot",                (void*)sbmlsupport::cot,            SUPPORT_D1, 0 },
 
     // AST_FUNCTION_COTH:
-    executionEngine->addGlobalMapping(
-            createGlobalMappingFunction("coth",
-                    FunctionType::get(double_type, args_d1, false), module),
-                        (void*) sbmlsupport::coth);
+    { "coth",               (void*)sbmlsupport::coth,           SUPPORT_D1, 0 },
 
     // AST_FUNCTION_CSC:
-    executionEngine->addGlobalMapping(
-            createGlobalMappingFunction("csc",
-                    FunctionType::get(double_type, args_d1, false), module),
-                        (void*) sbmlsupport::csc);
+    { "csc",                (void*)sbmlsupport::csc,            SUPPORT_D1, 0 },
 
     // AST_FUNCTION_CSCH:
-    executionEngine->addGlobalMapping(
-            createGlobalMappingFunction("csch",
-                    FunctionType::get(double_type, args_d1, false), module),
-                        (void*) sbmlsupport::csch);
+    { "csch",               (void*)sbmlsupport::csch,           SUPPORT_D1, 0 },
 
     // AST_FUNCTION_FACTORIAL:
-    executionEngine->addGlobalMapping(
-            createGlobalMappingFunction("rr_factoriali",
-                    FunctionType::get(int_type, args_i1, false), module),
-                        (void*) sbmlsupport::factoriali);
-
-    executionEngine->addGlobalMapping(
-            createGlobalMappingFunction("rr_factoriald",
-                    FunctionType::get(double_type, args_d1, false), module),
-                        (void*) sbmlsupport::factoriald);
+    { "rr_factoriali",      (void*)sbmlsupport::factoriali,     SUPPORT_I1, 0 },
+    { "rr_factoriald",      (void*)sbmlsupport::factoriald,     SUPPORT_D1, 0 },
 
     // case AST_FUNCTION_LOG:
-    executionEngine->addGlobalMapping(
-            createGlobalMappingFunction("rr_logd",
-                    FunctionType::get(double_type, args_d2, false), module),
-                        (void*) sbmlsupport::logd);
+    { "rr_logd",            (void*)sbmlsupport::logd,           SUPPORT_D2, 0 },
 
     // AST_FUNCTION_ROOT:
-    executionEngine->addGlobalMapping(
-            createGlobalMappingFunction("rr_rootd",
-                    FunctionType::get(double_type, args_d2, false), module),
-                        (void*) sbmlsupport::rootd);
+    { "rr_rootd",           (void*)sbmlsupport::rootd,          SUPPORT_D2, 0 },
 
     // AST_FUNCTION_SEC:
-    executionEngine->addGlobalMapping(
-            createGlobalMappingFunction("sec",
-                    FunctionType::get(double_type, args_d1, false), module),
-                        (void*) sbmlsupport::sec);
+    { "sec",                (void*)sbmlsupport::sec,            SUPPORT_D1, 0 },
 
     // AST_FUNCTION_SECH:
-    executionEngine->addGlobalMapping(
-            createGlobalMappingFunction("sech",
-                    FunctionType::get(double_type, args_d1, false), module),
-                        (void*) sbmlsupport::sech);
+    { "sech",               (void*)sbmlsupport::sech,           SUPPORT_D1, 0 },
 
     // AST_FUNCTION_ARCCOSH:
-    executionEngine->addGlobalMapping(
-            createGlobalMappingFunction("arccosh",
-                    FunctionType::get(double_type, args_d1, false), module),
-                        (void*)static_cast<double (*)(double)>(acosh));
+    { "arccosh",  (void*)static_cast<double (*)(double)>(acosh), SUPPORT_D1, 0 },
 
     // AST_FUNCTION_ARCSINH:
-    executionEngine->addGlobalMapping(
-            createGlobalMappingFunction("arcsinh",
-                    FunctionType::get(double_type, args_d1, false), module),
-                        (void*)static_cast<double (*)(double)>(asinh));
+    { "arcsinh",  (void*)static_cast<double (*)(double)>(asinh), SUPPORT_D1, 0 },
 
     // AST_FUNCTION_ARCTANH:
-    executionEngine->addGlobalMapping(
-            createGlobalMappingFunction("arctanh",
-                    FunctionType::get(double_type, args_d1, false), module),
-                        (void*)static_cast<double (*)(double)>(atanh));
+    { "arctanh",  (void*)static_cast<double (*)(double)>(atanh), SUPPORT_D1, 0 }
+};
+
+static const unsigned numSupportFunctions =
+        sizeof(supportFunctions) / sizeof(SupportFunction);
+
+void ModelGeneratorContext::addGlobalMappings()
+{
+    LLVMContext& context = module->getContext();
+    Type *double_type = Type::getDoubleTy(context);
+    Type *int_type = Type::getInt32Ty(context);
+    Type* args_i1[] = { int_type };
+    Type* args_d1[] = { double_type };
+    Type* args_d2[] = { double_type, double_type };
+
+    for (unsigned i = 0; i < numSupportFunctions; ++i)
+    {
+        const SupportFunction& f = supportFunctions[i];
+        Function *decl = 0;
+
+        switch (f.type)
+        {
+        case SUPPORT_D1:
+            decl = createGlobalMappingFunction(f.name,
+                    FunctionType::get(double_type, args_d1, false), module);
+            break;
+        case SUPPORT_D2:
+            decl = createGlobalMappingFunction(f.name,
+                    FunctionType::get(double_type, args_d2, false), module);
+            break;
+        case SUPPORT_I1:
+            decl = createGlobalMappingFunction(f.name,
+                    FunctionType::get(int_type, args_i1, false), module);
+            break;
+        case SUPPORT_DECL:
+            decl = f.declare(module);
+            break;
+        }
+
+        executionEngine->addGlobalMapping(decl, f.address);
+    }
+}
+
+void* getSupportFunctionAddress(const std::string& name)
+{
+    for (unsigned i = 0; i < numSupportFunctions; ++i)
+    {
+        if (name == supportFunctions[i].name)
+        {
+            return supportFunctions[i].address;
+        }
+    }
 
+    // distrib functions are mapped by the Random object
+    return Random::getDistribFunctionAddress(name);
 }
 
 static void createLibraryFunctions(Module* module)
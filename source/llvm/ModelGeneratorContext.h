@@ -235,8 +235,28 @@ private:
 };
 
 
+/**
+ * allocate a new model data for the given symbols.
+ *
+ * @param literalInitialValues: the literal initial values evalInitialConditions
+ * starts from, in the order of the symbols. NULL uses the values from the sbml
+ * the symbols were created from.
+ */
 LLVMModelData *createModelData(const rrllvm::LLVMModelDataSymbols &symbols,
-        const Random* random);
+        const Random* random,
+        const std::vector<double>* literalInitialValues = 0);
+
+/**
+ * get the address of a runtime support function which the generated code
+ * calls by name, these are the functions that are added as global mappings
+ * to the execution engine.
+ *
+ * Ahead of time compiled models do not have an execution engine, so their
+ * imports are bound with this function when they are loaded.
+ *
+ * @return the function address, or NULL if there is no such support function.
+ */
+void* getSupportFunctionAddress(const std::string& name);
 
 
 } /* namespace rr */
@@ -57,6 +57,16 @@ llvm::Value* ModelInitialValueSymbolResolver::loadSymbolValue(
         return ConstantFP::get(builder.getContext(), APFloat(0.0));
     }
 
+    /*************************************************************************/
+    /* Literal Initial Value */
+    /*************************************************************************/
+    if (symbol.compare(0, sizeof(SBML_LITERAL_SYMBOL_PREFIX) - 1,
+            SBML_LITERAL_SYMBOL_PREFIX) == 0)
+    {
+        return mdbuilder.createLiteralInitialValueLoad(
+                symbol.substr(sizeof(SBML_LITERAL_SYMBOL_PREFIX) - 1));
+    }
+
     /*************************************************************************/
     /* Function */
     /*************************************************************************/
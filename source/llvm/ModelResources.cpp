@@ -7,8 +7,10 @@
 #pragma hdrstop
 #include "ModelResources.h"
 #include "Random.h"
+#include "rrRoadRunnerOptions.h"
 
 #include <rrLogger.h>
+#include <Poco/SharedLibrary.h>
 
 using rr::Logger;
 using rr::getLogger;
@@ -17,7 +19,8 @@ namespace rrllvm
 {
 
 ModelResources::ModelResources() :
-        symbols(0), executionEngine(0), context(0), random(0), errStr(0)
+        symbols(0), executionEngine(0), context(0), random(0), errStr(0),
+        library(0), size(0)
 {
     // the reset of the ivars are assigned by the generator,
     // and in an exception they are not, does not matter as
@@ -39,6 +42,25 @@ ModelResources::~ModelResources()
     delete context;
     delete random;
     delete errStr;
+
+    if (library)
+    {
+        library->unload();
+        delete library;
+    }
+}
+
+bool hasModelFunctions(ModelFunctionKind kind, unsigned options)
+{
+    switch (kind)
+    {
+    case MODEL_FUNCTION_WRITABLE:
+        return !(options & rr::LoadSBMLOptions::READ_ONLY);
+    case MODEL_FUNCTION_INITIAL_VALUE:
+        return (options & rr::LoadSBMLOptions::MUTABLE_INITIAL_CONDITIONS) != 0;
+    default:
+        return true;
+    }
 }
 
 } /* namespace rrllvm */
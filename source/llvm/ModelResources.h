@@ -11,6 +11,11 @@
 
 #include "LLVMExecutableModel.h"
 
+namespace Poco
+{
+class SharedLibrary;
+}
+
 namespace rrllvm
 {
 
@@ -26,8 +31,21 @@ public:
     const class Random *random;
     const std::string *errStr;
 
+    /**
+     * the shared library of an ahead of time compiled model, all of the
+     * function pointers point into this library. NULL for JIT models.
+     */
+    Poco::SharedLibrary *library;
+
+    /**
+     * estimated memory in bytes of the generated code and symbols, used to
+     * keep the model cache in its budget.
+     */
+    size_t size;
+
     EvalInitialConditionsCodeGen::FunctionPtr evalInitialConditionsPtr;
     EvalReactionRatesCodeGen::FunctionPtr evalReactionRatesPtr;
+    EvalStateVectorRateCodeGen::FunctionPtr evalStateVectorRatePtr;
     GetBoundarySpeciesAmountCodeGen::FunctionPtr getBoundarySpeciesAmountPtr;
     GetFloatingSpeciesAmountCodeGen::FunctionPtr getFloatingSpeciesAmountPtr;
     GetBoundarySpeciesConcentrationCodeGen::FunctionPtr getBoundarySpeciesConcentrationPtr;
@@ -63,5 +81,134 @@ public:
     SetGlobalParameterInitValueCodeGen::FunctionPtr setGlobalParameterInitValuePtr;
 };
 
+/**
+ * which models have a generated function, see visitModelFunctions.
+ */
+enum ModelFunctionKind
+{
+    /**
+     * every model.
+     */
+    MODEL_FUNCTION_REQUIRED,
+
+    /**
+     * the models the code generator creates the function for, see
+     * hasModelFunction.
+     */
+    MODEL_FUNCTION_OPTIONAL,
+
+    /**
+     * models which are not loaded with LoadSBMLOptions::READ_ONLY.
+     */
+    MODEL_FUNCTION_WRITABLE,
+
+    /**
+     * models loaded with LoadSBMLOptions::MUTABLE_INITIAL_CONDITIONS.
+     */
+    MODEL_FUNCTION_INITIAL_VALUE
+};
+
+/**
+ * does a model loaded with the given LoadSBMLOptions have the functions
+ * of the given kind.
+ */
+bool hasModelFunctions(ModelFunctionKind kind, unsigned options);
+
+/**
+ * does the code generator create a function for its model, only the
+ * MODEL_FUNCTION_OPTIONAL generators may not.
+ */
+template <typename CodeGenType>
+inline bool hasModelFunction(const CodeGenType&)
+{
+    return true;
+}
+
+/**
+ * the state vector rate function only exists for models with constant
+ * stoichiometry.
+ */
+inline bool hasModelFunction(const EvalStateVectorRateCodeGen& codeGen)
+{
+    return codeGen.hasConstantStoichiometry();
+}
+
+/**
+ * The list of the generated functions of a model, used by the JIT model
+ * generator, the model exporter and the exported model loader so they
+ * all agree on the functions a model has.
+ *
+ * Calls visitor.visit<CodeGenType>(functionPtr, kind) for each function
+ * pointer of the resources, with the code generator which creates it.
+ */
+template <typename Visitor>
+void visitModelFunctions(ModelResources& rc, Visitor& visitor)
+{
+    visitor.template visit<EvalInitialConditionsCodeGen>(
+            rc.evalInitialConditionsPtr, MODEL_FUNCTION_REQUIRED);
+    visitor.template visit<EvalReactionRatesCodeGen>(
+            rc.evalReactionRatesPtr, MODEL_FUNCTION_REQUIRED);
+    visitor.template visit<EvalStateVectorRateCodeGen>(
+            rc.evalStateVectorRatePtr, MODEL_FUNCTION_OPTIONAL);
+    visitor.template visit<GetBoundarySpeciesAmountCodeGen>(
+            rc.getBoundarySpeciesAmountPtr, MODEL_FUNCTION_REQUIRED);
+    visitor.template visit<GetFloatingSpeciesAmountCodeGen>(
+            rc.getFloatingSpeciesAmountPtr, MODEL_FUNCTION_REQUIRED);
+    visitor.template visit<GetBoundarySpeciesConcentrationCodeGen>(
+            rc.getBoundarySpeciesConcentrationPtr, MODEL_FUNCTION_REQUIRED);
+    visitor.template visit<GetFloatingSpeciesConcentrationCodeGen>(
+            rc.getFloatingSpeciesConcentrationPtr, MODEL_FUNCTION_REQUIRED);
+    visitor.template visit<GetCompartmentVolumeCodeGen>(
+            rc.getCompartmentVolumePtr, MODEL_FUNCTION_REQUIRED);
+    visitor.template visit<GetGlobalParameterCodeGen>(
+            rc.getGlobalParameterPtr, MODEL_FUNCTION_REQUIRED);
+    visitor.template visit<EvalRateRuleRatesCodeGen>(
+            rc.evalRateRuleRatesPtr, MODEL_FUNCTION_REQUIRED);
+    visitor.template visit<GetEventTriggerCodeGen>(
+            rc.getEventTriggerPtr, MODEL_FUNCTION_REQUIRED);
+    visitor.template visit<GetEventPriorityCodeGen>(
+            rc.getEventPriorityPtr, MODEL_FUNCTION_REQUIRED);
+    visitor.template visit<GetEventDelayCodeGen>(
+            rc.getEventDelayPtr, MODEL_FUNCTION_REQUIRED);
+    visitor.template visit<EventTriggerCodeGen>(
+            rc.eventTriggerPtr, MODEL_FUNCTION_REQUIRED);
+    visitor.template visit<EventAssignCodeGen>(
+            rc.eventAssignPtr, MODEL_FUNCTION_REQUIRED);
+    visitor.template visit<EvalVolatileStoichCodeGen>(
+            rc.evalVolatileStoichPtr, MODEL_FUNCTION_REQUIRED);
+    visitor.template visit<EvalConversionFactorCodeGen>(
+            rc.evalConversionFactorPtr, MODEL_FUNCTION_REQUIRED);
+
+    visitor.template visit<SetBoundarySpeciesAmountCodeGen>(
+            rc.setBoundarySpeciesAmountPtr, MODEL_FUNCTION_WRITABLE);
+    visitor.template visit<SetBoundarySpeciesConcentrationCodeGen>(
+            rc.setBoundarySpeciesConcentrationPtr, MODEL_FUNCTION_WRITABLE);
+    visitor.template visit<SetFloatingSpeciesConcentrationCodeGen>(
+            rc.setFloatingSpeciesConcentrationPtr, MODEL_FUNCTION_WRITABLE);
+    visitor.template visit<SetCompartmentVolumeCodeGen>(
+            rc.setCompartmentVolumePtr, MODEL_FUNCTION_WRITABLE);
+    visitor.template visit<SetFloatingSpeciesAmountCodeGen>(
+            rc.setFloatingSpeciesAmountPtr, MODEL_FUNCTION_WRITABLE);
+    visitor.template visit<SetGlobalParameterCodeGen>(
+            rc.setGlobalParameterPtr, MODEL_FUNCTION_WRITABLE);
+
+    visitor.template visit<GetFloatingSpeciesInitConcentrationCodeGen>(
+            rc.getFloatingSpeciesInitConcentrationsPtr, MODEL_FUNCTION_INITIAL_VALUE);
+    visitor.template visit<SetFloatingSpeciesInitConcentrationCodeGen>(
+            rc.setFloatingSpeciesInitConcentrationsPtr, MODEL_FUNCTION_INITIAL_VALUE);
+    visitor.template visit<GetFloatingSpeciesInitAmountCodeGen>(
+            rc.getFloatingSpeciesInitAmountsPtr, MODEL_FUNCTION_INITIAL_VALUE);
+    visitor.template visit<SetFloatingSpeciesInitAmountCodeGen>(
+            rc.setFloatingSpeciesInitAmountsPtr, MODEL_FUNCTION_INITIAL_VALUE);
+    visitor.template visit<GetCompartmentInitVolumeCodeGen>(
+            rc.getCompartmentInitVolumesPtr, MODEL_FUNCTION_INITIAL_VALUE);
+    visitor.template visit<SetCompartmentInitVolumeCodeGen>(
+            rc.setCompartmentInitVolumesPtr, MODEL_FUNCTION_INITIAL_VALUE);
+    visitor.template visit<GetGlobalParameterInitValueCodeGen>(
+            rc.getGlobalParameterInitValuePtr, MODEL_FUNCTION_INITIAL_VALUE);
+    visitor.template visit<SetGlobalParameterInitValueCodeGen>(
+            rc.setGlobalParameterInitValuePtr, MODEL_FUNCTION_INITIAL_VALUE);
+}
+
 } /* namespace rrllvm */
 #endif /* CACHEDMODEL_H_ */
@@ -13,15 +13,6 @@
 #include "rrUtils.h"
 #include <stdint.h>
 
-
-#if INTPTR_MAX == INT32_MAX
-    #define RR_32BIT
-#elif INTPTR_MAX == INT64_MAX
-   #define RR_64BIT
-#else
-    #error "Environment not 32 or 64-bit."
-#endif
-
 using rr::Logger;
 using rr::Config;
 using rr::getMicroSeconds;
@@ -58,21 +49,21 @@ static int64_t defaultSeed()
     return seed;
 }
 
-Random::Random(ModelGeneratorContext& ctx)
+Random::Random(ModelGeneratorContext& ctx) : replicate(0)
 {
     addGlobalMappings(ctx);
     setRandomSeed(defaultSeed());
     randomCount++;
 }
 
-Random::Random(const Random& other)
+Random::Random(const Random& other) : replicate(0)
 {
     *this = other;
     setRandomSeed(defaultSeed());
     randomCount++;
 }
 
-Random::Random()
+Random::Random() : replicate(0)
 {
     setRandomSeed(defaultSeed());
     randomCount++;
@@ -81,6 +72,9 @@ Random::Random()
 Random& Random::operator =(const Random& rhs)
 {
     engine = rhs.engine;
+    eventEngine = rhs.eventEngine;
+    randomSeed = rhs.randomSeed;
+    replicate = rhs.replicate;
     return *this;
 }
 
@@ -154,21 +148,16 @@ Random::~Random()
 
 double Random::operator ()()
 {
-    double range = engine.max() - engine.min();
-    return engine() / range;
+    return engine.uniform();
 }
 
 void Random::setRandomSeed(int64_t val)
 {
-#ifdef RR_32BIT
-    unsigned long maxl = std::numeric_limits<unsigned long>::max() - 2;
-    unsigned long seed = val % maxl;
-    engine.seed(seed);
-    randomSeed = seed;
-#else
-    engine.seed(val);
+    // the Philox key is 64 bits on every platform, so the seed no longer
+    // needs to be truncated to an unsigned long on 32 bit systems.
     randomSeed = val;
-#endif
+    engine.seed(val, replicate, rr::Philox::DISTRIB_STREAM);
+    eventEngine.seed(val, replicate, rr::Philox::EVENT_STREAM);
 }
 
 int64_t Random::getRandomSeed()
@@ -176,5 +165,34 @@ int64_t Random::getRandomSeed()
     return randomSeed;
 }
 
+void Random::setReplicate(uint32_t val)
+{
+    replicate = val;
+    setRandomSeed(randomSeed);
+}
+
+uint32_t Random::getReplicate()
+{
+    return replicate;
+}
+
+unsigned Random::selectEvent(unsigned n)
+{
+    return n > 1 ? (unsigned)(eventEngine.uniform() * n) : 0;
+}
+
+void* Random::getDistribFunctionAddress(const std::string& name)
+{
+    if (name == "rr_distrib_uniform")
+    {
+        return (void*)distrib_uniform;
+    }
+    else if (name == "rr_distrib_normal")
+    {
+        return (void*)distrib_normal;
+    }
+    return 0;
+}
+
 } /* namespace rrllvm */
 
@@ -9,7 +9,9 @@
 #define _RRLLVM_RANDOM_H_
 
 #include "tr1proxy/rr_random.h" // rr proxy to <random>
+#include "rrPhilox.h"
 #include <stdint.h>
+#include <string>
 
 namespace rrllvm
 {
@@ -31,7 +33,8 @@ public:
 
     /**
      * assignment operator, copies the fields from the
-     * other object, but does not re-intialize them.
+     * other object, but does not re-intialize them, so both
+     * produce the same sequence from here on.
      */
     Random& operator=( const Random& rhs);
 
@@ -86,13 +89,46 @@ public:
     int64_t getRandomSeed();
 
     /**
-     * RNG engine.
+     * set the replicate number, each replicate of a model with the same seed
+     * draws from an independent sequence. This resets the RNG to the start
+     * of the new sequence.
      */
-    cxx11_ns::mt19937 engine;
+    void setReplicate(uint32_t);
+
+    /**
+     * get the replicate number.
+     */
+    uint32_t getReplicate();
+
+    /**
+     * select one of n items, i.e. one of several simultaneous events,
+     * from the event stream so tie breaking does not disturb the
+     * sequence seen by the distribution functions.
+     */
+    unsigned selectEvent(unsigned n);
+
+    /**
+     * get the address of one of the distribution functions that generated
+     * code calls by name, i.e. "rr_distrib_uniform". Returns NULL if the name
+     * is not one of the distribution functions.
+     */
+    static void* getDistribFunctionAddress(const std::string& name);
+
+    /**
+     * RNG engine, the Philox::DISTRIB_STREAM of (seed, replicate).
+     */
+    rr::Philox engine;
 
 private:
+    /**
+     * the Philox::EVENT_STREAM of (seed, replicate).
+     */
+    rr::Philox eventEngine;
+
     // seed that was used to seed the engine.
     int64_t randomSeed;
+
+    uint32_t replicate;
 };
 
 
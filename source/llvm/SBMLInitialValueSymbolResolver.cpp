@@ -9,6 +9,7 @@
 #include "ASTNodeCodeGen.h"
 #include "LLVMException.h"
 #include "FunctionResolver.h"
+#include "ModelDataIRBuilder.h"
 #include <sbml/Model.h>
 
 using namespace std;
@@ -37,6 +38,17 @@ llvm::Value* SBMLInitialValueSymbolResolver::loadSymbolValue(
         return ConstantFP::get(builder.getContext(), APFloat(0.0));
     }
 
+    /*************************************************************************/
+    /* Literal Initial Value */
+    /*************************************************************************/
+    if (symbol.compare(0, sizeof(SBML_LITERAL_SYMBOL_PREFIX) - 1,
+            SBML_LITERAL_SYMBOL_PREFIX) == 0)
+    {
+        ModelDataIRBuilder mdbuilder(modelData, modelDataSymbols, builder);
+        return mdbuilder.createLiteralInitialValueLoad(
+                symbol.substr(sizeof(SBML_LITERAL_SYMBOL_PREFIX) - 1));
+    }
+
     /*************************************************************************/
     /* Function */
     /*************************************************************************/
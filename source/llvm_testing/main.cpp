@@ -15,12 +15,15 @@
 #include "ConfigurableTest.h"
 
 #include "rrRoadRunner.h"
+#include "ExecutableModelFactory.h"
 
 #include "Integrator.h"
 
 #include "rrLogger.h"
 
 #include "TestVariant.h"
+#include "CSRMatrixTest.h"
+#include "rrPhilox.h"
 
 #include <sbml/SBMLDocument.h>
 #include <sbml/Model.h>
@@ -29,6 +32,7 @@
 #include <stdio.h>
 #include <cmath>
 #include <stdint.h>
+#include <stdlib.h>
 
 
 
@@ -477,6 +481,171 @@ int matnames_test(int argc, char* argv[]) {
 }
 
 
+/**
+ * compare the values and rates of the models at their current state,
+ * returns the number of values which differ.
+ */
+static int compare_models(ExecutableModel* a, ExecutableModel* b)
+{
+    int errors = 0;
+
+    int n = a->getStateVector(0);
+    if (n != b->getStateVector(0) || a->getNumReactions() != b->getNumReactions())
+    {
+        cout << "the models have different sizes" << endl;
+        return 1;
+    }
+
+    vector<double> x(n), ya(n), yb(n);
+    a->getStateVector(&x[0]);
+    a->getStateVectorRate(a->getTime(), &x[0], &ya[0]);
+    b->getStateVectorRate(b->getTime(), &x[0], &yb[0]);
+
+    int nr = a->getNumReactions();
+    vector<double> ra(nr), rb(nr);
+    a->getReactionRates(nr, 0, &ra[0]);
+    b->getReactionRates(nr, 0, &rb[0]);
+
+    ya.insert(ya.end(), ra.begin(), ra.end());
+    yb.insert(yb.end(), rb.begin(), rb.end());
+
+    for (unsigned i = 0; i < ya.size(); ++i)
+    {
+        if (std::abs(ya[i] - yb[i]) > 1e-12 * (1 + std::abs(ya[i])))
+        {
+            cout << "value " << i << " differs, " << ya[i] << " != " << yb[i] << endl;
+            ++errors;
+        }
+    }
+
+    return errors;
+}
+
+/**
+ * export a model, link it into a shared library with the system compiler,
+ * load it back and compare it with the JIT compiled model, before and after
+ * changing a global parameter.
+ */
+/**
+ * check Philox against the Philox4x32-10 known answer vectors of the
+ * Random123 reference implementation. The counter is
+ * (block lo, block hi, stream, replicate) and the key the seed, so each
+ * vector is addressed by seed, replicate, stream and block.
+ */
+int philox_test(int argc, char* argv[])
+{
+    static const uint32_t kat[3][10] = {
+        {0x00000000, 0x00000000, 0x00000000, 0x00000000,
+         0x00000000, 0x00000000,
+         0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8},
+        {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff,
+         0xffffffff, 0xffffffff,
+         0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd},
+        {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344,
+         0xa4093822, 0x299f31d0,
+         0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}
+    };
+
+    int errors = 0;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        const uint32_t *v = kat[i];
+        uint64_t seed = (uint64_t)v[5] << 32 | v[4];
+        uint64_t block = (uint64_t)v[1] << 32 | v[0];
+
+        Philox philox(seed, v[3], v[2]);
+        philox.setBlock(block);
+
+        for (int j = 0; j < 4; ++j)
+        {
+            uint32_t value = philox();
+            if (value != v[6 + j])
+            {
+                cout << "vector " << i << ", value " << j << ": expected "
+                     << hex << v[6 + j] << ", got " << value << dec << endl;
+                ++errors;
+            }
+        }
+    }
+
+    // jumping to a position gives the same values as drawing up to it
+    Philox seq(1234, 5, Philox::DISTRIB_STREAM);
+    for (uint64_t pos = 0; pos < 11; ++pos)
+    {
+        Philox jump(1234, 5, Philox::DISTRIB_STREAM);
+        jump.setPosition(pos);
+        if (jump.getPosition() != pos || jump() != seq())
+        {
+            cout << "setPosition(" << pos << ") differs from sequential draws" << endl;
+            ++errors;
+        }
+    }
+
+    cout << (errors ? "philox test failed" : "philox test passed") << endl;
+    return errors ? -1 : 0;
+}
+
+int export_test(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        cout << "usage: llvm_testing export fname [dir]" << endl;
+        return -1;
+    }
+
+    ExecutableModel *jit = 0;
+    ExecutableModel *exported = 0;
+    int errors = 0;
+
+    try
+    {
+        RoadRunner r(argv[2]);
+        std::string sbml = r.getSBML();
+
+        std::string dir = argc > 3 ? argv[3] : getTempDir();
+        std::string obj = joinPath(dir, "export_test.o");
+        std::string lib = joinPath(dir, "export_test.so");
+
+        ExecutableModelFactory::exportModel(sbml, obj);
+
+        std::string cmd = "cc -shared -o " + lib + " " + obj + " -lm";
+        if (system(cmd.c_str()) != 0)
+        {
+            cout << "failed to link the exported model: " << cmd << endl;
+            return -1;
+        }
+
+        jit = ExecutableModelFactory::createModel(sbml);
+        exported = ExecutableModelFactory::loadExportedModel(lib);
+
+        errors += compare_models(jit, exported);
+
+        if (jit->getNumGlobalParameters() > 0)
+        {
+            int index = 0;
+            double value = 0;
+            jit->getGlobalParameterValues(1, &index, &value);
+            value = 2 * value + 1;
+            jit->setGlobalParameterValues(1, &index, &value);
+            exported->setGlobalParameterValues(1, &index, &value);
+
+            errors += compare_models(jit, exported);
+        }
+    }
+    catch (std::exception& e)
+    {
+        cout << "Error running export test: " << e.what() << endl;
+        errors = -1;
+    }
+
+    delete jit;
+    delete exported;
+
+    cout << (errors == 0 ? "export test passed" : "export test failed") << endl;
+
+    return errors == 0 ? 0 : -1;
+}
 
 int main(int argc, char* argv[])
 {
@@ -526,6 +695,18 @@ int main(int argc, char* argv[])
         return matnames_test(argc, argv);
     }
 
+    if(strcmp("export", argv[1]) == 0) {
+        return export_test(argc, argv);
+    }
+
+    if(strcmp("philox", argv[1]) == 0) {
+        return philox_test(argc, argv);
+    }
+
+    if(strcmp("simd", argv[1]) == 0) {
+        return runSimdKernelTest() ? 0 : -1;
+    }
+
 
 
     cout << "error, invalid test name: " << argv[1] << endl;
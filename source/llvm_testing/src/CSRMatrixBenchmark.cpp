@@ -0,0 +1,156 @@
+/*
+ * CSRMatrixBenchmark.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Microbenchmark of the csr_matrix kernels, compares the instruction sets,
+ * the CSR and SELL-C-sigma storage, and k dgemv calls with one dgemm on a
+ * block of k vectors.
+ *
+ * usage: csr_benchmark [rows [cols [nnz per row [k [repeats]]]]]
+ */
+#include "rrSparse.h"
+
+#include <Poco/Timestamp.h>
+
+#include <vector>
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+
+using namespace std;
+using namespace rr;
+
+/**
+ * random matrix with about nnzPerRow entries per row, like a
+ * stoichiometry matrix with a few reactions per species.
+ */
+static csr_matrix* randomMatrix(unsigned m, unsigned n, unsigned nnzPerRow)
+{
+    vector<unsigned> rowidx;
+    vector<unsigned> colidx;
+    vector<double> values;
+
+    for (unsigned i = 0; i < m; i++)
+    {
+        unsigned len = 1 + rand() % (2 * nnzPerRow);
+        unsigned rowStart = values.size();
+        for (unsigned j = 0; j < len && j < n; j++)
+        {
+            unsigned col = rand() % n;
+            bool dup = false;
+            for (unsigned k = rowStart; k < values.size(); k++)
+            {
+                dup = dup || colidx[k] == col;
+            }
+            if (!dup)
+            {
+                rowidx.push_back(i);
+                colidx.push_back(col);
+                values.push_back(rand() % 5 - 2);
+            }
+        }
+    }
+
+    return csr_matrix_new(m, n, rowidx, colidx, values);
+}
+
+/**
+ * nanoseconds per call.
+ */
+template <typename F>
+static double timeIt(F f, unsigned repeats)
+{
+    f();
+    Poco::Timestamp start;
+    for (unsigned i = 0; i < repeats; i++)
+    {
+        f();
+    }
+    return start.elapsed() * 1000.0 / repeats;
+}
+
+struct Dgemv
+{
+    const csr_matrix *A; const double *x; double *y;
+    void operator()() const { csr_matrix_dgemv(1.0, A, x, 0.0, y); }
+};
+
+struct SellDgemv
+{
+    const csr_matrix_sell *A; const double *x; double *y;
+    void operator()() const { csr_matrix_sell_dgemv(1.0, A, x, 0.0, y); }
+};
+
+/**
+ * k products with the columns of a row major block, as a Jacobian by
+ * columns or an ensemble is computed without dgemm.
+ */
+struct DgemvColumns
+{
+    const csr_matrix *A; const double *X; double *Y; unsigned k;
+    mutable vector<double> x, y;
+    void operator()() const
+    {
+        x.resize(A->n);
+        y.resize(A->m);
+        for (unsigned j = 0; j < k; j++)
+        {
+            for (unsigned i = 0; i < A->n; i++) x[i] = X[i * k + j];
+            csr_matrix_dgemv(1.0, A, &x[0], 0.0, &y[0]);
+            for (unsigned i = 0; i < A->m; i++) Y[i * k + j] = y[i];
+        }
+    }
+};
+
+struct Dgemm
+{
+    const csr_matrix *A; const double *X; double *Y; unsigned k;
+    void operator()() const { csr_matrix_dgemm(1.0, A, X, k, 0.0, Y); }
+};
+
+int main(int argc, char* argv[])
+{
+    unsigned m = argc > 1 ? atoi(argv[1]) : 2000;
+    unsigned n = argc > 2 ? atoi(argv[2]) : 3000;
+    unsigned nnzPerRow = argc > 3 ? atoi(argv[3]) : 4;
+    unsigned k = argc > 4 ? atoi(argv[4]) : 8;
+    unsigned repeats = argc > 5 ? atoi(argv[5]) : 1000;
+
+    srand(42);
+    csr_matrix *A = randomMatrix(m, n, nnzPerRow);
+    csr_matrix_sell *S1 = csr_matrix_sell_new(A, 1);
+    csr_matrix_sell *S64 = csr_matrix_sell_new(A, 64);
+
+    vector<double> x(n), X(n * k), y(m), Y(m * k);
+    for (unsigned i = 0; i < x.size(); i++) x[i] = rand() / (double)RAND_MAX;
+    for (unsigned i = 0; i < X.size(); i++) X[i] = rand() / (double)RAND_MAX;
+
+    printf("%u x %u, %u non-zeros, k = %u, supported: %s\n", m, n, A->nnz, k,
+            csr_matrix_simd_name(csr_matrix_simd_supported()));
+    printf("%-8s %12s %12s %12s %14s %12s\n", "kernels", "dgemv", "sell-8-1",
+            "sell-8-64", "k x dgemv", "dgemm");
+
+    for (int level = CSR_SIMD_SCALAR; level <= csr_matrix_simd_supported(); level++)
+    {
+        csr_matrix_set_simd(level);
+
+        Dgemv gemv = { A, &x[0], &y[0] };
+        SellDgemv sell1 = { S1, &x[0], &y[0] };
+        SellDgemv sell64 = { S64, &x[0], &y[0] };
+        DgemvColumns columns;
+        columns.A = A; columns.X = &X[0]; columns.Y = &Y[0]; columns.k = k;
+        Dgemm gemm = { A, &X[0], &Y[0], k };
+
+        printf("%-8s %10.0fns %10.0fns %10.0fns %12.0fns %10.0fns\n",
+                csr_matrix_simd_name(level),
+                timeIt(gemv, repeats), timeIt(sell1, repeats),
+                timeIt(sell64, repeats), timeIt(columns, repeats / k + 1),
+                timeIt(gemm, repeats / k + 1));
+    }
+
+    csr_matrix_sell_delete(S64);
+    csr_matrix_sell_delete(S1);
+    csr_matrix_delete(A);
+    return 0;
+}
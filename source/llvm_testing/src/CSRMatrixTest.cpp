@@ -29,6 +29,8 @@
 #include "llvm/LLVMModelData.h"
 
 #include <utility>
+#include <limits>
+#include <cmath>
 #include <cstdlib>
 #include <iostream>
 #include <fstream>
@@ -176,3 +178,164 @@ bool runSparseTest(const int m, const int n, const int nnz)
 
     return true;
 }
+
+/**
+ * y := alpha*A*x + beta*y over the triplets, and the sum of the absolute
+ * values of the terms, which bounds the rounding error of the kernels.
+ */
+static void tripletDgemv(unsigned m, const vector<uint>& rowidx,
+        const vector<uint>& colidx, const vector<double>& values,
+        double alpha, const double *x, unsigned incx, double beta,
+        double *y, unsigned incy, double *bound)
+{
+    vector<double> sum(m, 0.0);
+    vector<double> abssum(m, 0.0);
+
+    for (unsigned k = 0; k < values.size(); k++)
+    {
+        double term = values[k] * x[colidx[k] * incx];
+        sum[rowidx[k]] += term;
+        abssum[rowidx[k]] += fabs(term);
+    }
+
+    for (unsigned i = 0; i < m; i++)
+    {
+        double by = beta == 0 ? 0 : beta * y[i * incy];
+        y[i * incy] = alpha * sum[i] + by;
+        bound[i * incy] = 1e-13 * (1 + fabs(alpha) * abssum[i] + fabs(by));
+    }
+}
+
+static int compareVectors(const char *kernel, int level, unsigned size,
+        const double *expected, const double *bound, const double *actual)
+{
+    for (unsigned i = 0; i < size; i++)
+    {
+        if (!(fabs(expected[i] - actual[i]) <= bound[i]))
+        {
+            cout << kernel << " (" << csr_matrix_simd_name(level)
+                    << ") differs at " << i << ": " << actual[i]
+                    << ", expected " << expected[i] << endl;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+bool runSimdKernelTest()
+{
+    // row lengths from 0 to 19, so there are empty rows and rows which are
+    // not a multiple of any vector width, and more rows than a few slices.
+    const unsigned m = 53;
+    const unsigned n = 41;
+
+    vector<uint> rowidx;
+    vector<uint> colidx;
+    vector<double> values;
+
+    srand(7);
+    for (unsigned i = 0; i < m; i++)
+    {
+        unsigned len = (i % 6 == 0) ? 0 : (i * 7) % 20;
+        unsigned start = rand() % n;
+        for (unsigned j = 0; j < len && j < n; j++)
+        {
+            rowidx.push_back(i);
+            colidx.push_back((start + j * 3) % n);
+            values.push_back((rand() % 2001 - 1000) / 250.0);
+        }
+    }
+
+    csr_matrix *A = csr_matrix_new(m, n, rowidx, colidx, values);
+    csr_matrix_sell *S1 = csr_matrix_sell_new(A, 1);
+    csr_matrix_sell *S16 = csr_matrix_sell_new(A, 16);
+
+    const unsigned maxk = 13;
+    vector<double> X(n * maxk);
+    vector<double> Y0(m * maxk);
+    for (unsigned i = 0; i < X.size(); i++) X[i] = rand() / (double)RAND_MAX - 0.5;
+    for (unsigned i = 0; i < Y0.size(); i++) Y0[i] = rand() / (double)RAND_MAX - 0.5;
+
+    // k is the width of the dgemm block, none but 1 a multiple of a
+    // vector width, and (alpha, beta) pairs, beta zero must not read y.
+    const unsigned ks[] = { 1, 3, 5, 7, 9, 13 };
+    const double scales[][2] = { { 1, 0 }, { 1.5, 0 }, { -0.75, 1 }, { 2, -0.5 } };
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+
+    const int saved = csr_matrix_get_simd();
+    int errors = 0;
+
+    for (int level = CSR_SIMD_SCALAR; level <= csr_matrix_simd_supported(); level++)
+    {
+        if (csr_matrix_set_simd(level) != level)
+        {
+            cout << "could not select " << csr_matrix_simd_name(level) << endl;
+            errors++;
+            continue;
+        }
+
+        vector<double> expected(m), bound(m), y(m);
+
+        // ddot of each row
+        tripletDgemv(m, rowidx, colidx, values, 1, &X[0], 1, 0,
+                &expected[0], 1, &bound[0]);
+        for (unsigned i = 0; i < m; i++)
+        {
+            y[i] = csr_matrix_ddot(i, A, &X[0]);
+        }
+        errors += compareVectors("ddot", level, m, &expected[0], &bound[0], &y[0]);
+
+        for (unsigned s = 0; s < sizeof(scales) / sizeof(scales[0]); s++)
+        {
+            double alpha = scales[s][0];
+            double beta = scales[s][1];
+
+            for (unsigned i = 0; i < m; i++) expected[i] = Y0[i];
+            tripletDgemv(m, rowidx, colidx, values, alpha, &X[0], 1, beta,
+                    &expected[0], 1, &bound[0]);
+
+            for (unsigned i = 0; i < m; i++) y[i] = beta == 0 ? nan : Y0[i];
+            csr_matrix_dgemv(alpha, A, &X[0], beta, &y[0]);
+            errors += compareVectors("dgemv", level, m, &expected[0], &bound[0], &y[0]);
+
+            for (unsigned i = 0; i < m; i++) y[i] = beta == 0 ? nan : Y0[i];
+            csr_matrix_sell_dgemv(alpha, S1, &X[0], beta, &y[0]);
+            errors += compareVectors("sell_dgemv sigma 1", level, m,
+                    &expected[0], &bound[0], &y[0]);
+
+            for (unsigned i = 0; i < m; i++) y[i] = beta == 0 ? nan : Y0[i];
+            csr_matrix_sell_dgemv(alpha, S16, &X[0], beta, &y[0]);
+            errors += compareVectors("sell_dgemv sigma 16", level, m,
+                    &expected[0], &bound[0], &y[0]);
+
+            // X and Y are row major, n by k and m by k.
+            for (unsigned kk = 0; kk < sizeof(ks) / sizeof(ks[0]); kk++)
+            {
+                unsigned k = ks[kk];
+                vector<double> E(Y0.begin(), Y0.begin() + m * k);
+                vector<double> B(m * k);
+                vector<double> Y(m * k);
+
+                for (unsigned j = 0; j < k; j++)
+                {
+                    tripletDgemv(m, rowidx, colidx, values, alpha, &X[j], k,
+                            beta, &E[j], k, &B[j]);
+                }
+
+                for (unsigned i = 0; i < m * k; i++) Y[i] = beta == 0 ? nan : Y0[i];
+                csr_matrix_dgemm(alpha, A, &X[0], k, beta, &Y[0]);
+                errors += compareVectors("dgemm", level, m * k, &E[0], &B[0], &Y[0]);
+            }
+        }
+    }
+
+    csr_matrix_set_simd(saved);
+
+    csr_matrix_sell_delete(S1);
+    csr_matrix_sell_delete(S16);
+    csr_matrix_delete(A);
+
+    cout << (errors == 0 ? "simd kernel test passed" : "simd kernel test failed") << endl;
+
+    return errors == 0;
+}
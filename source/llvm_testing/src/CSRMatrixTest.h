@@ -10,4 +10,10 @@
 
 bool runSparseTest(const int m, const int n, const int nnz);
 
+/**
+ * compare the csr_matrix ddot, dgemv, dgemm and sell_dgemv kernels of each
+ * supported instruction set with a plain loop over the entries.
+ */
+bool runSimdKernelTest();
+
 #endif /* CSRMATRIXTEST_H_ */
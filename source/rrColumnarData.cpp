@@ -0,0 +1,519 @@
+/*
+ * rrColumnarData.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+#pragma hdrstop
+#include "rrColumnarData.h"
+#include "rrLogger.h"
+#include "rrStringUtils.h"
+
+#include <Poco/File.h>
+#include <Poco/SharedMemory.h>
+#include <Poco/DeflatingStream.h>
+#include <Poco/InflatingStream.h>
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <string.h>
+
+using namespace std;
+
+namespace rr
+{
+
+const char* ColumnarDataWriter::fileExtension = ".rrcd";
+
+static const char fileMagic[4] = {'R', 'R', 'C', 'D'};
+static const char chunkMagic[4] = {'C', 'H', 'N', 'K'};
+static const char footerMagic[8] = {'R', 'R', 'C', 'D', 'E', 'N', 'D', 0};
+static const uint32_t formatVersion = 1;
+static const uint32_t endianMarker = 0x01020304;
+static const uint32_t compressedFlag = 1;
+
+static uint64_t padding(uint64_t size)
+{
+    return (8 - size % 8) % 8;
+}
+
+static void writePadding(ostream& out, uint64_t size)
+{
+    static const char zeros[8] = {0};
+    out.write(zeros, padding(size));
+}
+
+ColumnarDataWriter::ColumnarDataWriter(const std::string& fileName,
+        const std::vector<std::string>& colNames, unsigned chunkRows,
+        bool compress) :
+        fileName(fileName),
+        colNames(colNames),
+        chunkRows(chunkRows ? chunkRows : 1),
+        compress(compress),
+        chunkFill(0),
+        numRows(0),
+        closed(false)
+{
+    if (colNames.empty())
+    {
+        throw invalid_argument("columnar data file " + fileName +
+                " must have at least one column");
+    }
+
+    out.open(fileName.c_str(), ios::out | ios::binary | ios::trunc);
+
+    if (!out)
+    {
+        throw runtime_error("Failed opening file: " + fileName);
+    }
+
+    chunk.resize((size_t)this->chunkRows * colNames.size());
+
+    ColumnarFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, fileMagic, sizeof(fileMagic));
+    header.version = formatVersion;
+    header.endian = endianMarker;
+    header.numCols = colNames.size();
+    header.chunkRows = this->chunkRows;
+    header.flags = compress ? compressedFlag : 0;
+
+    header.headerSize = sizeof(header);
+    for (unsigned i = 0; i < colNames.size(); ++i)
+    {
+        uint64_t len = sizeof(uint32_t) + colNames[i].size();
+        header.headerSize += len + padding(len);
+    }
+
+    out.write((const char*)&header, sizeof(header));
+
+    for (unsigned i = 0; i < colNames.size(); ++i)
+    {
+        uint32_t len = colNames[i].size();
+        out.write((const char*)&len, sizeof(len));
+        out.write(colNames[i].c_str(), len);
+        writePadding(out, sizeof(len) + len);
+    }
+}
+
+ColumnarDataWriter::~ColumnarDataWriter()
+{
+    try
+    {
+        close();
+    }
+    catch (std::exception& e)
+    {
+        Log(Logger::LOG_ERROR) << "Error closing " << fileName << ": " << e.what();
+    }
+}
+
+void ColumnarDataWriter::writeRow(const double* row)
+{
+    if (closed)
+    {
+        throw logic_error("attempt to write to closed file " + fileName);
+    }
+
+    std::copy(row, row + colNames.size(), &chunk[chunkFill * colNames.size()]);
+
+    if (++chunkFill == chunkRows)
+    {
+        writeChunk();
+    }
+}
+
+void ColumnarDataWriter::writeRows(const double* rows, unsigned n)
+{
+    for (unsigned i = 0; i < n; ++i)
+    {
+        writeRow(rows + i * colNames.size());
+    }
+}
+
+void ColumnarDataWriter::writeChunk()
+{
+    if (chunkFill == 0)
+    {
+        return;
+    }
+
+    const unsigned numCols = colNames.size();
+
+    chunkOffsets.push_back((uint64_t)out.tellp());
+
+    ColumnarChunkHeader chunkHeader;
+    memcpy(chunkHeader.magic, chunkMagic, sizeof(chunkMagic));
+    chunkHeader.rows = chunkFill;
+    chunkHeader.reserved = 0;
+    out.write((const char*)&chunkHeader, sizeof(chunkHeader));
+
+    // transpose the row major chunk into columns.
+    vector<double> column(chunkFill);
+
+    for (unsigned col = 0; col < numCols; ++col)
+    {
+        for (unsigned row = 0; row < chunkFill; ++row)
+        {
+            column[row] = chunk[row * numCols + col];
+        }
+
+        const char* colData = (const char*)&column[0];
+        uint64_t colSize = chunkFill * sizeof(double);
+        string deflated;
+
+        if (compress)
+        {
+            stringstream ss(ios::in | ios::out | ios::binary);
+            Poco::DeflatingOutputStream deflater(ss,
+                    Poco::DeflatingStreamBuf::STREAM_ZLIB);
+            deflater.write(colData, colSize);
+            deflater.close();
+
+            deflated = ss.str();
+            colData = deflated.data();
+            colSize = deflated.size();
+        }
+
+        out.write((const char*)&colSize, sizeof(colSize));
+        out.write(colData, colSize);
+        writePadding(out, colSize);
+    }
+
+    if (!out)
+    {
+        throw runtime_error("Error writing to file: " + fileName);
+    }
+
+    numRows += chunkFill;
+    chunkFill = 0;
+}
+
+void ColumnarDataWriter::close()
+{
+    if (closed)
+    {
+        return;
+    }
+
+    writeChunk();
+
+    ColumnarFileFooter footer;
+    footer.numRows = numRows;
+    footer.numChunks = chunkOffsets.size();
+    footer.indexOffset = (uint64_t)out.tellp();
+    memcpy(footer.magic, footerMagic, sizeof(footerMagic));
+
+    if (chunkOffsets.size())
+    {
+        out.write((const char*)&chunkOffsets[0],
+                chunkOffsets.size() * sizeof(uint64_t));
+    }
+    out.write((const char*)&footer, sizeof(footer));
+    out.close();
+
+    closed = true;
+
+    Log(Logger::LOG_DEBUG) << "wrote " << numRows << " rows in "
+            << chunkOffsets.size() << " chunks to " << fileName;
+}
+
+uint64_t ColumnarDataWriter::getNumRows() const
+{
+    return numRows + chunkFill;
+}
+
+
+ColumnarDataReader::ColumnarDataReader(const std::string& fileName) :
+        fileName(fileName),
+        mem(0),
+        data(0),
+        size(0),
+        chunkOffsets(0)
+{
+    Poco::File file(fileName);
+
+    if (!file.exists() || file.getSize() <
+            sizeof(ColumnarFileHeader) + sizeof(ColumnarFileFooter))
+    {
+        throw runtime_error(fileName + " is not a valid columnar data file");
+    }
+
+    mem = new Poco::SharedMemory(file, Poco::SharedMemory::AM_READ);
+    data = mem->begin();
+    size = mem->end() - mem->begin();
+
+    try
+    {
+        memcpy(&header, data, sizeof(header));
+        memcpy(&footer, data + size - sizeof(footer), sizeof(footer));
+
+        if (memcmp(header.magic, fileMagic, sizeof(fileMagic)) != 0 ||
+                memcmp(footer.magic, footerMagic, sizeof(footerMagic)) != 0)
+        {
+            throw runtime_error(fileName + " is not a valid columnar data file");
+        }
+
+        if (header.version != formatVersion || header.endian != endianMarker)
+        {
+            throw runtime_error(fileName + " has unsupported version "
+                    + toString((int)header.version) + " or byte order");
+        }
+
+        // the sizes are compared by subtraction, so corrupt values can not
+        // overflow the sums.
+        const uint64_t indexEnd = size - sizeof(footer);
+
+        if (header.numCols == 0 || header.chunkRows == 0
+                || header.headerSize < sizeof(header)
+                || footer.indexOffset > indexEnd
+                || footer.indexOffset % sizeof(uint64_t) != 0
+                || header.headerSize > footer.indexOffset
+                || footer.numChunks != (indexEnd - footer.indexOffset) / sizeof(uint64_t)
+                || (indexEnd - footer.indexOffset) % sizeof(uint64_t) != 0)
+        {
+            throw runtime_error(fileName + " is truncated or corrupt");
+        }
+
+        chunkOffsets = (const uint64_t*)(data + footer.indexOffset);
+
+        const char* p = data + sizeof(header);
+        const char* namesEnd = data + header.headerSize;
+        for (unsigned i = 0; i < header.numCols; ++i)
+        {
+            uint32_t len;
+            if ((uint64_t)(namesEnd - p) < sizeof(len))
+            {
+                throw runtime_error(fileName + " is truncated or corrupt");
+            }
+            memcpy(&len, p, sizeof(len));
+
+            if (len > (uint64_t)(namesEnd - p) - sizeof(len))
+            {
+                throw runtime_error(fileName + " is truncated or corrupt");
+            }
+            colNames.push_back(string(p + sizeof(len), len));
+            p += sizeof(len) + len + padding(sizeof(len) + len);
+        }
+
+        // every chunk, and every column of it, must lie between the header
+        // and the chunk index, so the accessors can use them unchecked.
+        uint64_t totalRows = 0;
+        for (uint64_t chunk = 0; chunk < footer.numChunks; ++chunk)
+        {
+            uint64_t offset = chunkOffsets[chunk];
+            if (offset < header.headerSize || offset > footer.indexOffset
+                    || footer.indexOffset - offset < sizeof(ColumnarChunkHeader))
+            {
+                throw runtime_error(fileName + " is truncated or corrupt");
+            }
+
+            ColumnarChunkHeader chunkHeader;
+            memcpy(&chunkHeader, data + offset, sizeof(chunkHeader));
+
+            if (memcmp(chunkHeader.magic, chunkMagic, sizeof(chunkMagic)) != 0
+                    || chunkHeader.rows == 0 || chunkHeader.rows > header.chunkRows)
+            {
+                throw runtime_error(fileName + " is truncated or corrupt");
+            }
+
+            offset += sizeof(chunkHeader);
+            for (unsigned col = 0; col < header.numCols; ++col)
+            {
+                uint64_t colSize;
+                if (footer.indexOffset - offset < sizeof(colSize))
+                {
+                    throw runtime_error(fileName + " is truncated or corrupt");
+                }
+                memcpy(&colSize, data + offset, sizeof(colSize));
+                offset += sizeof(colSize);
+
+                if (colSize > footer.indexOffset - offset || (!isCompressed()
+                        && colSize != chunkHeader.rows * sizeof(double)))
+                {
+                    throw runtime_error(fileName + " is truncated or corrupt");
+                }
+                offset += colSize;
+                offset += std::min(padding(colSize), footer.indexOffset - offset);
+            }
+
+            totalRows += chunkHeader.rows;
+        }
+
+        if (totalRows != footer.numRows)
+        {
+            throw runtime_error(fileName + " is truncated or corrupt");
+        }
+    }
+    catch (...)
+    {
+        delete mem;
+        throw;
+    }
+}
+
+ColumnarDataReader::~ColumnarDataReader()
+{
+    delete mem;
+}
+
+const std::vector<std::string>& ColumnarDataReader::getColumnNames() const
+{
+    return colNames;
+}
+
+int ColumnarDataReader::getColumnIndex(const std::string& name) const
+{
+    for (unsigned i = 0; i < colNames.size(); ++i)
+    {
+        if (colNames[i] == name)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+unsigned ColumnarDataReader::getNumCols() const
+{
+    return header.numCols;
+}
+
+uint64_t ColumnarDataReader::getNumRows() const
+{
+    return footer.numRows;
+}
+
+unsigned ColumnarDataReader::getNumChunks() const
+{
+    return footer.numChunks;
+}
+
+unsigned ColumnarDataReader::getChunkRows(unsigned chunk) const
+{
+    if (chunk >= footer.numChunks)
+    {
+        throw out_of_range("chunk index " + toString((int)chunk) + " out of range");
+    }
+
+    const ColumnarChunkHeader* chunkHeader =
+            (const ColumnarChunkHeader*)(data + chunkOffsets[chunk]);
+    return chunkHeader->rows;
+}
+
+bool ColumnarDataReader::isCompressed() const
+{
+    return (header.flags & compressedFlag) != 0;
+}
+
+const char* ColumnarDataReader::chunkColumnData(unsigned chunk, unsigned col,
+        uint64_t& colSize) const
+{
+    if (col >= header.numCols)
+    {
+        throw out_of_range("column index " + toString((int)col) + " out of range");
+    }
+
+    // validates chunk index
+    getChunkRows(chunk);
+
+    const char* p = data + chunkOffsets[chunk] + sizeof(ColumnarChunkHeader);
+
+    for (unsigned i = 0; i <= col; ++i)
+    {
+        memcpy(&colSize, p, sizeof(colSize));
+        p += sizeof(colSize);
+
+        if (p + colSize > data + size)
+        {
+            throw runtime_error(fileName + " is truncated or corrupt");
+        }
+
+        if (i < col)
+        {
+            p += colSize + padding(colSize);
+        }
+    }
+
+    return p;
+}
+
+const double* ColumnarDataReader::getChunkColumn(unsigned chunk,
+        unsigned col) const
+{
+    if (isCompressed())
+    {
+        throw logic_error("can not access compressed data in place, "
+                "use readColumn or readRows");
+    }
+
+    uint64_t colSize;
+    const char* p = chunkColumnData(chunk, col, colSize);
+
+    if (colSize != getChunkRows(chunk) * sizeof(double))
+    {
+        throw runtime_error(fileName + " is truncated or corrupt");
+    }
+
+    return (const double*)p;
+}
+
+void ColumnarDataReader::readChunkColumn(unsigned chunk, unsigned col,
+        double* dst, unsigned stride) const
+{
+    unsigned rows = getChunkRows(chunk);
+    uint64_t colSize;
+    const char* src = chunkColumnData(chunk, col, colSize);
+
+    vector<double> inflated;
+
+    if (isCompressed())
+    {
+        inflated.resize(rows);
+        istringstream ss(string(src, colSize), ios::in | ios::binary);
+        Poco::InflatingInputStream inflater(ss,
+                Poco::InflatingStreamBuf::STREAM_ZLIB);
+        inflater.read((char*)&inflated[0], rows * sizeof(double));
+
+        if (inflater.gcount() != rows * sizeof(double))
+        {
+            throw runtime_error(fileName + " has corrupt compressed data");
+        }
+        src = (const char*)&inflated[0];
+    }
+    else if (colSize != rows * sizeof(double))
+    {
+        throw runtime_error(fileName + " is truncated or corrupt");
+    }
+
+    const double* values = (const double*)src;
+    for (unsigned i = 0; i < rows; ++i)
+    {
+        dst[i * stride] = values[i];
+    }
+}
+
+void ColumnarDataReader::readColumn(unsigned col, double* values) const
+{
+    for (unsigned chunk = 0; chunk < footer.numChunks; ++chunk)
+    {
+        readChunkColumn(chunk, col, values, 1);
+        values += getChunkRows(chunk);
+    }
+}
+
+void ColumnarDataReader::readRows(double* values) const
+{
+    const unsigned numCols = header.numCols;
+
+    for (unsigned chunk = 0; chunk < footer.numChunks; ++chunk)
+    {
+        for (unsigned col = 0; col < numCols; ++col)
+        {
+            readChunkColumn(chunk, col, values + col, numCols);
+        }
+        values += (size_t)getChunkRows(chunk) * numCols;
+    }
+}
+
+}
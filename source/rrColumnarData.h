@@ -0,0 +1,235 @@
+/*
+ * rrColumnarData.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef RRCOLUMNARDATA_H_
+#define RRCOLUMNARDATA_H_
+
+#include "rrExporter.h"
+#include <string>
+#include <vector>
+#include <fstream>
+#include <stdint.h>
+
+namespace Poco
+{
+class SharedMemory;
+}
+
+namespace rr
+{
+
+/**
+ * @internal
+ * on disk layout of the binary columnar result format.
+ *
+ * All values are stored in the native byte order, the header records
+ * an endian marker so a reader can reject a file from a different
+ * architecture. Every block is padded to 8 bytes so that uncompressed
+ * column data can be used in place from a memory mapped file.
+ *
+ * file:
+ *     ColumnarFileHeader
+ *     column names, for each: uint32 length, chars, padded to 8 bytes.
+ *     chunks...
+ *     chunk index: uint64 file offset of each chunk
+ *     ColumnarFileFooter
+ *
+ * chunk:
+ *     ColumnarChunkHeader
+ *     for each column: uint64 byte size, data padded to 8 bytes.
+ *     The data is rows doubles, or the zlib deflated doubles if the
+ *     file is compressed.
+ */
+struct ColumnarFileHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t endian;
+    uint32_t numCols;
+    uint32_t chunkRows;
+    uint32_t flags;
+    uint64_t headerSize;
+};
+
+struct ColumnarChunkHeader
+{
+    char magic[4];
+    uint32_t rows;
+    uint64_t reserved;
+};
+
+struct ColumnarFileFooter
+{
+    uint64_t numRows;
+    uint64_t numChunks;
+    uint64_t indexOffset;
+    char magic[8];
+};
+
+/**
+ * Writes tabular (i.e. simulation result) data to the binary columnar
+ * format.
+ *
+ * Rows are buffered until a chunk is full, then the chunk is written
+ * column by column, so rows can be written one at a time as they are
+ * produced, i.e. from inside a simulation loop, with bounded memory.
+ */
+class RR_DECLSPEC ColumnarDataWriter
+{
+public:
+
+    /**
+     * default file extension for the binary columnar format.
+     */
+    static const char* fileExtension;
+
+    /**
+     * open a file for writing.
+     *
+     * @param fileName: the file to write, will be overwritten.
+     * @param colNames: the column names, determines the number of columns,
+     *        which must be at least one.
+     * @param chunkRows: number of rows per chunk.
+     * @param compress: zlib compress each column of each chunk. Compressed
+     *        files can not be read in place (zero copy).
+     * @throws std::invalid_argument if there are no columns.
+     * @throws std::runtime_error if the file can not be opened.
+     */
+    ColumnarDataWriter(const std::string& fileName,
+            const std::vector<std::string>& colNames,
+            unsigned chunkRows = 4096, bool compress = false);
+
+    /**
+     * closes the file if it is not already closed.
+     */
+    ~ColumnarDataWriter();
+
+    /**
+     * write a single row, must have a value for each column.
+     */
+    void writeRow(const double* row);
+
+    /**
+     * write a number of rows from a C (row major) ordered buffer.
+     */
+    void writeRows(const double* rows, unsigned numRows);
+
+    /**
+     * flushes any buffered rows, and writes the chunk index. No more
+     * rows can be written after the file is closed.
+     */
+    void close();
+
+    /**
+     * total number of rows written so far.
+     */
+    uint64_t getNumRows() const;
+
+private:
+    void writeChunk();
+
+    std::ofstream out;
+    std::string fileName;
+    std::vector<std::string> colNames;
+    unsigned chunkRows;
+    bool compress;
+
+    /**
+     * rows of the current chunk, row major.
+     */
+    std::vector<double> chunk;
+    unsigned chunkFill;
+    std::vector<uint64_t> chunkOffsets;
+    uint64_t numRows;
+    bool closed;
+};
+
+
+/**
+ * Reads a binary columnar file.
+ *
+ * The file is memory mapped, so opening even a very large file is cheap,
+ * and for uncompressed files, column data is accessed in place without
+ * any copy or parsing.
+ */
+class RR_DECLSPEC ColumnarDataReader
+{
+public:
+
+    /**
+     * open and map a file. The chunk index, and the size of every chunk
+     * and column, are checked against the size of the file.
+     *
+     * @throws std::runtime_error if the file is not a valid columnar file.
+     */
+    ColumnarDataReader(const std::string& fileName);
+
+    ~ColumnarDataReader();
+
+    const std::vector<std::string>& getColumnNames() const;
+
+    /**
+     * index of the named column, -1 if not found.
+     */
+    int getColumnIndex(const std::string& name) const;
+
+    unsigned getNumCols() const;
+
+    uint64_t getNumRows() const;
+
+    unsigned getNumChunks() const;
+
+    /**
+     * number of rows in the given chunk.
+     */
+    unsigned getChunkRows(unsigned chunk) const;
+
+    bool isCompressed() const;
+
+    /**
+     * pointer to the data of a column in a chunk, directly in the mapped
+     * file. Only available for uncompressed files, the pointer is valid for
+     * the life time of this reader.
+     *
+     * @throws std::logic_error if the file is compressed.
+     */
+    const double* getChunkColumn(unsigned chunk, unsigned col) const;
+
+    /**
+     * copy (decompressing if needed) a complete column into the given
+     * buffer, which must have getNumRows() elements.
+     */
+    void readColumn(unsigned col, double* values) const;
+
+    /**
+     * copy all of the data into a C (row major) ordered buffer, which
+     * must have getNumRows() * getNumCols() elements.
+     */
+    void readRows(double* values) const;
+
+private:
+    /**
+     * read a column of a chunk into dst with the given stride.
+     */
+    void readChunkColumn(unsigned chunk, unsigned col, double* dst,
+            unsigned stride) const;
+
+    const char* chunkColumnData(unsigned chunk, unsigned col,
+            uint64_t& size) const;
+
+    std::string fileName;
+    Poco::SharedMemory *mem;
+    const char* data;
+    size_t size;
+    ColumnarFileHeader header;
+    ColumnarFileFooter footer;
+    std::vector<std::string> colNames;
+    const uint64_t* chunkOffsets;
+};
+
+}
+
+#endif /* RRCOLUMNARDATA_H_ */
@@ -127,7 +127,12 @@ static Variant values[] =  {
     Variant(true),      // LLVM_SYMBOL_CACHE
     Variant(true),      // OPTIMIZE_REACTION_RATE_SELECTION
     Variant(true),     // LOADSBMLOPTIONS_PERMISSIVE
-    Variant(20000)      // MAX_OUTPUT_ROWS
+    Variant(20000),     // MAX_OUTPUT_ROWS
+    Variant(8),         // LLVM_PIECEWISE_TABLE_MIN_SIZE
+    Variant(0),         // LLVM_MODEL_CACHE_SIZE
+    Variant(0),         // LOADSBMLOPTIONS_OPTIMIZE_LEVEL
+    Variant(false),     // LOADSBMLOPTIONS_FAST_MATH
+    Variant(std::string(""))  // LLVM_TARGET_CPU
     // add space after develop keys to clean up merging
 
 
@@ -229,6 +234,11 @@ static void getKeyNames(StringIntMap& keys)
     keys["OPTIMIZE_REACTION_RATE_SELECTION"] = rr::Config::OPTIMIZE_REACTION_RATE_SELECTION;
     keys["LOADSBMLOPTIONS_PERMISSIVE"] = rr::Config::LOADSBMLOPTIONS_PERMISSIVE;
     keys["MAX_OUTPUT_ROWS"] = rr::Config::MAX_OUTPUT_ROWS;
+    keys["LLVM_PIECEWISE_TABLE_MIN_SIZE"] = rr::Config::LLVM_PIECEWISE_TABLE_MIN_SIZE;
+    keys["LLVM_MODEL_CACHE_SIZE"] = rr::Config::LLVM_MODEL_CACHE_SIZE;
+    keys["LOADSBMLOPTIONS_OPTIMIZE_LEVEL"] = rr::Config::LOADSBMLOPTIONS_OPTIMIZE_LEVEL;
+    keys["LOADSBMLOPTIONS_FAST_MATH"] = rr::Config::LOADSBMLOPTIONS_FAST_MATH;
+    keys["LLVM_TARGET_CPU"] = rr::Config::LLVM_TARGET_CPU;
 
 
 
@@ -547,6 +557,16 @@ Config::Keys Config::stringToKey(const std::string& key) {
         return Config::LOADSBMLOPTIONS_PERMISSIVE;
     else if (key == "MAX_OUTPUT_ROWS")
         return Config::MAX_OUTPUT_ROWS;
+    else if (key == "LLVM_PIECEWISE_TABLE_MIN_SIZE")
+        return Config::LLVM_PIECEWISE_TABLE_MIN_SIZE;
+    else if (key == "LLVM_MODEL_CACHE_SIZE")
+        return Config::LLVM_MODEL_CACHE_SIZE;
+    else if (key == "LOADSBMLOPTIONS_OPTIMIZE_LEVEL")
+        return Config::LOADSBMLOPTIONS_OPTIMIZE_LEVEL;
+    else if (key == "LOADSBMLOPTIONS_FAST_MATH")
+        return Config::LOADSBMLOPTIONS_FAST_MATH;
+    else if (key == "LLVM_TARGET_CPU")
+        return Config::LLVM_TARGET_CPU;
     else
         throw std::runtime_error("No such config key: '" + key + "'");
 }
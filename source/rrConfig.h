@@ -455,6 +455,49 @@ public:
          */
         MAX_OUTPUT_ROWS,
 
+        /**
+         * piecewise functions of time or of a single variable, with at
+         * least this many pieces, with constant or linear pieces and sorted
+         * thresholds or intervals, are compiled into a table lookup with a
+         * binary search, or direct indexing on a uniform grid, rather than
+         * a chain of comparisons. Zero disables the table lookup.
+         */
+        LLVM_PIECEWISE_TABLE_MIN_SIZE,
+
+        /**
+         * size in megabytes of the compiled model cache. Compiled models are
+         * always shared whilst in use, this many megabytes of the most
+         * recently used ones are also kept after the last RoadRunner using
+         * them is gone, so loading them again does not recompile them. The
+         * least recently used are released first. Zero only shares models
+         * whilst they are in use. The size of a model is its machine code
+         * plus an estimate of its IR and symbols, so the bound is approximate.
+         */
+        LLVM_MODEL_CACHE_SIZE,
+
+        /**
+         * optimization level preset of the generated code, 0 for the
+         * individual LOADSBMLOPTIONS_OPTIMIZE_* passes, 2 or 3 for the
+         * function level part of the -O2 or -O3 pipeline, including the
+         * vectorizers.
+         */
+        LOADSBMLOPTIONS_OPTIMIZE_LEVEL,
+
+        /**
+         * allow fast math, re-association and fused multiply adds, in the
+         * kinetic laws and rate rules.
+         */
+        LOADSBMLOPTIONS_FAST_MATH,
+
+        /**
+         * the CPU the generated code is compiled for, empty for the generic
+         * CPU of the host architecture, "host" for the CPU and features of
+         * this machine, i.e. AVX and FMA, or an LLVM CPU name such as
+         * "corei7-avx". Code compiled for a CPU may not run on another,
+         * exported models record it and are only loaded on a matching CPU.
+         */
+        LLVM_TARGET_CPU,
+
 
         // add lots of space so not to conflict with other branches.
 
@@ -3,9 +3,14 @@
 #include <string.h>
 #include "rrExecutableModel.h"
 #include "rrSparse.h"
+#include "rrSparseMatrix.h"
+#include <Poco/Mutex.h>
+#include <stdexcept>
+#include <algorithm>
 #include <iomanip>
 
 using namespace std;
+using Poco::Mutex;
 
 template <typename numeric_type>
 static void dump_array(std::ostream &os, int n, const numeric_type *p)
@@ -102,6 +107,202 @@ std::ostream& operator <<(std::ostream &stream, ExecutableModel* model)
     return stream;
 }
 
+void ExecutableModel::getSparseStoichiometryMatrix(SparseMatrix& mat)
+{
+    int rows = 0;
+    int cols = 0;
+    double* data = 0;
+
+    getStoichiometryMatrix(&rows, &cols, &data);
+
+    mat = SparseMatrix::fromDense(rows, cols, data);
+
+    free(data);
+}
+
+static Mutex serialMutex;
+static unsigned long lastSerial = 0;
+
+ExecutableModel::ExecutableModel()
+{
+    Mutex::ScopedLock lock(serialMutex);
+    serial = ++lastSerial;
+}
+
+unsigned long ExecutableModel::getSerial() const
+{
+    return serial;
+}
+
+ValueHandle ExecutableModel::createValueHandle(const std::vector<std::string>& ids)
+{
+    ValueHandle handle(this);
+    for (unsigned i = 0; i < ids.size(); ++i)
+    {
+        handle.add(ids[i], SelectionRecord::UNKNOWN, -1);
+    }
+    return handle;
+}
+
+static void checkValueHandle(const ExecutableModel* model, const ValueHandle& handle)
+{
+    // the serial catches a later model at the address of a deleted one.
+    if (handle.getModel() != model || handle.getModelSerial() != model->getSerial())
+    {
+        throw std::invalid_argument("the value handle was not created for this model");
+    }
+}
+
+void ExecutableModel::getIndexedValues(const ValueHandle& handle, double* values)
+{
+    checkValueHandle(this, handle);
+
+    const std::vector<std::string>& ids = handle.getIds();
+    const std::vector<ValueHandle::Group>& groups = handle.getGroups();
+    std::vector<double> buffer;
+
+    for (std::vector<ValueHandle::Group>::const_iterator g = groups.begin();
+            g != groups.end(); ++g)
+    {
+        const int len = g->positions.size();
+
+        if (g->type != SelectionRecord::UNKNOWN)
+        {
+            buffer.resize(len);
+            if (getValueGroup(g->type, len, &g->indices[0], &buffer[0]))
+            {
+                for (int i = 0; i < len; ++i)
+                {
+                    values[g->positions[i]] = buffer[i];
+                }
+                continue;
+            }
+        }
+
+        for (int i = 0; i < len; ++i)
+        {
+            values[g->positions[i]] = getValue(ids[g->positions[i]]);
+        }
+    }
+}
+
+void ExecutableModel::setIndexedValues(const ValueHandle& handle, const double* values)
+{
+    checkValueHandle(this, handle);
+
+    const std::vector<std::string>& ids = handle.getIds();
+    const std::vector<ValueHandle::Group>& groups = handle.getGroups();
+    std::vector<double> buffer;
+
+    for (std::vector<ValueHandle::Group>::const_iterator g = groups.begin();
+            g != groups.end(); ++g)
+    {
+        const int len = g->positions.size();
+
+        if (g->type != SelectionRecord::UNKNOWN)
+        {
+            buffer.resize(len);
+            for (int i = 0; i < len; ++i)
+            {
+                buffer[i] = values[g->positions[i]];
+            }
+
+            if (setValueGroup(g->type, len, &g->indices[0], &buffer[0]))
+            {
+                continue;
+            }
+        }
+
+        for (int i = 0; i < len; ++i)
+        {
+            setValue(ids[g->positions[i]], values[g->positions[i]]);
+        }
+    }
+}
+
+bool ExecutableModel::getValueGroup(SelectionRecord::SelectionType type,
+        int len, const int* indx, double* values)
+{
+    switch(type)
+    {
+    case SelectionRecord::TIME:
+        std::fill(values, values + len, getTime());
+        return true;
+    case SelectionRecord::FLOATING_AMOUNT:
+        getFloatingSpeciesAmounts(len, indx, values);
+        return true;
+    case SelectionRecord::BOUNDARY_AMOUNT:
+        getBoundarySpeciesAmounts(len, indx, values);
+        return true;
+    case SelectionRecord::COMPARTMENT:
+        getCompartmentVolumes(len, indx, values);
+        return true;
+    case SelectionRecord::GLOBAL_PARAMETER:
+        getGlobalParameterValues(len, indx, values);
+        return true;
+    case SelectionRecord::REACTION_RATE:
+        getReactionRates(len, indx, values);
+        return true;
+    case SelectionRecord::FLOATING_CONCENTRATION:
+        getFloatingSpeciesConcentrations(len, indx, values);
+        return true;
+    case SelectionRecord::BOUNDARY_CONCENTRATION:
+        getBoundarySpeciesConcentrations(len, indx, values);
+        return true;
+    case SelectionRecord::FLOATING_AMOUNT_RATE:
+        getFloatingSpeciesAmountRates(len, indx, values);
+        return true;
+    case SelectionRecord::INITIAL_FLOATING_AMOUNT:
+        getFloatingSpeciesInitAmounts(len, indx, values);
+        return true;
+    case SelectionRecord::INITIAL_COMPARTMENT:
+        getCompartmentInitVolumes(len, indx, values);
+        return true;
+    case SelectionRecord::INITIAL_FLOATING_CONCENTRATION:
+        getFloatingSpeciesInitConcentrations(len, indx, values);
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool ExecutableModel::setValueGroup(SelectionRecord::SelectionType type,
+        int len, const int* indx, const double* values)
+{
+    switch(type)
+    {
+    case SelectionRecord::TIME:
+        setTime(values[len - 1]);
+        return true;
+    case SelectionRecord::FLOATING_AMOUNT:
+        setFloatingSpeciesAmounts(len, indx, values);
+        return true;
+    case SelectionRecord::COMPARTMENT:
+        setCompartmentVolumes(len, indx, values);
+        return true;
+    case SelectionRecord::GLOBAL_PARAMETER:
+        setGlobalParameterValues(len, indx, values);
+        return true;
+    case SelectionRecord::FLOATING_CONCENTRATION:
+        setFloatingSpeciesConcentrations(len, indx, values);
+        return true;
+    case SelectionRecord::BOUNDARY_CONCENTRATION:
+        setBoundarySpeciesConcentrations(len, indx, values);
+        return true;
+    case SelectionRecord::INITIAL_FLOATING_AMOUNT:
+        setFloatingSpeciesInitAmounts(len, indx, values);
+        return true;
+    case SelectionRecord::INITIAL_COMPARTMENT:
+        setCompartmentInitVolumes(len, indx, values);
+        return true;
+    case SelectionRecord::INITIAL_FLOATING_CONCENTRATION:
+        setFloatingSpeciesInitConcentrations(len, indx, values);
+        return true;
+    default:
+        return false;
+    }
+}
+
 
 
 
@@ -18,6 +18,7 @@
 
 # include "rrOSSpecifics.h"
 # include "rrException.h"
+# include "rrValueHandle.h"
 
 # include <stdint.h>
 # include <string>
@@ -33,6 +34,10 @@
 namespace rr
 {
 
+class PerfCounters;
+
+class SparseMatrix;
+
 class ExecutableModel;
 
 /**
@@ -435,6 +440,29 @@ public:
      */
     virtual void setValue(const std::string& id, double value) = 0;
 
+    /**
+     * resolve a list of ids, as accepted by getValue and setValue, once into
+     * a handle for getIndexedValues and setIndexedValues.
+     *
+     * The default implementation does not resolve anything, the values are
+     * then accessed one at a time by id, models which can look up the
+     * indices of the ids should override this.
+     */
+    virtual ValueHandle createValueHandle(const std::vector<std::string>& ids);
+
+    /**
+     * get the values of all the ids of a handle created by this model.
+     *
+     * @param[out] values must have room for handle.size() values.
+     */
+    virtual void getIndexedValues(const ValueHandle& handle, double* values);
+
+    /**
+     * set the values of all the ids of a handle created by this model, like
+     * setValue for each of them, but group by group, see ValueHandle.
+     */
+    virtual void setIndexedValues(const ValueHandle& handle, const double* values);
+
 
     /************************ End Selection Ids Species Section *******************/
     #endif /***********************************************************************/
@@ -452,6 +480,18 @@ public:
      */
     virtual int getStoichiometryMatrix(int* rows, int* cols, double** data) = 0;
 
+    /**
+     * get the stoichiometry matrix in compressed sparse row format, without
+     * creating the dense matrix. The rows are the floating species and the
+     * columns the reactions, the same as getStoichiometryMatrix.
+     *
+     * The default implementation compresses the dense matrix, models which
+     * store the stoichiometry sparse should override this.
+     *
+     * @param[out] mat is replaced with the stoichiometry matrix.
+     */
+    virtual void getSparseStoichiometryMatrix(SparseMatrix& mat);
+
     /**
      * Get the current stiochiometry value for the given species / reaction.
      *
@@ -567,6 +607,32 @@ public:
      */
     virtual void getStateVectorRate(double time, const double *y, double* dydt=0) = 0;
 
+    /**
+     * get the structural sparsity pattern of the Jacobian of the state
+     * vector rate, d(dydt)/dy. Solvers use this to compute finite difference
+     * Jacobians with one model evaluation per group of structurally
+     * independent columns instead of one per column.
+     *
+     * @param[out] cols for each state vector element (column), the sorted
+     *         indices of the state vector rates (rows) which may depend on it.
+     * @return true if the pattern is known, false if the Jacobian must be
+     *         treated as dense.
+     */
+    virtual bool getStateVectorJacobianPattern(std::vector<std::vector<unsigned> >& cols) {
+        return false;
+    }
+
+    /**
+     * the performance counters of this model, which the model, its solvers
+     * and RoadRunner record into, see PerfCounters.
+     *
+     * @return a borrowed reference owned by the model, or null if the model
+     *         does not keep counters.
+     */
+    virtual PerfCounters* getPerfCounters() {
+        return 0;
+    }
+
     virtual void testConstraints() = 0;
 
     virtual std::string getInfo() = 0;
@@ -636,6 +702,15 @@ public:
      */
     virtual ~ExecutableModel() {};
 
+    ExecutableModel();
+
+    /**
+     * a number which identifies this model object, unique for the life of
+     * the process. Unlike the address of the object, it is never reused for
+     * a later model, i.e. one loaded by the same RoadRunner.
+     */
+    unsigned long getSerial() const;
+
     /******************************* Events Section *******************************/
      #endif /**********************************************************************/
     /******************************************************************************/
@@ -691,6 +766,19 @@ public:
      */
     virtual double getRandom() = 0;
 
+    /**
+     * set the replicate number used by the RNG. Copies of a model with the
+     * same seed but different replicate numbers draw from independent
+     * random sequences, so replicates can be run in parallel and any one
+     * of them reproduced by itself. This will reset the RNG.
+     */
+    virtual void setRandomReplicate(uint32_t) {};
+
+    /**
+     * get the replicate number used by the RNG.
+     */
+    virtual uint32_t getRandomReplicate() { return 0; };
+
     /**
      * Get the current set of flags
      */
@@ -725,6 +813,20 @@ public:
 
 protected:
 
+    /**
+     * get the values of one group of a ValueHandle with the indexed accessor
+     * for its type. Returns false if there is none, the values are then
+     * read by id. Models with more accessors than this interface extend it.
+     */
+    virtual bool getValueGroup(SelectionRecord::SelectionType type, int len,
+            const int* indx, double* values);
+
+    /**
+     * set the values of one group of a ValueHandle, like getValueGroup.
+     */
+    virtual bool setValueGroup(SelectionRecord::SelectionType type, int len,
+            const int* indx, const double* values);
+
     /**
      * is integration is currently proceeding.
      */
@@ -738,7 +840,8 @@ protected:
         setFlags(flags);
     }
 
-
+private:
+    unsigned long serial;
 };
 
 
@@ -8,10 +8,13 @@
 #include "rrUtils.h"
 #include "rrException.h"
 #include "rrConfig.h"
+#include "rrPerfCounters.h"
 
 #include <Poco/Mutex.h>
 #include <assert.h>
 #include <math.h>
+#include <limits>
+#include <algorithm>
 
 namespace rr
 {
@@ -23,6 +26,10 @@ namespace rr
 // may use the nleq steady state.
 static ExecutableModel* callbackModel = NULL;
 
+// colouring for the Jacobian callback, only set while solving with a
+// coloured Jacobian.
+static const JacobianColoring* callbackColoring = NULL;
+
 // mutex to ensure only one thead
 using Poco::Mutex;
 static Mutex mutex;
@@ -30,6 +37,9 @@ static Mutex mutex;
 // the NLEQ callback, we use same data types as f2c here.
 static void ModelFunction(int* nx, double* y, double* fval, int* pErr);
 
+// the NLEQ Jacobian callback
+static void ModelJacobian(int* nx, int* ldjac, double* y, double* dfdx, int* pErr);
+
 static string ErrorForStatus(int error);
 
 static bool isError(int e)
@@ -54,6 +64,7 @@ NLEQInterface::NLEQInterface(ExecutableModel *_model) :
     ierr(0),
     iopt(0),
     model(0),
+    useColoredJacobian(false),
     nOpts(50),
     maxIterations(Config::getInt(Config::STEADYSTATE_MAXIMUM_NUM_STEPS)),
     relativeTolerance(Config::getDouble(Config::STEADYSTATE_RELATIVE)),
@@ -117,6 +128,16 @@ void NLEQInterface::setup()
     }
 
     RWK[22 - 1] = minDamping; // Minimal allowed damping factor
+
+    std::vector<std::vector<unsigned> > pattern;
+    if (n > 0 && model->getStateVectorJacobianPattern(pattern))
+    {
+        jacobianColoring = JacobianColoring(n, pattern);
+        useColoredJacobian = jacobianColoring.getNumColors() < n;
+
+        Log(Logger::LOG_DEBUG) << "NLEQInterface: Jacobian colours: "
+                << jacobianColoring.getNumColors() << ", state vector size: " << n;
+    }
 }
 
 bool NLEQInterface::isAvailable()
@@ -159,6 +180,11 @@ double NLEQInterface::solve()
 
     iopt[31 - 1] = 3; // Set for Highly nonlinear problem
 
+    if (useColoredJacobian)
+    {
+        iopt[3 - 1] = 1; // Jacobian supplied by ModelJacobian
+    }
+
     // Initialise all array elements to 0.0
     for (int i = 0; i < LIWK; i++)
     {
@@ -188,12 +214,13 @@ double NLEQInterface::solve()
     try
     {
         callbackModel = model;
+        callbackColoring = useColoredJacobian ? &jacobianColoring : NULL;
         vector<double> stateVector(n);
         model->getStateVector(&stateVector[0]);
 
         NLEQ1(  &n,
                 &ModelFunction,
-                NULL,
+                useColoredJacobian ? &ModelJacobian : NULL,
                 &stateVector[0],
                 XScal,
                 &tmpTol,
@@ -206,14 +233,23 @@ double NLEQInterface::solve()
 
         // done, clear it.
         callbackModel = NULL;
+        callbackColoring = NULL;
     }
     catch(...)
     {
         // clear the global model and re-throw the exception.
         callbackModel = NULL;
+        callbackColoring = NULL;
         throw;
     }
 
+    RR_PERF_ONLY(PerfCounters* counters = model->getPerfCounters());
+    RR_PERF_SET(counters, STEADY_STATE_ITERATIONS, getNumberOfNewtonIterations());
+    RR_PERF_SET(counters, STEADY_STATE_MODEL_EVALS, getNumberOfModelEvaluations());
+    RR_PERF_SET(counters, STEADY_STATE_JACOBIAN_EVALS, getNumberOfJacobianEvaluations());
+    RR_PERF_SET(counters, STEADY_STATE_JACOBIAN_MODEL_EVALS,
+            getNumberOfModelEvaluationsForJacobian());
+
     if (ierr == 2) // retry
     {
         for (int i = 0; i < nOpts; i++)
@@ -315,6 +351,69 @@ void ModelFunction(int* nx, double* y, double* fval, int* pErr)
     *pErr = 0;
 }
 
+/*     JAC(N,LDJAC,X,DFDX,IFAIL) Ext    Jacobian subroutine */
+/*       N              Int    Number of vector components (input) */
+/*       LDJAC          Int    Leading dimension of DFDX (input) */
+/*       X(N)           Dble   Vector of unknowns (input) */
+/*       DFDX(LDJAC,N)  Dble   Jacobian, column major (output) */
+/*       IFAIL          Int    JAC evaluation-failure indicator. (output) */
+
+void ModelJacobian(int* nx, int* ldjac, double* y, double* dfdx, int* pErr)
+{
+    ExecutableModel* model = callbackModel;
+    const JacobianColoring* coloring = callbackColoring;
+    assert(model && coloring && "model or coloring is NULL");
+
+    const int n = *nx;
+    const double ajdel = sqrt(10.0 * std::numeric_limits<double>::epsilon());
+
+    vector<double> f0(n);
+    vector<double> f1(n);
+    vector<double> saved(n);
+
+    model->getStateVectorRate(0, y, &f0[0]);
+
+    for (int j = 0; j < n; ++j)
+    {
+        for (int i = 0; i < *ldjac; ++i)
+        {
+            dfdx[j * (*ldjac) + i] = 0;
+        }
+    }
+
+    // forward differences, same increment as the NLEQ numerical Jacobian,
+    // all columns of a colour perturbed at once.
+    for (unsigned c = 0; c < coloring->getNumColors(); ++c)
+    {
+        const std::vector<unsigned>& cols = coloring->getColorColumns(c);
+
+        for (unsigned i = 0; i < cols.size(); ++i)
+        {
+            unsigned j = cols[i];
+            double u = std::max(fabs(y[j]), 1.0);
+            saved[j] = y[j];
+            y[j] += ajdel * (y[j] < 0 ? -u : u);
+        }
+
+        model->getStateVectorRate(0, y, &f1[0]);
+
+        for (unsigned i = 0; i < cols.size(); ++i)
+        {
+            unsigned j = cols[i];
+            double invDelta = 1.0 / (y[j] - saved[j]);
+            y[j] = saved[j];
+
+            const std::vector<unsigned>& rows = coloring->getColumnRows(j);
+            for (unsigned k = 0; k < rows.size(); ++k)
+            {
+                dfdx[j * (*ldjac) + rows[k]] = (f1[rows[k]] - f0[rows[k]]) * invDelta;
+            }
+        }
+    }
+
+    *pErr = 0;
+}
+
 void NLEQInterface::setScalingFactors(const vector<double>& sx)
 {
     for (int i = 0; i < n; i++)
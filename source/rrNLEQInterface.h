@@ -4,6 +4,7 @@
 #include "rrExporter.h"
 #include "rrExecutableModel.h"
 #include "rrSteadyStateSolver.h"
+#include "rrSparse.h"
 using std::vector;
 
 namespace rr
@@ -80,6 +81,14 @@ private:
     long n;
     void setup();
 
+    /**
+     * column colouring of the state vector Jacobian, if the model has a
+     * sparse structure, the Jacobian is computed by colour instead of
+     * letting NLEQ perturb every column.
+     */
+    JacobianColoring jacobianColoring;
+    bool useColoredJacobian;
+
     bool isAvailable();
 
     int maxIterations;
@@ -0,0 +1,1158 @@
+/*
+ * rrParameterEstimation.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+#pragma hdrstop
+#include "rrParameterEstimation.h"
+#include "rrRoadRunner.h"
+#include "rrRoadRunnerData.h"
+#include "rrExecutableModel.h"
+#include "Integrator.h"
+#include "rrLogger.h"
+#include "rrConfig.h"
+#include "rrSelectionRecord.h"
+
+#include <Poco/Thread.h>
+#include <Poco/Runnable.h>
+#include <Poco/Mutex.h>
+#include <Poco/Environment.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <limits>
+#include <math.h>
+
+using namespace std;
+using Poco::Mutex;
+
+namespace rr
+{
+
+static const double inf = numeric_limits<double>::infinity();
+
+/**
+ * Levenberg-Marquardt gives up once the damping grows past this.
+ */
+static const double maxLambda = 1e10;
+
+struct ParameterEstimation::Experiment
+{
+    /**
+     * the measured selections, all the data columns except time.
+     */
+    vector<string> columns;
+    vector<double> times;
+
+    /**
+     * a row for each time, a column for each selection, missing values are
+     * NaN.
+     */
+    vector<vector<double> > data;
+    vector<vector<double> > weights;
+
+    vector<string> initialIds;
+    vector<double> initialValues;
+
+    /**
+     * where the residuals of this experiment start in the residual vector.
+     */
+    unsigned offset;
+};
+
+/**
+ * a simulation of one experiment with one parameter vector.
+ */
+struct EstimationJob
+{
+    const vector<double>* params;
+    unsigned experiment;
+    vector<double>* residuals;
+    unsigned index;
+};
+
+/**
+ * state shared by the workers while evaluating a set of jobs.
+ */
+struct EvaluateState
+{
+    const vector<EstimationJob>* jobs;
+    unsigned next;
+
+    /**
+     * indices of the parameter vectors for which a simulation failed.
+     */
+    vector<unsigned> failed;
+    Mutex mutex;
+};
+
+/**
+ * each worker has its own copy of the model, and takes jobs from the shared
+ * state until they are all done.
+ */
+struct ParameterEstimation::Worker : public Poco::Runnable
+{
+    Worker(const ParameterEstimation& pe) :
+        state(0), parameterIds(pe.parameterIds), experiments(pe.experiments)
+    {
+        rr.setConservedMoietyAnalysis(pe.conservedMoieties);
+        rr.load(pe.sbml);
+        rr.setIntegrator(pe.integratorName);
+
+        Integrator* integrator = rr.getIntegrator();
+        for (unsigned i = 0; i < pe.integratorSettings.size(); ++i)
+        {
+            integrator->setValue(pe.integratorSettings[i].first,
+                    pe.integratorSettings[i].second);
+        }
+
+        // the data times are the output times.
+        if (integrator->hasValue("variable_step_size"))
+        {
+            integrator->setValue("variable_step_size", false);
+        }
+
+        for (unsigned i = 0; i < parameterIds.size(); ++i)
+        {
+            initIds.push_back("init(" + parameterIds[i] + ")");
+        }
+
+        selections.resize(experiments.size());
+        for (unsigned i = 0; i < experiments.size(); ++i)
+        {
+            const vector<string>& columns = experiments[i]->columns;
+            for (unsigned j = 0; j < columns.size(); ++j)
+            {
+                selections[i].push_back(rr.createSelection(columns[j]));
+            }
+        }
+    }
+
+    virtual void run()
+    {
+        while (true)
+        {
+            unsigned index;
+            {
+                Mutex::ScopedLock lock(state->mutex);
+                index = state->next++;
+            }
+
+            if (index >= state->jobs->size())
+            {
+                return;
+            }
+
+            const EstimationJob& job = (*state->jobs)[index];
+            if (!simulate(job))
+            {
+                Mutex::ScopedLock lock(state->mutex);
+                state->failed.push_back(job.index);
+            }
+        }
+    }
+
+    /**
+     * simulate the experiment of the job and write its residuals, each job
+     * has its own range of the residual vector.
+     */
+    bool simulate(const EstimationJob& job)
+    {
+        const Experiment& ex = *experiments[job.experiment];
+        const vector<SelectionRecord>& sel = selections[job.experiment];
+        const vector<double>& p = *job.params;
+        double* r = &(*job.residuals)[ex.offset];
+        ExecutableModel* model = rr.getModel();
+
+        try
+        {
+            // set the initial values of the parameters before the reset, so
+            // the initial assignments which depend on them are evaluated
+            // with the fitted values, then the current values, which the
+            // default reset leaves alone.
+            for (unsigned i = 0; i < p.size(); ++i)
+            {
+                model->setValue(initIds[i], p[i]);
+            }
+
+            model->reset(Config::getInt(Config::MODEL_RESET)
+                    | SelectionRecord::DEPENDENT_INITIAL_GLOBAL_PARAMETER);
+
+            for (unsigned i = 0; i < p.size(); ++i)
+            {
+                model->setValue(parameterIds[i], p[i]);
+            }
+
+            for (unsigned i = 0; i < ex.initialIds.size(); ++i)
+            {
+                model->setValue(ex.initialIds[i], ex.initialValues[i]);
+            }
+
+            Integrator* integrator = rr.getIntegrator();
+            integrator->restart(0);
+
+            double t = 0;
+            for (unsigned i = 0; i < ex.times.size(); ++i)
+            {
+                if (ex.times[i] > t)
+                {
+                    t = integrator->integrate(t, ex.times[i] - t);
+                }
+
+                for (unsigned j = 0; j < sel.size(); ++j, ++r)
+                {
+                    double d = ex.data[i][j];
+                    double w = ex.weights[i][j];
+
+                    if (d != d || w == 0)
+                    {
+                        *r = 0;
+                        continue;
+                    }
+
+                    double v = rr.getValue(sel[j]);
+                    if (v != v || fabs(v) == inf)
+                    {
+                        return false;
+                    }
+
+                    *r = w * (v - d);
+                }
+            }
+
+            return true;
+        }
+        catch (std::exception& e)
+        {
+            Log(Logger::LOG_DEBUG) << "parameter estimation simulation failed: "
+                    << e.what();
+            return false;
+        }
+    }
+
+    RoadRunner rr;
+    EvaluateState* state;
+    const vector<string>& parameterIds;
+    const vector<Experiment*>& experiments;
+
+    /**
+     * the 'init(...)' ids of the fitted parameters.
+     */
+    vector<string> initIds;
+
+    /**
+     * the measured selections of each experiment.
+     */
+    vector<vector<SelectionRecord> > selections;
+};
+
+/**
+ * solve A x = b for a symmetric positive definite A, row major n by n, by
+ * Cholesky factorization. The matrices here are the size of the number of
+ * parameters, so nothing fancy is needed. Returns false if A is not
+ * positive definite.
+ */
+static bool choleskySolve(unsigned n, vector<double> A, const vector<double>& b,
+        vector<double>& x)
+{
+    for (unsigned j = 0; j < n; ++j)
+    {
+        double d = A[j * n + j];
+        for (unsigned k = 0; k < j; ++k)
+        {
+            d -= A[j * n + k] * A[j * n + k];
+        }
+
+        if (!(d > 0))
+        {
+            return false;
+        }
+
+        A[j * n + j] = sqrt(d);
+
+        for (unsigned i = j + 1; i < n; ++i)
+        {
+            double s = A[i * n + j];
+            for (unsigned k = 0; k < j; ++k)
+            {
+                s -= A[i * n + k] * A[j * n + k];
+            }
+            A[i * n + j] = s / A[j * n + j];
+        }
+    }
+
+    x = b;
+
+    // L y = b
+    for (unsigned i = 0; i < n; ++i)
+    {
+        for (unsigned k = 0; k < i; ++k)
+        {
+            x[i] -= A[i * n + k] * x[k];
+        }
+        x[i] /= A[i * n + i];
+    }
+
+    // L^T x = y
+    for (unsigned i = n; i-- > 0;)
+    {
+        for (unsigned k = i + 1; k < n; ++k)
+        {
+            x[i] -= A[k * n + i] * x[k];
+        }
+        x[i] /= A[i * n + i];
+    }
+
+    return true;
+}
+
+/**
+ * J^T J and J^T r, row major.
+ */
+static void normalEquations(const ls::DoubleMatrix& J, const vector<double>& r,
+        vector<double>& JTJ, vector<double>& JTr)
+{
+    const unsigned m = J.RSize();
+    const unsigned n = J.CSize();
+
+    JTJ.assign(n * n, 0);
+    JTr.assign(n, 0);
+
+    for (unsigned k = 0; k < m; ++k)
+    {
+        for (unsigned i = 0; i < n; ++i)
+        {
+            double Jki = J(k, i);
+            if (Jki == 0)
+            {
+                continue;
+            }
+
+            JTr[i] += Jki * r[k];
+            for (unsigned j = 0; j <= i; ++j)
+            {
+                JTJ[i * n + j] += Jki * J(k, j);
+            }
+        }
+    }
+
+    for (unsigned i = 0; i < n; ++i)
+    {
+        for (unsigned j = 0; j < i; ++j)
+        {
+            JTJ[j * n + i] = JTJ[i * n + j];
+        }
+    }
+}
+
+static double sumOfSquares(const vector<double>& r)
+{
+    double s = 0;
+    for (unsigned i = 0; i < r.size(); ++i)
+    {
+        s += r[i] * r[i];
+    }
+    return s;
+}
+
+/**
+ * quantile of the standard normal distribution, P. J. Acklam's rational
+ * approximation, relative error below 1.2e-9.
+ */
+static double normalQuantile(double p)
+{
+    static const double a[] = { -3.969683028665376e+01, 2.209460984245205e+02,
+            -2.759285104469687e+02, 1.383577518672690e+02,
+            -3.066479806614716e+01, 2.506628277459239e+00 };
+    static const double b[] = { -5.447609879822406e+01, 1.615858368580409e+02,
+            -1.556989798598866e+02, 6.680131188771972e+01,
+            -1.328068155288572e+01 };
+    static const double c[] = { -7.784894002430293e-03, -3.223964580411365e-01,
+            -2.400758277161838e+00, -2.549732539343734e+00,
+            4.374664141464968e+00, 2.938163982698783e+00 };
+    static const double d[] = { 7.784695709041462e-03, 3.224671290700398e-01,
+            2.445134137142996e+00, 3.754408661907416e+00 };
+    static const double low = 0.02425;
+
+    if (p < low)
+    {
+        double q = sqrt(-2 * log(p));
+        return (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5])
+                / ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+    }
+
+    if (p > 1 - low)
+    {
+        double q = sqrt(-2 * log(1 - p));
+        return -(((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5])
+                / ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+    }
+
+    double q = p - 0.5;
+    double r = q * q;
+    return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q
+            / (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1);
+}
+
+/**
+ * quantile of Student's t distribution with dof degrees of freedom. The
+ * distribution has a closed form quantile for one and two degrees of
+ * freedom, where the expansion is poor, otherwise it is the Cornish-Fisher
+ * expansion about the normal quantile, good to a few digits for three or
+ * more degrees of freedom, which is plenty for a confidence interval.
+ */
+static double tQuantile(double p, double dof)
+{
+    static const double pi = 3.14159265358979323846;
+
+    if (dof == 1)
+    {
+        return tan(pi * (p - 0.5));
+    }
+
+    if (dof == 2)
+    {
+        return (2 * p - 1) / sqrt(2 * p * (1 - p));
+    }
+
+    double z = normalQuantile(p);
+    double z2 = z * z;
+    double z3 = z2 * z;
+    double z5 = z3 * z2;
+    double z7 = z5 * z2;
+    double z9 = z7 * z2;
+
+    double g1 = (z3 + z) / 4;
+    double g2 = (5 * z5 + 16 * z3 + 3 * z) / 96;
+    double g3 = (3 * z7 + 19 * z5 + 17 * z3 - 15 * z) / 384;
+    double g4 = (79 * z9 + 776 * z7 + 1482 * z5 - 1920 * z3 - 945 * z) / 92160;
+
+    return z + g1 / dof + g2 / (dof * dof) + g3 / (dof * dof * dof)
+            + g4 / (dof * dof * dof * dof);
+}
+
+
+ParameterEstimation::ParameterEstimation(RoadRunner* rr) :
+        conservedMoieties(rr->getConservedMoietyAnalysis()),
+        numResiduals(0),
+        numDataPoints(0),
+        method(LEVENBERG_MARQUARDT),
+        numThreads(Poco::Environment::processorCount()),
+        maxIterations(100),
+        tolerance(1e-8),
+        differenceStep(1e-4),
+        confidenceLevel(0.95),
+        chiSquare(0),
+        iterations(0)
+{
+    ExecutableModel* model = rr->getModel();
+
+    if (!model)
+    {
+        throw std::invalid_argument("parameter estimation requires a loaded model");
+    }
+
+    sbml = rr->getCurrentSBML();
+
+    Integrator* integrator = rr->getIntegrator();
+    integratorName = integrator->getName();
+
+    vector<string> keys = integrator->getSettings();
+    for (unsigned i = 0; i < keys.size(); ++i)
+    {
+        integratorSettings.push_back(make_pair(keys[i],
+                integrator->getValue(keys[i])));
+    }
+
+    for (int i = 0; i < model->getNumGlobalParameters(); ++i)
+    {
+        string id = model->getGlobalParameterId(i);
+        globalParameterIds.push_back(id);
+        globalParameterValues.push_back(model->getValue(id));
+    }
+}
+
+ParameterEstimation::~ParameterEstimation()
+{
+    deleteWorkers();
+
+    for (unsigned i = 0; i < experiments.size(); ++i)
+    {
+        delete experiments[i];
+    }
+}
+
+void ParameterEstimation::addParameter(const std::string& id)
+{
+    addParameter(id, -inf, inf);
+}
+
+void ParameterEstimation::addParameter(const std::string& id, double lo,
+        double hi)
+{
+    vector<string>::const_iterator i = find(globalParameterIds.begin(),
+            globalParameterIds.end(), id);
+
+    if (i == globalParameterIds.end())
+    {
+        throw std::invalid_argument(id + " is not a global parameter");
+    }
+
+    if (find(parameterIds.begin(), parameterIds.end(), id) != parameterIds.end())
+    {
+        throw std::invalid_argument(id + " is already fitted");
+    }
+
+    if (!(lo <= hi))
+    {
+        throw std::invalid_argument("invalid bounds for " + id);
+    }
+
+    parameterIds.push_back(id);
+    initialValues.push_back(globalParameterValues[i - globalParameterIds.begin()]);
+    lower.push_back(lo);
+    upper.push_back(hi);
+
+    deleteWorkers();
+}
+
+void ParameterEstimation::addExperiment(const std::string& fileName,
+        const std::vector<std::string>& initialIds,
+        const std::vector<double>& initialValues)
+{
+    RoadRunnerData file;
+
+    if (!file.readFrom(fileName))
+    {
+        throw std::invalid_argument("could not read experimental data from "
+                + fileName);
+    }
+
+    ls::DoubleMatrix data = file.getData();
+    data.setColNames(file.getColumnNames());
+
+    addExperiment(data, file.hasWeights() ? &file.getWeights() : 0,
+            initialIds, initialValues);
+}
+
+void ParameterEstimation::addExperiment(const ls::DoubleMatrix& data,
+        const ls::DoubleMatrix* weights,
+        const std::vector<std::string>& initialIds,
+        const std::vector<double>& initialValues)
+{
+    vector<string> names = data.getColNames();
+
+    if (names.size() != data.CSize())
+    {
+        throw std::invalid_argument("experimental data requires a name for each column");
+    }
+
+    if (weights && (weights->RSize() != data.RSize()
+            || weights->CSize() != data.CSize()))
+    {
+        throw std::invalid_argument("the weights must have the same size as the data");
+    }
+
+    if (initialIds.size() != initialValues.size())
+    {
+        throw std::invalid_argument("an initial value is required for each initial id");
+    }
+
+    unsigned timeCol = find(names.begin(), names.end(), "time") - names.begin();
+    if (timeCol == names.size())
+    {
+        throw std::invalid_argument("experimental data requires a time column");
+    }
+
+    Experiment* e = new Experiment();
+    e->initialIds = initialIds;
+    e->initialValues = initialValues;
+    e->offset = numResiduals;
+
+    for (unsigned j = 0; j < names.size(); ++j)
+    {
+        if (j != timeCol)
+        {
+            e->columns.push_back(names[j]);
+        }
+    }
+
+    unsigned points = 0;
+    for (unsigned i = 0; i < data.RSize(); ++i)
+    {
+        double t = data(i, timeCol);
+
+        if (!(t >= 0) || (e->times.size() && t < e->times.back()))
+        {
+            delete e;
+            throw std::invalid_argument("the times of experimental data must "
+                    "not be negative or decreasing");
+        }
+
+        e->times.push_back(t);
+        e->data.push_back(vector<double>());
+        e->weights.push_back(vector<double>());
+
+        for (unsigned j = 0; j < names.size(); ++j)
+        {
+            if (j == timeCol)
+            {
+                continue;
+            }
+
+            double d = data(i, j);
+            double w = weights ? (*weights)(i, j) : 1.0;
+
+            e->data.back().push_back(d);
+            e->weights.back().push_back(w);
+
+            if (d == d && w != 0)
+            {
+                ++points;
+            }
+        }
+    }
+
+    experiments.push_back(e);
+    numResiduals += e->times.size() * e->columns.size();
+    numDataPoints += points;
+
+    deleteWorkers();
+}
+
+void ParameterEstimation::setMethod(Method m)
+{
+    method = m;
+}
+
+void ParameterEstimation::setNumThreads(unsigned threads)
+{
+    numThreads = threads ? threads : 1;
+    deleteWorkers();
+}
+
+void ParameterEstimation::setMaxIterations(unsigned iter)
+{
+    maxIterations = iter;
+}
+
+void ParameterEstimation::setTolerance(double tol)
+{
+    tolerance = tol;
+}
+
+void ParameterEstimation::setDifferenceStep(double step)
+{
+    if (!(step > 0))
+    {
+        throw std::invalid_argument("the difference step must be positive");
+    }
+    differenceStep = step;
+}
+
+void ParameterEstimation::setConfidenceLevel(double level)
+{
+    if (!(level > 0 && level < 1))
+    {
+        throw std::invalid_argument("the confidence level must be between 0 and 1");
+    }
+    confidenceLevel = level;
+}
+
+ls::DoubleMatrix ParameterEstimation::fit()
+{
+    if (parameterIds.empty())
+    {
+        throw std::invalid_argument("parameter estimation requires at least one parameter");
+    }
+
+    if (numDataPoints == 0)
+    {
+        throw std::invalid_argument("parameter estimation requires experimental data");
+    }
+
+    createWorkers();
+
+    const unsigned n = parameterIds.size();
+    vector<double> p = initialValues;
+    clamp(p);
+
+    iterations = 0;
+    chiSquare = evaluate(p, residuals);
+
+    if (chiSquare == inf)
+    {
+        throw std::runtime_error("the experiments could not be simulated with "
+                "the initial parameter values");
+    }
+
+    if (method == NELDER_MEAD)
+    {
+        nelderMead(p);
+    }
+    else
+    {
+        levenbergMarquardt(p);
+    }
+
+    Log(Logger::LOG_INFORMATION) << "parameter estimation, chi square "
+            << chiSquare << " after " << iterations << " iterations";
+
+    // the Fisher information of the weighted residuals is J^T J, its inverse
+    // scaled by the residual variance estimates the covariance.
+    vector<double> JTJ, JTr;
+    normalEquations(jacobian(p, residuals), residuals, JTJ, JTr);
+
+    const double dof = numDataPoints > n ? numDataPoints - n : 0;
+    const double variance = dof > 0 ? chiSquare / dof : inf;
+
+    covariance = ls::DoubleMatrix(n, n);
+    covariance.setRowNames(parameterIds);
+    covariance.setColNames(parameterIds);
+
+    vector<double> unit(n), column(n);
+    for (unsigned j = 0; j < n; ++j)
+    {
+        unit.assign(n, 0);
+        unit[j] = 1;
+
+        if (!choleskySolve(n, JTJ, unit, column))
+        {
+            Log(Logger::LOG_WARNING) << "parameter estimation, the parameters "
+                    "are not identifiable from the data, the covariance is "
+                    "undefined";
+            column.assign(n, numeric_limits<double>::quiet_NaN());
+        }
+
+        for (unsigned i = 0; i < n; ++i)
+        {
+            covariance(i, j) = column[i] * variance;
+        }
+    }
+
+    const double t = dof > 0 ? tQuantile((1 + confidenceLevel) / 2, dof) : inf;
+
+    vector<string> names;
+    names.push_back("value");
+    names.push_back("standard_error");
+    names.push_back("lower");
+    names.push_back("upper");
+
+    ls::DoubleMatrix result(n, names.size());
+    result.setRowNames(parameterIds);
+    result.setColNames(names);
+
+    for (unsigned i = 0; i < n; ++i)
+    {
+        double se = sqrt(covariance(i, i));
+        result(i, 0) = p[i];
+        result(i, 1) = se;
+        result(i, 2) = p[i] - t * se;
+        result(i, 3) = p[i] + t * se;
+    }
+
+    return result;
+}
+
+double ParameterEstimation::getChiSquare() const
+{
+    return chiSquare;
+}
+
+double ParameterEstimation::getReducedChiSquare() const
+{
+    const unsigned n = parameterIds.size();
+    return numDataPoints > n ? chiSquare / (numDataPoints - n) : inf;
+}
+
+unsigned ParameterEstimation::getNumIterations() const
+{
+    return iterations;
+}
+
+ls::DoubleMatrix ParameterEstimation::getCovariance() const
+{
+    return covariance;
+}
+
+std::vector<double> ParameterEstimation::getResiduals() const
+{
+    return residuals;
+}
+
+void ParameterEstimation::createWorkers()
+{
+    while (workers.size() < numThreads)
+    {
+        workers.push_back(new Worker(*this));
+    }
+}
+
+void ParameterEstimation::deleteWorkers()
+{
+    for (unsigned i = 0; i < workers.size(); ++i)
+    {
+        delete workers[i];
+    }
+    workers.clear();
+}
+
+void ParameterEstimation::clamp(std::vector<double>& p) const
+{
+    for (unsigned i = 0; i < p.size(); ++i)
+    {
+        p[i] = max(lower[i], min(upper[i], p[i]));
+    }
+}
+
+std::vector<bool> ParameterEstimation::evaluate(
+        const std::vector<std::vector<double> >& params,
+        std::vector<std::vector<double> >& res)
+{
+    vector<EstimationJob> jobs;
+    res.resize(params.size());
+    for (unsigned i = 0; i < params.size(); ++i)
+    {
+        res[i].resize(numResiduals);
+        for (unsigned j = 0; j < experiments.size(); ++j)
+        {
+            EstimationJob job = { &params[i], j, &res[i], i };
+            jobs.push_back(job);
+        }
+    }
+
+    if (jobs.empty())
+    {
+        return vector<bool>(params.size(), true);
+    }
+
+    createWorkers();
+
+    EvaluateState state;
+    state.jobs = &jobs;
+    state.next = 0;
+
+    const unsigned count = min((unsigned)workers.size(), (unsigned)jobs.size());
+    for (unsigned i = 0; i < count; ++i)
+    {
+        workers[i]->state = &state;
+    }
+
+    // the first worker runs on this thread.
+    vector<Poco::Thread*> threads;
+    for (unsigned i = 1; i < count; ++i)
+    {
+        threads.push_back(new Poco::Thread());
+        threads.back()->start(*workers[i]);
+    }
+
+    workers[0]->run();
+
+    for (unsigned i = 0; i < threads.size(); ++i)
+    {
+        threads[i]->join();
+        delete threads[i];
+    }
+
+    vector<bool> ok(params.size(), true);
+    for (unsigned i = 0; i < state.failed.size(); ++i)
+    {
+        ok[state.failed[i]] = false;
+    }
+    return ok;
+}
+
+double ParameterEstimation::evaluate(const std::vector<double>& p,
+        std::vector<double>& r)
+{
+    vector<vector<double> > params(1, p);
+    vector<vector<double> > res;
+
+    if (!evaluate(params, res)[0])
+    {
+        return inf;
+    }
+
+    r.swap(res[0]);
+    return sumOfSquares(r);
+}
+
+ls::DoubleMatrix ParameterEstimation::jacobian(const std::vector<double>& p,
+        const std::vector<double>& r)
+{
+    const unsigned n = p.size();
+
+    // a forward step for each parameter, backwards at an upper bound.
+    vector<vector<double> > params(n, p);
+    vector<double> steps(n);
+    for (unsigned i = 0; i < n; ++i)
+    {
+        double h = differenceStep * (p[i] != 0 ? fabs(p[i]) : 1.0);
+        if (p[i] + h > upper[i])
+        {
+            h = -h;
+        }
+        params[i][i] += h;
+        steps[i] = params[i][i] - p[i];
+    }
+
+    vector<vector<double> > res;
+    vector<bool> ok = evaluate(params, res);
+
+    ls::DoubleMatrix J(r.size(), n);
+    for (unsigned j = 0; j < n; ++j)
+    {
+        if (!ok[j])
+        {
+            Log(Logger::LOG_WARNING) << "parameter estimation, the simulation "
+                    "failed at a step of " << parameterIds[j]
+                    << ", its derivatives are set to zero";
+        }
+
+        for (unsigned i = 0; i < r.size(); ++i)
+        {
+            J(i, j) = ok[j] ? (res[j][i] - r[i]) / steps[j] : 0;
+        }
+    }
+
+    return J;
+}
+
+void ParameterEstimation::levenbergMarquardt(std::vector<double>& p)
+{
+    const unsigned n = p.size();
+
+    // three trial steps are evaluated together, with the damping a factor
+    // ten either side of the current one.
+    static const double factors[] = { 0.1, 1, 10 };
+    static const unsigned numTrials = 3;
+
+    double lambda = 1e-3;
+    vector<double> JTJ, JTr;
+
+    while (iterations < maxIterations && chiSquare > 0)
+    {
+        ++iterations;
+
+        normalEquations(jacobian(p, residuals), residuals, JTJ, JTr);
+
+        vector<double> g(n);
+        for (unsigned i = 0; i < n; ++i)
+        {
+            g[i] = -JTr[i];
+        }
+
+        bool improved = false;
+        double previous = chiSquare;
+
+        while (!improved && lambda < maxLambda)
+        {
+            vector<vector<double> > trials;
+            vector<double> trialLambdas;
+
+            for (unsigned k = 0; k < numTrials; ++k)
+            {
+                // Marquardt's scaling of the damping by the diagonal, so the
+                // step does not depend on the units of the parameters.
+                double l = lambda * factors[k];
+                vector<double> A = JTJ;
+                for (unsigned i = 0; i < n; ++i)
+                {
+                    A[i * n + i] += l * (JTJ[i * n + i] > 0 ? JTJ[i * n + i] : 1.0);
+                }
+
+                vector<double> delta;
+                if (!choleskySolve(n, A, g, delta))
+                {
+                    continue;
+                }
+
+                vector<double> trial = p;
+                for (unsigned i = 0; i < n; ++i)
+                {
+                    trial[i] += delta[i];
+                }
+                clamp(trial);
+
+                trials.push_back(trial);
+                trialLambdas.push_back(l);
+            }
+
+            vector<vector<double> > res;
+            vector<bool> ok = evaluate(trials, res);
+
+            unsigned best = trials.size();
+            double bestChi = chiSquare;
+            for (unsigned k = 0; k < trials.size(); ++k)
+            {
+                double chi = ok[k] ? sumOfSquares(res[k]) : inf;
+                if (chi < bestChi)
+                {
+                    best = k;
+                    bestChi = chi;
+                }
+            }
+
+            if (best < trials.size())
+            {
+                p = trials[best];
+                residuals.swap(res[best]);
+                chiSquare = bestChi;
+                lambda = trialLambdas[best];
+                improved = true;
+            }
+            else
+            {
+                lambda *= 100;
+            }
+        }
+
+        Log(Logger::LOG_DEBUG) << "Levenberg-Marquardt iteration " << iterations
+                << ", chi square " << chiSquare << ", lambda " << lambda;
+
+        if (!improved || previous - chiSquare <= tolerance * previous)
+        {
+            break;
+        }
+    }
+}
+
+void ParameterEstimation::nelderMead(std::vector<double>& p)
+{
+    const unsigned n = p.size();
+    const unsigned maxSteps = maxIterations * 10 * n;
+
+    // the initial simplex, a step of ten percent along each parameter.
+    vector<vector<double> > simplex(n + 1, p);
+    for (unsigned i = 0; i < n; ++i)
+    {
+        double h = p[i] != 0 ? 0.1 * fabs(p[i]) : 0.1;
+        if (p[i] + h > upper[i])
+        {
+            h = -h;
+        }
+        simplex[i + 1][i] += h;
+        clamp(simplex[i + 1]);
+    }
+
+    vector<double> f(n + 1);
+    {
+        vector<vector<double> > res;
+        vector<bool> ok = evaluate(simplex, res);
+        for (unsigned i = 0; i <= n; ++i)
+        {
+            f[i] = ok[i] ? sumOfSquares(res[i]) : inf;
+        }
+    }
+
+    vector<unsigned> order(n + 1);
+    vector<vector<double> > candidates(4, p);
+
+    while (iterations < maxSteps)
+    {
+        ++iterations;
+
+        for (unsigned i = 0; i <= n; ++i)
+        {
+            order[i] = i;
+        }
+        for (unsigned i = 1; i <= n; ++i)
+        {
+            for (unsigned j = i; j > 0 && f[order[j]] < f[order[j - 1]]; --j)
+            {
+                swap(order[j], order[j - 1]);
+            }
+        }
+
+        const unsigned best = order[0];
+        const unsigned worst = order[n];
+        const unsigned second = order[n - 1];
+
+        if (f[worst] - f[best] <= tolerance * f[best])
+        {
+            break;
+        }
+
+        vector<double> centroid(n, 0);
+        for (unsigned i = 0; i < n; ++i)
+        {
+            for (unsigned j = 0; j < n; ++j)
+            {
+                centroid[j] += simplex[order[i]][j] / n;
+            }
+        }
+
+        // reflection, expansion and both contractions are evaluated
+        // together, only one of them is used.
+        static const double coefficients[] = { 1, 2, 0.5, -0.5 };
+        for (unsigned k = 0; k < 4; ++k)
+        {
+            for (unsigned j = 0; j < n; ++j)
+            {
+                candidates[k][j] = centroid[j] + coefficients[k]
+                        * (centroid[j] - simplex[worst][j]);
+            }
+            clamp(candidates[k]);
+        }
+
+        vector<vector<double> > res;
+        vector<bool> ok = evaluate(candidates, res);
+        double fc[4];
+        for (unsigned k = 0; k < 4; ++k)
+        {
+            fc[k] = ok[k] ? sumOfSquares(res[k]) : inf;
+        }
+
+        int accept = -1;
+        if (fc[0] < f[best])
+        {
+            accept = fc[1] < fc[0] ? 1 : 0;
+        }
+        else if (fc[0] < f[second])
+        {
+            accept = 0;
+        }
+        else if (fc[0] < f[worst])
+        {
+            accept = fc[2] <= fc[0] ? 2 : -1;
+        }
+        else
+        {
+            accept = fc[3] < f[worst] ? 3 : -1;
+        }
+
+        if (accept >= 0)
+        {
+            simplex[worst] = candidates[accept];
+            f[worst] = fc[accept];
+            continue;
+        }
+
+        // shrink towards the best vertex.
+        vector<vector<double> > shrunk;
+        for (unsigned i = 1; i <= n; ++i)
+        {
+            vector<double>& v = simplex[order[i]];
+            for (unsigned j = 0; j < n; ++j)
+            {
+                v[j] = simplex[best][j] + 0.5 * (v[j] - simplex[best][j]);
+            }
+            shrunk.push_back(v);
+        }
+
+        ok = evaluate(shrunk, res);
+        for (unsigned i = 1; i <= n; ++i)
+        {
+            f[order[i]] = ok[i - 1] ? sumOfSquares(res[i - 1]) : inf;
+        }
+    }
+
+    unsigned best = min_element(f.begin(), f.end()) - f.begin();
+    if (f[best] < chiSquare)
+    {
+        p = simplex[best];
+        chiSquare = evaluate(p, residuals);
+    }
+}
+
+}
@@ -0,0 +1,241 @@
+/*
+ * rrParameterEstimation.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef RRPARAMETERESTIMATION_H_
+#define RRPARAMETERESTIMATION_H_
+
+#include "rrExporter.h"
+#include "Variant.h"
+#include "rr-libstruct/lsMatrix.h"
+#include <string>
+#include <vector>
+
+namespace rr
+{
+
+class RoadRunner;
+
+/**
+ * Fit global parameters of a model to experimental data.
+ *
+ * The data of each experiment is a time course in the RoadRunnerData file
+ * format, a 'time' column and a column for each measured selection, i.e.
+ * "S1" or "[S1]", with an optional WEIGHTS section. Each experiment may
+ * start from its own initial conditions, values set on the model after it
+ * is reset, before it is simulated. Missing data points are NaN. The fitted
+ * parameters are set as initial values before the reset, so the initial
+ * assignments which depend on them follow the fit.
+ *
+ * The residuals are weight * (simulated - measured), so the weights are
+ * the reciprocal of the measurement standard deviation, a weight of zero
+ * removes a point. Without weights all points have weight one.
+ *
+ * Two methods minimize the sum of the squared residuals:
+ *
+ * LEVENBERG_MARQUARDT uses the Jacobian of the residuals, by forward
+ * differences of the simulations, one for each parameter.
+ *
+ * NELDER_MEAD is derivative free, for problems where the residuals are
+ * not smooth, i.e. with events, or the differences are too noisy.
+ *
+ * The simulations are distributed over a number of worker threads, each
+ * with its own copy of the model, the columns of the Jacobian, the vertices
+ * of the initial simplex and the experiments are evaluated concurrently.
+ *
+ * The covariance of the parameters is estimated from the Fisher
+ * information, J^T J of the weighted residuals at the optimum, scaled by
+ * the residual variance, and gives the standard errors and confidence
+ * intervals. These are only meaningful near a well determined optimum.
+ */
+class RR_DECLSPEC ParameterEstimation
+{
+public:
+
+    enum Method
+    {
+        LEVENBERG_MARQUARDT = 0,
+        NELDER_MEAD
+    };
+
+    /**
+     * create an estimation for the model currently loaded in the given
+     * RoadRunner, the model is copied with its current integrator settings,
+     * the RoadRunner object itself is not modified.
+     */
+    ParameterEstimation(RoadRunner* rr);
+
+    ~ParameterEstimation();
+
+    /**
+     * fit a global parameter, starting from its current value.
+     */
+    void addParameter(const std::string& id);
+
+    /**
+     * fit a global parameter within bounds, starting from its current value
+     * clamped to them.
+     */
+    void addParameter(const std::string& id, double lower, double upper);
+
+    /**
+     * add an experiment from a RoadRunnerData file, simulated from the
+     * initial conditions of the model, with the given ids set to values.
+     */
+    void addExperiment(const std::string& fileName,
+            const std::vector<std::string>& initialIds = std::vector<std::string>(),
+            const std::vector<double>& initialValues = std::vector<double>());
+
+    /**
+     * add an experiment from a matrix, the column names are the selections,
+     * one of them must be 'time'. The weights, if given, must have the
+     * same size as the data.
+     */
+    void addExperiment(const ls::DoubleMatrix& data,
+            const ls::DoubleMatrix* weights,
+            const std::vector<std::string>& initialIds = std::vector<std::string>(),
+            const std::vector<double>& initialValues = std::vector<double>());
+
+    /**
+     * the method, default LEVENBERG_MARQUARDT.
+     */
+    void setMethod(Method method);
+
+    /**
+     * number of worker threads, default is the number of processors.
+     */
+    void setNumThreads(unsigned threads);
+
+    /**
+     * maximum number of iterations, default 100 for Levenberg-Marquardt,
+     * the Nelder-Mead limit is this times 10 times the number of parameters.
+     */
+    void setMaxIterations(unsigned iterations);
+
+    /**
+     * stop when an iteration improves the sum of squares by less than this
+     * fraction, default 1e-8.
+     */
+    void setTolerance(double tol);
+
+    /**
+     * relative step of the forward differences, default 1e-4, which is
+     * well above the error of the default integrator tolerances.
+     */
+    void setDifferenceStep(double step);
+
+    /**
+     * confidence level of the intervals, default 0.95.
+     */
+    void setConfidenceLevel(double level);
+
+    /**
+     * perform the fit.
+     *
+     * @return a matrix with a row for each parameter, with the row names
+     * set to the parameter ids, and columns 'value', 'standard_error',
+     * 'lower' and 'upper', the bounds of the confidence interval.
+     */
+    ls::DoubleMatrix fit();
+
+    /**
+     * sum of the squared weighted residuals at the optimum.
+     */
+    double getChiSquare() const;
+
+    /**
+     * chi square divided by the degrees of freedom, the number of data
+     * points less the number of parameters.
+     */
+    double getReducedChiSquare() const;
+
+    /**
+     * number of iterations of the last fit.
+     */
+    unsigned getNumIterations() const;
+
+    /**
+     * estimated covariance of the parameters at the optimum.
+     */
+    ls::DoubleMatrix getCovariance() const;
+
+    /**
+     * the weighted residuals at the optimum, for each experiment the
+     * rows of its data, each with a residual for each measured column.
+     */
+    std::vector<double> getResiduals() const;
+
+private:
+    struct Experiment;
+    struct Worker;
+
+    /**
+     * evaluate the residuals of all the experiments for each of the
+     * parameter vectors. Returns false for the ones which failed, i.e. the
+     * integrator did not converge.
+     */
+    std::vector<bool> evaluate(const std::vector<std::vector<double> >& params,
+            std::vector<std::vector<double> >& residuals);
+
+    /**
+     * sum of squares of the residuals, infinite if they failed.
+     */
+    double evaluate(const std::vector<double>& p, std::vector<double>& residuals);
+
+    /**
+     * forward difference Jacobian, a row for each residual.
+     */
+    ls::DoubleMatrix jacobian(const std::vector<double>& p,
+            const std::vector<double>& residuals);
+
+    void levenbergMarquardt(std::vector<double>& p);
+
+    void nelderMead(std::vector<double>& p);
+
+    void clamp(std::vector<double>& p) const;
+
+    void createWorkers();
+
+    void deleteWorkers();
+
+    std::string sbml;
+    bool conservedMoieties;
+    std::string integratorName;
+    std::vector<std::pair<std::string, Variant> > integratorSettings;
+
+    /**
+     * the global parameters of the model and their values when this
+     * object was created, the starting point of the fits.
+     */
+    std::vector<std::string> globalParameterIds;
+    std::vector<double> globalParameterValues;
+
+    std::vector<std::string> parameterIds;
+    std::vector<double> initialValues;
+    std::vector<double> lower;
+    std::vector<double> upper;
+
+    std::vector<Experiment*> experiments;
+    unsigned numResiduals;
+    unsigned numDataPoints;
+
+    Method method;
+    unsigned numThreads;
+    unsigned maxIterations;
+    double tolerance;
+    double differenceStep;
+    double confidenceLevel;
+
+    double chiSquare;
+    unsigned iterations;
+    std::vector<double> residuals;
+    ls::DoubleMatrix covariance;
+
+    std::vector<Worker*> workers;
+};
+
+}
+
+#endif /* RRPARAMETERESTIMATION_H_ */
@@ -0,0 +1,140 @@
+/*
+ * rrPerfCounters.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+#pragma hdrstop
+#include "rrPerfCounters.h"
+#include "Dictionary.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <mach/mach_time.h>
+#else
+#include <time.h>
+#endif
+
+#include <string.h>
+
+namespace rr
+{
+
+static const char* counterNames[] = {
+    "state_vector_rate_evals",
+    "event_root_evals",
+    "event_applications",
+    "selection_evals",
+    "integrator_steps",
+    "integrator_rhs_evals",
+    "integrator_jacobian_evals",
+    "integrator_jacobian_rhs_evals",
+    "integrator_linear_solver_setups",
+    "integrator_error_test_fails",
+    "integrator_nonlinear_iterations",
+    "integrator_nonlinear_conv_fails",
+    "integrator_root_evals",
+    "integrator_method_switches",
+    "steady_state_iterations",
+    "steady_state_model_evals",
+    "steady_state_jacobian_evals",
+    "steady_state_jacobian_model_evals"
+};
+
+static const char* timerNames[] = {
+    "load_read_time",
+    "load_model_generation_time",
+    "load_initialization_time",
+    "structural_analysis_time",
+    "state_vector_rate_time",
+    "event_root_time",
+    "event_time",
+    "selection_time",
+    "integrate_time",
+    "simulate_time",
+    "steady_state_time"
+};
+
+PerfCounters::PerfCounters()
+{
+    resetAll();
+}
+
+void PerfCounters::resetCounts()
+{
+    memset(counts, 0, sizeof(counts));
+}
+
+void PerfCounters::resetAll()
+{
+    resetCounts();
+
+    for (int i = 0; i < NUM_TIMERS; ++i)
+    {
+        times[i] = 0;
+    }
+}
+
+void PerfCounters::fillDictionary(BasicDictionary& dict) const
+{
+    dict.setItem("enabled", isEnabled());
+
+    for (int i = 0; i < NUM_COUNTERS; ++i)
+    {
+        dict.setItem(counterNames[i], counts[i]);
+    }
+
+    for (int i = 0; i < NUM_TIMERS; ++i)
+    {
+        dict.setItem(timerNames[i], times[i]);
+    }
+}
+
+const char* PerfCounters::getCounterName(Counter counter)
+{
+    return counter >= 0 && counter < NUM_COUNTERS ? counterNames[counter] : "";
+}
+
+const char* PerfCounters::getTimerName(Timer timer)
+{
+    return timer >= 0 && timer < NUM_TIMERS ? timerNames[timer] : "";
+}
+
+bool PerfCounters::isEnabled()
+{
+#if RR_PERF_COUNTERS
+    return true;
+#else
+    return false;
+#endif
+}
+
+double PerfCounters::now()
+{
+#if defined(_WIN32)
+    static double period = 0;
+    LARGE_INTEGER t;
+    if (period == 0)
+    {
+        QueryPerformanceFrequency(&t);
+        period = 1.0 / t.QuadPart;
+    }
+    QueryPerformanceCounter(&t);
+    return t.QuadPart * period;
+#elif defined(__APPLE__)
+    static double period = 0;
+    if (period == 0)
+    {
+        mach_timebase_info_data_t info;
+        mach_timebase_info(&info);
+        period = 1e-9 * info.numer / info.denom;
+    }
+    return mach_absolute_time() * period;
+#else
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + 1e-9 * t.tv_nsec;
+#endif
+}
+
+}
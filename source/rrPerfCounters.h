@@ -0,0 +1,258 @@
+/*
+ * rrPerfCounters.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef RRPERFCOUNTERS_H_
+#define RRPERFCOUNTERS_H_
+
+#include "rrExporter.h"
+#include "rrConfigure.h"
+#include <string>
+#include <stdint.h>
+
+namespace rr
+{
+
+class BasicDictionary;
+
+/**
+ * Counters and timers of where time goes while loading and simulating a
+ * model.
+ *
+ * Each model has a set of counters, which the model itself, the integrators,
+ * the steady state solvers and RoadRunner record into. Counts are per run,
+ * they are cleared at the start of each simulate or steadyState call, so
+ * after a run they describe that run, i.e. how many times the model
+ * function was evaluated, or how many Jacobians CVODE built. Timers are
+ * cumulative, in seconds, and are only cleared with resetAll, so the load
+ * phases remain available after any number of runs.
+ *
+ * Instrumentation is only compiled in if roadrunner is configured with
+ * RR_PERF_COUNTERS, otherwise the RR_PERF_* macros expand to nothing and
+ * there is no run time cost at all, the counters then all remain zero.
+ */
+class RR_DECLSPEC PerfCounters
+{
+public:
+
+    enum Counter
+    {
+        /**
+         * calls to ExecutableModel::getStateVectorRate.
+         */
+        STATE_VECTOR_RATE_EVALS,
+
+        /**
+         * evaluations of the event trigger root functions.
+         */
+        EVENT_ROOT_EVALS,
+
+        /**
+         * number of events that were applied.
+         */
+        EVENT_APPLICATIONS,
+
+        /**
+         * number of selection rows evaluated.
+         */
+        SELECTION_EVALS,
+
+        /**
+         * CVODE statistics, see the CVODE user guide.
+         */
+        INTEGRATOR_STEPS,
+        INTEGRATOR_RHS_EVALS,
+        INTEGRATOR_JACOBIAN_EVALS,
+        INTEGRATOR_JACOBIAN_RHS_EVALS,
+        INTEGRATOR_LINEAR_SOLVER_SETUPS,
+        INTEGRATOR_ERROR_TEST_FAILS,
+        INTEGRATOR_NONLINEAR_ITERATIONS,
+        INTEGRATOR_NONLINEAR_CONV_FAILS,
+        INTEGRATOR_ROOT_EVALS,
+
+        /**
+         * switches between the Adams and BDF methods with
+         * stiffness_detection.
+         */
+        INTEGRATOR_METHOD_SWITCHES,
+
+        /**
+         * NLEQ statistics.
+         */
+        STEADY_STATE_ITERATIONS,
+        STEADY_STATE_MODEL_EVALS,
+        STEADY_STATE_JACOBIAN_EVALS,
+        STEADY_STATE_JACOBIAN_MODEL_EVALS,
+
+        NUM_COUNTERS
+    };
+
+    enum Timer
+    {
+        /**
+         * reading the SBML document.
+         */
+        LOAD_READ_TIME,
+
+        /**
+         * model generation, parsing, code generation and JIT compilation.
+         */
+        LOAD_MODEL_GENERATION_TIME,
+
+        /**
+         * setting up the solvers, resetting the model and creating the
+         * selections.
+         */
+        LOAD_INITIALIZATION_TIME,
+
+        /**
+         * libstruct structural analysis.
+         */
+        STRUCTURAL_ANALYSIS_TIME,
+
+        STATE_VECTOR_RATE_TIME,
+        EVENT_ROOT_TIME,
+        EVENT_TIME,
+        SELECTION_TIME,
+        INTEGRATE_TIME,
+        SIMULATE_TIME,
+        STEADY_STATE_TIME,
+
+        NUM_TIMERS
+    };
+
+    PerfCounters();
+
+    void add(Counter counter, uint64_t n)
+    {
+        counts[counter] += n;
+    }
+
+    void set(Counter counter, uint64_t n)
+    {
+        counts[counter] = n;
+    }
+
+    void addTime(Timer timer, double seconds)
+    {
+        times[timer] += seconds;
+    }
+
+    uint64_t getCount(Counter counter) const
+    {
+        return counts[counter];
+    }
+
+    double getTime(Timer timer) const
+    {
+        return times[timer];
+    }
+
+    /**
+     * clear the per run counters.
+     */
+    void resetCounts();
+
+    /**
+     * clear the counters and the timers.
+     */
+    void resetAll();
+
+    /**
+     * add all of the counters and timers to the dictionary. The keys are
+     * the lower case enum names, i.e. "state_vector_rate_evals" or
+     * "integrate_time", and "enabled" which is false if the
+     * instrumentation is not compiled in.
+     */
+    void fillDictionary(BasicDictionary& dict) const;
+
+    static const char* getCounterName(Counter counter);
+
+    static const char* getTimerName(Timer timer);
+
+    /**
+     * was roadrunner built with RR_PERF_COUNTERS.
+     */
+    static bool isEnabled();
+
+    /**
+     * monotonic high resolution time in seconds, from an arbitrary start.
+     */
+    static double now();
+
+private:
+    uint64_t counts[NUM_COUNTERS];
+    double times[NUM_TIMERS];
+};
+
+/**
+ * adds the elapsed time of a scope to a timer. A null counters pointer
+ * is allowed, then nothing is recorded.
+ */
+class PerfTimer
+{
+public:
+    PerfTimer(PerfCounters* counters, PerfCounters::Timer timer) :
+        counters(counters), timer(timer), start(counters ? PerfCounters::now() : 0)
+    {
+    }
+
+    ~PerfTimer()
+    {
+        if (counters)
+        {
+            counters->addTime(timer, PerfCounters::now() - start);
+        }
+    }
+
+private:
+    PerfCounters* counters;
+    PerfCounters::Timer timer;
+    double start;
+};
+
+}
+
+#define RR_PERF_CONCAT_(a, b) a##b
+#define RR_PERF_CONCAT(a, b) RR_PERF_CONCAT_(a, b)
+
+#if RR_PERF_COUNTERS
+
+/**
+ * add n to a counter, counters is a PerfCounters* which may be null.
+ */
+#define RR_PERF_COUNT(counters, counter, n) { \
+    rr::PerfCounters* _rr_perf_c = (counters); \
+    if (_rr_perf_c) _rr_perf_c->add(rr::PerfCounters::counter, (n)); }
+
+/**
+ * set a counter to n.
+ */
+#define RR_PERF_SET(counters, counter, n) { \
+    rr::PerfCounters* _rr_perf_c = (counters); \
+    if (_rr_perf_c) _rr_perf_c->set(rr::PerfCounters::counter, (n)); }
+
+/**
+ * time the rest of the current scope.
+ */
+#define RR_PERF_TIMER(counters, timer) \
+    rr::PerfTimer RR_PERF_CONCAT(_rr_perf_timer_, __LINE__)((counters), \
+            rr::PerfCounters::timer)
+
+/**
+ * code that only exists with instrumentation enabled.
+ */
+#define RR_PERF_ONLY(code) code
+
+#else
+
+#define RR_PERF_COUNT(counters, counter, n)
+#define RR_PERF_SET(counters, counter, n)
+#define RR_PERF_TIMER(counters, timer)
+#define RR_PERF_ONLY(code)
+
+#endif
+
+#endif /* RRPERFCOUNTERS_H_ */
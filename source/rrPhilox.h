@@ -0,0 +1,212 @@
+/*
+ * rrPhilox.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef RRPHILOX_H_
+#define RRPHILOX_H_
+
+#include <stdint.h>
+
+namespace rr
+{
+
+/**
+ * Philox4x32-10 counter based random number generator, see Salmon et al.,
+ * "Parallel Random Numbers: As Easy as 1, 2, 3", SC 2011.
+ *
+ * The output is a pure function of (seed, replicate, stream, position), a
+ * 64 bit key and a 128 bit counter, there is no hidden state. So each
+ * replicate of a stochastic simulation can be run on any thread, in any
+ * order, and any single replicate can be reproduced directly from its
+ * number, without replaying any other. The streams separate the different
+ * consumers of random numbers in a single model instance, so the draws of
+ * one, i.e. the distribution functions, do not shift the sequence of
+ * another, i.e. the Gillespie integrator.
+ *
+ * Models this is a UniformRandomBitGenerator, so it can be used with the
+ * standard library distributions.
+ */
+class Philox
+{
+public:
+    typedef uint32_t result_type;
+
+    /**
+     * the streams used by the different stochastic paths of a model.
+     */
+    enum Stream
+    {
+        /**
+         * stochastic simulation algorithm, the Gillespie integrator.
+         */
+        SSA_STREAM = 0,
+
+        /**
+         * distribution functions called from the model, i.e. uniform and
+         * normal from the distrib package.
+         */
+        DISTRIB_STREAM = 1,
+
+        /**
+         * choosing between simultaneous events.
+         */
+        EVENT_STREAM = 2
+    };
+
+    Philox(uint64_t seed = 0, uint32_t replicate = 0, uint32_t stream = 0)
+    {
+        this->seed(seed, replicate, stream);
+    }
+
+    /**
+     * address a new sequence, the position is reset to zero.
+     */
+    void seed(uint64_t seed, uint32_t replicate = 0, uint32_t stream = 0)
+    {
+        key[0] = (uint32_t)seed;
+        key[1] = (uint32_t)(seed >> 32);
+        this->replicate = replicate;
+        this->stream = stream;
+        block = 0;
+        index = 4;
+    }
+
+    uint64_t getSeed() const
+    {
+        return (uint64_t)key[1] << 32 | key[0];
+    }
+
+    uint32_t getReplicate() const
+    {
+        return replicate;
+    }
+
+    uint32_t getStream() const
+    {
+        return stream;
+    }
+
+    /**
+     * number of 32 bit values drawn so far.
+     */
+    uint64_t getPosition() const
+    {
+        return index == 4 ? 4 * block : 4 * (block - 1) + index;
+    }
+
+    /**
+     * jump to the given position, constant time.
+     */
+    void setPosition(uint64_t position)
+    {
+        setBlock(position / 4);
+
+        if (position % 4)
+        {
+            generate();
+            index = position % 4;
+        }
+    }
+
+    /**
+     * jump to the start of the given block of four values, this addresses
+     * the whole 64 bit block counter, positions only reach a quarter of it.
+     */
+    void setBlock(uint64_t block)
+    {
+        this->block = block;
+        index = 4;
+    }
+
+    result_type operator()()
+    {
+        if (index == 4)
+        {
+            generate();
+        }
+        return output[index++];
+    }
+
+    /**
+     * uniform double in the open interval (0, 1) with 53 random bits,
+     * consumes two values.
+     */
+    double uniform()
+    {
+        uint32_t a = (*this)() >> 5;
+        uint32_t b = (*this)() >> 6;
+        return (a * 67108864.0 + b + 0.5) / 9007199254740992.0;
+    }
+
+    static result_type min()
+    {
+        return 0;
+    }
+
+    static result_type max()
+    {
+        return 0xffffffff;
+    }
+
+private:
+    uint32_t key[2];
+    uint32_t replicate;
+    uint32_t stream;
+
+    /**
+     * index of the next block of four values to generate.
+     */
+    uint64_t block;
+
+    uint32_t output[4];
+
+    /**
+     * next value in output, 4 if the output is used up.
+     */
+    unsigned index;
+
+    static void mulhilo(uint32_t a, uint32_t b, uint32_t &hi, uint32_t &lo)
+    {
+        uint64_t p = (uint64_t)a * b;
+        hi = (uint32_t)(p >> 32);
+        lo = (uint32_t)p;
+    }
+
+    /**
+     * encrypt the counter (block, stream, replicate) with the key.
+     */
+    void generate()
+    {
+        uint32_t c[4] = { (uint32_t)block, (uint32_t)(block >> 32), stream, replicate };
+        uint32_t k[2] = { key[0], key[1] };
+
+        for (int round = 0; round < 10; ++round)
+        {
+            uint32_t hi0, lo0, hi1, lo1;
+            mulhilo(0xD2511F53, c[0], hi0, lo0);
+            mulhilo(0xCD9E8D57, c[2], hi1, lo1);
+
+            c[0] = hi1 ^ c[1] ^ k[0];
+            c[1] = lo1;
+            c[2] = hi0 ^ c[3] ^ k[1];
+            c[3] = lo0;
+
+            k[0] += 0x9E3779B9;
+            k[1] += 0xBB67AE85;
+        }
+
+        output[0] = c[0];
+        output[1] = c[1];
+        output[2] = c[2];
+        output[3] = c[3];
+
+        ++block;
+        index = 0;
+    }
+};
+
+}
+
+#endif /* RRPHILOX_H_ */
@@ -27,6 +27,10 @@
 #include "rrSBMLReader.h"
 #include "rrConfig.h"
 #include "SBMLValidator.h"
+#include "rrSparse.h"
+#include "rrSparseMatrix.h"
+#include "rrPerfCounters.h"
+#include "rrSimulateFuture.h"
 
 #include <sbml/conversion/SBMLLocalParameterConverter.h>
 #include <sbml/conversion/SBMLLevelVersionConverter.h>
@@ -37,7 +41,9 @@
 #include <rr-libstruct/lsLibStructural.h>
 #include <Poco/File.h>
 #include <Poco/Mutex.h>
+#include <Poco/Timestamp.h>
 #include <list>
+#include <map>
 
 
 #ifdef _MSC_VER
@@ -154,6 +160,62 @@ enum ParameterType
  */
 #define assert_similar(a, b) assert(std::abs(a - b) < 1e-13)
 
+/**
+ * The expensive derived quantities the selections of one output row
+ * share: the eigenvalues of the full Jacobian, and the unscaled
+ * elasticities and control coefficients with respect to a parameter.
+ *
+ * Each one is computed at most once per row, so eigen(S1) ... eigen(Sn)
+ * build one Jacobian, and the elasticities of all the reactions with respect
+ * to a parameter come from the same four perturbations. The cache is only
+ * active while a row is evaluated, values computed at one state are never
+ * used at another.
+ */
+struct SelectionRowCache
+{
+    SelectionRowCache() : active(false), hasEigenValues(false),
+            hasSteadyState(false) {}
+
+    bool active;
+
+    bool hasEigenValues;
+    std::vector<Complex> eigenValues;
+
+    /**
+     * parameter id -> unscaled elasticities of all the reaction rates.
+     */
+    std::map<std::string, std::vector<double> > elasticities;
+
+    /**
+     * the control selections move the model to its steady state, the
+     * reaction rates followed by the floating species concentrations there.
+     */
+    bool hasSteadyState;
+    std::vector<double> steadyStateValues;
+
+    /**
+     * parameter id -> unscaled control coefficients of the steady state
+     * reaction rates followed by the floating species concentrations.
+     */
+    std::map<std::string, std::vector<double> > controls;
+
+    /**
+     * forget the quantities that depend on the model state.
+     */
+    void invalidateState()
+    {
+        hasEigenValues = false;
+        elasticities.clear();
+    }
+
+    void clear()
+    {
+        invalidateState();
+        hasSteadyState = false;
+        controls.clear();
+    }
+};
+
 /**
  * implemention class, hide all details here.
  */
@@ -164,7 +226,12 @@ public:
     double mDiffStepSize;
 
     double mSteadyStateThreshold;
-    ls::DoubleMatrix simulationResult;
+
+    /**
+     * the result of the last simulation, which may be shared with the
+     * holders of getSharedSimulationData.
+     */
+    cxx11_ns::shared_ptr<ls::DoubleMatrix> simulationResult;
 
     /**
      * Points to the current integrator. This is a pointer into the
@@ -203,11 +270,38 @@ public:
      */
     LibStructural* mLS;
 
+    /**
+     * column colouring of the reduced Jacobian, created on demand,
+     * belongs to the current model.
+     */
+    JacobianColoring* reducedJacobianColoring;
+
+    /**
+     * returned by getPerformanceCounters.
+     */
+    BasicDictionary perfCountersDict;
+
     /**
      * options that are specific to the simulation
      */
     SimulateOptions simulateOpt;
 
+    /**
+     * why the last simulation stopped.
+     */
+    SimulateOptions::StopReason simulateStopReason;
+
+    /**
+     * the asynchronous run in progress, if any, which is told about the
+     * progress of a simulation and may cancel it.
+     */
+    SimulateFuture* future;
+
+    /**
+     * shared by the selections of the row being evaluated.
+     */
+    SelectionRowCache rowCache;
+
     /**
      * various general options that can be modified by external callers.
      */
@@ -225,19 +319,38 @@ public:
      */
     friend class aFinalizer;
 
+    /**
+     * the simulation result for a new simulation to write. A result still
+     * shared with the holders of getSharedSimulationData is left to them,
+     * an empty one with the same column names takes its place.
+     */
+    ls::DoubleMatrix& writableSimulationResult()
+    {
+        if (!simulationResult.unique())
+        {
+            ls::DoubleMatrix* result = new ls::DoubleMatrix();
+            result->setColNames(simulationResult->getColNames());
+            simulationResult.reset(result);
+        }
+        return *simulationResult;
+    }
+
 
     RoadRunnerImpl(const std::string& uriOrSBML,
             const Dictionary* dict) :
                 mDiffStepSize(0.05),
                 mSteadyStateThreshold(1.E-2),
-                simulationResult(),
+                simulationResult(new ls::DoubleMatrix()),
                 integrator(0),
                 mSelectionList(),
                 mSteadyStateSelection(),
                 model(0),
                 mCurrentSBML(),
                 mLS(0),
+                reducedJacobianColoring(0),
                 simulateOpt(),
+                simulateStopReason(SimulateOptions::STOP_END_TIME),
+                future(0),
                 mInstanceID(0),
                 loadOpt(dict),
                 compiler(Compiler::New())
@@ -251,14 +364,17 @@ public:
             const string& _supportCodeDir) :
                 mDiffStepSize(0.05),
                 mSteadyStateThreshold(1.E-2),
-                simulationResult(),
+                simulationResult(new ls::DoubleMatrix()),
                 integrator(0),
                 mSelectionList(),
                 mSteadyStateSelection(),
                 model(0),
                 mCurrentSBML(),
                 mLS(0),
+                reducedJacobianColoring(0),
                 simulateOpt(),
+                simulateStopReason(SimulateOptions::STOP_END_TIME),
+                future(0),
                 mInstanceID(0),
                 compiler(Compiler::New())
     {
@@ -277,6 +393,7 @@ public:
         delete compiler;
         delete model;
         delete mLS;
+        delete reducedJacobianColoring;
 
 		deleteAllSolvers();
 
@@ -299,6 +416,11 @@ public:
         steady_state_solvers.clear();
 	}
 
+    PerfCounters* perfCounters()
+    {
+        return model ? model->getPerfCounters() : 0;
+    }
+
     void syncAllSolversWithModel(ExecutableModel* m)
     {
         for (std::vector<Integrator*>::iterator it = integrators.begin(); it != integrators.end(); ++it)
@@ -396,6 +518,276 @@ public:
 
 
 
+/**
+ * activates the row cache while the selections of one row are evaluated,
+ * does nothing if a row is already being evaluated.
+ */
+class SelectionRowScope
+{
+public:
+    SelectionRowScope(SelectionRowCache& cache) : cache(cache),
+            owner(!cache.active)
+    {
+        if (owner)
+        {
+            cache.clear();
+            cache.active = true;
+        }
+    }
+
+    ~SelectionRowScope()
+    {
+        if (owner)
+        {
+            cache.clear();
+            cache.active = false;
+        }
+    }
+
+private:
+    SelectionRowCache& cache;
+    bool owner;
+};
+
+/**
+ * the eigenvalues of the full Jacobian, computed once per row if the cache
+ * is active, every call otherwise.
+ */
+static const std::vector<Complex>& rowEigenValues(RoadRunner& r,
+        SelectionRowCache& cache)
+{
+    if (!cache.active || !cache.hasEigenValues)
+    {
+        DoubleMatrix jac = r.getFullJacobian();
+        cache.eigenValues = ls::getEigenValues(jac);
+        cache.hasEigenValues = cache.active;
+    }
+    return cache.eigenValues;
+}
+
+/**
+ * an elasticity of a reaction with respect to a species, global parameter
+ * or conserved moiety, the same as RoadRunner::getuEE / getEE without the
+ * steady state. The first column of a row with a given parameter computes
+ * the elasticities of all the reactions, with the same 5 point formula.
+ */
+static double rowElasticity(RoadRunnerImpl& self, const string& reactionName,
+        const string& parameterName, bool scaled)
+{
+    ExecutableModel *model = self.model;
+    SelectionRowCache& cache = self.rowCache;
+    ParameterType parameterType;
+    int reactionIndex;
+    int parameterIndex;
+
+    if ((reactionIndex = model->getReactionIndex(reactionName)) < 0)
+    {
+        throw CoreException("Unable to locate reaction name: [" + reactionName + "]");
+    }
+
+    if ((parameterIndex = model->getFloatingSpeciesIndex(parameterName)) >= 0)
+    {
+        parameterType = ptFloatingSpecies;
+    }
+    else if ((parameterIndex = model->getBoundarySpeciesIndex(parameterName)) >= 0)
+    {
+        parameterType = ptBoundaryParameter;
+    }
+    else if ((parameterIndex = model->getGlobalParameterIndex(parameterName)) >= 0)
+    {
+        parameterType = ptGlobalParameter;
+    }
+    else if ((parameterIndex = model->getConservedMoietyIndex(parameterName)) >= 0)
+    {
+        parameterType = ptConservationParameter;
+    }
+    else
+    {
+        throw CoreException("Unable to locate variable: [" + parameterName + "]");
+    }
+
+    double originalParameterValue = self.getParameterValue(parameterType, parameterIndex);
+
+    std::vector<double>& uee = cache.elasticities[parameterName];
+
+    if (uee.empty())
+    {
+        int n = model->getNumReactions();
+        std::vector<double> fi(n), fi2(n), fd(n), fd2(n);
+
+        double hstep = self.mDiffStepSize*originalParameterValue;
+        if (fabs(hstep) < 1E-12)
+        {
+            hstep = self.mDiffStepSize;
+        }
+
+        self.setParameterValue(parameterType, parameterIndex, originalParameterValue + hstep);
+        model->getReactionRates(n, 0, &fi[0]);
+
+        self.setParameterValue(parameterType, parameterIndex, originalParameterValue + 2*hstep);
+        model->getReactionRates(n, 0, &fi2[0]);
+
+        self.setParameterValue(parameterType, parameterIndex, originalParameterValue - hstep);
+        model->getReactionRates(n, 0, &fd[0]);
+
+        self.setParameterValue(parameterType, parameterIndex, originalParameterValue - 2*hstep);
+        model->getReactionRates(n, 0, &fd2[0]);
+
+        self.setParameterValue(parameterType, parameterIndex, originalParameterValue);
+
+        uee.resize(n);
+        for (int i = 0; i < n; ++i)
+        {
+            uee[i] = 1/(12*hstep)*((fd2[i] + 8*fi[i]) - (8*fd[i] + fi2[i]));
+        }
+    }
+
+    if (!scaled)
+    {
+        return uee[reactionIndex];
+    }
+
+    double variableValue = 0;
+    model->getReactionRates(1, &reactionIndex, &variableValue);
+    if (variableValue == 0)
+    {
+        variableValue = 1e-12;
+    }
+    return uee[reactionIndex] * originalParameterValue / variableValue;
+}
+
+/**
+ * the steady state reaction rates followed by the floating species
+ * concentrations.
+ */
+static void getSteadyStateVariables(ExecutableModel *model, std::vector<double>& values)
+{
+    int nr = model->getNumReactions();
+    int nf = model->getNumFloatingSpecies();
+    values.resize(nr + nf);
+    if (nr)
+    {
+        model->getReactionRates(nr, 0, &values[0]);
+    }
+    if (nf)
+    {
+        model->getFloatingSpeciesConcentrations(nf, 0, &values[nr]);
+    }
+}
+
+/**
+ * a control coefficient of a flux or species with respect to a global
+ * parameter, boundary species or conserved moiety, the same as
+ * RoadRunner::getuCC / getCC. The first control column of a row moves the
+ * model to its steady state, and the first column with a given parameter
+ * computes the coefficients of all the fluxes and species from the same
+ * four perturbed steady states.
+ */
+static double rowControl(RoadRunner& r, RoadRunnerImpl& self,
+        const string& variableName, const string& parameterName, bool scaled)
+{
+    ExecutableModel *model = self.model;
+    SelectionRowCache& cache = self.rowCache;
+    ParameterType parameterType;
+    int variableIndex;
+    int parameterIndex;
+
+    if ((variableIndex = model->getReactionIndex(variableName)) < 0)
+    {
+        if ((variableIndex = model->getFloatingSpeciesIndex(variableName)) < 0)
+        {
+            throw CoreException("Unable to locate variable: [" + variableName + "]");
+        }
+        variableIndex += model->getNumReactions();
+    }
+
+    if ((parameterIndex = model->getGlobalParameterIndex(parameterName)) >= 0)
+    {
+        parameterType = ptGlobalParameter;
+    }
+    else if ((parameterIndex = model->getBoundarySpeciesIndex(parameterName)) >= 0)
+    {
+        parameterType = ptBoundaryParameter;
+    }
+    else if ((parameterIndex = model->getConservedMoietyIndex(parameterName)) >= 0)
+    {
+        parameterType = ptConservationParameter;
+    }
+    else
+    {
+        throw CoreException("Unable to locate parameter: [" + parameterName + "]");
+    }
+
+    if (!cache.hasSteadyState)
+    {
+        r.steadyState();
+        getSteadyStateVariables(model, cache.steadyStateValues);
+        cache.hasSteadyState = true;
+
+        // anything computed before was at the old state.
+        cache.invalidateState();
+    }
+
+    double originalParameterValue = self.getParameterValue(parameterType, parameterIndex);
+
+    std::vector<double>& ucc = cache.controls[parameterName];
+
+    if (ucc.empty())
+    {
+        std::vector<double> fi, fi2, fd, fd2;
+
+        double hstep = self.mDiffStepSize*originalParameterValue;
+        if (fabs(hstep) < 1E-12)
+        {
+            hstep = self.mDiffStepSize;
+        }
+
+        try
+        {
+            self.setParameterValue(parameterType, parameterIndex, originalParameterValue + hstep);
+            r.steadyState();
+            getSteadyStateVariables(model, fi);
+
+            self.setParameterValue(parameterType, parameterIndex, originalParameterValue + 2*hstep);
+            r.steadyState();
+            getSteadyStateVariables(model, fi2);
+
+            self.setParameterValue(parameterType, parameterIndex, originalParameterValue - hstep);
+            r.steadyState();
+            getSteadyStateVariables(model, fd);
+
+            self.setParameterValue(parameterType, parameterIndex, originalParameterValue - 2*hstep);
+            r.steadyState();
+            getSteadyStateVariables(model, fd2);
+
+            self.setParameterValue(parameterType, parameterIndex, originalParameterValue);
+            r.steadyState();
+        }
+        catch(...)
+        {
+            // What ever happens, make sure we restore the parameter level
+            self.setParameterValue(parameterType, parameterIndex, originalParameterValue);
+            r.steadyState();
+            throw;
+        }
+
+        ucc.resize(fi.size());
+        for (int i = 0; i < ucc.size(); ++i)
+        {
+            ucc[i] = 1/(12*hstep)*((fd2[i] + 8*fi[i]) - (8*fd[i] + fi2[i]));
+        }
+    }
+
+    if (!scaled)
+    {
+        return ucc[variableIndex];
+    }
+
+    return ucc[variableIndex] * originalParameterValue
+            / cache.steadyStateValues[variableIndex];
+}
+
+
 int RoadRunner::getInstanceCount()
 {
     return mInstanceCount;
@@ -526,11 +918,49 @@ string RoadRunner::getInfo()
         ss << "Null" << endl;
     }
 
+    if(impl->model && PerfCounters::isEnabled()) {
+        const Dictionary* perf = getPerformanceCounters();
+        std::vector<std::string> keys = perf->getKeys();
+
+        ss << "'performanceCounters' : " << endl;
+        for(int i = 0; i < keys.size(); ++i) {
+            ss << "    '" << keys[i] << "' : "
+               << perf->getItem(keys[i]).toString() << endl;
+        }
+    }
+
     ss << "}>";
 
     return ss.str();
 }
 
+const Dictionary* RoadRunner::getPerformanceCounters()
+{
+    check_model();
+
+    impl->perfCountersDict = BasicDictionary();
+
+    PerfCounters* counters = impl->model->getPerfCounters();
+    if(counters) {
+        counters->fillDictionary(impl->perfCountersDict);
+    }
+    else {
+        PerfCounters().fillDictionary(impl->perfCountersDict);
+    }
+
+    return &impl->perfCountersDict;
+}
+
+void RoadRunner::resetPerformanceCounters()
+{
+    check_model();
+
+    PerfCounters* counters = impl->model->getPerfCounters();
+    if(counters) {
+        counters->resetAll();
+    }
+}
+
 string RoadRunner::getExtendedVersionInfo()
 {
     stringstream info;
@@ -551,6 +981,8 @@ ls::LibStructural* RoadRunner::getLibStruct()
     }
     else if (!impl->mCurrentSBML.empty())
     {
+        RR_PERF_TIMER(impl->perfCounters(), STRUCTURAL_ANALYSIS_TIME);
+
         impl->mLS = new ls::LibStructural(impl->mCurrentSBML);
         Log(Logger::LOG_INFORMATION) << "created structural analysis, messages: "
                 << impl->mLS->getAnalysisMsg();
@@ -750,19 +1182,27 @@ double RoadRunner::getValue(const SelectionRecord& record)
         break;
 
     case SelectionRecord::ELASTICITY:
-        dResult = getEE(record.p1, record.p2, false);
+        dResult = impl->rowCache.active
+                ? rowElasticity(*impl, record.p1, record.p2, true)
+                : getEE(record.p1, record.p2, false);
         break;
 
     case SelectionRecord::UNSCALED_ELASTICITY:
-        dResult = getuEE(record.p1, record.p2, false);
+        dResult = impl->rowCache.active
+                ? rowElasticity(*impl, record.p1, record.p2, false)
+                : getuEE(record.p1, record.p2, false);
         break;
 
     case SelectionRecord::CONTROL:
-        dResult = getCC(record.p1, record.p2);
+        dResult = impl->rowCache.active
+                ? rowControl(*this, *impl, record.p1, record.p2, true)
+                : getCC(record.p1, record.p2);
         break;
 
     case SelectionRecord::UNSCALED_CONTROL:
-        dResult = getuCC(record.p1, record.p2);
+        dResult = impl->rowCache.active
+                ? rowControl(*this, *impl, record.p1, record.p2, false)
+                : getuCC(record.p1, record.p2);
         break;
 
     case SelectionRecord::EIGENVALUE:
@@ -775,7 +1215,7 @@ double RoadRunner::getValue(const SelectionRecord& record)
             throw std::logic_error("Invalid species id" + record.p1 + " for eigenvalue");
         }
 
-        vector<Complex> eig = getEigenValues(JACOBIAN_FULL);
+        const vector<Complex>& eig = rowEigenValues(*this, impl->rowCache);
 
         if (eig.size() <= index)
         {
@@ -796,7 +1236,7 @@ double RoadRunner::getValue(const SelectionRecord& record)
             throw std::logic_error("Invalid species id" + record.p1 + " for eigenvalue");
         }
 
-        vector<Complex> eig = getEigenValues(JACOBIAN_FULL);
+        const vector<Complex>& eig = rowEigenValues(*this, impl->rowCache);
 
         if (eig.size() <= index)
         {
@@ -862,6 +1302,10 @@ int RoadRunner::getTimeRowIndex()
 
 void RoadRunner::getSelectedValues(DoubleMatrix& results, int nRow, double currentTime)
 {
+    RR_PERF_TIMER(impl->perfCounters(), SELECTION_TIME);
+    RR_PERF_COUNT(impl->perfCounters(), SELECTION_EVALS, 1);
+    SelectionRowScope row(impl->rowCache);
+
     for (u_int j = 0; j < impl->mSelectionList.size(); j++)
     {
         double out =  getNthSelectedOutput(j, currentTime);
@@ -869,9 +1313,25 @@ void RoadRunner::getSelectedValues(DoubleMatrix& results, int nRow, double curre
     }
 }
 
+void RoadRunner::getSelectedValues(double* results, double currentTime)
+{
+    RR_PERF_TIMER(impl->perfCounters(), SELECTION_TIME);
+    RR_PERF_COUNT(impl->perfCounters(), SELECTION_EVALS, 1);
+    SelectionRowScope row(impl->rowCache);
+
+    for (u_int j = 0; j < impl->mSelectionList.size(); j++)
+    {
+        results[j] = getNthSelectedOutput(j, currentTime);
+    }
+}
+
 void RoadRunner::getSelectedValues(std::vector<double>& results,
         double currentTime)
 {
+    RR_PERF_TIMER(impl->perfCounters(), SELECTION_TIME);
+    RR_PERF_COUNT(impl->perfCounters(), SELECTION_EVALS, 1);
+    SelectionRowScope row(impl->rowCache);
+
     assert(results.size() == impl->mSelectionList.size()
             && "given vector and selection list different size");
 
@@ -894,6 +1354,12 @@ void RoadRunner::load(const string& uriOrSbml, const Dictionary *dict)
 
     get_self();
 
+#if RR_PERF_COUNTERS
+    double perfStart = PerfCounters::now();
+    double perfReadTime = 0;
+    double perfGenerationTime = 0;
+#endif
+
     self.mCurrentSBML = SBMLReader::read(uriOrSbml);
 
     delete impl->model;
@@ -902,6 +1368,9 @@ void RoadRunner::load(const string& uriOrSbml, const Dictionary *dict)
     delete impl->mLS;
     impl->mLS = NULL;
 
+    delete impl->reducedJacobianColoring;
+    impl->reducedJacobianColoring = NULL;
+
     if(dict) {
         self.loadOpt = LoadSBMLOptions(dict);
     }
@@ -915,6 +1384,11 @@ void RoadRunner::load(const string& uriOrSbml, const Dictionary *dict)
         Log(Logger::LOG_WARNING)<<"Stoichiometry is not defined for all reactions; assuming unit stoichiometry where missing";
     }
 
+#if RR_PERF_COUNTERS
+    perfReadTime = PerfCounters::now() - perfStart;
+    perfStart = PerfCounters::now();
+#endif
+
     // the following lines load and compile the model. If anything fails here,
     // we validate the model to provide explicit details about where it
     // failed. Its *VERY* expensive to pre-validate the model.
@@ -933,6 +1407,11 @@ void RoadRunner::load(const string& uriOrSbml, const Dictionary *dict)
         throw;
     }
 
+#if RR_PERF_COUNTERS
+    perfGenerationTime = PerfCounters::now() - perfStart;
+    perfStart = PerfCounters::now();
+#endif
+
     impl->syncAllSolversWithModel(impl->model);
 
     reset();
@@ -941,6 +1420,16 @@ void RoadRunner::load(const string& uriOrSbml, const Dictionary *dict)
     {
         createDefaultSelectionLists();
     }
+
+#if RR_PERF_COUNTERS
+    if (PerfCounters* counters = impl->perfCounters())
+    {
+        counters->addTime(PerfCounters::LOAD_READ_TIME, perfReadTime);
+        counters->addTime(PerfCounters::LOAD_MODEL_GENERATION_TIME, perfGenerationTime);
+        counters->addTime(PerfCounters::LOAD_INITIALIZATION_TIME,
+                PerfCounters::now() - perfStart);
+    }
+#endif
 }
 
 bool RoadRunner::createDefaultSelectionLists()
@@ -982,6 +1471,9 @@ bool RoadRunner::clearModel()
 
 		delete impl->mLS;
 		impl->mLS = NULL;
+
+        delete impl->reducedJacobianColoring;
+        impl->reducedJacobianColoring = NULL;
         return true;
     }
     return false;
@@ -1063,6 +1555,16 @@ double RoadRunner::steadyState(const Dictionary* dict)
 
     Log(Logger::LOG_DEBUG)<<"Attempting to find steady state using solver '" << impl->steady_state_solver->getName() << "'...";
 
+#if RR_PERF_COUNTERS
+    PerfCounters* perf = impl->perfCounters();
+    if (perf)
+    {
+        perf->resetCounts();
+    }
+#endif
+
+    RR_PERF_TIMER(perf, STEADY_STATE_TIME);
+
     double ss = impl->steady_state_solver->solve();
     if(ss < 0)
     {
@@ -1078,6 +1580,35 @@ DoubleMatrix RoadRunner::steadyStateNamedArray(const Dictionary* dict)
     return getSteadyStateValuesNamedArray();
 }
 
+SimulateFuture* RoadRunner::steadyStateAsync()
+{
+    get_self();
+    check_model();
+
+    if (self.future)
+    {
+        throw std::logic_error("an asynchronous run is already in progress");
+    }
+
+    SimulateFuture* future = new SimulateFuture(this,
+            SimulateFuture::STEADY_STATE, self.simulateOpt);
+
+    self.future = future;
+
+    try
+    {
+        future->start();
+    }
+    catch (std::exception&)
+    {
+        self.future = 0;
+        delete future;
+        throw;
+    }
+
+    return future;
+}
+
 
 
 
@@ -1309,12 +1840,362 @@ const DoubleMatrix* RoadRunner::simulate(const Dictionary* dict)
 
     applySimulateOptions();
 
+    simulateImpl(0, 0, 0);
+
+    return self.simulationResult.get();
+}
+
+int RoadRunner::simulate(const Dictionary* dict, double* buffer, int rows, int cols)
+{
+    get_self();
+    check_model();
+
+    if (!buffer)
+    {
+        throw std::invalid_argument("simulate output buffer is NULL");
+    }
+
+    const SimulateOptions *opt = dynamic_cast<const SimulateOptions*>(dict);
+
+    if (opt) {
+        self.simulateOpt = *opt;
+    }
+
+    applySimulateOptions();
+
+    return simulateImpl(buffer, rows, cols);
+}
+
+SimulateFuture* RoadRunner::simulateAsync(const Dictionary* dict)
+{
+    get_self();
+    check_model();
+
+    if (self.future)
+    {
+        throw std::logic_error("an asynchronous run is already in progress");
+    }
+
+    const SimulateOptions *opt = dynamic_cast<const SimulateOptions*>(dict);
+
+    SimulateFuture* future = new SimulateFuture(this, SimulateFuture::SIMULATE,
+            opt ? *opt : self.simulateOpt);
+
+    self.future = future;
+
+    try
+    {
+        future->start();
+    }
+    catch (std::exception&)
+    {
+        self.future = 0;
+        delete future;
+        throw;
+    }
+
+    return future;
+}
+
+void RoadRunner::setFuture(SimulateFuture* future)
+{
+    impl->future = future;
+}
+
+/**
+ * The early stop conditions of the simulate options, checked at each
+ * output point of a simulation. Cancellation and the wall time limit are
+ * also checked by the integrator between its internal steps, so a long
+ * integration between two output points can be stopped.
+ */
+class SimulateStopCheck : public IntegratorInterrupt
+{
+public:
+    SimulateStopCheck(RoadRunner& r, ExecutableModel* model,
+            const SimulateOptions& opt, SimulateFuture* future) :
+                r(r),
+                model(model),
+                tolerance(opt.steady_state_tolerance),
+                window(opt.steady_state_window),
+                steadySince(-1),
+                hasCondition(false),
+                op(LT),
+                rhsValue(0),
+                hasRhsSelection(false),
+                conditionWasTrue(false),
+                maxWallTime(opt.max_wall_time),
+                future(future),
+                interruptCalls(0),
+                interruptReason(SimulateOptions::STOP_END_TIME)
+    {
+        if (tolerance > 0)
+        {
+            dydt.resize(model->getStateVector(0));
+        }
+
+        if (opt.stop_condition.size())
+        {
+            parseCondition(opt.stop_condition);
+            conditionWasTrue = evalCondition();
+        }
+    }
+
+    bool enabled() const
+    {
+        return tolerance > 0 || hasCondition || maxWallTime > 0 || future;
+    }
+
+    /**
+     * are there any conditions the integrator should check between steps.
+     */
+    bool interruptible() const
+    {
+        return maxWallTime > 0 || future;
+    }
+
+    /**
+     * called by the integrator for each internal step, or each right hand
+     * side evaluation, so only every interruptInterval calls look at the
+     * future or the clock.
+     */
+    virtual bool interrupted()
+    {
+        if (interruptReason != SimulateOptions::STOP_END_TIME)
+        {
+            return true;
+        }
+
+        if (++interruptCalls % interruptInterval)
+        {
+            return false;
+        }
+
+        if (future && future->isCancelled())
+        {
+            interruptReason = SimulateOptions::STOP_CANCELLED;
+        }
+        else if (maxWallTime > 0 && wallStart.elapsed() > maxWallTime * 1.e6)
+        {
+            interruptReason = SimulateOptions::STOP_WALL_TIME;
+        }
+
+        return interruptReason != SimulateOptions::STOP_END_TIME;
+    }
+
+    /**
+     * why the integrator was interrupted.
+     */
+    SimulateOptions::StopReason getInterruptReason() const
+    {
+        return interruptReason;
+    }
+
+    /**
+     * check the conditions at an output point, the model is at time t.
+     */
+    SimulateOptions::StopReason check(double t)
+    {
+        if (future && future->update(t))
+        {
+            return SimulateOptions::STOP_CANCELLED;
+        }
+
+        if (hasCondition)
+        {
+            bool value = evalCondition();
+            bool fired = value && !conditionWasTrue;
+            conditionWasTrue = value;
+            if (fired)
+            {
+                return SimulateOptions::STOP_CONDITION;
+            }
+        }
+
+        if (tolerance > 0)
+        {
+            double norm = 0;
+            if (dydt.size())
+            {
+                model->getStateVectorRate(t, 0, &dydt[0]);
+                for (unsigned i = 0; i < dydt.size(); ++i)
+                {
+                    norm += dydt[i] * dydt[i];
+                }
+                norm = sqrt(norm);
+            }
+
+            if (norm < tolerance)
+            {
+                if (steadySince < 0)
+                {
+                    steadySince = t;
+                }
+
+                if (t - steadySince >= window)
+                {
+                    return SimulateOptions::STOP_STEADY_STATE;
+                }
+            }
+            else
+            {
+                steadySince = -1;
+            }
+        }
+
+        if (maxWallTime > 0 && wallStart.elapsed() > maxWallTime * 1.e6)
+        {
+            return SimulateOptions::STOP_WALL_TIME;
+        }
+
+        return SimulateOptions::STOP_END_TIME;
+    }
+
+private:
+    enum Op { LT, LEQ, GT, GEQ };
+
+    RoadRunner& r;
+    ExecutableModel* model;
+
+    double tolerance;
+    double window;
+    double steadySince;
+    std::vector<double> dydt;
+
+    bool hasCondition;
+    SelectionRecord lhs;
+    Op op;
+    double rhsValue;
+    bool hasRhsSelection;
+    SelectionRecord rhs;
+    bool conditionWasTrue;
+
+    double maxWallTime;
+    Poco::Timestamp wallStart;
+
+    SimulateFuture* future;
+
+    static const unsigned interruptInterval = 16;
+    unsigned interruptCalls;
+    SimulateOptions::StopReason interruptReason;
+
+    void parseCondition(const std::string& str)
+    {
+        std::string::size_type pos = str.find_first_of("<>");
+        if (pos == std::string::npos || pos == 0)
+        {
+            throw std::invalid_argument("invalid stop condition '" + str +
+                    "', expected 'selection op value', where op is one "
+                    "of <, <=, > or >=");
+        }
+
+        std::string::size_type end = pos + 1;
+        bool orEqual = end < str.size() && str[end] == '=';
+        if (orEqual)
+        {
+            ++end;
+        }
+
+        if (str[pos] == '<')
+        {
+            op = orEqual ? LEQ : LT;
+        }
+        else
+        {
+            op = orEqual ? GEQ : GT;
+        }
+
+        lhs = r.createSelection(trim(str.substr(0, pos)));
+
+        std::string value = trim(str.substr(end));
+        char* valueEnd = 0;
+        rhsValue = strtod(value.c_str(), &valueEnd);
+        if (value.empty() || *valueEnd != '\0')
+        {
+            rhs = r.createSelection(value);
+            hasRhsSelection = true;
+        }
+
+        hasCondition = true;
+
+        Log(Logger::LOG_DEBUG) << "simulate stop condition: "
+                << lhs.to_string() << " " << str.substr(pos, end - pos) << " "
+                << (hasRhsSelection ? rhs.to_string() : value);
+    }
+
+    bool evalCondition()
+    {
+        double a = r.getValue(lhs);
+        double b = hasRhsSelection ? r.getValue(rhs) : rhsValue;
+
+        switch (op)
+        {
+        case LT:  return a < b;
+        case LEQ: return a <= b;
+        case GT:  return a > b;
+        default:  return a >= b;
+        }
+    }
+};
+
+/**
+ * sets the interrupt of an integrator for the duration of a simulation.
+ */
+class ScopedIntegratorInterrupt
+{
+public:
+    ScopedIntegratorInterrupt(Integrator* integrator, IntegratorInterrupt* interrupt) :
+            integrator(integrator)
+    {
+        integrator->setInterrupt(interrupt);
+    }
+
+    ~ScopedIntegratorInterrupt()
+    {
+        integrator->setInterrupt(0);
+    }
+
+private:
+    Integrator* integrator;
+};
+
+int RoadRunner::simulateImpl(double* buffer, int bufferRows, int bufferCols)
+{
+    get_self();
+
+    if (buffer && bufferCols != self.mSelectionList.size())
+    {
+        throw std::invalid_argument("simulate output buffer has " +
+                toString(bufferCols) + " columns, but there are " +
+                toString((int)self.mSelectionList.size()) + " selections");
+    }
+
+    // number of rows actually written.
+    int resultRows = 0;
+
+    // the result matrix, unless writing to the buffer.
+    ls::DoubleMatrix* result = buffer ? 0 : &self.writableSimulationResult();
+
     const double timeEnd = self.simulateOpt.duration + self.simulateOpt.start;
     const double timeStart = self.simulateOpt.start;
 
+#if RR_PERF_COUNTERS
+    PerfCounters* perf = self.perfCounters();
+    if (perf)
+    {
+        perf->resetCounts();
+    }
+#endif
+
+    RR_PERF_TIMER(perf, SIMULATE_TIME);
+
     // evalute the model with its current state
     self.model->getStateVectorRate(timeStart, 0, 0);
 
+    self.simulateStopReason = SimulateOptions::STOP_END_TIME;
+    SimulateStopCheck stopCheck(*this, self.model, self.simulateOpt, self.future);
+    ScopedIntegratorInterrupt interrupt(self.integrator,
+            stopCheck.interruptible() ? &stopCheck : 0);
+
     // Variable Time Step Integration
     if (self.integrator->hasValue("variable_step_size") && self.integrator->getValueAsBool("variable_step_size"))
     {
@@ -1341,7 +2222,8 @@ const DoubleMatrix* RoadRunner::simulate(const Dictionary* dict)
 
             while( tout < timeEnd &&
               ( !self.simulateOpt.steps || n < self.simulateOpt.steps) &&
-              ( !rr::Config::getInt(rr::Config::MAX_OUTPUT_ROWS) || n < rr::Config::getInt(rr::Config::MAX_OUTPUT_ROWS)) )
+              ( !rr::Config::getInt(rr::Config::MAX_OUTPUT_ROWS) || n < rr::Config::getInt(rr::Config::MAX_OUTPUT_ROWS)) &&
+              ( !buffer || n + 1 < bufferRows) )
             {
                 Log(Logger::LOG_DEBUG) << "variable step, start: " << tout
                         << ", end: " << timeEnd;
@@ -1399,23 +2281,47 @@ const DoubleMatrix* RoadRunner::simulate(const Dictionary* dict)
                 results.push_back(row);
 
                 ++n;
+
+                if (stopCheck.enabled() && (self.simulateStopReason =
+                        stopCheck.check(tout)) != SimulateOptions::STOP_END_TIME)
+                {
+                    break;
+                }
             }
         }
         catch (EventListenerException& e)
         {
             Log(Logger::LOG_NOTICE) << e.what();
+            self.simulateStopReason = SimulateOptions::STOP_EVENT_LISTENER;
+        }
+        catch (IntegratorInterruptedException& e)
+        {
+            Log(Logger::LOG_NOTICE) << e.what() << " at time " << e.time;
+            self.simulateStopReason = stopCheck.getInterruptReason();
+        }
+
+        // stuff list values into result matrix, or the callers buffer.
+        if (!buffer)
+        {
+            result->resize(results.size(), row.size());
+        }
+        else if (results.size() > bufferRows)
+        {
+            // could happen if the buffer is too small for even the initial row
+            results.resize(bufferRows);
         }
 
-        // stuff list values into result matrix
-        self.simulationResult.resize(results.size(), row.size());
         uint rowi = 0;
         for (DoubleVectorList::const_iterator i = results.begin();
                 i != results.end(); ++i, ++rowi)
         {
             // evidently [] operator gets row, go figure...
-            double* prow = self.simulationResult[rowi];
+            double* prow = buffer ? buffer + rowi * bufferCols
+                    : (*result)[rowi];
             std::copy(i->begin(), i->end(), prow);
         }
+
+        resultRows = results.size();
     }
 
     // Stochastic Fixed Step Integration
@@ -1439,13 +2345,29 @@ const DoubleMatrix* RoadRunner::simulate(const Dictionary* dict)
 
         Log(Logger::LOG_DEBUG) << "starting simulation with " << nrCols << " selected columns";
 
-        // ignored if same
-        self.simulationResult.resize(self.simulateOpt.steps + 1, nrCols);
+        resultRows = self.simulateOpt.steps + 1;
+
+        if (!buffer)
+        {
+            // ignored if same
+            result->resize(resultRows, nrCols);
+        }
+        else if (bufferRows < resultRows)
+        {
+            throw std::invalid_argument("simulate output buffer has " +
+                    toString(bufferRows) + " rows, but " +
+                    toString(resultRows) + " are required");
+        }
+
+        // the number of rows written so far, where an event listener
+        // exception ends the result.
+        int written = 0;
 
         try
         {
             // add current state as first row
-            getSelectedValues(self.simulationResult, 0, timeStart);
+            getSelectedValues(outputRow(buffer, bufferCols, 0), timeStart);
+            written = 1;
 
             self.integrator->restart(timeStart);
 
@@ -1468,16 +2390,32 @@ const DoubleMatrix* RoadRunner::simulate(const Dictionary* dict)
                 // get the output, always get at least one output
                 do
                 {
-                    getSelectedValues(self.simulationResult, i, next);
+                    getSelectedValues(outputRow(buffer, bufferCols, i), next);
                     i++;
+                    written = i;
                     next = timeStart + i * hstep;
                 }
                 while((i < self.simulateOpt.steps + 1) && tout > next);
+
+                if (stopCheck.enabled() && (self.simulateStopReason =
+                        stopCheck.check(tout)) != SimulateOptions::STOP_END_TIME)
+                {
+                    resultRows = i;
+                    break;
+                }
             }
         }
         catch (EventListenerException& e)
         {
             Log(Logger::LOG_NOTICE) << e.what();
+            self.simulateStopReason = SimulateOptions::STOP_EVENT_LISTENER;
+            resultRows = written;
+        }
+        catch (IntegratorInterruptedException& e)
+        {
+            Log(Logger::LOG_NOTICE) << e.what() << " at time " << e.time;
+            self.simulateStopReason = stopCheck.getInterruptReason();
+            resultRows = written;
         }
     }
 
@@ -1500,13 +2438,29 @@ const DoubleMatrix* RoadRunner::simulate(const Dictionary* dict)
 
         Log(Logger::LOG_DEBUG) << "starting simulation with " << nrCols << " selected columns";
 
-        // ignored if same
-        self.simulationResult.resize(self.simulateOpt.steps + 1, nrCols);
+        resultRows = self.simulateOpt.steps + 1;
+
+        if (!buffer)
+        {
+            // ignored if same
+            result->resize(resultRows, nrCols);
+        }
+        else if (bufferRows < resultRows)
+        {
+            throw std::invalid_argument("simulate output buffer has " +
+                    toString(bufferRows) + " rows, but " +
+                    toString(resultRows) + " are required");
+        }
+
+        // the number of rows written so far, where an event listener
+        // exception ends the result.
+        int written = 0;
 
         try
         {
             // add current state as first row
-            getSelectedValues(self.simulationResult, 0, timeStart);
+            getSelectedValues(outputRow(buffer, bufferCols, 0), timeStart);
+            written = 1;
 
             self.integrator->restart(timeStart);
 
@@ -1525,12 +2479,28 @@ const DoubleMatrix* RoadRunner::simulate(const Dictionary* dict)
                 // will return a value just slightly off from the exact time
                 // value.
                 tout = timeStart + i * hstep;
-                getSelectedValues(self.simulationResult, i, tout);
+                getSelectedValues(outputRow(buffer, bufferCols, i), tout);
+                written = i + 1;
+
+                if (stopCheck.enabled() && (self.simulateStopReason =
+                        stopCheck.check(tout)) != SimulateOptions::STOP_END_TIME)
+                {
+                    resultRows = i + 1;
+                    break;
+                }
             }
         }
         catch (EventListenerException& e)
         {
             Log(Logger::LOG_NOTICE) << e.what();
+            self.simulateStopReason = SimulateOptions::STOP_EVENT_LISTENER;
+            resultRows = written;
+        }
+        catch (IntegratorInterruptedException& e)
+        {
+            Log(Logger::LOG_NOTICE) << e.what() << " at time " << e.time;
+            self.simulateStopReason = stopCheck.getInterruptReason();
+            resultRows = written;
         }
     }
 
@@ -1538,9 +2508,32 @@ const DoubleMatrix* RoadRunner::simulate(const Dictionary* dict)
 
     self.model->setIntegration(false);
 
+    if (self.simulateStopReason != SimulateOptions::STOP_END_TIME)
+    {
+        Log(Logger::LOG_INFORMATION) << "Simulation stopped early, reason: "
+                << SimulateOptions::stopReasonToString(self.simulateStopReason)
+                << ", rows: " << resultRows;
+    }
+
+    // drop the rows after an early stop from the result matrix.
+    if (result && resultRows < result->RSize())
+    {
+        ls::DoubleMatrix truncated(resultRows, result->CSize());
+        std::copy(result->getArray(),
+                result->getArray() + resultRows * truncated.CSize(),
+                truncated.getArray());
+        truncated.setColNames(result->getColNames());
+        *result = truncated;
+    }
+
     Log(Logger::LOG_DEBUG) << "Simulation done..";
 
-    return &self.simulationResult;
+    return resultRows;
+}
+
+double* RoadRunner::outputRow(double* buffer, int bufferCols, int row)
+{
+    return buffer ? buffer + row * bufferCols : (*impl->simulationResult)[row];
 }
 
 
@@ -1686,6 +2679,27 @@ DoubleMatrix RoadRunner::getFullJacobian()
     return jac;
 }
 
+SparseMatrix RoadRunner::getFullJacobianSparse()
+{
+    check_model();
+
+    get_self();
+
+    SparseMatrix jac = getFullStoichiometryMatrixSparse().multiply(
+            getUnscaledElasticityMatrixSparse());
+
+    // get the row/column ids, independent floating species
+    std::list<std::string> list;
+    self.model->getIds(SelectionRecord::FLOATING_AMOUNT, list);
+    std::vector<std::string> ids(list.begin(), list.end());
+    assert(ids.size() == jac.numRows() &&
+            ids.size() == jac.numCols() && "independent species ids length != numRows && numCols");
+    jac.setColNames(ids);
+    jac.setRowNames(ids);
+
+    return jac;
+}
+
 DoubleMatrix RoadRunner::getFullReorderedJacobian()
 {
     check_model();
@@ -1696,17 +2710,44 @@ DoubleMatrix RoadRunner::getFullReorderedJacobian()
     return mult(*rsm, uelast);
 }
 
-DoubleMatrix RoadRunner::getReducedJacobian(double h)
+/**
+ * the reduced Jacobian is the independent floating species block of the
+ * state vector Jacobian, which follows the rate rules in the state vector.
+ */
+static JacobianColoring* createReducedJacobianColoring(ExecutableModel* model)
 {
-    get_self();
+    int nIndSpecies = model->getNumIndFloatingSpecies();
+    int nRateRules = model->getNumRateRules();
 
-    check_model();
+    std::vector<std::vector<unsigned> > statePattern;
+    if (!model->getStateVectorJacobianPattern(statePattern))
+    {
+        Log(Logger::LOG_DEBUG) << "no Jacobian pattern available, using dense Jacobian";
+        return new JacobianColoring(nIndSpecies, nIndSpecies);
+    }
 
-    if (h <= 0)
+    std::vector<std::vector<unsigned> > pattern(nIndSpecies);
+    for (int i = 0; i < nIndSpecies; ++i)
     {
-        h = self.roadRunnerOptions.jacobianStepSize;
+        const std::vector<unsigned>& rows = statePattern[nRateRules + i];
+        for (int j = 0; j < rows.size(); ++j)
+        {
+            if (rows[j] >= nRateRules)
+            {
+                pattern[i].push_back(rows[j] - nRateRules);
+            }
+        }
     }
 
+    return new JacobianColoring(nIndSpecies, pattern);
+}
+
+DoubleMatrix RoadRunner::getReducedJacobian(double h)
+{
+    get_self();
+
+    check_model();
+
     int nIndSpecies = self.model->getNumIndFloatingSpecies();
 
     // result matrix
@@ -1720,6 +2761,60 @@ DoubleMatrix RoadRunner::getReducedJacobian(double h)
     jac.setColNames(ids);
     jac.setRowNames(ids);
 
+    std::vector<int> rows;
+    std::vector<int> cols;
+    std::vector<double> values;
+    getReducedJacobianEntries(h, rows, cols, values);
+
+    for (int i = 0; i < values.size(); ++i)
+    {
+        jac(rows[i], cols[i]) = values[i];
+    }
+
+    return jac;
+}
+
+SparseMatrix RoadRunner::getReducedJacobianSparse(double h)
+{
+    get_self();
+
+    check_model();
+
+    int nIndSpecies = self.model->getNumIndFloatingSpecies();
+
+    std::vector<int> rows;
+    std::vector<int> cols;
+    std::vector<double> values;
+    getReducedJacobianEntries(h, rows, cols, values);
+
+    SparseMatrix jac = SparseMatrix::fromTriplets(nIndSpecies, nIndSpecies,
+            rows, cols, values);
+
+    std::list<std::string> list;
+    self.model->getIds(SelectionRecord::INDEPENDENT_FLOATING_AMOUNT, list);
+    std::vector<std::string> ids(list.begin(), list.end());
+    jac.setColNames(ids);
+    jac.setRowNames(ids);
+
+    return jac;
+}
+
+void RoadRunner::getReducedJacobianEntries(double h, std::vector<int>& rows,
+        std::vector<int>& cols, std::vector<double>& values)
+{
+    get_self();
+
+    if (h <= 0)
+    {
+        h = self.roadRunnerOptions.jacobianStepSize;
+    }
+
+    int nIndSpecies = self.model->getNumIndFloatingSpecies();
+
+    rows.clear();
+    cols.clear();
+    values.clear();
+
     // need 2 buffers for rate central difference.
     std::vector<double> dy0v(nIndSpecies);
     std::vector<double> dy1v(nIndSpecies);
@@ -1754,37 +2849,62 @@ DoubleMatrix RoadRunner::getReducedJacobian(double h)
         setValuePtr =     &ExecutableModel::setFloatingSpeciesConcentrations;
     }
 
-    for (int i = 0; i < nIndSpecies; ++i)
+    if (!self.reducedJacobianColoring)
     {
-        double savedVal = 0;
-        double y = 0;
+        self.reducedJacobianColoring = createReducedJacobianColoring(self.model);
+    }
+
+    const JacobianColoring& coloring = *self.reducedJacobianColoring;
 
-        // current value of species i
-        (self.model->*getValuePtr)(1, &i, &savedVal);
+    std::vector<double> savedVals(nIndSpecies);
+    std::vector<double> y(nIndSpecies);
+    (self.model->*getValuePtr)(nIndSpecies, 0, &savedVals[0]);
+
+    // perturb all of the structurally independent species of a colour at
+    // once, each rate only depends on one of them.
+    for (int c = 0; c < coloring.getNumColors(); ++c)
+    {
+        const std::vector<unsigned>& colorCols = coloring.getColorColumns(c);
+        const std::vector<int> indxv(colorCols.begin(), colorCols.end());
+        const int *indx = &indxv[0];
 
         // get the entire rate of change for all the species with
-        // species i being value(i) + h;
-        y = savedVal + h;
-        (self.model->*setValuePtr)(1, &i, &y);
+        // species of this colour being value(i) + h;
+        for (int i = 0; i < colorCols.size(); ++i)
+        {
+            y[i] = savedVals[colorCols[i]] + h;
+        }
+        (self.model->*setValuePtr)(colorCols.size(), indx, &y[0]);
         (self.model->*getRateValuePtr)(nIndSpecies, 0, dy0);
 
-
         // get the entire rate of change for all the species with
-        // species i being value(i) - h;
-        y = savedVal - h;
-        (self.model->*setValuePtr)(1, &i, &y);
+        // species of this colour being value(i) - h;
+        for (int i = 0; i < colorCols.size(); ++i)
+        {
+            y[i] = savedVals[colorCols[i]] - h;
+        }
+        (self.model->*setValuePtr)(colorCols.size(), indx, &y[0]);
         (self.model->*getRateValuePtr)(nIndSpecies, 0, dy1);
 
-        // restore original value
-        (self.model->*setValuePtr)(1, &i, &savedVal);
+        // restore original values
+        for (int i = 0; i < colorCols.size(); ++i)
+        {
+            y[i] = savedVals[colorCols[i]];
+        }
+        (self.model->*setValuePtr)(colorCols.size(), indx, &y[0]);
 
-        // matrix is row-major, so have to copy by elements
-       for (int j = 0; j < nIndSpecies; ++j)
-       {
-           jac(j, i) = (dy0[j] - dy1[j]) / (2.0*h) ;
-       }
+        // only the structurally non-zero rows of each column
+        for (int i = 0; i < colorCols.size(); ++i)
+        {
+            const std::vector<unsigned>& colRows = coloring.getColumnRows(colorCols[i]);
+            for (int j = 0; j < colRows.size(); ++j)
+            {
+                rows.push_back(colRows[j]);
+                cols.push_back(colorCols[i]);
+                values.push_back((dy0[colRows[j]] - dy1[colRows[j]]) / (2.0*h));
+            }
+        }
     }
-    return jac;
 }
 
 DoubleMatrix RoadRunner::getLinkMatrix()
@@ -1801,6 +2921,12 @@ DoubleMatrix RoadRunner::getLinkMatrix()
     return res;
 }
 
+SparseMatrix RoadRunner::getLinkMatrixSparse()
+{
+    // libstruct only has a dense link matrix, this avoids the copy.
+    return SparseMatrix::fromDense(getLinkMatrix());
+}
+
 DoubleMatrix RoadRunner::getReducedStoichiometryMatrix()
 {
     return getNrMatrix();
@@ -1860,6 +2986,25 @@ DoubleMatrix RoadRunner::getFullStoichiometryMatrix()
     return m;
 }
 
+SparseMatrix RoadRunner::getFullStoichiometryMatrixSparse()
+{
+    check_model();
+    get_self();
+
+    // libstruct reorders the species for conservation conversion, and it
+    // only has a dense matrix.
+    if (self.loadOpt.getConservedMoietyConversion())
+    {
+        return SparseMatrix::fromDense(getFullStoichiometryMatrix());
+    }
+
+    SparseMatrix m;
+    self.model->getSparseStoichiometryMatrix(m);
+    m.setRowNames(getFloatingSpeciesIds());
+    m.setColNames(getReactionIds());
+    return m;
+}
+
 DoubleMatrix RoadRunner::getL0Matrix()
 {
     check_model();
@@ -1907,6 +3052,11 @@ DoubleMatrix RoadRunner::getConservationMatrix()
     }
 }
 
+SparseMatrix RoadRunner::getConservationMatrixSparse()
+{
+    return SparseMatrix::fromDense(getConservationMatrix());
+}
+
 // Help("Returns the number of dependent species in the model")
 int RoadRunner::getNumberOfDependentSpecies()
 {
@@ -2013,6 +3163,7 @@ vector<double> RoadRunner::getSteadyStateValues()
     steadyState();
 
     vector<double> result; //= new double[oSelection.Length];
+    SelectionRowScope row(impl->rowCache);
     for (int i = 0; i < impl->mSteadyStateSelection.size(); i++)
     {
         result.push_back(getValue(impl->mSteadyStateSelection[i]));
@@ -2046,6 +3197,7 @@ DoubleMatrix RoadRunner::getSteadyStateValuesNamedArray()
     steadyState();
 
     DoubleMatrix v(1,impl->mSteadyStateSelection.size());
+    SelectionRowScope row(impl->rowCache);
     for (int i = 0; i < impl->mSteadyStateSelection.size(); i++)
     {
         v(0,i) = getValue(impl->mSteadyStateSelection[i]);
@@ -2643,9 +3795,33 @@ double RoadRunner::getUnscaledSpeciesElasticity(int reactionId, int speciesIndex
 
     check_model();
 
+    if (reactionId < 0 || reactionId >= self.model->getNumReactions())
+    {
+        throw std::out_of_range("invalid reaction index");
+    }
+
+    std::vector<double> column(self.model->getNumReactions());
+    getUnscaledSpeciesElasticityColumn(speciesIndex, &column[0]);
+    return column[reactionId];
+}
+
+void RoadRunner::getUnscaledSpeciesElasticityColumn(int speciesIndex,
+        double* column)
+{
+    get_self();
+
+    check_model();
+
     // make sure no rate rules or events
     metabolicControlCheck(self.model);
 
+    const int nReactions = self.model->getNumReactions();
+
+    if (nReactions == 0)
+    {
+        return;
+    }
+
     // function pointers to the model get values and get init values based on
     // if we are doing amounts or concentrations.
     typedef int (ExecutableModel::*GetValueFuncPtr)(int len, int const *indx,
@@ -2676,7 +3852,12 @@ double RoadRunner::getUnscaledSpeciesElasticity(int reactionId, int speciesIndex
 
     double value;
     double originalConc = 0;
-    double result = std::numeric_limits<double>::quiet_NaN();
+
+    // rates of all the reactions at each of the four perturbations
+    std::vector<double> fi(nReactions);
+    std::vector<double> fi2(nReactions);
+    std::vector<double> fd(nReactions);
+    std::vector<double> fd2(nReactions);
 
     // note setting init values auotmatically sets the current values to the
     // init values
@@ -2719,31 +3900,30 @@ double RoadRunner::getUnscaledSpeciesElasticity(int reactionId, int speciesIndex
         value = originalConc + hstep;
         (self.model->*setInitValuePtr)(1, &speciesIndex, &value);
 
-        double fi = 0;
-        self.model->getReactionRates(1, &reactionId, &fi);
+        self.model->getReactionRates(nReactions, 0, &fi[0]);
 
         value = originalConc + 2*hstep;
         (self.model->*setInitValuePtr)(1, &speciesIndex, &value);
-        double fi2 = 0;
-        self.model->getReactionRates(1, &reactionId, &fi2);
+        self.model->getReactionRates(nReactions, 0, &fi2[0]);
 
         value = originalConc - hstep;
         (self.model->*setInitValuePtr)(1, &speciesIndex, &value);
-        double fd = 0;
-        self.model->getReactionRates(1, &reactionId, &fd);
+        self.model->getReactionRates(nReactions, 0, &fd[0]);
 
         value = originalConc - 2*hstep;
         (self.model->*setInitValuePtr)(1, &speciesIndex, &value);
-        double fd2 = 0;
-        self.model->getReactionRates(1, &reactionId, &fd2);
+        self.model->getReactionRates(nReactions, 0, &fd2[0]);
 
         // Use instead the 5th order approximation
         // double unscaledElasticity = (0.5/hstep)*(fi-fd);
         // The following separated lines avoid small amounts of roundoff error
-        double f1 = fd2 + 8*fi;
-        double f2 = -(8*fd + fi2);
+        for (int i = 0; i < nReactions; ++i)
+        {
+            double f1 = fd2[i] + 8*fi[i];
+            double f2 = -(8*fd[i] + fi2[i]);
 
-        result = 1/(12*hstep)*(f1 + f2);
+            column[i] = 1/(12*hstep)*(f1 + f2);
+        }
     }
     catch(const std::exception& e)
     {
@@ -2766,8 +3946,6 @@ double RoadRunner::getUnscaledSpeciesElasticity(int reactionId, int speciesIndex
     // only set the indep species, setting dep species is not permitted.
     (self.model->*setValuePtr)(
             self.model->getNumIndFloatingSpecies(), 0, &conc[0]);
-
-    return result;
 }
 
 
@@ -2783,17 +3961,63 @@ DoubleMatrix RoadRunner::getUnscaledElasticityMatrix()
     uElastMatrix.setRowNames(getReactionIds());
     uElastMatrix.setColNames(getFloatingSpeciesIds());
 
-    for (int i = 0; i < self.model->getNumReactions(); i++)
+    // one column, all of the reactions, per species perturbation.
+    std::vector<double> column(self.model->getNumReactions());
+
+    for (int j = 0; j < self.model->getNumFloatingSpecies(); j++)
     {
-        for (int j = 0; j < self.model->getNumFloatingSpecies(); j++)
+        getUnscaledSpeciesElasticityColumn(j, column.empty() ? 0 : &column[0]);
+
+        for (int i = 0; i < self.model->getNumReactions(); i++)
         {
-            uElastMatrix[i][j] = getUnscaledSpeciesElasticity(i, j);
+            uElastMatrix[i][j] = column[i];
         }
     }
 
     return uElastMatrix;
 }
 
+SparseMatrix RoadRunner::getUnscaledElasticityMatrixSparse()
+{
+    get_self();
+
+    check_model();
+
+    const int nReactions = self.model->getNumReactions();
+    const int nSpecies = self.model->getNumFloatingSpecies();
+
+    std::vector<int> rows;
+    std::vector<int> cols;
+    std::vector<double> values;
+
+    // only a column is ever dense, reactions which do not depend on the
+    // species have exactly the same rate at every perturbation, so their
+    // elasticity is exactly zero and is not stored.
+    std::vector<double> column(nReactions);
+
+    for (int j = 0; j < nSpecies; j++)
+    {
+        getUnscaledSpeciesElasticityColumn(j, column.empty() ? 0 : &column[0]);
+
+        for (int i = 0; i < nReactions; i++)
+        {
+            if (column[i] != 0)
+            {
+                rows.push_back(i);
+                cols.push_back(j);
+                values.push_back(column[i]);
+            }
+        }
+    }
+
+    SparseMatrix result = SparseMatrix::fromTriplets(nReactions, nSpecies,
+            rows, cols, values);
+    result.setRowNames(getReactionIds());
+    result.setColNames(getFloatingSpeciesIds());
+
+    return result;
+}
+
 DoubleMatrix RoadRunner::getScaledElasticityMatrix()
 {
     get_self();
@@ -2830,6 +4054,42 @@ DoubleMatrix RoadRunner::getScaledElasticityMatrix()
 }
 
 
+SparseMatrix RoadRunner::getScaledElasticityMatrixSparse()
+{
+    get_self();
+
+    check_model();
+
+    SparseMatrix uelast = getUnscaledElasticityMatrixSparse();
+
+    vector<double> rates(self.model->getNumReactions());
+    self.model->getReactionRates(rates.size(), 0, rates.empty() ? 0 : &rates[0]);
+
+    vector<double> conc(self.model->getNumFloatingSpecies());
+    self.model->getFloatingSpeciesConcentrations(conc.size(), 0,
+            conc.empty() ? 0 : &conc[0]);
+
+    const std::vector<int>& rowptr = uelast.getRowPointers();
+    const std::vector<int>& colidx = uelast.getColumnIndices();
+    const std::vector<double>& values = uelast.getValues();
+
+    SparseMatrix result(0, uelast.numCols());
+    result.setRowNames(uelast.getRowNames());
+    result.setColNames(uelast.getColNames());
+
+    for (int i = 0; i < uelast.numRows(); i++)
+    {
+        for (int k = rowptr[i]; k < rowptr[i + 1]; k++)
+        {
+            result.addEntry(colidx[k], values[k]*conc[colidx[k]]/rates[i]);
+        }
+        result.endRow();
+    }
+
+    return result;
+}
+
+
 double RoadRunner::getScaledFloatingSpeciesElasticity(const string& reactionName,
         const string& speciesName)
 {
@@ -3336,6 +4596,60 @@ void RoadRunner::setValue(const string& sId, double dValue)
     }
 }
 
+ValueHandle RoadRunner::createValueHandle(const std::vector<std::string>& ids)
+{
+    check_model();
+
+    return impl->model->createValueHandle(ids);
+}
+
+std::vector<double> RoadRunner::getValues(const ValueHandle& handle)
+{
+    std::vector<double> values(handle.size());
+
+    if (values.size())
+    {
+        getValues(handle, &values[0]);
+    }
+
+    return values;
+}
+
+void RoadRunner::getValues(const ValueHandle& handle, double* values)
+{
+    check_model();
+
+    impl->model->getIndexedValues(handle, values);
+}
+
+void RoadRunner::setValues(const ValueHandle& handle, const std::vector<double>& values)
+{
+    if (values.size() != handle.size())
+    {
+        throw std::invalid_argument("expected " + toString((int)handle.size())
+                + " values, but got " + toString((int)values.size()));
+    }
+
+    if (values.size())
+    {
+        setValues(handle, &values[0]);
+    }
+}
+
+void RoadRunner::setValues(const ValueHandle& handle, const double* values)
+{
+    check_model();
+
+    impl->model->setIndexedValues(handle, values);
+
+    // one reset for all the initial values, instead of one for each.
+    if (handle.hasType(SelectionRecord::INITIAL_FLOATING_AMOUNT) ||
+            handle.hasType(SelectionRecord::INITIAL_FLOATING_CONCENTRATION))
+    {
+        reset();
+    }
+}
+
 
 double RoadRunner::getValue(const std::string& sel)
 {
@@ -3353,6 +4667,7 @@ vector<double> RoadRunner::getSelectedValues()
     vector<double> result;
     result.resize(impl->mSelectionList.size());
 
+    SelectionRowScope row(impl->rowCache);
     for (int i = 0; i < impl->mSelectionList.size(); i++)
     {
         result[i] = getNthSelectedOutput(i, impl->model->getTime());
@@ -3572,7 +4887,12 @@ void RoadRunner::setSelections(const vector<string>& _selList)
     {
         selstr[i] = impl->mSelectionList[i].to_string();
     }
-    impl->simulationResult.setColNames(selstr.begin(), selstr.end());
+    // a result still shared keeps its names.
+    if (!impl->simulationResult.unique())
+    {
+        impl->simulationResult.reset(new DoubleMatrix(*impl->simulationResult));
+    }
+    impl->simulationResult->setColNames(selstr.begin(), selstr.end());
 }
 
 void RoadRunner::setSelections(const std::vector<rr::SelectionRecord>& ss)
@@ -4031,7 +5351,17 @@ RoadRunnerOptions& RoadRunner::getOptions()
 
 const DoubleMatrix* RoadRunner::getSimulationData() const
 {
-    return &impl->simulationResult;
+    return impl->simulationResult.get();
+}
+
+cxx11_ns::shared_ptr<const DoubleMatrix> RoadRunner::getSharedSimulationData() const
+{
+    return impl->simulationResult;
+}
+
+SimulateOptions::StopReason RoadRunner::getSimulateStopReason() const
+{
+    return impl->simulateStopReason;
 }
 
 void RoadRunner::applySimulateOptions()
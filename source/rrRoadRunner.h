@@ -5,6 +5,9 @@
 #include "rr-libstruct/lsMatrix.h"
 #include "rrSelectionRecord.h"
 #include "rrRoadRunnerOptions.h"
+#include "rrSparseMatrix.h"
+#include "rrValueHandle.h"
+#include "tr1proxy/rr_memory.h"
 
 #include <string>
 #include <vector>
@@ -23,6 +26,7 @@ class SBMLModelSimulation;
 class ExecutableModel;
 class Integrator;
 class SteadyStateSolver;
+class SimulateFuture;
 
 /**
  * The main RoadRunner class.
@@ -94,6 +98,27 @@ public:
      */
     std::string getInfo();
 
+    /**
+     * performance counters and timers of the current model.
+     *
+     * The counters describe the last simulate or steadyState run, i.e. the
+     * number of model evaluations, events, selections and the CVODE and NLEQ
+     * solver statistics. The timers are in seconds and accumulate over all
+     * runs since the model was loaded, and include the load phases, see
+     * PerfCounters for the keys.
+     *
+     * The values are only recorded if roadrunner was built with
+     * RR_PERF_COUNTERS, the "enabled" item tells if it was.
+     *
+     * @return a dictionary owned by this object, valid until the next call.
+     */
+    const Dictionary* getPerformanceCounters();
+
+    /**
+     * clear the performance counters and timers of the current model.
+     */
+    void resetPerformanceCounters();
+
     /**
      * The Compiler that the ModelGenerator is using to compile / interpret sbml code.
      */
@@ -236,12 +261,62 @@ public:
      */
     const ls::DoubleMatrix *simulate(const Dictionary* options = 0);
 
+    /**
+     * Simulate the current model, but write the selected values directly
+     * into a caller owned buffer instead of the internal result matrix.
+     *
+     * The buffer is C (row major) ordered, with one row per time point,
+     * and one column per time course selection. This allows the result to
+     * be written straight into memory owned by the caller, i.e. a numpy
+     * array, with no intermediate copy. The internal simulation data
+     * (getSimulationData) is not changed.
+     *
+     * For fixed step simulations, the buffer must have at least steps + 1
+     * rows. Variable step simulations stop when the buffer is full.
+     *
+     * @param options: same as simulate(const Dictionary*)
+     * @param buffer: the output buffer, must have rows * cols elements.
+     * @param rows: number of rows in the output buffer.
+     * @param cols: number of columns, must be equal to the number of
+     * time course selections.
+     * @throws std::invalid_argument if the buffer is too small.
+     * @returns the number of rows written.
+     */
+    int simulate(const Dictionary* options, double* buffer, int rows, int cols);
+
     /**
      * RoadRunner keeps a copy of the simulation data around until the
      * next call to simulate. This matrix can be obtained here.
      */
     const ls::DoubleMatrix* getSimulationData() const;
 
+    /**
+     * the simulation data, shared with the caller. As long as the caller
+     * holds on to it, the next simulation writes to a new matrix, so it
+     * stays valid and unchanged without being copied. The Python bindings
+     * use this to hand the result to numpy without a copy.
+     */
+    cxx11_ns::shared_ptr<const ls::DoubleMatrix> getSharedSimulationData() const;
+
+    /**
+     * why the last simulation stopped. If it stopped early because of one
+     * of the stop conditions in the SimulateOptions, the result only has
+     * the rows up to and including the point where it stopped.
+     */
+    SimulateOptions::StopReason getSimulateStopReason() const;
+
+    /**
+     * start a simulation on a background thread and return immediately.
+     *
+     * The options are the same as simulate(const Dictionary*), and are
+     * copied. The returned object reports the progress of the simulation,
+     * can cancel it, and waits for its result, the caller owns it and must
+     * delete it. Until it is done this RoadRunner object must not be used
+     * for anything else, and only one asynchronous run may be in progress
+     * at a time.
+     */
+    SimulateFuture* simulateAsync(const Dictionary* options = 0);
+
     #ifndef SWIG // deprecated methods not SWIG'ed
 
     #endif
@@ -420,6 +495,42 @@ public:
      */
     void setValue(const std::string& id, double value);
 
+    /**
+     * resolve a list of ids once into a handle for getValues and setValues,
+     * which then get or set all of them at once without looking up any of
+     * the ids again, see ValueHandle.
+     *
+     * The ids are the model values accepted by setValue, and the ones
+     * getValue accepts for the model, i.e. "S1", "[S1]", "init(k1)" or
+     * "J1", but not the derived values like control coefficients or
+     * eigenvalues. The handle is only valid until another model is loaded.
+     */
+    ValueHandle createValueHandle(const std::vector<std::string>& ids);
+
+    /**
+     * get the current values of the ids of a handle.
+     */
+    std::vector<double> getValues(const ValueHandle& handle);
+
+    /**
+     * get the current values of the ids of a handle into an array which
+     * has room for handle.size() values.
+     */
+    void getValues(const ValueHandle& handle, double* values);
+
+    /**
+     * set the values of the ids of a handle, there must be handle.size()
+     * values. Setting initial species values resets the model once, like
+     * setValue does for each of them.
+     */
+    void setValues(const ValueHandle& handle, const std::vector<double>& values);
+
+    /**
+     * set the values of the ids of a handle from an array of
+     * handle.size() values.
+     */
+    void setValues(const ValueHandle& handle, const double* values);
+
 /************************ End Selection Ids Species Section *******************/
 #endif /***********************************************************************/
 /******************************************************************************/
@@ -441,6 +552,13 @@ public:
      */
     ls::DoubleMatrix getFullJacobian();
 
+    /**
+     * compute the full Jacobian at the current operating point as a sparse
+     * matrix, the product of the sparse stoichiometry and elasticity
+     * matrices. No dense matrix is created.
+     */
+    SparseMatrix getFullJacobianSparse();
+
     ls::DoubleMatrix getFullReorderedJacobian();
 
     /**
@@ -450,6 +568,15 @@ public:
      */
     ls::DoubleMatrix getReducedJacobian(double h = -1.0);
 
+    /**
+     * Compute the reduced Jacobian at the current operating point as a
+     * sparse matrix, only the structurally non-zero entries are evaluated
+     * and stored.
+     * @param h The step sized used for central difference method.
+     *          If negative, the default value from the config file is used.
+     */
+    SparseMatrix getReducedJacobianSparse(double h = -1.0);
+
     /**
      * Returns the eigenvalues of the full jacobian.
      *
@@ -471,6 +598,11 @@ public:
 
     ls::DoubleMatrix getLinkMatrix();
 
+    /**
+     * the link matrix in compressed sparse row format.
+     */
+    SparseMatrix getLinkMatrixSparse();
+
     /**
      * get the reduced stochiometry matrix. If conservation conversion is enabled,
      * this is the matrix that coresponds to the independent species.
@@ -500,11 +632,24 @@ public:
      */
     ls::DoubleMatrix getFullStoichiometryMatrix();
 
+    /**
+     * the full stoichiometry matrix in compressed sparse row format. Unless
+     * the conservation conversion is enabled, this comes straight from the
+     * sparse matrix in the model and no dense matrix is created.
+     */
+    SparseMatrix getFullStoichiometryMatrixSparse();
+
 
     ls::DoubleMatrix getL0Matrix();
 
 
     ls::DoubleMatrix getConservationMatrix();
+
+    /**
+     * the conservation matrix in compressed sparse row format.
+     */
+    SparseMatrix getConservationMatrixSparse();
+
     ls::DoubleMatrix getUnscaledConcentrationControlCoefficientMatrix();
     ls::DoubleMatrix getScaledConcentrationControlCoefficientMatrix();
     ls::DoubleMatrix getUnscaledFluxControlCoefficientMatrix();
@@ -624,11 +769,24 @@ public:
      */
     ls::DoubleMatrix getUnscaledElasticityMatrix();
 
+    /**
+     * Compute the unscaled species elasticity matrix at the current operating
+     * point in compressed sparse row format, the species are perturbed one
+     * at a time and only the non-zero elasticities are kept.
+     */
+    SparseMatrix getUnscaledElasticityMatrixSparse();
+
     /**
      * Compute the unscaled elasticity matrix at the current operating point
      */
     ls::DoubleMatrix getScaledElasticityMatrix();
 
+    /**
+     * Compute the scaled elasticity matrix at the current operating point in
+     * compressed sparse row format.
+     */
+    SparseMatrix getScaledElasticityMatrixSparse();
+
     /**
      * Compute the scaled elasticity for a given reaction and given species
      */
@@ -665,6 +823,13 @@ public:
      */
     ls::DoubleMatrix steadyStateNamedArray(const Dictionary* dict = 0);
 
+    /**
+     * compute the steady state on a background thread, like simulateAsync.
+     * The steady state solvers can not be interrupted, so cancelling only
+     * takes effect if the calculation has not yet started.
+     */
+    SimulateFuture* steadyStateAsync();
+
     /**
      * returns the current set of steady state selections.
      */
@@ -962,6 +1127,13 @@ public:
 
 private:
 
+    friend class SimulateFuture;
+
+    /**
+     * the asynchronous run in progress on this object, or null when it is
+     * finished.
+     */
+    void setFuture(SimulateFuture* future);
 
     int createDefaultSteadyStateSelectionList();
     int createDefaultTimeCourseSelectionList();
@@ -978,6 +1150,26 @@ private:
      */
     void getSelectedValues(std::vector<double> &results, double currentTime);
 
+    /**
+     * copies the current selection values into the given row, which
+     * must have room for all selections.
+     */
+    void getSelectedValues(double *results, double currentTime);
+
+    /**
+     * performs the simulation with the current simulate options, writes
+     * into buffer if given, otherwise to the simulationResult matrix.
+     *
+     * @returns the number of rows written.
+     */
+    int simulateImpl(double* buffer, int bufferRows, int bufferCols);
+
+    /**
+     * the n'th output row of a simulation, either in the given buffer,
+     * or the simulationResult matrix if buffer is NULL.
+     */
+    double* outputRow(double* buffer, int bufferCols, int row);
+
     bool populateResult();
 
 
@@ -995,6 +1187,19 @@ private:
     double getVariableValue(const VariableType variableType,
             const int variableIndex);
 
+    /**
+     * the unscaled elasticities of all the reactions with respect to one
+     * floating species, column must have room for getNumReactions values.
+     */
+    void getUnscaledSpeciesElasticityColumn(int speciesIndex, double* column);
+
+    /**
+     * evaluate the structurally non-zero entries of the reduced Jacobian,
+     * in coordinate format.
+     */
+    void getReducedJacobianEntries(double h, std::vector<int>& rows,
+            std::vector<int>& cols, std::vector<double>& values);
+
     /**
      * the LibStruct is normally null, only created on demand here.
      */
@@ -9,6 +9,7 @@
 #include "Poco/TemporaryFile.h"
 #include "rrRoadRunnerData.h"
 #include "rrRoadRunner.h"
+#include "rrColumnarData.h"
 
 
 //---------------------------------------------------------------------------
@@ -337,8 +338,63 @@ bool RoadRunnerData::loadSimpleFormat(const string& fName)
     return true;
 }
 
+static bool isBinaryFileName(const string& fileName)
+{
+    const string ext = ColumnarDataWriter::fileExtension;
+    return fileName.size() > ext.size() &&
+            fileName.compare(fileName.size() - ext.size(), ext.size(), ext) == 0;
+}
+
+bool RoadRunnerData::writeBinary(const string& fileName, bool compress) const
+{
+    if(!check())
+    {
+        Log(Logger::LOG_ERROR)<<"Can't write data.. the dimension of the header don't agree with nr of cols of data";
+        return false;
+    }
+
+    try
+    {
+        ColumnarDataWriter writer(fileName, mColumnNames, 4096, compress);
+
+        // ls matrix is row major
+        const double* data = const_cast<DoubleMatrix&>(mTheData).getArray();
+        writer.writeRows(data, mTheData.RSize());
+        writer.close();
+        return true;
+    }
+    catch(const std::exception& e)
+    {
+        Log(Logger::LOG_ERROR)<<"Failed writing file: "<<fileName<<", "<<e.what();
+        return false;
+    }
+}
+
+bool RoadRunnerData::readBinary(const string& fileName)
+{
+    try
+    {
+        ColumnarDataReader reader(fileName);
+        mColumnNames = reader.getColumnNames();
+        mTheData.resize(reader.getNumRows(), reader.getNumCols());
+        mWeights.resize(0,0);
+        reader.readRows(mTheData.getArray());
+        return true;
+    }
+    catch(const std::exception& e)
+    {
+        Log(Logger::LOG_ERROR)<<"Failed reading file: "<<fileName<<", "<<e.what();
+        return false;
+    }
+}
+
 bool RoadRunnerData::writeTo(const string& fileName) const
 {
+    if(isBinaryFileName(fileName))
+    {
+        return writeBinary(fileName);
+    }
+
     ofstream aFile(fileName.c_str());
     if(!aFile)
     {
@@ -359,6 +415,11 @@ bool RoadRunnerData::writeTo(const string& fileName) const
 
 bool RoadRunnerData::readFrom(const string& fileName)
 {
+    if(isBinaryFileName(fileName))
+    {
+        return readBinary(fileName);
+    }
+
     ifstream aFile(fileName.c_str());
     if(!aFile)
     {
@@ -65,6 +65,18 @@ public:
 
     bool readFrom(const std::string& fileName);
 
+    /**
+     * write the data (without weights) in the binary columnar format,
+     * @see ColumnarDataWriter. writeTo also uses this format if the file
+     * name has the ColumnarDataWriter::fileExtension extension.
+     */
+    bool writeBinary(const std::string& fileName, bool compress = false) const;
+
+    /**
+     * read data from a binary columnar file, @see ColumnarDataReader.
+     */
+    bool readBinary(const std::string& fileName);
+
     bool check() const;
 
     bool structuredResult;
@@ -83,7 +83,10 @@ namespace rr
 		:
 		steps(Config::getInt(Config::SIMULATEOPTIONS_STEPS)),
 		start(0),
-		duration(Config::getDouble(Config::SIMULATEOPTIONS_DURATION))
+		duration(Config::getDouble(Config::SIMULATEOPTIONS_DURATION)),
+		steady_state_tolerance(0),
+		steady_state_window(0),
+		max_wall_time(0)
 	{
 		getConfigValues(this);
 	}
@@ -205,7 +208,15 @@ namespace rr
 
 		ss << "'start' : " << start << "," << std::endl;
 
-		ss << "'duration' : " << duration;
+		ss << "'duration' : " << duration << "," << std::endl;
+
+		ss << "'steadyStateTolerance' : " << steady_state_tolerance << "," << std::endl;
+
+		ss << "'steadyStateWindow' : " << steady_state_window << "," << std::endl;
+
+		ss << "'stopCondition' : '" << stop_condition << "'," << std::endl;
+
+		ss << "'maxWallTime' : " << max_wall_time;
 
 		std::vector<std::string> keys = getKeys();
 
@@ -228,6 +239,27 @@ namespace rr
 		return ss.str();
 	}
 
+	std::string SimulateOptions::stopReasonToString(StopReason reason)
+	{
+		switch (reason)
+		{
+		case STOP_END_TIME:
+			return "end_time";
+		case STOP_STEADY_STATE:
+			return "steady_state";
+		case STOP_CONDITION:
+			return "stop_condition";
+		case STOP_WALL_TIME:
+			return "wall_time";
+		case STOP_EVENT_LISTENER:
+			return "event_listener";
+		case STOP_CANCELLED:
+			return "cancelled";
+		default:
+			return "unknown";
+		}
+	}
+
 	std::string SimulateOptions::toRepr() const
 	{
 		std::stringstream ss;
@@ -317,6 +349,15 @@ namespace rr
 		if (Config::getBool(Config::LLVM_SYMBOL_CACHE))
 			modelGeneratorOpt |= LoadSBMLOptions::LLVM_SYMBOL_CACHE;
 
+		if (Config::getInt(Config::LOADSBMLOPTIONS_OPTIMIZE_LEVEL) == 2)
+			modelGeneratorOpt |= LoadSBMLOptions::OPTIMIZE_LEVEL_2;
+
+		if (Config::getInt(Config::LOADSBMLOPTIONS_OPTIMIZE_LEVEL) >= 3)
+			modelGeneratorOpt |= LoadSBMLOptions::OPTIMIZE_LEVEL_3;
+
+		if (Config::getBool(Config::LOADSBMLOPTIONS_FAST_MATH))
+			modelGeneratorOpt |= LoadSBMLOptions::FAST_MATH;
+
 
 		setItem("tempDir", "");
 		setItem("compiler", "LLVM");
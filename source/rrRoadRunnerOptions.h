@@ -133,7 +133,29 @@ namespace rr
 			USE_MCJIT = (0x1 << 10),
 
 
-			LLVM_SYMBOL_CACHE = (0x1 << 11)
+			LLVM_SYMBOL_CACHE = (0x1 << 11),
+
+			/**
+			* Run the function level part of the standard -O2 pipeline on the
+			* generated code, including the loop and SLP vectorizers, rather
+			* than the individual passes above.
+			*/
+			OPTIMIZE_LEVEL_2 = (0x1 << 12),
+
+			/**
+			* As OPTIMIZE_LEVEL_2, with the aggressive code generator
+			* optimization level.
+			*/
+			OPTIMIZE_LEVEL_3 = (0x1 << 13),
+
+			/**
+			* Allow fast math on the kinetic laws and rate rules, re-association
+			* and contraction of multiplies and adds into fused multiply adds.
+			* The results may differ in the last bits from the strict IEEE
+			* evaluation, and NaN and infinite rates are not preserved, so this
+			* is only on when asked for.
+			*/
+			FAST_MATH = (0x1 << 14)
 		};
 
 		enum LoadOpt
@@ -301,6 +323,84 @@ namespace rr
 		*/
 		std::vector<std::string> concentrations;
 
+		/**
+		* Why a simulation stopped, see RoadRunner::getSimulateStopReason.
+		*/
+		enum StopReason
+		{
+			/**
+			* integrated to start + duration, or to the maximum number of rows.
+			*/
+			STOP_END_TIME = 0,
+
+			/**
+			* the norm of the state vector rate stayed below
+			* steady_state_tolerance for steady_state_window time units.
+			*/
+			STOP_STEADY_STATE,
+
+			/**
+			* the stop_condition became true.
+			*/
+			STOP_CONDITION,
+
+			/**
+			* the simulation ran for longer than max_wall_time.
+			*/
+			STOP_WALL_TIME,
+
+			/**
+			* an integrator listener asked to stop.
+			*/
+			STOP_EVENT_LISTENER,
+
+			/**
+			* an asynchronous simulation was cancelled, see
+			* RoadRunner::simulateAsync.
+			*/
+			STOP_CANCELLED
+		};
+
+		/**
+		* Stop the simulation once the model is at steady state, that is when
+		* the 2-norm of the state vector rate, ||dy/dt||, is below this value
+		* at every output point over the last steady_state_window time units.
+		* Zero (the default) disables the check.
+		*/
+		double steady_state_tolerance;
+
+		/**
+		* The length of simulation time the steady state condition must hold
+		* for before the simulation stops. The default of zero stops at the
+		* first output point below the tolerance.
+		*/
+		double steady_state_window;
+
+		/**
+		* Stop the simulation when a condition on a selection becomes true,
+		* in the form "selection op value" where op is one of <, <=, > or >=
+		* and value is a number or another selection, i.e. "S1 > 10" or
+		* "[S1] >= [S2]". Like an event trigger, the condition is checked at
+		* each output point and fires when it changes from false to true, so
+		* a condition which holds at the start time does not stop the
+		* simulation until it has first become false. Empty (the default)
+		* disables the check.
+		*/
+		std::string stop_condition;
+
+		/**
+		* Stop the simulation after this many seconds of wall clock time.
+		* Zero (the default) is no limit. Checked at the output points, and
+		* between the internal steps of the cvode, rk45 and gillespie
+		* integrators, the result ends at the last output point.
+		*/
+		double max_wall_time;
+
+		/**
+		* the name of a stop reason.
+		*/
+		static std::string stopReasonToString(StopReason reason);
+
 		/**
 		* get a description of this object, compatable with python __str__
 		*/
@@ -0,0 +1,270 @@
+/*
+ * rrSimulateFuture.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "rrSimulateFuture.h"
+#include "rrRoadRunner.h"
+#include "rrLogger.h"
+
+#include <Poco/Thread.h>
+#include <Poco/Runnable.h>
+#include <Poco/Mutex.h>
+#include <Poco/Event.h>
+
+#include <stdexcept>
+
+using Poco::Mutex;
+
+namespace rr
+{
+
+class SimulateFuture::Impl : public Poco::Runnable
+{
+public:
+    Impl(RoadRunner* r, Kind kind, const SimulateOptions& opt) :
+                r(r),
+                kind(kind),
+                opt(opt),
+                doneEvent(false),
+                started(false),
+                finished(false),
+                cancelled(false),
+                time(opt.start),
+                progress(0),
+                steadyStateValue(0),
+                stopReason(SimulateOptions::STOP_END_TIME)
+    {
+    }
+
+    virtual void run();
+
+    RoadRunner* r;
+    Kind kind;
+    SimulateOptions opt;
+
+    Poco::Thread thread;
+
+    /**
+     * set once the run has finished, manual reset so any number of
+     * waiters see it.
+     */
+    Poco::Event doneEvent;
+
+    /**
+     * guards everything below, which is shared between the simulation
+     * thread and the callers.
+     */
+    mutable Mutex mutex;
+
+    bool started;
+    bool finished;
+    bool cancelled;
+    double time;
+    double progress;
+    double steadyStateValue;
+    SimulateOptions::StopReason stopReason;
+    ls::DoubleMatrix result;
+    std::string error;
+};
+
+void SimulateFuture::Impl::run()
+{
+    bool cancelledBeforeStart;
+    {
+        Mutex::ScopedLock lock(mutex);
+        cancelledBeforeStart = cancelled;
+    }
+
+    try
+    {
+        if (cancelledBeforeStart)
+        {
+            Mutex::ScopedLock lock(mutex);
+            stopReason = SimulateOptions::STOP_CANCELLED;
+        }
+        else if (kind == SIMULATE)
+        {
+            const ls::DoubleMatrix* data = r->simulate(&opt);
+
+            Mutex::ScopedLock lock(mutex);
+            result = *data;
+            stopReason = r->getSimulateStopReason();
+            if (stopReason == SimulateOptions::STOP_END_TIME)
+            {
+                time = opt.start + opt.duration;
+                progress = 1;
+            }
+        }
+        else
+        {
+            double value = r->steadyState();
+
+            Mutex::ScopedLock lock(mutex);
+            steadyStateValue = value;
+            progress = 1;
+        }
+    }
+    catch (std::exception& e)
+    {
+        Log(Logger::LOG_ERROR) << "asynchronous "
+                << (kind == SIMULATE ? "simulation" : "steady state")
+                << " failed: " << e.what();
+
+        Mutex::ScopedLock lock(mutex);
+        error = e.what();
+    }
+
+    // the RoadRunner is free again before anyone waiting is woken up.
+    r->setFuture(0);
+
+    {
+        Mutex::ScopedLock lock(mutex);
+        finished = true;
+    }
+
+    doneEvent.set();
+}
+
+SimulateFuture::SimulateFuture(RoadRunner* r, Kind kind,
+        const SimulateOptions& opt) :
+                impl(0)
+{
+    impl = new Impl(r, kind, opt);
+}
+
+SimulateFuture::~SimulateFuture()
+{
+    cancel();
+
+    if (impl->started)
+    {
+        impl->thread.join();
+    }
+
+    delete impl;
+}
+
+void SimulateFuture::start()
+{
+    impl->thread.start(*impl);
+    impl->started = true;
+}
+
+bool SimulateFuture::wait(double timeout)
+{
+    if (timeout < 0)
+    {
+        impl->doneEvent.wait();
+        return true;
+    }
+
+    return impl->doneEvent.tryWait(static_cast<long>(timeout * 1000));
+}
+
+bool SimulateFuture::isDone() const
+{
+    Mutex::ScopedLock lock(impl->mutex);
+    return impl->finished;
+}
+
+double SimulateFuture::getProgress() const
+{
+    Mutex::ScopedLock lock(impl->mutex);
+    return impl->progress;
+}
+
+double SimulateFuture::getTime() const
+{
+    Mutex::ScopedLock lock(impl->mutex);
+    return impl->time;
+}
+
+void SimulateFuture::cancel()
+{
+    Mutex::ScopedLock lock(impl->mutex);
+    if (!impl->finished)
+    {
+        impl->cancelled = true;
+    }
+}
+
+bool SimulateFuture::isCancelled() const
+{
+    Mutex::ScopedLock lock(impl->mutex);
+    return impl->cancelled;
+}
+
+ls::DoubleMatrix SimulateFuture::getResult()
+{
+    if (impl->kind != SIMULATE)
+    {
+        throw std::logic_error("not an asynchronous simulation");
+    }
+
+    wait();
+    checkError();
+
+    Mutex::ScopedLock lock(impl->mutex);
+    return impl->result;
+}
+
+double SimulateFuture::getSteadyStateValue()
+{
+    if (impl->kind != STEADY_STATE)
+    {
+        throw std::logic_error("not an asynchronous steady state calculation");
+    }
+
+    wait();
+    checkError();
+
+    Mutex::ScopedLock lock(impl->mutex);
+    return impl->steadyStateValue;
+}
+
+SimulateOptions::StopReason SimulateFuture::getStopReason()
+{
+    wait();
+
+    Mutex::ScopedLock lock(impl->mutex);
+    return impl->stopReason;
+}
+
+std::string SimulateFuture::getError() const
+{
+    Mutex::ScopedLock lock(impl->mutex);
+    return impl->error;
+}
+
+RoadRunner* SimulateFuture::getRoadRunner() const
+{
+    return impl->r;
+}
+
+bool SimulateFuture::update(double time)
+{
+    Mutex::ScopedLock lock(impl->mutex);
+
+    impl->time = time;
+
+    if (impl->opt.duration > 0)
+    {
+        double p = (time - impl->opt.start) / impl->opt.duration;
+        impl->progress = p < 0 ? 0 : (p > 1 ? 1 : p);
+    }
+
+    return impl->cancelled;
+}
+
+void SimulateFuture::checkError() const
+{
+    Mutex::ScopedLock lock(impl->mutex);
+    if (impl->error.size())
+    {
+        throw std::runtime_error(impl->error);
+    }
+}
+
+}
@@ -0,0 +1,149 @@
+/*
+ * rrSimulateFuture.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef RRSIMULATEFUTURE_H_
+#define RRSIMULATEFUTURE_H_
+
+#include "rrExporter.h"
+#include "rrRoadRunnerOptions.h"
+#include "rr-libstruct/lsMatrix.h"
+#include <string>
+
+namespace rr
+{
+
+class RoadRunner;
+class SimulateStopCheck;
+
+/**
+ * A simulation or steady state calculation running on a background thread,
+ * created with RoadRunner::simulateAsync or RoadRunner::steadyStateAsync.
+ *
+ * While it runs the RoadRunner object belongs to the background thread and
+ * must not be used, other than through this object, until isDone is true.
+ * The RoadRunner must also outlive this object.
+ *
+ * A simulation reports its progress at each output point. Cancellation is
+ * checked at each output point, and by the cvode, rk45 and gillespie
+ * integrators between their internal steps, so a long interval between two
+ * output points does not delay it. The rk4 and euler integrators take one
+ * step per output point, so they stop at the next one. A cancelled
+ * simulation stops with the STOP_CANCELLED reason and its result has the
+ * rows up to the last output point before it stopped, like the other early
+ * stops of the SimulateOptions, and max_wall_time of the options limits how
+ * long it may run in the same way. The steady state solvers can not be
+ * interrupted, a cancelled steady state calculation runs to completion and
+ * only then reports that it was cancelled.
+ *
+ * Deleting this object cancels the run and waits for it to stop.
+ */
+class RR_DECLSPEC SimulateFuture
+{
+public:
+
+    ~SimulateFuture();
+
+    /**
+     * wait for the run to finish, for at most timeout seconds, or forever
+     * if the timeout is negative.
+     *
+     * @return true if it finished, false if the timeout expired.
+     */
+    bool wait(double timeout = -1);
+
+    /**
+     * has the run finished, either normally, by cancellation or with an
+     * error.
+     */
+    bool isDone() const;
+
+    /**
+     * the fraction of the simulation time span which has been integrated,
+     * between 0 and 1. A steady state calculation has no intermediate
+     * progress, it is 0 until it is done.
+     */
+    double getProgress() const;
+
+    /**
+     * the model time at the last output point.
+     */
+    double getTime() const;
+
+    /**
+     * ask the run to stop, at the next internal step of the integrator or
+     * the next output point. Returns immediately, use wait to wait for it to
+     * stop.
+     */
+    void cancel();
+
+    /**
+     * was the run cancelled before it finished.
+     */
+    bool isCancelled() const;
+
+    /**
+     * the result of a simulation, waits for it to finish if it is still
+     * running. Throws the error of a failed run.
+     *
+     * The result is also available from RoadRunner::getSimulationData.
+     */
+    ls::DoubleMatrix getResult();
+
+    /**
+     * the return value of RoadRunner::steadyState, waits for it to finish if
+     * it is still running. Throws the error of a failed run.
+     */
+    double getSteadyStateValue();
+
+    /**
+     * why the simulation stopped, waits for it to finish if it is still
+     * running.
+     */
+    SimulateOptions::StopReason getStopReason();
+
+    /**
+     * the message of the exception a failed run threw, empty if it did not
+     * fail.
+     */
+    std::string getError() const;
+
+    /**
+     * the RoadRunner object this runs on.
+     */
+    RoadRunner* getRoadRunner() const;
+
+private:
+    enum Kind
+    {
+        SIMULATE,
+        STEADY_STATE
+    };
+
+    SimulateFuture(RoadRunner* r, Kind kind, const SimulateOptions& opt);
+
+    /**
+     * called by the simulation thread at each output point, returns true
+     * if the simulation should stop.
+     */
+    bool update(double time);
+
+    /**
+     * throws the error of a failed run.
+     */
+    void checkError() const;
+
+    void start();
+
+    friend class RoadRunner;
+    friend class SimulateStopCheck;
+
+    class Impl;
+    Impl* impl;
+};
+
+}
+
+#endif /* RRSIMULATEFUTURE_H_ */
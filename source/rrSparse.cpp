@@ -163,53 +163,44 @@ void csr_matrix_delete(csr_matrix* mat)
     }
 }
 
-void csr_matrix_dgemv(double alpha, const csr_matrix* A, const double* x,
-        double beta, double* y)
+/**
+ * the buffers are laid out values first, as they have the strictest
+ * alignment, then colidx and rowptr.
+ */
+static size_t csr_matrix_header_bytes()
 {
-    const unsigned m = A->m;
-    unsigned *rowptr = A->rowptr;
-    unsigned *colidx = A->colidx;
-    double *values = A->values;
-    if (beta == 0.0)
-    {
-        for (unsigned i = 0; i < m; i++)
-        {
-            double yi = 0.0;
-            for (unsigned k = rowptr[i]; k < rowptr[i + 1]; k++)
-            {
-                yi = yi + alpha * values[k] * x[colidx[k]];
-            }
-            y[i] = yi;
-        }
-    }
-    else
-    {
-        for (unsigned i = 0; i < m; i++)
-        {
-            double yi = beta * y[i];
-            for (unsigned k = rowptr[i]; k < rowptr[i + 1]; k++)
-            {
-                yi = yi + alpha * values[k] * x[colidx[k]];
-            }
-            y[i] = yi;
-        }
-    }
+    return (sizeof(csr_matrix) + sizeof(double) - 1) / sizeof(double) * sizeof(double);
 }
 
+size_t csr_matrix_bytes(const csr_matrix* mat)
+{
+    return csr_matrix_header_bytes() + mat->nnz * sizeof(double)
+            + mat->nnz * sizeof(unsigned) + (mat->m + 1) * sizeof(unsigned);
+}
 
-double csr_matrix_ddot(int row, const csr_matrix *A, const double *x)
+csr_matrix* csr_matrix_copy_to(const csr_matrix* mat, void* buffer)
 {
-    assert(row < A->m && "invalid row");
-    unsigned *rowptr = A->rowptr;
-    unsigned *colidx = A->colidx;
-    double *values = A->values;
+    char *p = (char*)buffer;
+    csr_matrix *copy = (csr_matrix*)p;
+    p += csr_matrix_header_bytes();
 
-    double sum = 0.0;
-    for (unsigned k = rowptr[row]; k < rowptr[row + 1]; k++)
-    {
-        sum = sum + values[k] * x[colidx[k]];
-    }
-    return sum;
+    copy->m = mat->m;
+    copy->n = mat->n;
+    copy->nnz = mat->nnz;
+
+    copy->values = (double*)p;
+    p += mat->nnz * sizeof(double);
+
+    copy->colidx = (unsigned*)p;
+    p += mat->nnz * sizeof(unsigned);
+
+    copy->rowptr = (unsigned*)p;
+
+    memcpy(copy->values, mat->values, mat->nnz * sizeof(double));
+    memcpy(copy->colidx, mat->colidx, mat->nnz * sizeof(unsigned));
+    memcpy(copy->rowptr, mat->rowptr, (mat->m + 1) * sizeof(unsigned));
+
+    return copy;
 }
 
 void csr_matrix_fill_dense(const csr_matrix *A, double *dense)
@@ -292,6 +283,132 @@ std::ostream& operator <<(std::ostream& os, const csr_matrix* mat)
     return os;
 }
 
+// sort columns by decreasing number of non-zeros.
+struct column_size_pred
+{
+    column_size_pred(const vector<vector<unsigned> >& pattern) :
+        pattern(pattern) {}
+
+    bool operator()(unsigned left, unsigned right) const
+    {
+        return pattern[left].size() > pattern[right].size();
+    }
+
+    const vector<vector<unsigned> >& pattern;
+};
+
+JacobianColoring::JacobianColoring() : rows(0)
+{
 }
 
+JacobianColoring::JacobianColoring(unsigned rows, unsigned cols) :
+        rows(rows), pattern(cols), colors(cols)
+{
+    vector<unsigned> allRows(rows);
+    for (unsigned i = 0; i < rows; ++i)
+    {
+        allRows[i] = i;
+    }
 
+    for (unsigned i = 0; i < cols; ++i)
+    {
+        pattern[i] = allRows;
+        colors[i].push_back(i);
+    }
+}
+
+JacobianColoring::JacobianColoring(unsigned rows,
+        const vector<vector<unsigned> >& pattern) :
+        rows(rows), pattern(pattern)
+{
+    const unsigned cols = pattern.size();
+
+    vector<unsigned> order(cols);
+    for (unsigned i = 0; i < cols; ++i)
+    {
+        order[i] = i;
+    }
+    stable_sort(order.begin(), order.end(), column_size_pred(pattern));
+
+    // the colours of the columns which have a non-zero in each row.
+    vector<vector<unsigned> > rowColors(rows);
+
+    // indexed by colour, holds column + 1 if the colour is used by a row of
+    // that column, so it never needs to be cleared.
+    vector<unsigned> forbidden;
+
+    for (unsigned i = 0; i < cols; ++i)
+    {
+        const unsigned col = order[i];
+        const vector<unsigned>& colRows = pattern[col];
+
+        for (unsigned j = 0; j < colRows.size(); ++j)
+        {
+            if (colRows[j] >= rows)
+            {
+                throw out_of_range("Jacobian pattern row index out of range");
+            }
+
+            const vector<unsigned>& used = rowColors[colRows[j]];
+            for (unsigned k = 0; k < used.size(); ++k)
+            {
+                forbidden[used[k]] = col + 1;
+            }
+        }
+
+        unsigned color = 0;
+        while (color < forbidden.size() && forbidden[color] == col + 1)
+        {
+            ++color;
+        }
+
+        if (color == colors.size())
+        {
+            colors.push_back(vector<unsigned>());
+            forbidden.push_back(0);
+        }
+
+        colors[color].push_back(col);
+
+        for (unsigned j = 0; j < colRows.size(); ++j)
+        {
+            rowColors[colRows[j]].push_back(color);
+        }
+    }
+
+    for (unsigned i = 0; i < colors.size(); ++i)
+    {
+        sort(colors[i].begin(), colors[i].end());
+    }
+
+    Log(Logger::LOG_DEBUG) << "coloured " << rows << "x" << cols
+            << " Jacobian with " << colors.size() << " colours";
+}
+
+unsigned JacobianColoring::getNumRows() const
+{
+    return rows;
+}
+
+unsigned JacobianColoring::getNumCols() const
+{
+    return pattern.size();
+}
+
+unsigned JacobianColoring::getNumColors() const
+{
+    return colors.size();
+}
+
+const std::vector<unsigned>& JacobianColoring::getColorColumns(
+        unsigned color) const
+{
+    return colors.at(color);
+}
+
+const std::vector<unsigned>& JacobianColoring::getColumnRows(unsigned col) const
+{
+    return pattern.at(col);
+}
+
+}
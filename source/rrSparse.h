@@ -9,6 +9,7 @@
 #define RRCSPARSE_H_
 
 #include "rrOSSpecifics.h"
+#include "rrExporter.h"
 #include <vector>
 #include <ostream>
 
@@ -86,6 +87,21 @@ csr_matrix* csr_matrix_new(unsigned m, unsigned n,
  */
 void csr_matrix_delete(csr_matrix *mat);
 
+/**
+ * number of bytes needed to store a copy of the matrix, the struct and all
+ * of its buffers, in a single block of memory.
+ */
+size_t csr_matrix_bytes(const csr_matrix *mat);
+
+/**
+ * copy the matrix into a single block of memory of at least
+ * csr_matrix_bytes(mat) bytes, which must be aligned for a double.
+ *
+ * The copy is owned by whoever owns the block, it must NOT be freed
+ * with csr_matrix_delete.
+ */
+csr_matrix* csr_matrix_copy_to(const csr_matrix *mat, void *buffer);
+
 /**
  * sets a (previously allocted) non-zero value to the given value.
  *
@@ -107,6 +123,8 @@ double csr_matrix_get_nz(const csr_matrix *mat, unsigned row, unsigned col);
  *
  * The given vectors y and x must be the same size as number of
  * columns in the sparse matrix.
+ *
+ * If beta is zero, y is not read, so it need not be initialized.
  */
 void  csr_matrix_dgemv(double alpha, const csr_matrix *A,
         double const *x, double beta, double *y);
@@ -119,6 +137,128 @@ void  csr_matrix_dgemv(double alpha, const csr_matrix *A,
  */
 double csr_matrix_ddot(int row, const csr_matrix *x, const double *y);
 
+/**
+ * sparse matrix times dense block, Y := alpha*A*X + beta*Y, for k vectors
+ * at once in a single pass over the matrix.
+ *
+ * X is n x k and Y is m x k, both row major, so the i'th row holds the
+ * i'th entry of each of the k vectors. This is the layout of a set of
+ * state vectors or Jacobian columns stored side by side.
+ *
+ * If beta is zero, Y is not read.
+ */
+void csr_matrix_dgemm(double alpha, const csr_matrix *A, const double *X,
+        unsigned k, double beta, double *Y);
+
+/**
+ * number of rows in a slice of a csr_matrix_sell.
+ */
+#define CSR_SELL_C 8
+
+/**
+ * @internal
+ * Row blocked copy of a csr_matrix in the sliced ELLPACK (SELL-C-sigma)
+ * format, for faster matrix-vector products.
+ *
+ * The rows are grouped in slices of CSR_SELL_C rows, each slice is padded
+ * to its longest row and stored column major, so a SIMD register holds the
+ * same entry of several rows and the product is vectorized across rows,
+ * rather than along rows, which in a stoichiometry matrix are often shorter
+ * than a register. To reduce the padding, the rows may be pre-sorted by
+ * length within windows of sigma rows, perm maps the stored rows back to
+ * the rows of the matrix.
+ */
+typedef struct csr_matrix_sell_t
+{
+    /**
+     * number of rows
+     */
+    unsigned m;
+
+    /**
+     * number of columns
+     */
+    unsigned n;
+
+    /**
+     * number of slices, m / CSR_SELL_C rounded up.
+     */
+    unsigned slices;
+
+    /**
+     * offset of each slice in values and colidx, length slices + 1. The
+     * length of the rows in slice s is
+     * (sliceptr[s + 1] - sliceptr[s]) / CSR_SELL_C.
+     */
+    unsigned* sliceptr;
+
+    /**
+     * entry j of row r of slice s is at sliceptr[s] + j * CSR_SELL_C + r,
+     * padding entries are zero.
+     */
+    double* values;
+
+    /**
+     * column of each entry, padding entries refer to column zero.
+     */
+    unsigned* colidx;
+
+    /**
+     * the matrix row of each stored row, length slices * CSR_SELL_C,
+     * padding rows are m.
+     */
+    unsigned* perm;
+
+} csr_matrix_sell;
+
+/**
+ * create a SELL-C-sigma copy of a matrix, the rows are sorted by length
+ * in windows of sigma rows, sigma <= 1 keeps the original row order.
+ */
+csr_matrix_sell* csr_matrix_sell_new(const csr_matrix *A, unsigned sigma);
+
+void csr_matrix_sell_delete(csr_matrix_sell *mat);
+
+/**
+ * y := alpha*A*x + beta*y, same as csr_matrix_dgemv.
+ */
+void csr_matrix_sell_dgemv(double alpha, const csr_matrix_sell *A,
+        const double *x, double beta, double *y);
+
+/**
+ * instruction sets of the sparse kernels.
+ */
+enum CSRSimdLevel
+{
+    CSR_SIMD_SCALAR = 0,
+    CSR_SIMD_SSE2 = 1,
+    CSR_SIMD_AVX2 = 2,
+    CSR_SIMD_AVX512 = 3
+};
+
+/**
+ * the best kernels supported by both this CPU and the compiler, these are
+ * selected when the library is loaded.
+ */
+int csr_matrix_simd_supported();
+
+/**
+ * the kernels in use.
+ */
+int csr_matrix_get_simd();
+
+/**
+ * use the kernels for the given level, or the best supported one below it.
+ * For benchmarking and testing only. The level is a plain global, not an
+ * atomic, so it must be set once at startup, before any other thread
+ * evaluates a model, and not changed whilst one does.
+ *
+ * @return the level selected.
+ */
+int csr_matrix_set_simd(int level);
+
+const char* csr_matrix_simd_name(int level);
+
 /**
  * fill dense matrix
  */
@@ -130,6 +270,67 @@ void csr_matrix_fill_dense(const csr_matrix *x, double *dense);
 std::ostream& operator<< (std::ostream& os, const csr_matrix* mat);
 
 
+/**
+ * @internal
+ * Curtis-Powell-Reid (CPR) column colouring of a sparse Jacobian.
+ *
+ * Columns which do not share a structurally non-zero row are independent,
+ * so they can be perturbed together and a finite difference Jacobian
+ * computed with one function evaluation per colour instead of one per
+ * column. The difference for each row is attributed to the only column
+ * of the colour that has a non-zero in that row.
+ *
+ * Colours are assigned greedily, largest columns first, which is usually
+ * close to the chromatic number of the column intersection graph.
+ */
+class RR_DECLSPEC JacobianColoring
+{
+public:
+
+    /**
+     * empty colouring, for a zero size Jacobian.
+     */
+    JacobianColoring();
+
+    /**
+     * dense colouring, every column has its own colour and every row
+     * is non-zero.
+     */
+    JacobianColoring(unsigned rows, unsigned cols);
+
+    /**
+     * colour a sparsity pattern.
+     *
+     * @param rows: number of rows of the Jacobian.
+     * @param pattern: for each column, the indices of the rows which
+     *        may be non-zero.
+     */
+    JacobianColoring(unsigned rows,
+            const std::vector<std::vector<unsigned> >& pattern);
+
+    unsigned getNumRows() const;
+
+    unsigned getNumCols() const;
+
+    unsigned getNumColors() const;
+
+    /**
+     * the columns which share the given colour.
+     */
+    const std::vector<unsigned>& getColorColumns(unsigned color) const;
+
+    /**
+     * the rows which may be non-zero in the given column.
+     */
+    const std::vector<unsigned>& getColumnRows(unsigned col) const;
+
+private:
+    unsigned rows;
+    std::vector<std::vector<unsigned> > pattern;
+    std::vector<std::vector<unsigned> > colors;
+};
+
+
 }
 
 #endif /* RRCSPARSE_H_ */
@@ -0,0 +1,789 @@
+/*
+ * rrSparseKernels.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * SIMD kernels for the csr_matrix products, one set per instruction set,
+ * the best one the CPU supports is chosen when the library is loaded.
+ *
+ * The vector kernels are compiled with function level target attributes,
+ * so this file needs no special compiler flags and the library still runs
+ * on CPUs without AVX.
+ */
+#pragma hdrstop
+#include "rrSparse.h"
+#include "rrLogger.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <cassert>
+#include <algorithm>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define RR_CSR_X86 1
+#endif
+
+#if defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)))
+#define RR_CSR_TARGET(isa) __attribute__((target(isa)))
+#define RR_CSR_HAVE_AVX 1
+#define RR_CSR_HAVE_AVX512 1
+#elif defined(_MSC_VER)
+#define RR_CSR_TARGET(isa)
+#define RR_CSR_HAVE_AVX 1
+#if _MSC_VER >= 1911
+#define RR_CSR_HAVE_AVX512 1
+#endif
+#endif
+
+#if defined(RR_CSR_X86) && defined(RR_CSR_TARGET)
+#define RR_CSR_SIMD 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace rr
+{
+
+using namespace std;
+
+/**
+ * y := alpha * sum + beta * y, without reading y if beta is zero.
+ */
+static inline void csr_store(double alpha, double sum, double beta, double *y)
+{
+    *y = beta == 0.0 ? alpha * sum : alpha * sum + beta * *y;
+}
+
+// ** Scalar *******************************************************************
+
+static double csr_row_ddot_scalar(unsigned begin, unsigned end,
+        const double *values, const unsigned *colidx, const double *x)
+{
+    double sum = 0.0;
+    for (unsigned k = begin; k < end; k++)
+    {
+        sum += values[k] * x[colidx[k]];
+    }
+    return sum;
+}
+
+static double csr_ddot_scalar(int row, const csr_matrix *A, const double *x)
+{
+    return csr_row_ddot_scalar(A->rowptr[row], A->rowptr[row + 1], A->values,
+            A->colidx, x);
+}
+
+static void csr_dgemv_scalar(double alpha, const csr_matrix *A, const double *x,
+        double beta, double *y)
+{
+    for (unsigned i = 0; i < A->m; i++)
+    {
+        csr_store(alpha, csr_row_ddot_scalar(A->rowptr[i], A->rowptr[i + 1],
+                A->values, A->colidx, x), beta, &y[i]);
+    }
+}
+
+/**
+ * columns j0 to k of row i of the block product.
+ */
+static void csr_dgemm_row_scalar(double alpha, const csr_matrix *A, unsigned i,
+        const double *X, unsigned k, double beta, double *Y, unsigned j0)
+{
+    double *yi = Y + (size_t)i * k;
+    for (unsigned j = j0; j < k; j++)
+    {
+        double sum = 0.0;
+        for (unsigned p = A->rowptr[i]; p < A->rowptr[i + 1]; p++)
+        {
+            sum += A->values[p] * X[(size_t)A->colidx[p] * k + j];
+        }
+        csr_store(alpha, sum, beta, &yi[j]);
+    }
+}
+
+static void csr_dgemm_scalar(double alpha, const csr_matrix *A, const double *X,
+        unsigned k, double beta, double *Y)
+{
+    for (unsigned i = 0; i < A->m; i++)
+    {
+        csr_dgemm_row_scalar(alpha, A, i, X, k, beta, Y, 0);
+    }
+}
+
+/**
+ * store the CSR_SELL_C row sums of a slice.
+ */
+static void csr_sell_store(double alpha, const csr_matrix_sell *A, unsigned s,
+        const double *sums, double beta, double *y)
+{
+    for (unsigned r = 0; r < CSR_SELL_C; r++)
+    {
+        unsigned row = A->perm[s * CSR_SELL_C + r];
+        if (row < A->m)
+        {
+            csr_store(alpha, sums[r], beta, &y[row]);
+        }
+    }
+}
+
+static void csr_sell_dgemv_scalar(double alpha, const csr_matrix_sell *A,
+        const double *x, double beta, double *y)
+{
+    for (unsigned s = 0; s < A->slices; s++)
+    {
+        double sums[CSR_SELL_C] = {0};
+        for (unsigned p = A->sliceptr[s]; p < A->sliceptr[s + 1]; p += CSR_SELL_C)
+        {
+            for (unsigned r = 0; r < CSR_SELL_C; r++)
+            {
+                sums[r] += A->values[p + r] * x[A->colidx[p + r]];
+            }
+        }
+        csr_sell_store(alpha, A, s, sums, beta, y);
+    }
+}
+
+#ifdef RR_CSR_SIMD
+
+// ** SSE2 *********************************************************************
+
+RR_CSR_TARGET("sse2")
+static double csr_row_ddot_sse2(unsigned begin, unsigned end,
+        const double *values, const unsigned *colidx, const double *x)
+{
+    __m128d acc = _mm_setzero_pd();
+    unsigned k = begin;
+    for (; k + 2 <= end; k += 2)
+    {
+        __m128d xv = _mm_set_pd(x[colidx[k + 1]], x[colidx[k]]);
+        acc = _mm_add_pd(acc, _mm_mul_pd(_mm_loadu_pd(values + k), xv));
+    }
+
+    double sum = _mm_cvtsd_f64(_mm_add_sd(acc, _mm_unpackhi_pd(acc, acc)));
+    for (; k < end; k++)
+    {
+        sum += values[k] * x[colidx[k]];
+    }
+    return sum;
+}
+
+RR_CSR_TARGET("sse2")
+static double csr_ddot_sse2(int row, const csr_matrix *A, const double *x)
+{
+    return csr_row_ddot_sse2(A->rowptr[row], A->rowptr[row + 1], A->values,
+            A->colidx, x);
+}
+
+RR_CSR_TARGET("sse2")
+static void csr_dgemv_sse2(double alpha, const csr_matrix *A, const double *x,
+        double beta, double *y)
+{
+    for (unsigned i = 0; i < A->m; i++)
+    {
+        csr_store(alpha, csr_row_ddot_sse2(A->rowptr[i], A->rowptr[i + 1],
+                A->values, A->colidx, x), beta, &y[i]);
+    }
+}
+
+RR_CSR_TARGET("sse2")
+static void csr_dgemm_sse2(double alpha, const csr_matrix *A, const double *X,
+        unsigned k, double beta, double *Y)
+{
+    const __m128d valpha = _mm_set1_pd(alpha);
+    const __m128d vbeta = _mm_set1_pd(beta);
+
+    for (unsigned i = 0; i < A->m; i++)
+    {
+        double *yi = Y + (size_t)i * k;
+        unsigned j = 0;
+        for (; j + 2 <= k; j += 2)
+        {
+            __m128d acc = _mm_setzero_pd();
+            for (unsigned p = A->rowptr[i]; p < A->rowptr[i + 1]; p++)
+            {
+                __m128d xv = _mm_loadu_pd(X + (size_t)A->colidx[p] * k + j);
+                acc = _mm_add_pd(acc, _mm_mul_pd(_mm_set1_pd(A->values[p]), xv));
+            }
+            acc = _mm_mul_pd(acc, valpha);
+            if (beta != 0.0)
+            {
+                acc = _mm_add_pd(acc, _mm_mul_pd(vbeta, _mm_loadu_pd(yi + j)));
+            }
+            _mm_storeu_pd(yi + j, acc);
+        }
+        csr_dgemm_row_scalar(alpha, A, i, X, k, beta, Y, j);
+    }
+}
+
+RR_CSR_TARGET("sse2")
+static void csr_sell_dgemv_sse2(double alpha, const csr_matrix_sell *A,
+        const double *x, double beta, double *y)
+{
+    for (unsigned s = 0; s < A->slices; s++)
+    {
+        __m128d acc[CSR_SELL_C / 2];
+        for (unsigned r = 0; r < CSR_SELL_C / 2; r++)
+        {
+            acc[r] = _mm_setzero_pd();
+        }
+
+        for (unsigned p = A->sliceptr[s]; p < A->sliceptr[s + 1]; p += CSR_SELL_C)
+        {
+            const unsigned *c = A->colidx + p;
+            for (unsigned r = 0; r < CSR_SELL_C / 2; r++)
+            {
+                __m128d xv = _mm_set_pd(x[c[2 * r + 1]], x[c[2 * r]]);
+                acc[r] = _mm_add_pd(acc[r],
+                        _mm_mul_pd(_mm_loadu_pd(A->values + p + 2 * r), xv));
+            }
+        }
+
+        double sums[CSR_SELL_C];
+        for (unsigned r = 0; r < CSR_SELL_C / 2; r++)
+        {
+            _mm_storeu_pd(sums + 2 * r, acc[r]);
+        }
+        csr_sell_store(alpha, A, s, sums, beta, y);
+    }
+}
+
+// ** AVX2 *********************************************************************
+
+#ifdef RR_CSR_HAVE_AVX
+
+/**
+ * x[c[0..3]], loaded one at a time rather than with vgatherdpd, which is
+ * microcoded and, with the gather data sampling mitigation, slower than
+ * the scalar loads on most CPUs.
+ */
+RR_CSR_TARGET("avx2,fma")
+static inline __m256d csr_gather4(const double *x, const unsigned *c)
+{
+    return _mm256_set_pd(x[c[3]], x[c[2]], x[c[1]], x[c[0]]);
+}
+
+RR_CSR_TARGET("avx2,fma")
+static double csr_row_ddot_avx2(unsigned begin, unsigned end,
+        const double *values, const unsigned *colidx, const double *x)
+{
+    __m256d acc = _mm256_setzero_pd();
+    unsigned k = begin;
+    for (; k + 4 <= end; k += 4)
+    {
+        acc = _mm256_fmadd_pd(_mm256_loadu_pd(values + k),
+                csr_gather4(x, colidx + k), acc);
+    }
+
+    __m128d half = _mm_add_pd(_mm256_castpd256_pd128(acc),
+            _mm256_extractf128_pd(acc, 1));
+    double sum = _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+    for (; k < end; k++)
+    {
+        sum += values[k] * x[colidx[k]];
+    }
+    return sum;
+}
+
+RR_CSR_TARGET("avx2,fma")
+static double csr_ddot_avx2(int row, const csr_matrix *A, const double *x)
+{
+    return csr_row_ddot_avx2(A->rowptr[row], A->rowptr[row + 1], A->values,
+            A->colidx, x);
+}
+
+RR_CSR_TARGET("avx2,fma")
+static void csr_dgemv_avx2(double alpha, const csr_matrix *A, const double *x,
+        double beta, double *y)
+{
+    for (unsigned i = 0; i < A->m; i++)
+    {
+        csr_store(alpha, csr_row_ddot_avx2(A->rowptr[i], A->rowptr[i + 1],
+                A->values, A->colidx, x), beta, &y[i]);
+    }
+}
+
+RR_CSR_TARGET("avx2,fma")
+static void csr_dgemm_avx2(double alpha, const csr_matrix *A, const double *X,
+        unsigned k, double beta, double *Y)
+{
+    const __m256d valpha = _mm256_set1_pd(alpha);
+    const __m256d vbeta = _mm256_set1_pd(beta);
+
+    for (unsigned i = 0; i < A->m; i++)
+    {
+        double *yi = Y + (size_t)i * k;
+        unsigned j = 0;
+        for (; j + 4 <= k; j += 4)
+        {
+            __m256d acc = _mm256_setzero_pd();
+            for (unsigned p = A->rowptr[i]; p < A->rowptr[i + 1]; p++)
+            {
+                __m256d xv = _mm256_loadu_pd(X + (size_t)A->colidx[p] * k + j);
+                acc = _mm256_fmadd_pd(_mm256_set1_pd(A->values[p]), xv, acc);
+            }
+            acc = _mm256_mul_pd(acc, valpha);
+            if (beta != 0.0)
+            {
+                acc = _mm256_fmadd_pd(vbeta, _mm256_loadu_pd(yi + j), acc);
+            }
+            _mm256_storeu_pd(yi + j, acc);
+        }
+
+        _mm256_zeroupper();
+        csr_dgemm_row_scalar(alpha, A, i, X, k, beta, Y, j);
+    }
+}
+
+RR_CSR_TARGET("avx2,fma")
+static void csr_sell_dgemv_avx2(double alpha, const csr_matrix_sell *A,
+        const double *x, double beta, double *y)
+{
+    for (unsigned s = 0; s < A->slices; s++)
+    {
+        __m256d lo = _mm256_setzero_pd();
+        __m256d hi = _mm256_setzero_pd();
+
+        for (unsigned p = A->sliceptr[s]; p < A->sliceptr[s + 1]; p += CSR_SELL_C)
+        {
+            const unsigned *c = A->colidx + p;
+            lo = _mm256_fmadd_pd(_mm256_loadu_pd(A->values + p), csr_gather4(x, c), lo);
+            hi = _mm256_fmadd_pd(_mm256_loadu_pd(A->values + p + 4), csr_gather4(x, c + 4), hi);
+        }
+
+        double sums[CSR_SELL_C];
+        _mm256_storeu_pd(sums, lo);
+        _mm256_storeu_pd(sums + 4, hi);
+
+        // the store is not VEX encoded, avoid the AVX to SSE transition stall.
+        _mm256_zeroupper();
+        csr_sell_store(alpha, A, s, sums, beta, y);
+    }
+}
+
+#endif // RR_CSR_HAVE_AVX
+
+// ** AVX-512 ******************************************************************
+
+#ifdef RR_CSR_HAVE_AVX512
+
+/**
+ * x[c[0..7]], see csr_gather4.
+ */
+RR_CSR_TARGET("avx512f")
+static inline __m512d csr_gather8(const double *x, const unsigned *c)
+{
+    return _mm512_set_pd(x[c[7]], x[c[6]], x[c[5]], x[c[4]],
+            x[c[3]], x[c[2]], x[c[1]], x[c[0]]);
+}
+
+RR_CSR_TARGET("avx512f")
+static double csr_row_ddot_avx512(unsigned begin, unsigned end,
+        const double *values, const unsigned *colidx, const double *x)
+{
+    __m512d acc = _mm512_setzero_pd();
+    unsigned k = begin;
+    for (; k + 8 <= end; k += 8)
+    {
+        acc = _mm512_fmadd_pd(_mm512_loadu_pd(values + k),
+                csr_gather8(x, colidx + k), acc);
+    }
+
+    double lanes[8];
+    _mm512_storeu_pd(lanes, acc);
+    double sum = ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3]))
+            + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+    for (; k < end; k++)
+    {
+        sum += values[k] * x[colidx[k]];
+    }
+    return sum;
+}
+
+RR_CSR_TARGET("avx512f")
+static double csr_ddot_avx512(int row, const csr_matrix *A, const double *x)
+{
+    return csr_row_ddot_avx512(A->rowptr[row], A->rowptr[row + 1], A->values,
+            A->colidx, x);
+}
+
+RR_CSR_TARGET("avx512f")
+static void csr_dgemv_avx512(double alpha, const csr_matrix *A, const double *x,
+        double beta, double *y)
+{
+    for (unsigned i = 0; i < A->m; i++)
+    {
+        csr_store(alpha, csr_row_ddot_avx512(A->rowptr[i], A->rowptr[i + 1],
+                A->values, A->colidx, x), beta, &y[i]);
+    }
+}
+
+RR_CSR_TARGET("avx512f")
+static void csr_dgemm_avx512(double alpha, const csr_matrix *A, const double *X,
+        unsigned k, double beta, double *Y)
+{
+    const __m512d valpha = _mm512_set1_pd(alpha);
+    const __m512d vbeta = _mm512_set1_pd(beta);
+
+    for (unsigned i = 0; i < A->m; i++)
+    {
+        double *yi = Y + (size_t)i * k;
+        unsigned j = 0;
+        for (; j + 8 <= k; j += 8)
+        {
+            __m512d acc = _mm512_setzero_pd();
+            for (unsigned p = A->rowptr[i]; p < A->rowptr[i + 1]; p++)
+            {
+                __m512d xv = _mm512_loadu_pd(X + (size_t)A->colidx[p] * k + j);
+                acc = _mm512_fmadd_pd(_mm512_set1_pd(A->values[p]), xv, acc);
+            }
+            acc = _mm512_mul_pd(acc, valpha);
+            if (beta != 0.0)
+            {
+                acc = _mm512_fmadd_pd(vbeta, _mm512_loadu_pd(yi + j), acc);
+            }
+            _mm512_storeu_pd(yi + j, acc);
+        }
+
+        _mm256_zeroupper();
+        csr_dgemm_row_scalar(alpha, A, i, X, k, beta, Y, j);
+    }
+}
+
+RR_CSR_TARGET("avx512f")
+static void csr_sell_dgemv_avx512(double alpha, const csr_matrix_sell *A,
+        const double *x, double beta, double *y)
+{
+    for (unsigned s = 0; s < A->slices; s++)
+    {
+        __m512d acc = _mm512_setzero_pd();
+
+        for (unsigned p = A->sliceptr[s]; p < A->sliceptr[s + 1]; p += CSR_SELL_C)
+        {
+            acc = _mm512_fmadd_pd(_mm512_loadu_pd(A->values + p),
+                    csr_gather8(x, A->colidx + p), acc);
+        }
+
+        double sums[CSR_SELL_C];
+        _mm512_storeu_pd(sums, acc);
+
+        _mm256_zeroupper();
+        csr_sell_store(alpha, A, s, sums, beta, y);
+    }
+}
+
+#endif // RR_CSR_HAVE_AVX512
+
+// ** CPU detection ************************************************************
+
+static void csr_cpuid(unsigned leaf, unsigned subleaf, unsigned regs[4])
+{
+#if defined(_MSC_VER)
+    __cpuidex((int*)regs, leaf, subleaf);
+#else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+/**
+ * the register state the OS saves on a context switch.
+ */
+static unsigned long long csr_xgetbv()
+{
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    unsigned lo, hi;
+    __asm__ __volatile__ ("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return ((unsigned long long)hi << 32) | lo;
+#endif
+}
+
+static int csr_detect_simd()
+{
+    unsigned regs[4];
+    csr_cpuid(0, 0, regs);
+    const unsigned maxLeaf = regs[0];
+
+    if (maxLeaf < 1)
+    {
+        return CSR_SIMD_SCALAR;
+    }
+
+    csr_cpuid(1, 0, regs);
+    const bool sse2 = (regs[3] >> 26) & 1;
+    const bool fma = (regs[2] >> 12) & 1;
+    const bool osxsave = (regs[2] >> 27) & 1;
+    const bool avx = (regs[2] >> 28) & 1;
+
+    if (!sse2)
+    {
+        return CSR_SIMD_SCALAR;
+    }
+
+    if (!osxsave || !avx || maxLeaf < 7)
+    {
+        return CSR_SIMD_SSE2;
+    }
+
+    const unsigned long long xcr0 = csr_xgetbv();
+
+    // xmm and ymm state
+    if ((xcr0 & 0x6) != 0x6)
+    {
+        return CSR_SIMD_SSE2;
+    }
+
+    csr_cpuid(7, 0, regs);
+    const bool avx2 = (regs[1] >> 5) & 1;
+    const bool avx512f = (regs[1] >> 16) & 1;
+
+    // opmask, zmm hi256 and hi16 zmm state
+    if (avx512f && fma && (xcr0 & 0xe6) == 0xe6)
+    {
+        return CSR_SIMD_AVX512;
+    }
+
+    return avx2 && fma ? CSR_SIMD_AVX2 : CSR_SIMD_SSE2;
+}
+
+#else
+
+static int csr_detect_simd()
+{
+    return CSR_SIMD_SCALAR;
+}
+
+#endif // RR_CSR_SIMD
+
+// ** Dispatch *****************************************************************
+
+struct csr_kernels
+{
+    int level;
+    double (*ddot)(int, const csr_matrix*, const double*);
+    void (*dgemv)(double, const csr_matrix*, const double*, double, double*);
+    void (*dgemm)(double, const csr_matrix*, const double*, unsigned, double, double*);
+    void (*sell_dgemv)(double, const csr_matrix_sell*, const double*, double, double*);
+};
+
+static int csr_simd_compiled()
+{
+#if defined(RR_CSR_SIMD) && defined(RR_CSR_HAVE_AVX512)
+    return CSR_SIMD_AVX512;
+#elif defined(RR_CSR_SIMD) && defined(RR_CSR_HAVE_AVX)
+    return CSR_SIMD_AVX2;
+#elif defined(RR_CSR_SIMD)
+    return CSR_SIMD_SSE2;
+#else
+    return CSR_SIMD_SCALAR;
+#endif
+}
+
+static csr_kernels csr_make_kernels(int level)
+{
+    csr_kernels k = { CSR_SIMD_SCALAR, csr_ddot_scalar, csr_dgemv_scalar,
+            csr_dgemm_scalar, csr_sell_dgemv_scalar };
+
+    level = std::min(level, csr_matrix_simd_supported());
+
+#ifdef RR_CSR_SIMD
+#ifdef RR_CSR_HAVE_AVX512
+    if (level >= CSR_SIMD_AVX512)
+    {
+        csr_kernels avx512 = { CSR_SIMD_AVX512, csr_ddot_avx512,
+                csr_dgemv_avx512, csr_dgemm_avx512, csr_sell_dgemv_avx512 };
+        return avx512;
+    }
+#endif
+#ifdef RR_CSR_HAVE_AVX
+    if (level >= CSR_SIMD_AVX2)
+    {
+        csr_kernels avx2 = { CSR_SIMD_AVX2, csr_ddot_avx2, csr_dgemv_avx2,
+                csr_dgemm_avx2, csr_sell_dgemv_avx2 };
+        return avx2;
+    }
+#endif
+    if (level >= CSR_SIMD_SSE2)
+    {
+        csr_kernels sse2 = { CSR_SIMD_SSE2, csr_ddot_sse2, csr_dgemv_sse2,
+                csr_dgemm_sse2, csr_sell_dgemv_sse2 };
+        return sse2;
+    }
+#endif
+
+    return k;
+}
+
+/**
+ * selected when the library is loaded, so there is no race on first use.
+ * Only csr_matrix_set_simd changes it, which is documented as set once at
+ * startup, so the kernels are read without synchronization.
+ */
+static csr_kernels kernels = csr_make_kernels(CSR_SIMD_AVX512);
+
+int csr_matrix_simd_supported()
+{
+    static const int supported = std::min(csr_detect_simd(), csr_simd_compiled());
+    return supported;
+}
+
+int csr_matrix_get_simd()
+{
+    return kernels.level;
+}
+
+int csr_matrix_set_simd(int level)
+{
+    kernels = csr_make_kernels(level);
+    Log(Logger::LOG_DEBUG) << "csr_matrix kernels: "
+            << csr_matrix_simd_name(kernels.level);
+    return kernels.level;
+}
+
+const char* csr_matrix_simd_name(int level)
+{
+    switch (level)
+    {
+    case CSR_SIMD_SCALAR:   return "scalar";
+    case CSR_SIMD_SSE2:     return "sse2";
+    case CSR_SIMD_AVX2:     return "avx2";
+    case CSR_SIMD_AVX512:   return "avx512";
+    default:                return "unknown";
+    }
+}
+
+void csr_matrix_dgemv(double alpha, const csr_matrix* A, const double* x,
+        double beta, double* y)
+{
+    kernels.dgemv(alpha, A, x, beta, y);
+}
+
+double csr_matrix_ddot(int row, const csr_matrix *A, const double *x)
+{
+    assert((unsigned)row < A->m && "invalid row");
+    return kernels.ddot(row, A, x);
+}
+
+void csr_matrix_dgemm(double alpha, const csr_matrix *A, const double *X,
+        unsigned k, double beta, double *Y)
+{
+    kernels.dgemm(alpha, A, X, k, beta, Y);
+}
+
+void csr_matrix_sell_dgemv(double alpha, const csr_matrix_sell *A,
+        const double *x, double beta, double *y)
+{
+    kernels.sell_dgemv(alpha, A, x, beta, y);
+}
+
+// ** SELL-C-sigma storage *****************************************************
+
+// sort rows by decreasing number of non-zeros.
+struct row_length_pred
+{
+    row_length_pred(const csr_matrix *A) : A(A) {}
+
+    bool operator()(unsigned left, unsigned right) const
+    {
+        return A->rowptr[left + 1] - A->rowptr[left]
+                > A->rowptr[right + 1] - A->rowptr[right];
+    }
+
+    const csr_matrix *A;
+};
+
+csr_matrix_sell* csr_matrix_sell_new(const csr_matrix *A, unsigned sigma)
+{
+    csr_matrix_sell *mat = (csr_matrix_sell*)calloc(1, sizeof(csr_matrix_sell));
+
+    mat->m = A->m;
+    mat->n = A->n;
+    mat->slices = (A->m + CSR_SELL_C - 1) / CSR_SELL_C;
+
+    const unsigned rows = mat->slices * CSR_SELL_C;
+
+    vector<unsigned> order(A->m);
+    for (unsigned i = 0; i < A->m; i++)
+    {
+        order[i] = i;
+    }
+
+    if (sigma > 1)
+    {
+        for (unsigned w = 0; w < A->m; w += sigma)
+        {
+            stable_sort(order.begin() + w, order.begin() + std::min(w + sigma, A->m),
+                    row_length_pred(A));
+        }
+    }
+
+    mat->perm = (unsigned*)calloc(rows, sizeof(unsigned));
+    mat->sliceptr = (unsigned*)calloc(mat->slices + 1, sizeof(unsigned));
+
+    for (unsigned s = 0; s < mat->slices; s++)
+    {
+        unsigned len = 0;
+        for (unsigned r = 0; r < CSR_SELL_C; r++)
+        {
+            unsigned i = s * CSR_SELL_C + r;
+            unsigned row = i < A->m ? order[i] : A->m;
+            mat->perm[i] = row;
+            if (row < A->m)
+            {
+                len = std::max(len, A->rowptr[row + 1] - A->rowptr[row]);
+            }
+        }
+        mat->sliceptr[s + 1] = mat->sliceptr[s] + len * CSR_SELL_C;
+    }
+
+    const unsigned entries = mat->sliceptr[mat->slices];
+
+    // zero values and columns for the padding.
+    mat->values = (double*)calloc(entries, sizeof(double));
+    mat->colidx = (unsigned*)calloc(entries, sizeof(unsigned));
+
+    for (unsigned s = 0; s < mat->slices; s++)
+    {
+        for (unsigned r = 0; r < CSR_SELL_C; r++)
+        {
+            unsigned row = mat->perm[s * CSR_SELL_C + r];
+            if (row >= A->m)
+            {
+                continue;
+            }
+
+            unsigned p = mat->sliceptr[s] + r;
+            for (unsigned k = A->rowptr[row]; k < A->rowptr[row + 1]; k++)
+            {
+                mat->values[p] = A->values[k];
+                mat->colidx[p] = A->colidx[k];
+                p += CSR_SELL_C;
+            }
+        }
+    }
+
+    Log(Logger::LOG_DEBUG) << "SELL-" << CSR_SELL_C << "-" << sigma
+            << " matrix, " << A->nnz << " non-zeros stored in " << entries
+            << " entries";
+
+    return mat;
+}
+
+void csr_matrix_sell_delete(csr_matrix_sell *mat)
+{
+    if (mat)
+    {
+        free(mat->sliceptr);
+        free(mat->values);
+        free(mat->colidx);
+        free(mat->perm);
+        free(mat);
+    }
+}
+
+}
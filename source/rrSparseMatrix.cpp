@@ -0,0 +1,333 @@
+/*
+ * rrSparseMatrix.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+#pragma hdrstop
+#include "rrSparseMatrix.h"
+#include <algorithm>
+#include <stdexcept>
+#include <cmath>
+
+namespace rr
+{
+
+SparseMatrix::SparseMatrix() :
+        cols(0),
+        rowptr(1, 0)
+{
+}
+
+SparseMatrix::SparseMatrix(int rows, int cols) :
+        cols(cols),
+        rowptr(rows + 1, 0)
+{
+}
+
+SparseMatrix SparseMatrix::fromTriplets(int rows, int cols,
+        const std::vector<int>& rowidx, const std::vector<int>& colidx,
+        const std::vector<double>& values)
+{
+    if (rowidx.size() != colidx.size() || rowidx.size() != values.size())
+    {
+        throw std::invalid_argument("triplet arrays have different lengths");
+    }
+
+    // counting sort of the entries by row
+    std::vector<int> count(rows + 1, 0);
+    for (unsigned i = 0; i < rowidx.size(); ++i)
+    {
+        if (rowidx[i] < 0 || rowidx[i] >= rows || colidx[i] < 0 || colidx[i] >= cols)
+        {
+            throw std::out_of_range("triplet index out of range");
+        }
+        ++count[rowidx[i] + 1];
+    }
+
+    for (int i = 0; i < rows; ++i)
+    {
+        count[i + 1] += count[i];
+    }
+
+    std::vector<std::pair<int, double> > entries(rowidx.size());
+    std::vector<int> next(count.begin(), count.end() - 1);
+    for (unsigned i = 0; i < rowidx.size(); ++i)
+    {
+        entries[next[rowidx[i]]++] = std::make_pair(colidx[i], values[i]);
+    }
+
+    SparseMatrix result(0, cols);
+    result.values.reserve(entries.size());
+    result.colidx.reserve(entries.size());
+
+    for (int row = 0; row < rows; ++row)
+    {
+        std::sort(entries.begin() + count[row], entries.begin() + count[row + 1]);
+
+        for (int i = count[row]; i < count[row + 1]; ++i)
+        {
+            if (result.colidx.size() > (unsigned)result.rowptr.back()
+                    && result.colidx.back() == entries[i].first)
+            {
+                result.values.back() += entries[i].second;
+            }
+            else
+            {
+                result.addEntry(entries[i].first, entries[i].second);
+            }
+        }
+        result.endRow();
+    }
+
+    return result;
+}
+
+SparseMatrix SparseMatrix::fromDense(int rows, int cols, const double* data,
+        double tolerance)
+{
+    SparseMatrix result(0, cols);
+
+    for (int row = 0; row < rows; ++row)
+    {
+        for (int col = 0; col < cols; ++col)
+        {
+            double value = data[row * cols + col];
+            if (std::fabs(value) > tolerance)
+            {
+                result.addEntry(col, value);
+            }
+        }
+        result.endRow();
+    }
+
+    return result;
+}
+
+SparseMatrix SparseMatrix::fromDense(const ls::DoubleMatrix& mat,
+        double tolerance)
+{
+    SparseMatrix result(0, mat.CSize());
+
+    for (unsigned row = 0; row < mat.RSize(); ++row)
+    {
+        for (unsigned col = 0; col < mat.CSize(); ++col)
+        {
+            double value = mat(row, col);
+            if (std::fabs(value) > tolerance)
+            {
+                result.addEntry(col, value);
+            }
+        }
+        result.endRow();
+    }
+
+    result.setRowNames(mat.getRowNames());
+    result.setColNames(mat.getColNames());
+
+    return result;
+}
+
+int SparseMatrix::numRows() const
+{
+    return rowptr.size() - 1;
+}
+
+int SparseMatrix::numCols() const
+{
+    return cols;
+}
+
+int SparseMatrix::numNonZeros() const
+{
+    return values.size();
+}
+
+void SparseMatrix::addEntry(int col, double value)
+{
+    if (col < 0 || col >= cols)
+    {
+        throw std::out_of_range("column index out of range");
+    }
+
+    if (colidx.size() > (unsigned)rowptr.back() && colidx.back() >= col)
+    {
+        throw std::invalid_argument("columns must be added in increasing order");
+    }
+
+    colidx.push_back(col);
+    values.push_back(value);
+}
+
+void SparseMatrix::endRow()
+{
+    rowptr.push_back(colidx.size());
+}
+
+double SparseMatrix::operator()(int row, int col) const
+{
+    if (row < 0 || row >= numRows() || col < 0 || col >= cols)
+    {
+        throw std::out_of_range("index out of range");
+    }
+
+    std::vector<int>::const_iterator begin = colidx.begin() + rowptr[row];
+    std::vector<int>::const_iterator end = colidx.begin() + rowptr[row + 1];
+    std::vector<int>::const_iterator i = std::lower_bound(begin, end, col);
+
+    return i != end && *i == col ? values[i - colidx.begin()] : 0;
+}
+
+const std::vector<double>& SparseMatrix::getValues() const
+{
+    return values;
+}
+
+const std::vector<int>& SparseMatrix::getColumnIndices() const
+{
+    return colidx;
+}
+
+const std::vector<int>& SparseMatrix::getRowPointers() const
+{
+    return rowptr;
+}
+
+void SparseMatrix::getTriplets(std::vector<int>& rowidx,
+        std::vector<int>& colidx, std::vector<double>& values) const
+{
+    rowidx.resize(this->values.size());
+    colidx = this->colidx;
+    values = this->values;
+
+    for (int row = 0; row < numRows(); ++row)
+    {
+        std::fill(rowidx.begin() + rowptr[row], rowidx.begin() + rowptr[row + 1], row);
+    }
+}
+
+SparseMatrix SparseMatrix::multiply(const SparseMatrix& other) const
+{
+    if (cols != other.numRows())
+    {
+        throw std::invalid_argument("matrix dimensions do not agree");
+    }
+
+    SparseMatrix result(0, other.cols);
+
+    // Gustavson's algorithm, accumulate each row of the result in a dense
+    // work vector, marker records which columns are in the current row.
+    std::vector<double> work(other.cols, 0);
+    std::vector<int> marker(other.cols, -1);
+    std::vector<int> rowCols;
+
+    for (int row = 0; row < numRows(); ++row)
+    {
+        rowCols.clear();
+
+        for (int i = rowptr[row]; i < rowptr[row + 1]; ++i)
+        {
+            int k = colidx[i];
+            double a = values[i];
+
+            for (int j = other.rowptr[k]; j < other.rowptr[k + 1]; ++j)
+            {
+                int col = other.colidx[j];
+                if (marker[col] != row)
+                {
+                    marker[col] = row;
+                    work[col] = 0;
+                    rowCols.push_back(col);
+                }
+                work[col] += a * other.values[j];
+            }
+        }
+
+        std::sort(rowCols.begin(), rowCols.end());
+
+        for (unsigned i = 0; i < rowCols.size(); ++i)
+        {
+            result.addEntry(rowCols[i], work[rowCols[i]]);
+        }
+        result.endRow();
+    }
+
+    result.setRowNames(rowNames);
+    result.setColNames(other.colNames);
+
+    return result;
+}
+
+ls::DoubleMatrix SparseMatrix::toDense() const
+{
+    ls::DoubleMatrix result(numRows(), cols);
+
+    for (int row = 0; row < numRows(); ++row)
+    {
+        for (int col = 0; col < cols; ++col)
+        {
+            result(row, col) = 0;
+        }
+
+        for (int i = rowptr[row]; i < rowptr[row + 1]; ++i)
+        {
+            result(row, colidx[i]) = values[i];
+        }
+    }
+
+    result.setRowNames(rowNames);
+    result.setColNames(colNames);
+
+    return result;
+}
+
+std::vector<std::string>& SparseMatrix::getRowNames()
+{
+    return rowNames;
+}
+
+const std::vector<std::string>& SparseMatrix::getRowNames() const
+{
+    return rowNames;
+}
+
+void SparseMatrix::setRowNames(const std::vector<std::string>& names)
+{
+    rowNames = names;
+}
+
+std::vector<std::string>& SparseMatrix::getColNames()
+{
+    return colNames;
+}
+
+const std::vector<std::string>& SparseMatrix::getColNames() const
+{
+    return colNames;
+}
+
+void SparseMatrix::setColNames(const std::vector<std::string>& names)
+{
+    colNames = names;
+}
+
+std::ostream& operator<<(std::ostream& os, const SparseMatrix& mat)
+{
+    const std::vector<int>& rowptr = mat.getRowPointers();
+    const std::vector<int>& colidx = mat.getColumnIndices();
+    const std::vector<double>& values = mat.getValues();
+
+    os << "SparseMatrix(" << mat.numRows() << " x " << mat.numCols()
+            << ", nnz: " << mat.numNonZeros() << ")" << std::endl;
+
+    for (int row = 0; row < mat.numRows(); ++row)
+    {
+        for (int i = rowptr[row]; i < rowptr[row + 1]; ++i)
+        {
+            os << "(" << row << ", " << colidx[i] << "): " << values[i] << std::endl;
+        }
+    }
+
+    return os;
+}
+
+}
@@ -0,0 +1,155 @@
+/*
+ * rrSparseMatrix.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef RRSPARSEMATRIX_H_
+#define RRSPARSEMATRIX_H_
+
+#include "rrExporter.h"
+#include "rr-libstruct/lsMatrix.h"
+#include <string>
+#include <vector>
+#include <ostream>
+
+namespace rr
+{
+
+/**
+ * A labeled sparse matrix in compressed sparse row (CSR) format.
+ *
+ * This is the return type of the sparse stoichiometry, elasticity,
+ * Jacobian and structural matrix getters, it is the sparse counterpart
+ * of ls::DoubleMatrix. The arrays have the same layout as a
+ * scipy.sparse.csr_matrix, (values, colidx, rowptr), with 32 bit indices,
+ * so they can be handed to SciPy, Eigen or Matlab without any conversion
+ * or densification.
+ *
+ * The column indices in each row are sorted and unique. Only structurally
+ * non-zero entries are stored, an entry may still be stored with a zero
+ * value if it happens to evaluate to zero.
+ *
+ * A matrix is built row by row with addEntry and endRow, i.e.
+ * @code
+ * SparseMatrix m(0, 3);
+ * m.addEntry(0, 1.0); m.addEntry(2, -1.0); m.endRow();
+ * m.endRow();
+ * @endcode
+ * is a 2 x 3 matrix with an empty second row.
+ */
+class RR_DECLSPEC SparseMatrix
+{
+public:
+    /**
+     * empty 0 x 0 matrix.
+     */
+    SparseMatrix();
+
+    /**
+     * matrix with the given number of complete empty rows and columns,
+     * more rows may be appended with addEntry / endRow.
+     */
+    SparseMatrix(int rows, int cols);
+
+    /**
+     * build a matrix from coordinate (COO) triplets, which may be in any
+     * order, duplicate entries are summed.
+     */
+    static SparseMatrix fromTriplets(int rows, int cols,
+            const std::vector<int>& rowidx, const std::vector<int>& colidx,
+            const std::vector<double>& values);
+
+    /**
+     * compress a row major dense matrix, entries with an absolute value
+     * less than or equal to the tolerance are dropped.
+     */
+    static SparseMatrix fromDense(int rows, int cols, const double* data,
+            double tolerance = 0);
+
+    /**
+     * compress a dense matrix and copy its row and column names.
+     */
+    static SparseMatrix fromDense(const ls::DoubleMatrix& mat,
+            double tolerance = 0);
+
+    int numRows() const;
+
+    int numCols() const;
+
+    /**
+     * number of stored entries.
+     */
+    int numNonZeros() const;
+
+    /**
+     * append an entry to the row being built, the columns must be added in
+     * increasing order.
+     */
+    void addEntry(int col, double value);
+
+    /**
+     * finish the row being built and start the next one.
+     */
+    void endRow();
+
+    /**
+     * the value of the given entry, zero if it is not stored.
+     */
+    double operator()(int row, int col) const;
+
+    /**
+     * stored values, length numNonZeros().
+     */
+    const std::vector<double>& getValues() const;
+
+    /**
+     * column index of each stored value, length numNonZeros().
+     */
+    const std::vector<int>& getColumnIndices() const;
+
+    /**
+     * index of the first stored value of each row, length numRows() + 1,
+     * the last element is numNonZeros().
+     */
+    const std::vector<int>& getRowPointers() const;
+
+    /**
+     * get the matrix in coordinate (COO) format, in row major order.
+     */
+    void getTriplets(std::vector<int>& rowidx, std::vector<int>& colidx,
+            std::vector<double>& values) const;
+
+    /**
+     * the matrix product this * other, the row names of this and the
+     * column names of other are copied.
+     */
+    SparseMatrix multiply(const SparseMatrix& other) const;
+
+    /**
+     * expand to a dense matrix, mainly for testing and small matrices.
+     */
+    ls::DoubleMatrix toDense() const;
+
+    std::vector<std::string>& getRowNames();
+    const std::vector<std::string>& getRowNames() const;
+    void setRowNames(const std::vector<std::string>& names);
+
+    std::vector<std::string>& getColNames();
+    const std::vector<std::string>& getColNames() const;
+    void setColNames(const std::vector<std::string>& names);
+
+private:
+    int cols;
+    std::vector<double> values;
+    std::vector<int> colidx;
+    std::vector<int> rowptr;
+    std::vector<std::string> rowNames;
+    std::vector<std::string> colNames;
+};
+
+RR_DECLSPEC std::ostream& operator<<(std::ostream& os, const SparseMatrix& mat);
+
+}
+
+#endif /* RRSPARSEMATRIX_H_ */
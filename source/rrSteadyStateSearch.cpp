@@ -0,0 +1,490 @@
+/*
+ * rrSteadyStateSearch.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+#pragma hdrstop
+#include "rrSteadyStateSearch.h"
+#include "rrRoadRunner.h"
+#include "rrExecutableModel.h"
+#include "Integrator.h"
+#include "rrLogger.h"
+#include "rrStringUtils.h"
+
+#include <Poco/Thread.h>
+#include <Poco/Runnable.h>
+#include <Poco/Mutex.h>
+#include <Poco/Random.h>
+#include <Poco/Environment.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <limits>
+#include <complex>
+#include <math.h>
+
+using namespace std;
+using Poco::Mutex;
+
+namespace rr
+{
+
+/**
+ * eigenvalues whose real part is smaller than this fraction of the largest
+ * eigenvalue magnitude are treated as zero, i.e. neutral directions from
+ * conservation laws.
+ */
+static const double eigenvalueZero = 1e-8;
+
+/**
+ * state shared by the workers while solving a set of starts.
+ */
+struct SolveState
+{
+    const vector<vector<double> >* starts;
+    const string* parameterId;
+    double parameterValue;
+    unsigned next;
+
+    /**
+     * converged solution for each start, if any.
+     */
+    vector<SteadyStateSearch::Solution> results;
+    vector<bool> converged;
+    Mutex mutex;
+};
+
+/**
+ * each worker has its own copy of the model, and takes starts from the
+ * shared state until they are all done.
+ */
+struct SteadyStateSearch::Worker : public Poco::Runnable
+{
+    Worker(const string& sbml, bool conservedMoieties, double presimulationTime) :
+        state(0), presimulationTime(presimulationTime)
+    {
+        rr.setConservedMoietyAnalysis(conservedMoieties);
+        rr.load(sbml);
+    }
+
+    virtual void run()
+    {
+        while (true)
+        {
+            unsigned index;
+            {
+                Mutex::ScopedLock lock(state->mutex);
+                index = state->next++;
+            }
+
+            if (index >= state->starts->size())
+            {
+                return;
+            }
+
+            Solution solution;
+            if (solveStart((*state->starts)[index], solution))
+            {
+                Mutex::ScopedLock lock(state->mutex);
+                state->results[index] = solution;
+                state->converged[index] = true;
+            }
+        }
+    }
+
+    bool solveStart(const vector<double>& start, Solution& solution)
+    {
+        ExecutableModel* model = rr.getModel();
+
+        try
+        {
+            model->reset();
+
+            if (state->parameterId->size())
+            {
+                model->setValue(*state->parameterId, state->parameterValue);
+            }
+
+            if (start.size())
+            {
+                model->setFloatingSpeciesConcentrations(start.size(), 0, &start[0]);
+            }
+
+            if (presimulationTime > 0)
+            {
+                Integrator* integrator = rr.getIntegrator();
+                integrator->restart(0);
+                integrator->integrate(0, presimulationTime);
+            }
+
+            if (rr.steadyState() < 0)
+            {
+                return false;
+            }
+
+            solution.values.resize(model->getNumFloatingSpecies());
+            model->getFloatingSpeciesConcentrations(solution.values.size(), 0,
+                    &solution.values[0]);
+
+            double scale = 0;
+            for (unsigned i = 0; i < solution.values.size(); ++i)
+            {
+                scale = max(scale, fabs(solution.values[i]));
+            }
+
+            // reject diverged and non-physical solutions
+            for (unsigned i = 0; i < solution.values.size(); ++i)
+            {
+                double v = solution.values[i];
+                if (v != v || fabs(v) == numeric_limits<double>::infinity()
+                        || v < -eigenvalueZero * (1 + scale))
+                {
+                    return false;
+                }
+            }
+
+            vector<ls::Complex> eigen = rr.getReducedEigenValues();
+
+            double maxAbs = 0;
+            solution.maxEigenvalue = -numeric_limits<double>::infinity();
+            for (unsigned i = 0; i < eigen.size(); ++i)
+            {
+                maxAbs = max(maxAbs, abs(eigen[i]));
+                solution.maxEigenvalue = max(solution.maxEigenvalue,
+                        eigen[i].real());
+            }
+
+            solution.stable = solution.maxEigenvalue < eigenvalueZero * maxAbs;
+            solution.starts = 1;
+            return true;
+        }
+        catch (std::exception& e)
+        {
+            Log(Logger::LOG_DEBUG) << "steady state search start failed: "
+                    << e.what();
+            return false;
+        }
+    }
+
+    RoadRunner rr;
+    SolveState* state;
+    double presimulationTime;
+};
+
+
+SteadyStateSearch::SteadyStateSearch(RoadRunner* rr) :
+        conservedMoieties(rr->getConservedMoietyAnalysis()),
+        numStarts(100),
+        numThreads(Poco::Environment::processorCount()),
+        seed(0),
+        presimulationTime(0),
+        tolerance(1e-5)
+{
+    ExecutableModel* model = rr->getModel();
+
+    if (!model)
+    {
+        throw std::invalid_argument("steady state search requires a loaded model");
+    }
+
+    sbml = rr->getCurrentSBML();
+
+    for (int i = 0; i < model->getNumFloatingSpecies(); ++i)
+    {
+        floatingIds.push_back(model->getFloatingSpeciesId(i));
+    }
+
+    // independent species are first.
+    const int nInd = model->getNumIndFloatingSpecies();
+    indIds.assign(floatingIds.begin(), floatingIds.begin() + nInd);
+
+    vector<double> current(nInd);
+    if (nInd)
+    {
+        model->getFloatingSpeciesConcentrations(nInd, 0, &current[0]);
+    }
+
+    for (int i = 0; i < nInd; ++i)
+    {
+        lower.push_back(0);
+        upper.push_back(current[i] > 0 ? 2 * current[i] : 1.0);
+    }
+}
+
+SteadyStateSearch::~SteadyStateSearch()
+{
+    for (unsigned i = 0; i < workers.size(); ++i)
+    {
+        delete workers[i];
+    }
+}
+
+void SteadyStateSearch::setBounds(const std::string& speciesId, double lo,
+        double hi)
+{
+    vector<string>::const_iterator i = find(indIds.begin(), indIds.end(),
+            speciesId);
+
+    if (i == indIds.end())
+    {
+        throw std::invalid_argument(speciesId
+                + " is not an independent floating species");
+    }
+
+    if (!(lo <= hi))
+    {
+        throw std::invalid_argument("invalid bounds for " + speciesId);
+    }
+
+    lower[i - indIds.begin()] = lo;
+    upper[i - indIds.begin()] = hi;
+}
+
+void SteadyStateSearch::setNumStarts(unsigned starts)
+{
+    numStarts = starts;
+}
+
+void SteadyStateSearch::setNumThreads(unsigned threads)
+{
+    numThreads = threads ? threads : 1;
+
+    for (unsigned i = 0; i < workers.size(); ++i)
+    {
+        delete workers[i];
+    }
+    workers.clear();
+}
+
+void SteadyStateSearch::setSeed(unsigned long s)
+{
+    seed = s;
+}
+
+void SteadyStateSearch::setPresimulationTime(double time)
+{
+    presimulationTime = time;
+
+    for (unsigned i = 0; i < workers.size(); ++i)
+    {
+        workers[i]->presimulationTime = time;
+    }
+}
+
+void SteadyStateSearch::setTolerance(double tol)
+{
+    tolerance = tol;
+}
+
+ls::DoubleMatrix SteadyStateSearch::search()
+{
+    vector<Solution> solutions = solve(sample(seed), "", 0);
+    return toMatrix(solutions, 0, "");
+}
+
+ls::DoubleMatrix SteadyStateSearch::continuation(const std::string& parameterId,
+        double start, double end, unsigned steps)
+{
+    vector<Solution> all;
+    vector<double> parameterValues;
+    vector<Solution> previous;
+
+    for (unsigned step = 0; step <= steps; ++step)
+    {
+        double value = steps ? start + (end - start) * step / steps : start;
+
+        // previous solutions go first so that their branches keep their
+        // order, then fresh samples to pick up new branches.
+        vector<vector<double> > starts = predictors(previous);
+        vector<vector<double> > samples = sample(seed + step);
+        starts.insert(starts.end(), samples.begin(), samples.end());
+
+        previous = solve(starts, parameterId, value);
+
+        Log(Logger::LOG_INFORMATION) << "continuation, " << parameterId
+                << " = " << value << ", " << previous.size() << " steady states";
+
+        all.insert(all.end(), previous.begin(), previous.end());
+        parameterValues.insert(parameterValues.end(), previous.size(), value);
+    }
+
+    return toMatrix(all, &parameterValues, parameterId);
+}
+
+void SteadyStateSearch::createWorkers()
+{
+    while (workers.size() < numThreads)
+    {
+        workers.push_back(new Worker(sbml, conservedMoieties, presimulationTime));
+    }
+}
+
+vector<SteadyStateSearch::Solution> SteadyStateSearch::solve(
+        const vector<vector<double> >& starts, const std::string& parameterId,
+        double parameterValue)
+{
+    createWorkers();
+
+    SolveState state;
+    state.starts = &starts;
+    state.parameterId = &parameterId;
+    state.parameterValue = parameterValue;
+    state.next = 0;
+    state.results.resize(starts.size());
+    state.converged.resize(starts.size(), false);
+
+    vector<Poco::Thread*> threads;
+    for (unsigned i = 0; i < workers.size(); ++i)
+    {
+        workers[i]->state = &state;
+    }
+
+    // the first worker runs on this thread.
+    for (unsigned i = 1; i < workers.size(); ++i)
+    {
+        threads.push_back(new Poco::Thread());
+        threads.back()->start(*workers[i]);
+    }
+
+    workers[0]->run();
+
+    for (unsigned i = 0; i < threads.size(); ++i)
+    {
+        threads[i]->join();
+        delete threads[i];
+    }
+
+    // merge in start order, so the result does not depend on scheduling.
+    vector<Solution> solutions;
+    unsigned converged = 0;
+    for (unsigned i = 0; i < starts.size(); ++i)
+    {
+        if (!state.converged[i])
+        {
+            continue;
+        }
+
+        ++converged;
+
+        const Solution& s = state.results[i];
+        unsigned j = 0;
+        while (j < solutions.size() && !isSame(solutions[j].values, s.values))
+        {
+            ++j;
+        }
+
+        if (j < solutions.size())
+        {
+            solutions[j].starts++;
+        }
+        else
+        {
+            solutions.push_back(s);
+        }
+    }
+
+    Log(Logger::LOG_DEBUG) << "steady state search: " << converged << " of "
+            << starts.size() << " starts converged to " << solutions.size()
+            << " distinct steady states";
+
+    return solutions;
+}
+
+vector<vector<double> > SteadyStateSearch::sample(unsigned long s)
+{
+    const unsigned n = indIds.size();
+    const unsigned m = numStarts;
+
+    Poco::Random random;
+    random.seed(s);
+
+    vector<vector<double> > starts(m, vector<double>(n));
+    vector<unsigned> perm(m);
+
+    // each dimension is split into m strata, every stratum is sampled once.
+    for (unsigned d = 0; d < n; ++d)
+    {
+        for (unsigned i = 0; i < m; ++i)
+        {
+            perm[i] = i;
+        }
+
+        for (unsigned i = m; i > 1; --i)
+        {
+            swap(perm[i - 1], perm[random.next(i)]);
+        }
+
+        for (unsigned i = 0; i < m; ++i)
+        {
+            double u = (perm[i] + random.nextDouble()) / m;
+            starts[i][d] = lower[d] + u * (upper[d] - lower[d]);
+        }
+    }
+
+    return starts;
+}
+
+vector<vector<double> > SteadyStateSearch::predictors(
+        const vector<Solution>& solutions)
+{
+    vector<vector<double> > result;
+    for (unsigned i = 0; i < solutions.size(); ++i)
+    {
+        result.push_back(vector<double>(solutions[i].values.begin(),
+                solutions[i].values.begin() + indIds.size()));
+    }
+    return result;
+}
+
+bool SteadyStateSearch::isSame(const vector<double>& a,
+        const vector<double>& b) const
+{
+    for (unsigned i = 0; i < a.size(); ++i)
+    {
+        if (fabs(a[i] - b[i]) > tolerance * (1.0 + max(fabs(a[i]), fabs(b[i]))))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+ls::DoubleMatrix SteadyStateSearch::toMatrix(const vector<Solution>& solutions,
+        const vector<double>* parameterValues, const std::string& parameterId) const
+{
+    vector<string> names;
+    if (parameterValues)
+    {
+        names.push_back(parameterId);
+    }
+
+    names.insert(names.end(), floatingIds.begin(), floatingIds.end());
+    names.push_back("stable");
+    names.push_back("max_eigenvalue");
+    names.push_back("starts");
+
+    ls::DoubleMatrix result(solutions.size(), names.size());
+    result.setColNames(names);
+
+    for (unsigned i = 0; i < solutions.size(); ++i)
+    {
+        unsigned col = 0;
+        if (parameterValues)
+        {
+            result(i, col++) = (*parameterValues)[i];
+        }
+
+        for (unsigned j = 0; j < solutions[i].values.size(); ++j)
+        {
+            result(i, col++) = solutions[i].values[j];
+        }
+
+        result(i, col++) = solutions[i].stable ? 1 : 0;
+        result(i, col++) = solutions[i].maxEigenvalue;
+        result(i, col++) = solutions[i].starts;
+    }
+
+    return result;
+}
+
+}
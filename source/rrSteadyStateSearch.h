@@ -0,0 +1,171 @@
+/*
+ * rrSteadyStateSearch.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef RRSTEADYSTATESEARCH_H_
+#define RRSTEADYSTATESEARCH_H_
+
+#include "rrExporter.h"
+#include "rr-libstruct/lsMatrix.h"
+#include <string>
+#include <vector>
+
+namespace rr
+{
+
+class RoadRunner;
+
+/**
+ * Search for all of the steady states of a model.
+ *
+ * RoadRunner::steadyState finds at most one fixed point, the one the solver
+ * converges to from the current state. Multistable systems such as switches
+ * have several, so this runs the steady state solver from many starting
+ * points, Latin hypercube sampled over bounded ranges of the independent
+ * floating species, and collects the distinct solutions.
+ *
+ * Each solution is classified by the eigenvalues of the reduced Jacobian,
+ * and branches can be followed through a parameter range with natural
+ * parameter continuation, where the solutions of each step are the
+ * predictors for the next, together with a fresh set of sampled starts so
+ * that branches which appear along the way are found as well.
+ *
+ * The starts are distributed over a number of worker threads, each with
+ * its own copy of the model. Note that the NLEQ solver is not reentrant and
+ * is serialized internally, so the threads mainly speed up the optional
+ * pre-integration and the eigenvalue calculations.
+ *
+ * Conserved moiety totals are fixed by the initial conditions of the model,
+ * only the independent species are sampled, so enable conserved moiety
+ * analysis to search within a fixed set of totals.
+ */
+class RR_DECLSPEC SteadyStateSearch
+{
+public:
+
+    /**
+     * create a search for the model currently loaded in the given
+     * RoadRunner, the model is copied with its current parameter values,
+     * the RoadRunner object itself is not modified.
+     */
+    SteadyStateSearch(RoadRunner* rr);
+
+    ~SteadyStateSearch();
+
+    /**
+     * set the sampling range of an independent floating species
+     * concentration. Species without a range are sampled between zero
+     * and twice their current value (or one if the current value is zero).
+     */
+    void setBounds(const std::string& speciesId, double lower, double upper);
+
+    /**
+     * number of sampled starting points, default 100.
+     */
+    void setNumStarts(unsigned starts);
+
+    /**
+     * number of worker threads, default is the number of processors.
+     */
+    void setNumThreads(unsigned threads);
+
+    /**
+     * seed for the Latin hypercube sampling.
+     */
+    void setSeed(unsigned long seed);
+
+    /**
+     * integrate each start for this time before solving, can help the
+     * solver converge from poor starting points. Default 0, no integration.
+     */
+    void setPresimulationTime(double time);
+
+    /**
+     * relative tolerance for two solutions being the same, default 1e-5.
+     */
+    void setTolerance(double tol);
+
+    /**
+     * perform the search.
+     *
+     * @return a matrix with a row for each distinct steady state, columns
+     * are the floating species concentrations, then 'stable', 1 if all
+     * eigenvalues of the reduced Jacobian have negative real parts,
+     * 'max_eigenvalue', the largest real part, and 'starts', the number of
+     * starts that converged to this solution.
+     */
+    ls::DoubleMatrix search();
+
+    /**
+     * natural parameter continuation, performs a search at each of steps + 1
+     * evenly spaced values of the given parameter.
+     *
+     * @return same as search with an additional first column with the
+     * parameter value, solutions for each parameter value are consecutive
+     * rows.
+     */
+    ls::DoubleMatrix continuation(const std::string& parameterId,
+            double start, double end, unsigned steps);
+
+    /**
+     * @internal
+     * a converged steady state.
+     */
+    struct Solution
+    {
+        std::vector<double> values;
+        bool stable;
+        double maxEigenvalue;
+        unsigned starts;
+    };
+
+private:
+    struct Worker;
+
+    /**
+     * run the solver from each start, returns the distinct solutions.
+     */
+    std::vector<Solution> solve(const std::vector<std::vector<double> >& starts,
+            const std::string& parameterId, double parameterValue);
+
+    /**
+     * Latin hypercube sample of the independent species ranges.
+     */
+    std::vector<std::vector<double> > sample(unsigned long seed);
+
+    /**
+     * starting points for the next continuation step, the independent
+     * species of the given solutions.
+     */
+    std::vector<std::vector<double> > predictors(
+            const std::vector<Solution>& solutions);
+
+    bool isSame(const std::vector<double>& a, const std::vector<double>& b) const;
+
+    ls::DoubleMatrix toMatrix(const std::vector<Solution>& solutions,
+            const std::vector<double>* parameterValues,
+            const std::string& parameterId) const;
+
+    void createWorkers();
+
+    std::string sbml;
+    bool conservedMoieties;
+    std::vector<std::string> indIds;
+    std::vector<std::string> floatingIds;
+    std::vector<double> lower;
+    std::vector<double> upper;
+
+    unsigned numStarts;
+    unsigned numThreads;
+    unsigned long seed;
+    double presimulationTime;
+    double tolerance;
+
+    std::vector<Worker*> workers;
+};
+
+}
+
+#endif /* RRSTEADYSTATESEARCH_H_ */
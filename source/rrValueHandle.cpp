@@ -0,0 +1,86 @@
+/*
+ * rrValueHandle.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "rrValueHandle.h"
+#include "rrExecutableModel.h"
+
+namespace rr
+{
+
+ValueHandle::ValueHandle() :
+        model(0),
+        modelSerial(0)
+{
+}
+
+ValueHandle::ValueHandle(const ExecutableModel* model) :
+        model(model),
+        modelSerial(model ? model->getSerial() : 0)
+{
+}
+
+void ValueHandle::add(const std::string& id, SelectionRecord::SelectionType type,
+        int index)
+{
+    int position = ids.size();
+    ids.push_back(id);
+
+    std::vector<Group>::iterator i = groups.begin();
+    while (i != groups.end() && i->type != type)
+    {
+        ++i;
+    }
+
+    if (i == groups.end())
+    {
+        Group group;
+        group.type = type;
+        i = groups.insert(groups.end(), group);
+    }
+
+    i->indices.push_back(type == SelectionRecord::UNKNOWN ? -1 : index);
+    i->positions.push_back(position);
+}
+
+unsigned ValueHandle::size() const
+{
+    return ids.size();
+}
+
+const std::vector<std::string>& ValueHandle::getIds() const
+{
+    return ids;
+}
+
+const std::vector<ValueHandle::Group>& ValueHandle::getGroups() const
+{
+    return groups;
+}
+
+bool ValueHandle::hasType(SelectionRecord::SelectionType type) const
+{
+    for (std::vector<Group>::const_iterator i = groups.begin();
+            i != groups.end(); ++i)
+    {
+        if (i->type == type)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+const ExecutableModel* ValueHandle::getModel() const
+{
+    return model;
+}
+
+unsigned long ValueHandle::getModelSerial() const
+{
+    return modelSerial;
+}
+
+}
@@ -0,0 +1,125 @@
+/*
+ * rrValueHandle.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef RRVALUEHANDLE_H_
+#define RRVALUEHANDLE_H_
+
+#include "rrExporter.h"
+#include "rrSelectionRecord.h"
+#include <string>
+#include <vector>
+
+namespace rr
+{
+
+class ExecutableModel;
+
+/**
+ * A list of ids resolved once into typed indices, for getting and setting
+ * many values of a model at a time without looking up and parsing the id
+ * strings on every call.
+ *
+ * The ids are the ones ExecutableModel::getValue and setValue accept, i.e.
+ * "S1", "[S1]", "init([S1])" or "k1". They are grouped by the kind of value,
+ * and each group is read or written with a single call of the matching
+ * indexed accessor of the model, i.e. getGlobalParameterValues, so the
+ * values of a group are read or written together and whatever the model
+ * does after a change, like re-evaluating the initial conditions, happens
+ * once per group instead of once per value. The groups are processed in
+ * the order their first id appears in the list.
+ *
+ * Ids a model can not resolve to an index are kept in a group of their
+ * own, with the UNKNOWN type, and are read or written one at a time by id.
+ *
+ * Handles are created with ExecutableModel::createValueHandle or
+ * RoadRunner::createValueHandle and are only valid for the model they were
+ * created for, using one with any other model, including the model of the
+ * same RoadRunner after a new model was loaded, is an error. The model is
+ * identified by its address and its serial number, so a new model which
+ * happens to be at the address of the old one is also detected.
+ */
+class RR_DECLSPEC ValueHandle
+{
+public:
+
+    /**
+     * the ids of one kind of value, and where they are in the list.
+     */
+    struct Group
+    {
+        /**
+         * the kind of value, UNKNOWN for the ids which are accessed by id.
+         */
+        SelectionRecord::SelectionType type;
+
+        /**
+         * the indices of the values in the model, the argument of the
+         * indexed accessor.
+         */
+        std::vector<int> indices;
+
+        /**
+         * the positions of the values in the id list, and so in the
+         * array of values.
+         */
+        std::vector<int> positions;
+    };
+
+    /**
+     * an empty handle which does not belong to any model.
+     */
+    ValueHandle();
+
+    /**
+     * an empty handle for the given model, ids are added with add.
+     */
+    ValueHandle(const ExecutableModel* model);
+
+    /**
+     * append an id which the model resolved to a value of the given type
+     * and index, the index is ignored for UNKNOWN.
+     */
+    void add(const std::string& id, SelectionRecord::SelectionType type,
+            int index);
+
+    /**
+     * the number of ids, the size of the value arrays.
+     */
+    unsigned size() const;
+
+    /**
+     * the ids, in the order of the values.
+     */
+    const std::vector<std::string>& getIds() const;
+
+    const std::vector<Group>& getGroups() const;
+
+    /**
+     * does the handle have any values of the given type.
+     */
+    bool hasType(SelectionRecord::SelectionType type) const;
+
+    /**
+     * the model this handle belongs to.
+     */
+    const ExecutableModel* getModel() const;
+
+    /**
+     * the serial number of the model this handle belongs to, see
+     * ExecutableModel::getSerial.
+     */
+    unsigned long getModelSerial() const;
+
+private:
+    const ExecutableModel* model;
+    unsigned long modelSerial;
+    std::vector<std::string> ids;
+    std::vector<Group> groups;
+};
+
+}
+
+#endif /* RRVALUEHANDLE_H_ */
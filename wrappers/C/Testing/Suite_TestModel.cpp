@@ -10,6 +10,7 @@
 #include "rrc_cpp_support.h"
 #include "src/TestUtils.h"
 #include <algorithm>
+#include <cstdlib>
 
 #include "Poco/Path.h"
 #include "Poco/Glob.h"
@@ -149,6 +150,106 @@ void compareMatrices(const ls::DoubleMatrix& ref, RRDoubleMatrixPtr calc)
     }
 }
 
+/**
+ * check the CSR invariants and that every entry of the sparse matrix,
+ * stored or not, equals the dense entry with the same row and column name.
+ */
+void compareSparse(const ls::DoubleMatrix& ref, const SparseMatrix& calc)
+{
+    clog << "Dense Matrix:" << endl;
+    clog << ref << endl;
+
+    clog << "Sparse Matrix:" << endl;
+    clog << calc << endl;
+
+    if (calc.numRows() != ref.RSize() || calc.numCols() != ref.CSize())
+    {
+        CHECK(false);
+        return;
+    }
+
+    const vector<int>& rowptr = calc.getRowPointers();
+    const vector<int>& colidx = calc.getColumnIndices();
+    CHECK_EQUAL(calc.numRows() + 1, (int)rowptr.size());
+    CHECK_EQUAL(calc.numNonZeros(), rowptr.back());
+    CHECK_EQUAL(calc.numNonZeros(), (int)calc.getValues().size());
+
+    for (int i = 0; i < calc.numRows(); i++)
+    {
+        for (int k = rowptr[i] + 1; k < rowptr[i + 1]; k++)
+        {
+            CHECK(colidx[k - 1] < colidx[k]);
+        }
+    }
+
+    // the sparse getters may order the rows and columns differently to
+    // libstruct, so match them by name.
+    vector<int> rows(ref.RSize()), cols(ref.CSize());
+    for (int i = 0; i < ref.RSize(); i++)
+    {
+        rows[i] = i;
+        if (ref.getRowNames().size() && calc.getRowNames().size())
+        {
+            rows[i] = find(calc.getRowNames().begin(), calc.getRowNames().end(),
+                    ref.getRowNames()[i]) - calc.getRowNames().begin();
+            CHECK(rows[i] < calc.numRows());
+        }
+    }
+    for (int j = 0; j < ref.CSize(); j++)
+    {
+        cols[j] = j;
+        if (ref.getColNames().size() && calc.getColNames().size())
+        {
+            cols[j] = find(calc.getColNames().begin(), calc.getColNames().end(),
+                    ref.getColNames()[j]) - calc.getColNames().begin();
+            CHECK(cols[j] < calc.numCols());
+        }
+    }
+
+    for (int i = 0; i < ref.RSize(); i++)
+    {
+        for (int j = 0; j < ref.CSize(); j++)
+        {
+            if (rows[i] < calc.numRows() && cols[j] < calc.numCols())
+            {
+                CHECK_CLOSE(ref(i, j), calc(rows[i], cols[j]), abs(ref(i, j)) * 1e-12 + 1e-14);
+            }
+        }
+    }
+}
+
+/**
+ * the C API copies the CSR arrays of the sparse matrix as they are.
+ */
+void compareSparse(const SparseMatrix& ref, RRCSRMatrixPtr calc)
+{
+    if (!calc)
+    {
+        CHECK(false);
+        return;
+    }
+
+    CHECK_EQUAL(ref.numRows(), calc->RSize);
+    CHECK_EQUAL(ref.numCols(), calc->CSize);
+    CHECK_EQUAL(ref.numNonZeros(), calc->NNZ);
+
+    if (ref.numRows() != calc->RSize || ref.numNonZeros() != calc->NNZ)
+    {
+        return;
+    }
+
+    for (int i = 0; i <= ref.numRows(); i++)
+    {
+        CHECK_EQUAL(ref.getRowPointers()[i], calc->RowPointers[i]);
+    }
+
+    for (int k = 0; k < ref.numNonZeros(); k++)
+    {
+        CHECK_EQUAL(ref.getColumnIndices()[k], calc->ColIndices[k]);
+        CHECK_EQUAL(ref.getValues()[k], calc->Values[k]);
+    }
+}
+
 void trySteadyState(RRHandle& gRR)
 {
     double val;
@@ -917,6 +1018,71 @@ SUITE(TEST_MODEL)
         compareMatrices(ref, matrix);
       }
 
+    TEST(SPARSE_STOICHIOMETRY_MATRIX)
+    {
+        CHECK(gRR!=NULL);
+        if(!gRR)
+        {
+            return;
+        }
+        clog<< endl << "==== SPARSE_STOICHIOMETRY_MATRIX ====" << endl << endl;
+
+        RoadRunner* rri = castToRoadRunner(gRR);
+
+        SparseMatrix sparse = rri->getFullStoichiometryMatrixSparse();
+        compareSparse(rri->getFullStoichiometryMatrix(), sparse);
+
+        RRCSRMatrixPtr csr = getStoichiometryMatrixCSR(gRR);
+        compareSparse(sparse, csr);
+        freeCSRMatrix(csr);
+
+        // the model stoichiometry, without any libstruct reordering, is
+        // copied straight from the model CSR matrix.
+        ExecutableModel* model = rri->getModel();
+        int rows = 0, cols = 0;
+        double* data = 0;
+        model->getStoichiometryMatrix(&rows, &cols, &data);
+
+        SparseMatrix modelSparse;
+        model->getSparseStoichiometryMatrix(modelSparse);
+
+        ls::DoubleMatrix modelDense(rows, cols);
+        for(int i = 0; i < rows * cols; i++)
+        {
+            modelDense.getArray()[i] = data[i];
+        }
+        free(data);
+
+        compareSparse(modelDense, modelSparse);
+      }
+
+    TEST(SPARSE_ELASTICITY_MATRICES)
+    {
+        CHECK(gRR!=NULL);
+        if(!gRR)
+        {
+            return;
+        }
+        clog<<"\n==== SPARSE_ELASTICITY_MATRICES ====\n\n";
+
+        Config::setValue(Config::ROADRUNNER_JACOBIAN_MODE, (unsigned)Config::ROADRUNNER_JACOBIAN_MODE_CONCENTRATIONS);
+        RoadRunner* rri = castToRoadRunner(gRR);
+
+        SparseMatrix unscaled = rri->getUnscaledElasticityMatrixSparse();
+        compareSparse(rri->getUnscaledElasticityMatrix(), unscaled);
+
+        RRCSRMatrixPtr csr = getUnscaledElasticityMatrixCSR(gRR);
+        compareSparse(unscaled, csr);
+        freeCSRMatrix(csr);
+
+        SparseMatrix scaled = rri->getScaledElasticityMatrixSparse();
+        compareSparse(rri->getScaledElasticityMatrix(), scaled);
+
+        csr = getScaledElasticityMatrixCSR(gRR);
+        compareSparse(scaled, csr);
+        freeCSRMatrix(csr);
+      }
+
     TEST(UNSCALED_CONCENTRATION_CONTROL_MATRIX)
     {
 
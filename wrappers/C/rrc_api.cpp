@@ -52,6 +52,8 @@
 #include "rrException.h"
 #include "rrVersionInfo.h"
 #include "rrUtils.h"
+#include "rrSimulateFuture.h"
+#include "ExecutableModelFactory.h"
 #include "rrc_types.h"
 #include "rrc_api.h"           // Need to include this before the support header..
 #include "rrc_utilities.h"     //Support functions, not exposed as api functions and or data
@@ -270,6 +272,73 @@ char* rrcCallConv getInfo(RRHandle handle)
     catch_ptr_macro
 }
 
+RRStringArrayPtr rrcCallConv getListOfPerformanceCounters(RRHandle handle)
+{
+    start_try
+        RoadRunner* rri = castToRoadRunner(handle);
+        StringList names = rri->getPerformanceCounters()->getKeys();
+        return createList(names);
+    catch_ptr_macro
+}
+
+bool rrcCallConv getPerformanceCounter(RRHandle handle, const char* name, double* value)
+{
+    start_try
+        RoadRunner* rri = castToRoadRunner(handle);
+        const Dictionary* counters = rri->getPerformanceCounters();
+
+        if(!counters->hasKey(name))
+        {
+            setError(string("No performance counter named ") + name);
+            return false;
+        }
+
+        *value = counters->getItem(name).convert<double>();
+        return true;
+    catch_bool_macro
+}
+
+bool rrcCallConv resetPerformanceCounters(RRHandle handle)
+{
+    start_try
+        RoadRunner* rri = castToRoadRunner(handle);
+        rri->resetPerformanceCounters();
+        return true;
+    catch_bool_macro
+}
+
+RRStringArrayPtr rrcCallConv getListOfModelCacheStatistics()
+{
+    start_try
+        StringList names = ExecutableModelFactory::getModelCacheStatistics().getKeys();
+        return createList(names);
+    catch_ptr_macro
+}
+
+bool rrcCallConv getModelCacheStatistic(const char* name, double* value)
+{
+    start_try
+        BasicDictionary stats = ExecutableModelFactory::getModelCacheStatistics();
+
+        if(!stats.hasKey(name))
+        {
+            setError(string("No model cache statistic named ") + name);
+            return false;
+        }
+
+        *value = stats.getItem(name).convert<double>();
+        return true;
+    catch_bool_macro
+}
+
+bool rrcCallConv clearModelCache()
+{
+    start_try
+        ExecutableModelFactory::clearModelCache();
+        return true;
+    catch_bool_macro
+}
+
 char* rrcCallConv getExtendedAPIInfo()
 {
     start_try
@@ -706,6 +775,24 @@ RRDoubleMatrixPtr rrcCallConv getScaledElasticityMatrix(RRHandle handle)
     catch_ptr_macro
 }
 
+RRCSRMatrixPtr rrcCallConv getUnscaledElasticityMatrixCSR(RRHandle handle)
+{
+    start_try
+        RoadRunner* rri = castToRoadRunner(handle);
+        SparseMatrix tempMat = rri->getUnscaledElasticityMatrixSparse();
+        return createCSRMatrix(&tempMat);
+    catch_ptr_macro
+}
+
+RRCSRMatrixPtr rrcCallConv getScaledElasticityMatrixCSR(RRHandle handle)
+{
+    start_try
+        RoadRunner* rri = castToRoadRunner(handle);
+        SparseMatrix tempMat = rri->getScaledElasticityMatrixSparse();
+        return createCSRMatrix(&tempMat);
+    catch_ptr_macro
+}
+
 bool rrcCallConv getValue(RRHandle handle, const char* symbolId, double *value)
 {
     start_try
@@ -724,6 +811,55 @@ bool rrcCallConv setValue(RRHandle handle, const char* symbolId, const double va
     catch_bool_macro
 }
 
+RRValueHandle rrcCallConv createValueHandle(RRHandle handle, const RRStringArrayPtr ids)
+{
+    start_try
+        RoadRunner* rri = castToRoadRunner(handle);
+
+        if (!ids)
+        {
+            throw Exception("the list of symbols is NULL");
+        }
+
+        vector<string> symbols(ids->String, ids->String + ids->Count);
+        return new ValueHandle(rri->createValueHandle(symbols));
+    catch_ptr_macro
+}
+
+int rrcCallConv getValueHandleSize(RRValueHandle ids)
+{
+    start_try
+        ValueHandle* values = castToValueHandle(ids);
+        return values->size();
+    catch_int_macro
+}
+
+bool rrcCallConv getValues(RRHandle handle, RRValueHandle ids, double* values)
+{
+    start_try
+        RoadRunner* rri = castToRoadRunner(handle);
+        rri->getValues(*castToValueHandle(ids), values);
+        return true;
+    catch_bool_macro
+}
+
+bool rrcCallConv setValues(RRHandle handle, RRValueHandle ids, const double* values)
+{
+    start_try
+        RoadRunner* rri = castToRoadRunner(handle);
+        rri->setValues(*castToValueHandle(ids), values);
+        return true;
+    catch_bool_macro
+}
+
+bool rrcCallConv freeValueHandle(RRValueHandle ids)
+{
+    start_try
+        delete castToValueHandle(ids);
+        return true;
+    catch_bool_macro
+}
+
 RRDoubleMatrixPtr rrcCallConv getStoichiometryMatrix(RRHandle handle)
 {
     start_try
@@ -794,6 +930,33 @@ RRDoubleMatrixPtr rrcCallConv getNrMatrix(RRHandle handle)
     catch_ptr_macro
 }
 
+RRCSRMatrixPtr rrcCallConv getStoichiometryMatrixCSR(RRHandle handle)
+{
+    start_try
+        RoadRunner* rri = castToRoadRunner(handle);
+        SparseMatrix tempMat = rri->getFullStoichiometryMatrixSparse();
+        return createCSRMatrix(&tempMat);
+    catch_ptr_macro
+}
+
+RRCSRMatrixPtr rrcCallConv getLinkMatrixCSR(RRHandle handle)
+{
+    start_try
+        RoadRunner* rri = castToRoadRunner(handle);
+        SparseMatrix tempMat = rri->getLinkMatrixSparse();
+        return createCSRMatrix(&tempMat);
+    catch_ptr_macro
+}
+
+RRCSRMatrixPtr rrcCallConv getConservationMatrixCSR(RRHandle handle)
+{
+    start_try
+        RoadRunner* rri = castToRoadRunner(handle);
+        SparseMatrix tempMat = rri->getConservationMatrixSparse();
+        return createCSRMatrix(&tempMat);
+    catch_ptr_macro
+}
+
 C_DECL_SPEC bool rrcCallConv hasError()
 {
     return (gLastError != NULL) ? true : false;
@@ -1148,6 +1311,109 @@ bool rrcCallConv steadyState(RRHandle handle, double* value)
     catch_bool_macro
 }
 
+RRAsyncHandle rrcCallConv simulateAsync(RRHandle handle)
+{
+    start_try
+        RoadRunner* rri = castToRoadRunner(handle);
+        return rri->simulateAsync();
+    catch_ptr_macro
+}
+
+RRAsyncHandle rrcCallConv steadyStateAsync(RRHandle handle)
+{
+    start_try
+        RoadRunner* rri = castToRoadRunner(handle);
+        return rri->steadyStateAsync();
+    catch_ptr_macro
+}
+
+int rrcCallConv waitAsync(RRAsyncHandle handle, double timeout)
+{
+    start_try
+        SimulateFuture* future = castToSimulateFuture(handle);
+        return future->wait(timeout) ? 1 : 0;
+    catch_int_macro
+}
+
+int rrcCallConv isAsyncDone(RRAsyncHandle handle)
+{
+    start_try
+        SimulateFuture* future = castToSimulateFuture(handle);
+        return future->isDone() ? 1 : 0;
+    catch_int_macro
+}
+
+bool rrcCallConv getAsyncProgress(RRAsyncHandle handle, double* progress)
+{
+    start_try
+        SimulateFuture* future = castToSimulateFuture(handle);
+        *progress = future->getProgress();
+        return true;
+    catch_bool_macro
+}
+
+bool rrcCallConv getAsyncTime(RRAsyncHandle handle, double* time)
+{
+    start_try
+        SimulateFuture* future = castToSimulateFuture(handle);
+        *time = future->getTime();
+        return true;
+    catch_bool_macro
+}
+
+bool rrcCallConv cancelAsync(RRAsyncHandle handle)
+{
+    start_try
+        SimulateFuture* future = castToSimulateFuture(handle);
+        future->cancel();
+        return true;
+    catch_bool_macro
+}
+
+RRCDataPtr rrcCallConv getAsyncSimulationResult(RRAsyncHandle handle)
+{
+    start_try
+        SimulateFuture* future = castToSimulateFuture(handle);
+        future->wait();
+
+        if (future->getError().size())
+        {
+            throw Exception(future->getError());
+        }
+
+        // the result is also the simulation data of the roadrunner, which
+        // has the column names.
+        return createRRCData(*future->getRoadRunner());
+    catch_ptr_macro
+}
+
+bool rrcCallConv getAsyncSteadyStateValue(RRAsyncHandle handle, double* value)
+{
+    start_try
+        SimulateFuture* future = castToSimulateFuture(handle);
+        *value = future->getSteadyStateValue();
+        return true;
+    catch_bool_macro
+}
+
+char* rrcCallConv getAsyncStopReason(RRAsyncHandle handle)
+{
+    start_try
+        SimulateFuture* future = castToSimulateFuture(handle);
+        return rr::createText(SimulateOptions::stopReasonToString(
+                future->getStopReason()));
+    catch_ptr_macro
+}
+
+bool rrcCallConv freeAsync(RRAsyncHandle handle)
+{
+    start_try
+        SimulateFuture* future = castToSimulateFuture(handle);
+        delete future;
+        return true;
+    catch_bool_macro
+}
+
 bool rrcCallConv evalModel(RRHandle handle)
 {
     start_try
@@ -1222,6 +1488,24 @@ RRDoubleMatrixPtr rrcCallConv getReducedJacobian(RRHandle handle)
     catch_ptr_macro
 }
 
+RRCSRMatrixPtr rrcCallConv getFullJacobianCSR(RRHandle handle)
+{
+    start_try
+        RoadRunner* rri = castToRoadRunner(handle);
+        SparseMatrix tempMat = rri->getFullJacobianSparse();
+        return createCSRMatrix(&tempMat);
+    catch_ptr_macro
+}
+
+RRCSRMatrixPtr rrcCallConv getReducedJacobianCSR(RRHandle handle)
+{
+    start_try
+        RoadRunner* rri = castToRoadRunner(handle);
+        SparseMatrix tempMat = rri->getReducedJacobianSparse();
+        return createCSRMatrix(&tempMat);
+    catch_ptr_macro
+}
+
 RRDoubleMatrixPtr rrcCallConv getEigenvalues(RRHandle handle)
 {
     start_try
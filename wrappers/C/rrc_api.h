@@ -173,6 +173,67 @@ C_DECL_SPEC char*  rrcCallConv getCopyright(void);
 */
 C_DECL_SPEC char*  rrcCallConv getInfo(RRHandle handle);
 
+/*!
+ \brief Get the names of the performance counters and timers of the current model
+ \param[in] handle Handle to a RoadRunner instance
+ \return Returns null if it fails, otherwise a list of the counter names
+ \ingroup utility
+*/
+C_DECL_SPEC RRStringArrayPtr rrcCallConv getListOfPerformanceCounters(RRHandle handle);
+
+/*!
+ \brief Get the value of a performance counter or timer of the current model
+
+ Counters describe the last simulation or steady state run, timers are the
+ cumulative time in seconds. The values are only recorded if roadrunner was
+ built with RR_PERF_COUNTERS, the "enabled" counter is 1 if it was.
+ \param[in] handle Handle to a RoadRunner instance
+ \param[in] name The name of the counter, i.e. "integrator_rhs_evals"
+ \param[out] value The value of the counter
+ \return Returns true if successful
+ \ingroup utility
+*/
+C_DECL_SPEC bool rrcCallConv getPerformanceCounter(RRHandle handle, const char* name, double* value);
+
+/*!
+ \brief Clear the performance counters and timers of the current model
+ \param[in] handle Handle to a RoadRunner instance
+ \return Returns true if successful
+ \ingroup utility
+*/
+C_DECL_SPEC bool rrcCallConv resetPerformanceCounters(RRHandle handle);
+
+/*!
+ \brief Get the names of the statistics of the compiled model cache
+ \return Returns null if it fails, otherwise a list of the statistic names
+ \ingroup utility
+*/
+C_DECL_SPEC RRStringArrayPtr rrcCallConv getListOfModelCacheStatistics(void);
+
+/*!
+ \brief Get the value of a statistic of the compiled model cache
+
+ "hits" and "misses" count the models which were found in the cache and the
+ ones which were compiled, "evictions" the models released to stay within the
+ cache size. "models" and "size" are the number and estimated size in bytes
+ of the models the cache keeps, "capacity" is the cache size in bytes, see the
+ LLVM_MODEL_CACHE_SIZE configuration value.
+ \param[in] name The name of the statistic, i.e. "hits"
+ \param[out] value The value of the statistic
+ \return Returns true if successful
+ \ingroup utility
+*/
+C_DECL_SPEC bool rrcCallConv getModelCacheStatistic(const char* name, double* value);
+
+/*!
+ \brief Release all of the models the compiled model cache keeps
+
+ Models in use stay shared, the statistics are not reset.
+ \return Returns true if successful
+ \ingroup utility
+*/
+C_DECL_SPEC bool rrcCallConv clearModelCache(void);
+
  /*!
  \brief Retrieve the current version number of the libSBML library
  \param[in] handle Handle to a RoadRunner instance
@@ -1178,6 +1239,134 @@ C_DECL_SPEC bool rrcCallConv getNumPoints (RRHandle handle, int* numPoints);
 */
 C_DECL_SPEC bool rrcCallConv steadyState(RRHandle handle, double* value);
 
+/*!
+ \brief Start a time-course simulation on a background thread, and return immediately
+
+ The simulation uses the current settings, see simulate. Until it is done the RoadRunner
+ instance must not be used for anything else. Free the returned handle with freeAsync.
+
+ Example:
+ \code
+    RRAsyncHandle job = simulateAsync (rrHandle);
+    double progress;
+    while (waitAsync (job, 0.5) == 0)
+    {
+        getAsyncProgress (job, &progress);
+        printf ("%f\n", progress);
+    }
+    RRCDataPtr m = getAsyncSimulationResult (job);
+    freeAsync (job);
+ \endcode
+
+ \param[in] handle Handle to a RoadRunner instance
+ \return Returns null if the simulation could not be started, otherwise a handle to it
+ \ingroup simulation
+*/
+C_DECL_SPEC RRAsyncHandle rrcCallConv simulateAsync(RRHandle handle);
+
+/*!
+ \brief Compute the steady state on a background thread, and return immediately
+
+ Once the steady state solver has started it can not be cancelled. Free the returned
+ handle with freeAsync.
+
+ \param[in] handle Handle to a RoadRunner instance
+ \return Returns null if the calculation could not be started, otherwise a handle to it
+ \ingroup steadystate
+*/
+C_DECL_SPEC RRAsyncHandle rrcCallConv steadyStateAsync(RRHandle handle);
+
+/*!
+ \brief Wait for an asynchronous run to finish
+
+ \param[in] handle Handle to an asynchronous run
+ \param[in] timeout The maximum time to wait, in seconds, negative waits until it is done
+ \return Returns 1 if the run is done, 0 if the timeout expired and -1 if it fails
+ \ingroup simulation
+*/
+C_DECL_SPEC int rrcCallConv waitAsync(RRAsyncHandle handle, double timeout);
+
+/*!
+ \brief Check if an asynchronous run is done, without waiting
+
+ \param[in] handle Handle to an asynchronous run
+ \return Returns 1 if the run is done, 0 if it is still running and -1 if it fails
+ \ingroup simulation
+*/
+C_DECL_SPEC int rrcCallConv isAsyncDone(RRAsyncHandle handle);
+
+/*!
+ \brief Get the progress of an asynchronous simulation
+
+ \param[in] handle Handle to an asynchronous run
+ \param[out] progress The fraction of the simulation time span which has been integrated
+ \return Returns true if successful
+ \ingroup simulation
+*/
+C_DECL_SPEC bool rrcCallConv getAsyncProgress(RRAsyncHandle handle, double* progress);
+
+/*!
+ \brief Get the model time an asynchronous simulation has reached
+
+ \param[in] handle Handle to an asynchronous run
+ \param[out] time The model time at the last output point
+ \return Returns true if successful
+ \ingroup simulation
+*/
+C_DECL_SPEC bool rrcCallConv getAsyncTime(RRAsyncHandle handle, double* time);
+
+/*!
+ \brief Ask an asynchronous simulation to stop
+
+ It stops at the next internal step of the integrator, or the next output
+ point for integrators which take one step per output point. Returns
+ immediately, the result has the rows up to the last output point.
+
+ \param[in] handle Handle to an asynchronous run
+ \return Returns true if successful
+ \ingroup simulation
+*/
+C_DECL_SPEC bool rrcCallConv cancelAsync(RRAsyncHandle handle);
+
+/*!
+ \brief Get the result of an asynchronous simulation, waits for it to finish
+
+ \param[in] handle Handle to an asynchronous run
+ \return Returns null if the simulation failed, otherwise its result. The client is
+ responsible for freeing the resulting RRCDataPtr structure.
+ \ingroup simulation
+*/
+C_DECL_SPEC RRCDataPtr rrcCallConv getAsyncSimulationResult(RRAsyncHandle handle);
+
+/*!
+ \brief Get the result of an asynchronous steady state calculation, waits for it to finish
+
+ \param[in] handle Handle to an asynchronous run
+ \param[out] value The value steadyState would have returned
+ \return Returns true if successful
+ \ingroup steadystate
+*/
+C_DECL_SPEC bool rrcCallConv getAsyncSteadyStateValue(RRAsyncHandle handle, double* value);
+
+/*!
+ \brief Get why an asynchronous simulation stopped, waits for it to finish
+
+ \param[in] handle Handle to an asynchronous run
+ \return Returns null if it fails, otherwise one of "end_time", "steady_state",
+ "stop_condition", "wall_time", "event_listener" or "cancelled", free it with freeText
+ \ingroup simulation
+*/
+C_DECL_SPEC char* rrcCallConv getAsyncStopReason(RRAsyncHandle handle);
+
+/*!
+ \brief Cancel an asynchronous run, wait for it to stop and free it
+
+ \param[in] handle Handle to an asynchronous run
+ \return Returns true if successful
+ \ingroup freeRoutines
+*/
+C_DECL_SPEC bool rrcCallConv freeAsync(RRAsyncHandle handle);
+
 /*!
  \brief A convenient method for returning a vector of the steady state species concentrations
 
@@ -1254,6 +1443,69 @@ C_DECL_SPEC bool rrcCallConv getValue(RRHandle handle, const char* symbolId, dou
 */
 C_DECL_SPEC bool rrcCallConv setValue(RRHandle handle, const char* symbolId, const double value);
 
+/*!
+ \brief Resolve a list of symbols once, for getting and setting all of their values at once
+
+ The symbols are looked up only here, getValues and setValues then use their indices
+ directly, which is much faster than getValue or setValue for each of them. The
+ handle is only valid for the model which is currently loaded.
+
+ Example:
+ \code
+    RRValueHandle ids = createValueHandle (rrHandle, symbols);
+    double values[2] = {0.5, 2.0};
+    setValues (rrHandle, ids, values);
+    freeValueHandle (ids);
+ \endcode
+
+ \param[in] handle Handle to a RoadRunner instance
+ \param[in] ids The symbols, as accepted by setValue
+ \return Returns null if any of the symbols is invalid, otherwise a handle which must
+ be freed with freeValueHandle
+ \ingroup state
+*/
+C_DECL_SPEC RRValueHandle rrcCallConv createValueHandle(RRHandle handle, const RRStringArrayPtr ids);
+
+/*!
+ \brief Get the number of symbols of a value handle
+
+ \param[in] ids A value handle
+ \return Returns the number of symbols, or -1 if it fails
+ \ingroup state
+*/
+C_DECL_SPEC int rrcCallConv getValueHandleSize(RRValueHandle ids);
+
+/*!
+ \brief Get the current values of all the symbols of a value handle
+
+ \param[in] handle Handle to a RoadRunner instance
+ \param[in] ids A value handle created for the current model
+ \param[out] values An array with room for getValueHandleSize values
+ \return Returns true if successful
+ \ingroup state
+*/
+C_DECL_SPEC bool rrcCallConv getValues(RRHandle handle, RRValueHandle ids, double* values);
+
+/*!
+ \brief Set the values of all the symbols of a value handle
+
+ \param[in] handle Handle to a RoadRunner instance
+ \param[in] ids A value handle created for the current model
+ \param[in] values An array of getValueHandleSize values, in the order of the symbols
+ \return Returns true if successful
+ \ingroup state
+*/
+C_DECL_SPEC bool rrcCallConv setValues(RRHandle handle, RRValueHandle ids, const double* values);
+
+/*!
+ \brief Free a value handle
+
+ \param[in] ids A value handle
+ \return Returns true if successful
+ \ingroup freeRoutines
+*/
+C_DECL_SPEC bool rrcCallConv freeValueHandle(RRValueHandle ids);
+
 
 /*!
  \brief Retrieve in a vector the concentrations for all the floating species
@@ -1464,6 +1716,29 @@ C_DECL_SPEC RRDoubleMatrixPtr rrcCallConv getFullJacobian(RRHandle handle);
 */
 C_DECL_SPEC RRDoubleMatrixPtr rrcCallConv getReducedJacobian(RRHandle handle);
 
+/*!
+ \brief Retrieve the full Jacobian for the current model, in compressed sparse row format
+
+ The matrix is never densified, free it with freeCSRMatrix.
+
+ \param[in] handle Handle to a RoadRunner instance
+ \return Returns null if it fails, otherwise returns the sparse matrix
+ \ingroup Stoich
+*/
+C_DECL_SPEC RRCSRMatrixPtr rrcCallConv getFullJacobianCSR(RRHandle handle);
+
+/*!
+ \brief Retrieve the reduced Jacobian for the current model, in compressed sparse row format
+
+ The matrix is never densified, free it with freeCSRMatrix.
+ Only the structurally non-zero entries are evaluated.
+
+ \param[in] handle Handle to a RoadRunner instance
+ \return Returns null if it fails, otherwise returns the sparse matrix
+ \ingroup Stoich
+*/
+C_DECL_SPEC RRCSRMatrixPtr rrcCallConv getReducedJacobianCSR(RRHandle handle);
+
 /*!
  \brief Retrieve the eigenvalue matrix for the current model
  \param[in] handle Handle to a RoadRunner instance
@@ -1516,6 +1791,39 @@ C_DECL_SPEC RRDoubleMatrixPtr rrcCallConv getNrMatrix(RRHandle handle);
 */
 C_DECL_SPEC RRDoubleMatrixPtr rrcCallConv getConservationMatrix(RRHandle handle);
 
+/*!
+ \brief Retrieve the stoichiometry matrix for the current model, in compressed sparse row format
+
+ The matrix is never densified, free it with freeCSRMatrix.
+
+ \param[in] handle Handle to a RoadRunner instance
+ \return Returns null if it fails, otherwise returns the sparse matrix
+ \ingroup Stoich
+*/
+C_DECL_SPEC RRCSRMatrixPtr rrcCallConv getStoichiometryMatrixCSR(RRHandle handle);
+
+/*!
+ \brief Retrieve the Link matrix for the current model, in compressed sparse row format
+
+ The matrix is never densified, free it with freeCSRMatrix.
+
+ \param[in] handle Handle to a RoadRunner instance
+ \return Returns null if it fails, otherwise returns the sparse matrix
+ \ingroup Stoich
+*/
+C_DECL_SPEC RRCSRMatrixPtr rrcCallConv getLinkMatrixCSR(RRHandle handle);
+
+/*!
+ \brief Retrieve the conservation matrix for the current model, in compressed sparse row format
+
+ The matrix is never densified, free it with freeCSRMatrix.
+
+ \param[in] handle Handle to a RoadRunner instance
+ \return Returns null if it fails, otherwise returns the sparse matrix
+ \ingroup Stoich
+*/
+C_DECL_SPEC RRCSRMatrixPtr rrcCallConv getConservationMatrixCSR(RRHandle handle);
+
 // --------------------------------------------------------------------------------
 // Initial condition Methods
 // --------------------------------------------------------------------------------
@@ -1871,6 +2179,28 @@ C_DECL_SPEC RRDoubleMatrixPtr rrcCallConv getUnscaledElasticityMatrix(RRHandle h
 */
 C_DECL_SPEC RRDoubleMatrixPtr rrcCallConv getScaledElasticityMatrix(RRHandle handle);
 
+/*!
+ \brief Retrieve the unscaled elasticity matrix for the current model, in compressed sparse row format
+
+ The matrix is never densified, free it with freeCSRMatrix.
+
+ \param[in] handle Handle to a RoadRunner instance
+ \return Returns null if it fails, otherwise returns the sparse matrix
+ \ingroup mca
+*/
+C_DECL_SPEC RRCSRMatrixPtr rrcCallConv getUnscaledElasticityMatrixCSR(RRHandle handle);
+
+/*!
+ \brief Retrieve the scaled elasticity matrix for the current model, in compressed sparse row format
+
+ The matrix is never densified, free it with freeCSRMatrix.
+
+ \param[in] handle Handle to a RoadRunner instance
+ \return Returns null if it fails, otherwise returns the sparse matrix
+ \ingroup mca
+*/
+C_DECL_SPEC RRCSRMatrixPtr rrcCallConv getScaledElasticityMatrixCSR(RRHandle handle);
+
 
 /*!
  \brief Retrieve the scaled elasticity matrix for the current model
@@ -9,6 +9,9 @@
 #include "rrc_utilities.h"
 #include "rrStringUtils.h"
 #include "rrRoadRunner.h"
+#include "rrSparseMatrix.h"
+#include "rrSimulateFuture.h"
+#include <algorithm>
 
 namespace rrc
 {
@@ -39,6 +42,34 @@ RoadRunner* castToRoadRunner(RRHandle handle)
     }
 }
 
+SimulateFuture* castToSimulateFuture(RRAsyncHandle handle)
+{
+    SimulateFuture* future = (SimulateFuture*) handle;
+    if(future)
+    {
+        return future;
+    }
+    else
+    {
+        Exception ex("Failed to cast to a valid asynchronous run handle");
+        throw(ex);
+    }
+}
+
+ValueHandle* castToValueHandle(RRValueHandle handle)
+{
+    ValueHandle* values = (ValueHandle*) handle;
+    if(values)
+    {
+        return values;
+    }
+    else
+    {
+        Exception ex("Failed to cast to a valid value handle");
+        throw(ex);
+    }
+}
+
 RRDoubleMatrix* createMatrix(const ls::DoubleMatrix* mat)
 {
     if(!mat)
@@ -91,6 +122,29 @@ DoubleMatrix* createMatrix(const rrc::RRDoubleMatrixPtr mat)
     return matrix;
 }
 
+RRCSRMatrix* createCSRMatrix(const rr::SparseMatrix* mat)
+{
+    if(!mat)
+    {
+        return NULL;
+    }
+
+    RRCSRMatrixPtr matrix = new RRCSRMatrix;
+
+    matrix->RSize = mat->numRows();
+    matrix->CSize = mat->numCols();
+    matrix->NNZ = mat->numNonZeros();
+    matrix->Values = new double[matrix->NNZ];
+    matrix->ColIndices = new int[matrix->NNZ];
+    matrix->RowPointers = new int[matrix->RSize + 1];
+
+    std::copy(mat->getValues().begin(), mat->getValues().end(), matrix->Values);
+    std::copy(mat->getColumnIndices().begin(), mat->getColumnIndices().end(), matrix->ColIndices);
+    std::copy(mat->getRowPointers().begin(), mat->getRowPointers().end(), matrix->RowPointers);
+
+    return matrix;
+}
+
 RRComplexMatrix* createMatrix(const ls::ComplexMatrix* mat)
 {
     if(!mat)
@@ -53,6 +53,9 @@
 namespace rr
 {
 class RoadRunner;
+class SparseMatrix;
+class SimulateFuture;
+class ValueHandle;
 }
 
 //When using the rrc_core_api from C++, the following routines are useful
@@ -77,6 +80,22 @@ C_DECL_SPEC void                        setError(const string& err);
 */
 C_DECL_SPEC rr::RoadRunner*             castToRoadRunner(RRHandle rrHandle);
 
+/*!
+ \brief Cast a handle to an asynchronous run, throws if it fails
+ \param[in] handle  A handle to an asynchronous run
+ \return Pointer to a SimulateFuture
+ \ingroup cpp_support
+*/
+C_DECL_SPEC rr::SimulateFuture*         castToSimulateFuture(RRAsyncHandle handle);
+
+/*!
+ \brief Cast a handle to a value handle, throws if it fails
+ \param[in] handle  A handle to a resolved list of ids
+ \return Pointer to a ValueHandle
+ \ingroup cpp_support
+*/
+C_DECL_SPEC rr::ValueHandle*            castToValueHandle(RRValueHandle handle);
+
 
 /*!
  \brief Copy a C vector to a std::vector
@@ -127,6 +146,15 @@ C_DECL_SPEC RRDoubleMatrixPtr              createMatrix(const ls::DoubleMatrix*
 */
 C_DECL_SPEC ls::DoubleMatrix*                   createMatrix(const RRDoubleMatrixPtr mat);
 
+/*!
+ \brief Creates a C CSR matrix from a rr::SparseMatrix, the arrays are copied as is,
+        the matrix is never densified
+ \param[in] mat  Input SparseMatrix
+ \return A handle to a RRCSRMatrix. Null if it fails
+ \ingroup cpp_support
+*/
+C_DECL_SPEC RRCSRMatrixPtr                 createCSRMatrix(const rr::SparseMatrix* mat);
+
 
 /*!
  \brief Creates a C complex matrix from a ls::ComplexMatrix, supplied as a pointer
@@ -49,6 +49,12 @@ namespace rrc { extern "C" {
 /*!@brief Void pointer to a RoadRunner instance */
 typedef void* RRHandle; /*! Void pointer to a RoadRunner instance */
 
+/*!@brief Void pointer to an asynchronous simulation or steady state calculation */
+typedef void* RRAsyncHandle; /*! Void pointer to an asynchronous run */
+
+/*!@brief Void pointer to a list of ids resolved for getValues and setValues */
+typedef void* RRValueHandle; /*! Void pointer to a resolved list of ids */
+
 
 // ===================================== C TYPES =====================================
 
@@ -78,6 +84,20 @@ typedef struct RRDoubleMatrix
                                                             where i,j represent the row and column numberof the element. Indexing is from zero */
 } *RRDoubleMatrixPtr;                       /*!< Pointer to RRDoubleMatrixPtr struct */
 
+/*!@struct*/
+/*!@brief Structure for a sparse double matrix in compressed sparse row (CSR) format,
+           the same layout as a scipy.sparse.csr_matrix */
+typedef struct RRCSRMatrix
+{
+    int             RSize;                  /*!< The number of rows in the matrix */
+    int             CSize;                  /*!< The number of columns in the matrix */
+    int             NNZ;                    /*!< The number of stored (non-zero) entries */
+    double*         Values;                 /*!< The stored entries, row by row, NNZ items */
+    int*            ColIndices;             /*!< The column index of each stored entry, NNZ items */
+    int*            RowPointers;            /*!< The index in Values of the first entry of each row, RSize + 1 items.
+                                                 The entries of row i are Values[RowPointers[i]] to Values[RowPointers[i+1] - 1] */
+} *RRCSRMatrixPtr;                          /*!< Pointer to RRCSRMatrix struct */
+
 /*!@struct*/
 /*!@brief Structure for a complex number */
 typedef struct RRComplex
@@ -13,6 +13,7 @@
 #include "rrRoadRunner.h"
 #include "rrUtils.h"
 #include "rrException.h"
+#include "rrColumnarData.h"
 
 //---------------------------------------------------------------------------
 // max path stuff
@@ -59,6 +60,64 @@ char* rrcCallConv createTextMemory(const int count)
     return rr::createText(count);
 }
 
+int rrcCallConv writeRRDataBinary(RRHandle handle, const char* fileNameAndPath, int compress)
+{
+    start_try
+        RoadRunner* rri = castToRoadRunner(handle);
+
+        DoubleMatrix& result = const_cast<DoubleMatrix&>(*rri->getSimulationData());
+
+        // the result has the columns of the selections it was simulated
+        // with, which may not be the current ones.
+        vector<string> colNames = result.getColNames();
+        if(colNames.size() != result.CSize())
+        {
+            setError("The simulation result has " + toString((int) result.CSize()) +
+                    " columns, but " + toString((int) colNames.size()) + " column names");
+            return false;
+        }
+
+        ColumnarDataWriter writer(fileNameAndPath, colNames, 4096, compress != 0);
+        writer.writeRows(result.getArray(), result.RSize());
+        writer.close();
+        return true;
+    catch_bool_macro
+}
+
+RRCDataPtr rrcCallConv readRRDataBinary(const char* fileNameAndPath)
+{
+    start_try
+        ColumnarDataReader reader(fileNameAndPath);
+
+        // read before allocating the result, so nothing leaks if it throws.
+        double* data = new double[reader.getNumRows() * reader.getNumCols()];
+        try
+        {
+            reader.readRows(data);
+        }
+        catch(...)
+        {
+            delete[] data;
+            throw;
+        }
+
+        RRCData* rrCData  = new RRCData;
+        memset(rrCData, 0, sizeof(RRCData));
+
+        rrCData->RSize = reader.getNumRows();
+        rrCData->CSize = reader.getNumCols();
+        rrCData->Data = data;
+
+        const vector<string>& names = reader.getColumnNames();
+        rrCData->ColumnHeaders = new char*[names.size()];
+        for(int i = 0; i < names.size(); ++i)
+        {
+            rrCData->ColumnHeaders[i] = rr::createText(names[i]);
+        }
+        return rrCData;
+    catch_ptr_macro
+}
+
 // -------------------------------------------------------------------
 // List Routines
 // -------------------------------------------------------------------
@@ -297,6 +356,20 @@ int rrcCallConv freeMatrix(RRDoubleMatrixPtr matrix)
     catch_bool_macro
 }
 
+int rrcCallConv freeCSRMatrix(RRCSRMatrixPtr matrix)
+{
+    start_try
+        if(matrix)
+        {
+            delete [] (matrix->Values);
+            delete [] (matrix->ColIndices);
+            delete [] (matrix->RowPointers);
+            delete matrix;
+        }
+        return true;
+    catch_bool_macro
+}
+
 int rrcCallConv freeRRCData(RRCDataPtr handle)
 {
     start_try
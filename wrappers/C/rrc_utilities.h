@@ -338,6 +338,12 @@ C_DECL_SPEC int rrcCallConv freeVector(RRVectorPtr vector);
 */
 C_DECL_SPEC int rrcCallConv freeMatrix(RRDoubleMatrixPtr matrix);
 
+/*!
+ \brief Free RRCSRMatrixPtr structures
+ \ingroup freeRoutines
+*/
+C_DECL_SPEC int rrcCallConv freeCSRMatrix(RRCSRMatrixPtr matrix);
+
 // --------------------------------------------------------------------------------
 // Helper Methods
 // --------------------------------------------------------------------------------
@@ -647,6 +653,32 @@ C_DECL_SPEC char* rrcCallConv listToString(const RRListPtr list);
 */
 C_DECL_SPEC int rrcCallConv writeRRData(RRHandle handle, const char* fileNameAndPath);
 
+/*!
+ \brief Writes the current simulation result to file in the binary columnar format
+
+ The binary columnar format is much faster to write and read, and smaller
+ than the text format. Files are read back with readRRDataBinary.
+
+ \param handle Handle to a Roadrunner Instance
+ \param fileNameAndPath Pointer to string holding the file(with path) to write data to
+ \param compress If non zero, the column data is zlib compressed
+ \return Returns a t/f indicating the result
+ \ingroup helperRoutines
+*/
+C_DECL_SPEC int rrcCallConv writeRRDataBinary(RRHandle handle, const char* fileNameAndPath, int compress);
+
+/*!
+ \brief Reads a file written in the binary columnar format
+
+ The file is memory mapped, so reading large files is fast. The caller is
+ responsible for freeing the returned data with freeRRCData.
+
+ \param fileNameAndPath Pointer to string holding the file(with path) to read
+ \return Returns the data, or NULL if the file could not be read
+ \ingroup helperRoutines
+*/
+C_DECL_SPEC RRCDataPtr rrcCallConv readRRDataBinary(const char* fileNameAndPath);
+
 
 ///////////////////////////////////////////////////////////////////////////////////
 // TEST UTILITY functions (to be documented later. Only for internal testing)
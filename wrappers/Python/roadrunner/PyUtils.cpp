@@ -24,6 +24,7 @@
 #include <Dictionary.h>
 #include "rrConfig.h"
 #include "rrRoadRunnerOptions.h"
+#include "rrSparseMatrix.h"
 #include <numpy/arrayobject.h>
 #include "structmember.h"
 
@@ -417,7 +418,65 @@ PyObject* dictionary_contains(const Dictionary* dict, const char* key)
 
 
 static PyObject* NamedArray_New(int nd, npy_intp *dims, double *data, int pyFlags,
-        const ls::DoubleMatrix* mat);
+        const std::vector<std::string>& rowNames,
+        const std::vector<std::string>& colNames);
+
+/**
+ * make a numpy structured array descriptor with a 'f8' field for each name.
+ */
+static PyArray_Descr* structured_descr(const std::vector<std::string>& names)
+{
+    PyObject* list = PyList_New(names.size());
+
+    for(int i = 0; i < names.size(); ++i)
+    {
+        PyObject *col = rrPyString_FromString(names[i].c_str());
+        PyObject *type = rrPyString_FromString("f8");
+        PyObject *tup = PyTuple_Pack(2, col, type);
+
+        Py_DECREF(col);
+        Py_DECREF(type);
+
+        // list takes ownershipt of tuple
+        void PyList_SET_ITEM(list, i, tup);
+    }
+
+    PyArray_Descr* descr = 0;
+    PyArray_DescrConverter(list, &descr);
+
+    // done with list
+    Py_CLEAR(list);
+
+    return descr;
+}
+
+PyObject* doublematrix_alloc_py(int rows, const std::vector<std::string>& colNames,
+        bool structured_result)
+{
+    PyObject *pArray = NULL;
+
+    if (structured_result) {
+        npy_intp dims[] = {rows};
+
+        // steals a reference to descr
+        pArray = PyArray_SimpleNewFromDescr(1, dims, structured_descr(colNames));
+    }
+    else {
+        // passing a NULL for data tells numpy to allocate its own data
+        int nd = 2;
+        npy_intp dims[2] = {rows, (npy_intp)colNames.size()};
+        pArray = NamedArray_New(nd, dims, NULL, 0,
+                std::vector<std::string>(), colNames);
+    }
+
+    if (pArray) {
+        VERIFY_PYARRAY(pArray);
+        assert(PyArray_NBYTES(pArray) == rows*colNames.size()*sizeof(double)
+                && "invalid array size");
+    }
+
+    return pArray;
+}
 
 
 PyObject* doublematrix_to_py(const ls::DoubleMatrix* m, bool structured_result, bool copy_result)
@@ -457,26 +516,7 @@ PyObject* doublematrix_to_py(const ls::DoubleMatrix* m, bool structured_result,
 
         double* mData = mat->getArray();
 
-        PyObject* list = PyList_New(names.size());
-
-        for(int i = 0; i < names.size(); ++i)
-        {
-            PyObject *col = rrPyString_FromString(names[i].c_str());
-            PyObject *type = rrPyString_FromString("f8");
-            PyObject *tup = PyTuple_Pack(2, col, type);
-
-            Py_DECREF(col);
-            Py_DECREF(type);
-
-            // list takes ownershipt of tuple
-            void PyList_SET_ITEM(list, i, tup);
-        }
-
-        PyArray_Descr* descr = 0;
-        PyArray_DescrConverter(list, &descr);
-
-        // done with list
-        Py_CLEAR(list);
+        PyArray_Descr* descr = structured_descr(names);
         npy_intp dims[] = {rows};
 
         // steals a reference to descr
@@ -519,7 +559,7 @@ PyObject* doublematrix_to_py(const ls::DoubleMatrix* m, bool structured_result,
                 int nd = 2;
                 npy_intp dims[2] = {rows, cols};
                 pArray = NamedArray_New(nd, dims, NULL,
-                                     0, mat);
+                                     0, mat->getRowNames(), mat->getColNames());
             }
 
             VERIFY_PYARRAY(pArray);
@@ -545,7 +585,7 @@ PyObject* doublematrix_to_py(const ls::DoubleMatrix* m, bool structured_result,
                 int nd = 2;
                 npy_intp dims[2] = {rows, cols};
                 pArray = NamedArray_New(nd, dims, data,
-                        NPY_CARRAY, mat);
+                        NPY_CARRAY, mat->getRowNames(), mat->getColNames());
             }
 
             VERIFY_PYARRAY(pArray);
@@ -555,6 +595,75 @@ PyObject* doublematrix_to_py(const ls::DoubleMatrix* m, bool structured_result,
     }
 }
 
+typedef cxx11_ns::shared_ptr<const ls::DoubleMatrix> SharedDoubleMatrix;
+
+static void shared_doublematrix_free(PyObject* capsule)
+{
+    delete static_cast<SharedDoubleMatrix*>(PyCapsule_GetPointer(capsule, NULL));
+}
+
+PyObject* doublematrix_share_py(const SharedDoubleMatrix& m, bool structured_result)
+{
+    ls::DoubleMatrix *mat = const_cast<ls::DoubleMatrix*>(m.get());
+
+    int rows = mat->numRows();
+    int cols = mat->numCols();
+    double *data = mat->getArray();
+    PyObject *pArray = NULL;
+
+    if (structured_result) {
+        std::vector<string> names = mat->getColNames();
+
+        if (cols == 0) {
+            Py_RETURN_NONE;
+        }
+
+        if (cols != names.size()) {
+            throw std::logic_error("column names size does not match matrix columns size");
+        }
+
+        // a record per row has the same layout as the rows of the matrix,
+        // steals a reference to descr
+        npy_intp dims[] = {rows};
+        pArray = PyArray_NewFromDescr(&PyArray_Type, structured_descr(names),
+                1, dims, NULL, data, NPY_CARRAY, NULL);
+    }
+    else if(cols == 1 && mat->getColNames().size() == 0) {
+        npy_intp dims[1] = {rows};
+        pArray = PyArray_New(&PyArray_Type, 1, dims, NPY_DOUBLE,
+                NULL, data, 0, NPY_CARRAY, NULL);
+    }
+    else {
+        npy_intp dims[2] = {rows, cols};
+        pArray = NamedArray_New(2, dims, data,
+                NPY_CARRAY, mat->getRowNames(), mat->getColNames());
+    }
+
+    if (!pArray) {
+        return NULL;
+    }
+
+    VERIFY_PYARRAY(pArray);
+
+    // the array holds a reference to the matrix, which keeps the data alive
+    SharedDoubleMatrix *ref = new SharedDoubleMatrix(m);
+    PyObject *capsule = PyCapsule_New(ref, NULL, shared_doublematrix_free);
+
+    if (!capsule) {
+        delete ref;
+        Py_DECREF(pArray);
+        return NULL;
+    }
+
+    // steals the capsule reference, even if it fails
+    if (PyArray_SetBaseObject((PyArrayObject*)pArray, capsule) < 0) {
+        Py_DECREF(pArray);
+        return NULL;
+    }
+
+    return pArray;
+}
+
 
 struct NamedArrayObject {
     PyArrayObject array;
@@ -870,7 +979,8 @@ PyArray_New(PyTypeObject *subtype, int nd, npy_intp *dims, int type_num,
                                      NPY_CARRAY | NPY_OWNDATA, NULL);
  */
 PyObject* NamedArray_New(int nd, npy_intp *dims, double *data, int pyFlags,
-        const ls::DoubleMatrix* mat)
+        const std::vector<std::string>& rowNames,
+        const std::vector<std::string>& colNames)
 {
     bool named = Config::getValue(Config::PYTHON_ENABLE_NAMED_MATRIX);
 
@@ -888,8 +998,8 @@ PyObject* NamedArray_New(int nd, npy_intp *dims, double *data, int pyFlags,
             return NULL;
         }
 
-        array->rowNames = stringvector_to_py(mat->getRowNames());
-        array->colNames = stringvector_to_py(mat->getColNames());
+        array->rowNames = stringvector_to_py(rowNames);
+        array->colNames = stringvector_to_py(colNames);
         array->test1 = 1;
         array->test2 = 2;
         array->test3 = 3;
@@ -902,6 +1012,64 @@ PyObject* NamedArray_New(int nd, npy_intp *dims, double *data, int pyFlags,
     }
 }
 
+template <typename T>
+static PyObject* vector_to_py(const std::vector<T>& vec, int typenum)
+{
+    npy_intp dims[1] = {(npy_intp)vec.size()};
+    PyObject *array = PyArray_SimpleNew(1, dims, typenum);
+    VERIFY_PYARRAY(array);
+
+    if (array && vec.size()) {
+        memcpy(PyArray_DATA((PyArrayObject*)array), &vec[0], vec.size()*sizeof(T));
+    }
+    return array;
+}
+
+PyObject* sparsematrix_to_py(const SparseMatrix* mat)
+{
+    PyObject *data = vector_to_py(mat->getValues(), NPY_DOUBLE);
+    PyObject *indices = vector_to_py(mat->getColumnIndices(), NPY_INT32);
+    PyObject *indptr = vector_to_py(mat->getRowPointers(), NPY_INT32);
+    PyObject *shape = Py_BuildValue("(ii)", mat->numRows(), mat->numCols());
+
+    if (!data || !indices || !indptr || !shape) {
+        Py_XDECREF(data);
+        Py_XDECREF(indices);
+        Py_XDECREF(indptr);
+        Py_XDECREF(shape);
+        return NULL;
+    }
+
+    PyObject *sparse = PyImport_ImportModule("scipy.sparse");
+
+    if (!sparse) {
+        Log(Logger::LOG_DEBUG) << "scipy.sparse not available, returning "
+                "(data, indices, indptr, shape) tuple";
+        PyErr_Clear();
+        // steals the references
+        return Py_BuildValue("(NNNN)", data, indices, indptr, shape);
+    }
+
+    PyObject *result = PyObject_CallMethod(sparse, (char*)"csr_matrix",
+            (char*)"((NNN)N)", data, indices, indptr, shape);
+    Py_DECREF(sparse);
+
+    if (result) {
+        PyObject *rowNames = stringvector_to_py(mat->getRowNames());
+        PyObject *colNames = stringvector_to_py(mat->getColNames());
+
+        if (PyObject_SetAttrString(result, "rownames", rowNames) != 0 ||
+                PyObject_SetAttrString(result, "colnames", colNames) != 0) {
+            PyErr_Clear();
+        }
+
+        Py_DECREF(rowNames);
+        Py_DECREF(colNames);
+    }
+
+    return result;
+}
+
 PyObject* stringvector_to_py(const std::vector<std::string>& vec)
 {
     unsigned size = vec.size();
@@ -12,6 +12,7 @@
 #define PYUTILS_H_
 
 #include "Variant.h"
+#include "tr1proxy/rr_memory.h"
 #include <Python.h>
 #include <lsMatrix.h>
 #include <stdint.h>
@@ -85,6 +86,42 @@ PyObject *dictionary_contains(const Dictionary* dict, const char* key);
 
 PyObject *doublematrix_to_py(const ls::DoubleMatrix* mat, bool structured_result, bool copy_result);
 
+/**
+ * a numpy array of a shared matrix, without a copy. The array holds a
+ * reference to the matrix, so the data stays valid for as long as the
+ * array, or any view of it, lives.
+ *
+ * @param structured_result: if true, a 1-D structured array with a field
+ *        for each column, otherwise a 2-D array.
+ */
+PyObject *doublematrix_share_py(const cxx11_ns::shared_ptr<const ls::DoubleMatrix>& mat,
+        bool structured_result);
+
+/**
+ * allocate a new, python owned, uninitialized numpy array for rows of
+ * simulation results, so results can be written straight into it.
+ *
+ * @param rows: number of rows
+ * @param colNames: the column names, also determines number of columns.
+ * @param structured_result: if true, a 1-D structured array with a field
+ *        for each column is returned, otherwise a 2-D array. Both have the
+ *        same C ordered memory layout.
+ */
+PyObject *doublematrix_alloc_py(int rows, const std::vector<std::string>& colNames,
+        bool structured_result);
+
+class SparseMatrix;
+
+/**
+ * convert a sparse matrix to a scipy.sparse.csr_matrix, the data, indices
+ * and indptr arrays are copied as is, the matrix is never densified. The
+ * row and column names are set as the rownames and colnames attributes.
+ *
+ * If scipy is not available, a (data, indices, indptr, shape) tuple is
+ * returned, which is the argument scipy.sparse.csr_matrix takes.
+ */
+PyObject *sparsematrix_to_py(const SparseMatrix* mat);
+
 PyObject *stringvector_to_py(const std::vector<std::string>& vec);
 
 std::vector<std::string> py_to_stringvector(PyObject *obj);
@@ -93,6 +130,28 @@ Dictionary *Dictionary_from_py(PyObject *py);
 
 void pyutil_init(PyObject *module);
 
+/**
+ * @brief Releases the GIL for the lifetime of the object
+ * @details For the %extend methods which build python objects, so
+ * are compiled with the GIL held, but spend most of their time in
+ * native code, i.e. simulating into a numpy array. No Python API
+ * may be called while one of these is alive. The GIL is re-acquired
+ * when it goes out of scope, including when an exception is thrown.
+ */
+class PyAllowThreads
+{
+public:
+    PyAllowThreads() : state(PyEval_SaveThread()) {}
+
+    ~PyAllowThreads() { PyEval_RestoreThread(state); }
+
+private:
+    PyThreadState *state;
+
+    PyAllowThreads(const PyAllowThreads&);
+    PyAllowThreads& operator=(const PyAllowThreads&);
+};
+
 
 
 } /* namespace rr */
@@ -4,8 +4,12 @@
         "threads"=1 /*, directors="1"*/) roadrunner
 
 // most methods should leave the GIL locked, no point to extra overhead
-// for fast methods. Only Roadrunner with long methods like simulate
-// and load release the GIL.
+// for fast methods. The RoadRunner methods, which include the long ones
+// like load, simulate, steadyState and the MCA matrices, release the GIL,
+// so Python threads each driving their own RoadRunner run in parallel.
+// The %extend methods which build Python objects hold the GIL, and release
+// it around the native calls with a PyAllowThreads. Python callbacks from
+// native code, i.e. the integrator and event listeners, re-acquire it.
 %nothread;
 
 //%feature("director") PyEventListener;
@@ -36,6 +40,11 @@
     #include <rrExecutableModel.h>
     #include <rrRoadRunnerOptions.h>
     #include <rrRoadRunner.h>
+    #include <rrColumnarData.h>
+    #include <rrSteadyStateSearch.h>
+    #include <rrParameterEstimation.h>
+    #include <rrSimulateFuture.h>
+    #include <rrValueHandle.h>
     #include <SteadyStateSolver.h>
     #include <rrLogger.h>
     #include <rrConfig.h>
@@ -186,6 +195,17 @@
 
 %apply const ls::DoubleMatrix* {ls::DoubleMatrix*, DoubleMatrix*, const DoubleMatrix* };
 
+/**
+ * Convert from C --> Python
+ * a scipy.sparse.csr_matrix, the sparse arrays are copied, never densified.
+ */
+%typemap(out) rr::SparseMatrix {
+    // %typemap(out) rr::SparseMatrix
+    $result = sparsematrix_to_py(&($1));
+}
+
+%apply rr::SparseMatrix {SparseMatrix};
+
 
 
 /* Convert from C --> Python */
@@ -211,6 +231,36 @@
     $result  = array;
 }
 
+/*
+ * Convert from Python --> C, any sequence of numbers. Only applied to the
+ * arguments which are listed with %apply, the other vector arguments are
+ * not wrapped.
+ */
+%typemap(in) const std::vector<double>& DOUBLE_SEQUENCE (std::vector<double> temp) {
+
+    PyObject* seq = PySequence_Fast($input, "expected a sequence of numbers");
+    if (!seq) {
+        SWIG_fail;
+    }
+
+    Py_ssize_t len = PySequence_Fast_GET_SIZE(seq);
+    temp.resize(len);
+    for (Py_ssize_t i = 0; i < len; ++i) {
+        temp[i] = PyFloat_AsDouble(PySequence_Fast_GET_ITEM(seq, i));
+    }
+    Py_DECREF(seq);
+
+    if (PyErr_Occurred()) {
+        SWIG_fail;
+    }
+
+    $1 = &temp;
+}
+
+%typemap(typecheck) const std::vector<double>& DOUBLE_SEQUENCE {
+    $1 = PySequence_Check($input) ? 1 : 0;
+}
+
 
 /* Convert from C --> Python */
 %typemap(out) std::vector<ls::Complex> {
@@ -721,6 +771,7 @@ PyObject *Integrator_NewPythonObj(rr::Integrator* i) {
 %ignore rr::lUser;
 
 
+%ignore rr::ExecutableModel::getSparseStoichiometryMatrix;
 %ignore rr::ExecutableModel::getFloatingSpeciesAmounts(int, int const*, double *);
 %ignore rr::ExecutableModel::setFloatingSpeciesAmounts(int len, int const *indx, const double *values);
 %ignore rr::ExecutableModel::getFloatingSpeciesAmountRates(int, int const*, double *);
@@ -798,6 +849,7 @@ PyObject *Integrator_NewPythonObj(rr::Integrator* i) {
 // map the events to python using the PyEventListener class
 %ignore rr::ExecutableModel::setEventListener(int, rr::EventListenerPtr);
 %ignore rr::ExecutableModel::getEventListener(int);
+%ignore rr::ExecutableModel::getPerfCounters;
 %ignore rr::EventListenerPtr;
 %ignore rr::EventListenerException;
 
@@ -811,6 +863,11 @@ PyObject *Integrator_NewPythonObj(rr::Integrator* i) {
 %ignore rr::Integrator::setListener(rr::IntegratorListenerPtr);
 %ignore rr::Integrator::getListener();
 
+// the interrupt is set by simulate for cancellation and max_wall_time
+%ignore rr::IntegratorInterrupt;
+%ignore rr::IntegratorInterruptedException;
+%ignore rr::Integrator::setInterrupt;
+
 //%ignore rr::Integrator::addIntegratorListener;
 //%ignore rr::Integrator::removeIntegratorListener;
 
@@ -858,10 +915,39 @@ namespace std { class ostream{}; }
 %include <rrRoadRunnerOptions.h>
 %include <rrLogger.h>
 %include <rrCompiler.h>
+// only the ids and the size of a value handle are of interest in python.
+%ignore rr::ValueHandle::ValueHandle(const ExecutableModel*);
+%ignore rr::ValueHandle::Group;
+%ignore rr::ValueHandle::add;
+%ignore rr::ValueHandle::getGroups;
+%ignore rr::ValueHandle::hasType;
+%ignore rr::ValueHandle::getModel;
+%ignore rr::ValueHandle::getModelSerial;
+%include <rrValueHandle.h>
+
+// raw pointer versions, replaced with numpy versions in the extensions.
+%ignore rr::ExecutableModel::getIndexedValues;
+%ignore rr::ExecutableModel::setIndexedValues;
+%ignore rr::RoadRunner::getValues(const rr::ValueHandle&, double*);
+%ignore rr::RoadRunner::setValues(const rr::ValueHandle&, const double*);
+%ignore rr::RoadRunner::setValues(const rr::ValueHandle&, const std::vector<double>&);
+%ignore rr::RoadRunner::getSharedSimulationData;
+
 %include <rrExecutableModel.h>
 %include <ExecutableModelFactory.h>
 %include <rrVersionInfo.h>
 
+// the caller owns the asynchronous runs, which refer to the RoadRunner, so
+// keep it alive for as long as they are.
+%newobject rr::RoadRunner::simulateAsync;
+%newobject rr::RoadRunner::steadyStateAsync;
+%pythonappend rr::RoadRunner::simulateAsync %{
+    val._roadrunner = self
+%}
+%pythonappend rr::RoadRunner::steadyStateAsync %{
+    val._roadrunner = self
+%}
+
 %thread;
 %include <rrRoadRunner.h>
 %nothread;
@@ -878,6 +964,37 @@ namespace std { class ostream{}; }
 %include <SBMLValidator.h>
 %include <rrSBMLReader.h>
 
+// raw buffer access is replaced with numpy versions in the extensions.
+%ignore rr::ColumnarFileHeader;
+%ignore rr::ColumnarChunkHeader;
+%ignore rr::ColumnarFileFooter;
+%ignore rr::ColumnarDataWriter::writeRow;
+%ignore rr::ColumnarDataWriter::writeRows;
+%ignore rr::ColumnarDataReader::getChunkColumn;
+%ignore rr::ColumnarDataReader::readColumn;
+%ignore rr::ColumnarDataReader::readRows;
+%include <rrColumnarData.h>
+
+%ignore rr::SteadyStateSearch::Solution;
+%thread;
+%include <rrSteadyStateSearch.h>
+%nothread;
+
+// experiments are added from files, there is no input map for matrices.
+%ignore rr::ParameterEstimation::addExperiment(const ls::DoubleMatrix&,
+        const ls::DoubleMatrix*, const std::vector<std::string>&,
+        const std::vector<double>&);
+%apply const std::vector<double>& DOUBLE_SEQUENCE { const std::vector<double>& initialValues };
+%thread;
+%include <rrParameterEstimation.h>
+%nothread;
+%clear const std::vector<double>& initialValues;
+
+%ignore rr::SimulateFuture::getRoadRunner;
+%thread;
+%include <rrSimulateFuture.h>
+%nothread;
+
 
 %extend rr::RoadRunner
 {
@@ -901,10 +1018,64 @@ namespace std { class ostream{}; }
     }
 
     PyObject* _simulate(const rr::SimulateOptions* opt) {
+
         // its not const correct...
-        ls::DoubleMatrix *result = const_cast<ls::DoubleMatrix*>($self->simulate(opt));
+        ls::DoubleMatrix *result = 0;
+        {
+            rr::PyAllowThreads allow;
+            result = const_cast<ls::DoubleMatrix*>($self->simulate(opt));
+        }
 
-        return doublematrix_to_py(result, opt->structured_result, opt->copy_result);
+        if (!opt->copy_result && !opt->structured_result) {
+            return doublematrix_to_py(result, false, false);
+        }
+
+        // hand the result to numpy without a copy, the next simulation
+        // writes to a new matrix while the array holds on to this one.
+        return doublematrix_share_py($self->getSharedSimulationData(),
+                opt->structured_result);
+    }
+
+    /**
+     * simulate into an existing, C contiguous float64 array. The array must
+     * have a row for each output point, and a column for each selection,
+     * it may be a view into a larger array, i.e. one slice of a 3-D array.
+     *
+     * returns the number of rows written.
+     */
+    int _simulateInto(const rr::SimulateOptions* opt, PyObject* out) {
+
+        if (!PyArray_Check(out)) {
+            throw std::invalid_argument("simulate output must be a numpy array");
+        }
+
+        PyArrayObject *array = (PyArrayObject*)out;
+
+        if (PyArray_TYPE(array) != NPY_DOUBLE || !PyArray_ISCARRAY(array)
+                || PyArray_NDIM(array) != 2) {
+            throw std::invalid_argument("simulate output must be a writable, "
+                    "C contiguous, 2 dimensional float64 array");
+        }
+
+        // the caller holds a reference to out for the duration.
+        double *data = (double*)PyArray_DATA(array);
+        int rows = PyArray_DIM(array, 0);
+        int cols = PyArray_DIM(array, 1);
+
+        rr::PyAllowThreads allow;
+        return $self->simulate(opt, data, rows, cols);
+    }
+
+    /**
+     * set the values of a value handle from any array like object.
+     */
+    void setValues(const rr::ValueHandle& handle, int len, double const *values) {
+        if (len != handle.size()) {
+            std::stringstream ss;
+            ss << "expected " << handle.size() << " values, but got " << len;
+            throw std::invalid_argument(ss.str());
+        }
+        $self->setValues(handle, values);
     }
 
     double getValue(const rr::SelectionRecord* pRecord) {
@@ -1114,7 +1285,9 @@ namespace std { class ostream{}; }
             """
             return self.values(types).__iter__()
 
-        def simulate(self, start=None, end=None, points=None, selections=None, steps=None):
+        def simulate(self, start=None, end=None, points=None, selections=None, steps=None, out=None,
+                     steadyStateTolerance=None, steadyStateWindow=None, stopCondition=None,
+                     maxWallTime=None):
             '''
             Simulate the current SBML model.
 
@@ -1139,6 +1312,37 @@ namespace std { class ostream{}; }
             proper timecourse selections as in timeCourseSelections.
             The fifth argument, if supplied via keyword, is the number of intervals, not the
             number of points. Specifying intervals and points is an error.
+
+            If out is supplied via keyword, it must be a C contiguous float64 numpy array
+            with a row for each output point and a column for each selection, such as
+            one slice of a preallocated 3-D array. The results are written directly into
+            it, and a view of the rows that were written is returned. The results are
+            then only in out, getSimulationData still returns the previous simulation.
+
+            Without out, the returned array is the simulation result itself, handed to
+            numpy without a copy, so it shares its data with getSimulationData. The next
+            simulation writes to new memory while the array is alive, so it stays valid
+            and unchanged.
+
+            The simulation may also stop early, the result then ends at the point where
+            it stopped, these keyword arguments only apply to this simulation:
+
+            steadyStateTolerance
+                Stop the simulation once the norm of the rates of change of the state
+                vector is below this value. Zero (the default) runs to the end time.
+
+            steadyStateWindow
+                The length of simulation time the steadyStateTolerance must hold for
+                before the simulation stops, zero by default.
+
+            stopCondition
+                Stop the simulation when a condition such as "S1 > 10" or "[S1] <= [S2]"
+                becomes true. The operators are <, <=, > and >=.
+
+            maxWallTime
+                Stop the simulation after this many seconds.
+
+            Use getSimulateStopReason to find out why a simulation stopped.
             '''
 
             # check for errors
@@ -1174,6 +1378,16 @@ namespace std { class ostream{}; }
             o = self.__simulateOptions
             originalSteps = o.steps
 
+            stops = {"steady_state_tolerance" : steadyStateTolerance,
+                     "steady_state_window" : steadyStateWindow,
+                     "stop_condition" : stopCondition,
+                     "max_wall_time" : maxWallTime}
+            originalStops = {}
+            for attr, v in stops.items():
+                if v is not None:
+                    originalStops[attr] = getattr(o, attr)
+                    setattr(o, attr, v)
+
             if self.getIntegrator().hasValue('variable_step_size'):
                 if self.getIntegrator().getValue('variable_step_size') == True:
                     o.steps = 0
@@ -1193,11 +1407,15 @@ namespace std { class ostream{}; }
             if steps is not None:
                 o.steps = steps
 
-            result = self._simulate(o)
-
-            o.steps = originalSteps
+            try:
+                if out is not None:
+                    return out[:self._simulateInto(o, out)]
 
-            return result
+                return self._simulate(o)
+            finally:
+                o.steps = originalSteps
+                for attr, v in originalStops.items():
+                    setattr(o, attr, v)
 
         def __simulateOld(self, *args, **kwargs):
             """
@@ -1809,6 +2027,36 @@ namespace std { class ostream{}; }
 %extend rr::ExecutableModel
 {
 
+    /**
+     * the values of a value handle, as a new array.
+     */
+    PyObject *getIndexedValues(const rr::ValueHandle& handle) {
+        npy_intp dims[1] = {(npy_intp)handle.size()};
+        PyObject *array = PyArray_SimpleNew(1, dims, NPY_DOUBLE);
+
+        if (!array) {
+            return NULL;
+        }
+
+        try {
+            $self->getIndexedValues(handle, (double*)PyArray_DATA((PyArrayObject*)array));
+        } catch (...) {
+            Py_DECREF(array);
+            throw;
+        }
+
+        return array;
+    }
+
+    void setIndexedValues(const rr::ValueHandle& handle, int len, double const *values) {
+        if (len != handle.size()) {
+            std::stringstream ss;
+            ss << "expected " << handle.size() << " values, but got " << len;
+            throw std::invalid_argument(ss.str());
+        }
+        $self->setIndexedValues(handle, values);
+    }
+
     /**
      * creates a function signature of
      * SWIGINTERN PyObject *rr_ExecutableModel_getIds(rr::ExecutableModel *self,int types);
@@ -2506,6 +2754,129 @@ namespace std { class ostream{}; }
     %}
 }
 
+%extend rr::ColumnarDataWriter {
+
+    /**
+     * write a 2-D float64 array, must have a column for each column
+     * name.
+     */
+    void writeArray(PyObject* obj) {
+        PyArrayObject *array = (PyArrayObject*)PyArray_FromAny(obj,
+                PyArray_DescrFromType(NPY_DOUBLE), 2, 2,
+                NPY_CARRAY_RO, NULL);
+
+        if (!array) {
+            throw std::invalid_argument("could not convert argument to a "
+                    "2 dimensional float64 array");
+        }
+
+        try {
+            $self->writeRows((const double*)PyArray_DATA(array),
+                    PyArray_DIM(array, 0));
+        } catch (...) {
+            Py_DECREF(array);
+            throw;
+        }
+        Py_DECREF(array);
+    }
+}
+
+%extend rr::ColumnarDataReader {
+
+    /**
+     * read all of the data into a new array, structured if requested.
+     */
+    PyObject *toArray(bool structured_result = false) {
+        PyObject *array = doublematrix_alloc_py($self->getNumRows(),
+                $self->getColumnNames(), structured_result);
+
+        if (array) {
+            $self->readRows((double*)PyArray_DATA((PyArrayObject*)array));
+        }
+        return array;
+    }
+
+    /**
+     * read a single column, by index or name, into a new 1-D array.
+     */
+    PyObject *getColumn(PyObject *col) {
+        long index;
+# if PY_MAJOR_VERSION == 3
+        if (PyUnicode_Check(col)) {
+# else
+        if (PyString_Check(col)) {
+# endif
+            std::string name = rrPyString_getCPPString(col);
+            index = $self->getColumnIndex(name);
+            if (index < 0) {
+                throw std::invalid_argument("no column named " + name);
+            }
+        } else {
+            index = PyLong_AsLong(col);
+            if (PyErr_Occurred()) {
+                PyErr_Clear();
+                throw std::invalid_argument("column must be a name or an "
+                        "integer index");
+            }
+            if (index < 0 || index >= $self->getNumCols()) {
+                throw std::out_of_range("column index out of range");
+            }
+        }
+
+        npy_intp dims[1] = {(npy_intp)$self->getNumRows()};
+        PyObject *array = PyArray_SimpleNew(1, dims, NPY_DOUBLE);
+
+        if (array) {
+            $self->readColumn(index, (double*)PyArray_DATA((PyArrayObject*)array));
+        }
+        return array;
+    }
+
+    /**
+     * a read only 1-D view of a column of a chunk, in place in the mapped
+     * file. The view holds a reference to owner, the python reader object,
+     * so the mapping outlives it.
+     */
+    PyObject *_getChunkColumn(unsigned chunk, unsigned col, PyObject *owner) {
+        const double *data = $self->getChunkColumn(chunk, col);
+
+        npy_intp dims[1] = {(npy_intp)$self->getChunkRows(chunk)};
+        PyObject *array = PyArray_New(&PyArray_Type, 1, dims, NPY_DOUBLE, NULL,
+                (void*)data, 0, NPY_CARRAY_RO, NULL);
+
+        if (!array) {
+            return NULL;
+        }
+
+        // steals the reference
+        Py_INCREF(owner);
+        if (PyArray_SetBaseObject((PyArrayObject*)array, owner) < 0) {
+            Py_DECREF(array);
+            return NULL;
+        }
+
+        return array;
+    }
+
+    %pythoncode %{
+        def getChunkColumn(self, chunk, col):
+            """
+            A read only view of a column, by index or name, of a chunk. The
+            data is not copied, the view points into the memory mapped file
+            and keeps this reader open. Only available for uncompressed files.
+            """
+            import operator
+            try:
+                index = operator.index(col)
+            except TypeError:
+                index = self.getColumnIndex(col)
+                if index < 0:
+                    raise KeyError('no column named ' + str(col))
+
+            return self._getChunkColumn(chunk, index, self)
+    %}
+}
+
 %extend rr::Logger {
     static void enablePythonLogging() {
         PyLoggerStream::enablePythonLogging();
@@ -2677,4 +3048,18 @@ RoadRunner.ensureSolversRegistered()
 integrators = list(RoadRunner.getRegisteredIntegratorNames())
 steadyStateSolvers = list(RoadRunner.getRegisteredSteadyStateSolverNames())
 solvers = integrators + steadyStateSolvers
+
+def getModelCacheStatistics():
+    """
+    Statistics of the compiled model cache as a dict, see
+    ExecutableModelFactory.getModelCacheStatistics.
+    """
+    return dict(ExecutableModelFactory.getModelCacheStatistics().items())
+
+def clearModelCache():
+    """
+    Release all of the compiled models the cache keeps, see
+    ExecutableModelFactory.clearModelCache.
+    """
+    ExecutableModelFactory.clearModelCache()
 %}
@@ -716,6 +716,64 @@ return info about the current state of the object
 
 
 
+%feature("docstring") rr::RoadRunner::getPerformanceCounters "
+RoadRunner.getPerformanceCounters()
+
+Performance counters and timers of the current model. Counters such as
+``integrator_rhs_evals``, ``integrator_jacobian_evals``,
+``state_vector_rate_evals``, ``event_applications`` or
+``steady_state_iterations`` describe the last simulate or steadyState run.
+Timers, the keys ending in ``_time``, are in seconds and accumulate over all
+runs since the model was loaded, including the load phases.
+
+Values are only recorded if libRoadRunner was built with RR_PERF_COUNTERS,
+the ``enabled`` item tells if it was. ::
+
+   >>> r.simulate(0, 100, 100)
+   >>> c = r.getPerformanceCounters()
+   >>> c['integrator_rhs_evals'], c['selection_time']
+
+:rtype: Dictionary
+";
+
+
+
+%feature("docstring") rr::RoadRunner::resetPerformanceCounters "
+RoadRunner.resetPerformanceCounters()
+
+Clear the performance counters and timers of the current model.
+";
+
+
+
+%feature("docstring") rr::ExecutableModelFactory::getModelCacheStatistics "
+ExecutableModelFactory.getModelCacheStatistics()
+
+Statistics of the compiled model cache, see Config.LLVM_MODEL_CACHE_SIZE.
+``hits`` and ``misses`` count the models which were found in the cache and
+the ones which were compiled, ``evictions`` the models released to stay
+within the cache size. ``models`` and ``size`` are the number and estimated
+size in bytes of the models the cache keeps, ``capacity`` is the cache size
+in bytes. The module function ``roadrunner.getModelCacheStatistics()``
+returns the same items as a dict. ::
+
+   >>> s = roadrunner.getModelCacheStatistics()
+   >>> s['hits'], s['misses']
+
+:rtype: Dictionary
+";
+
+
+
+%feature("docstring") rr::ExecutableModelFactory::clearModelCache "
+ExecutableModelFactory.clearModelCache()
+
+Release all of the models the compiled model cache keeps, models in use
+stay shared. The statistics are not reset.
+";
+
+
+
 %feature("docstring") rr::RoadRunner::getInstanceCount "
 RoadRunner.getInstanceCount()
 
@@ -876,6 +934,23 @@ the new time which will be currentTime + StepSize::
 
 
 
+%feature("docstring") rr::RoadRunner::getSimulateStopReason "
+RoadRunner.getSimulateStopReason()
+
+Why the last simulation stopped, one of the SimulateOptions.STOP_* values.
+STOP_END_TIME is a complete simulation, the others mean it stopped early on
+one of the steadyStateTolerance, stopCondition or maxWallTime arguments to
+simulate, or on an integrator listener, and the result ends at that point::
+
+    result = r.simulate(0, 1000, 10001, steadyStateTolerance=1e-6)
+    if r.getSimulateStopReason() == roadrunner.SimulateOptions.STOP_STEADY_STATE:
+        print('steady state at', result[-1, 0])
+
+The result, and getSimulationData, only have the rows up to the stop.
+";
+
+
+
 %feature("docstring") rr::RoadRunner::reset "
 RoadRunner.reset()
 
@@ -1232,6 +1307,102 @@ and r is the rank of the stoichiometry matrix.
 
 
 
+%feature("docstring") rr::RoadRunner::getFullStoichiometryMatrixSparse "
+RoadRunner.getFullStoichiometryMatrixSparse()
+
+The full stoichiometry matrix, as getFullStoichiometryMatrix, in compressed sparse row format.
+Unless conservation conversion is enabled the matrix is copied straight from the sparse
+matrix in the model, no dense matrix is ever created.
+
+If scipy is available, this returns a scipy.sparse.csr_matrix with rownames and colnames
+attributes, otherwise a (data, indices, indptr, shape) tuple.
+
+:rtype: scipy.sparse.csr_matrix
+";
+
+
+
+%feature("docstring") rr::RoadRunner::getUnscaledElasticityMatrixSparse "
+RoadRunner.getUnscaledElasticityMatrixSparse()
+
+The unscaled species elasticity matrix in compressed sparse row format. Each species is
+perturbed once for all the reactions, and only the non-zero elasticities are stored.
+
+If scipy is available, this returns a scipy.sparse.csr_matrix with rownames and colnames
+attributes, otherwise a (data, indices, indptr, shape) tuple.
+
+:rtype: scipy.sparse.csr_matrix
+";
+
+
+
+%feature("docstring") rr::RoadRunner::getScaledElasticityMatrixSparse "
+RoadRunner.getScaledElasticityMatrixSparse()
+
+The scaled species elasticity matrix in compressed sparse row format.
+
+If scipy is available, this returns a scipy.sparse.csr_matrix with rownames and colnames
+attributes, otherwise a (data, indices, indptr, shape) tuple.
+
+:rtype: scipy.sparse.csr_matrix
+";
+
+
+
+%feature("docstring") rr::RoadRunner::getFullJacobianSparse "
+RoadRunner.getFullJacobianSparse()
+
+The full Jacobian in compressed sparse row format, the product of the sparse
+stoichiometry and unscaled elasticity matrices.
+
+If scipy is available, this returns a scipy.sparse.csr_matrix with rownames and colnames
+attributes, otherwise a (data, indices, indptr, shape) tuple.
+
+:rtype: scipy.sparse.csr_matrix
+";
+
+
+
+%feature("docstring") rr::RoadRunner::getReducedJacobianSparse "
+RoadRunner.getReducedJacobianSparse(h)()
+
+The reduced Jacobian in compressed sparse row format, only the structurally non-zero
+entries are evaluated.
+
+If scipy is available, this returns a scipy.sparse.csr_matrix with rownames and colnames
+attributes, otherwise a (data, indices, indptr, shape) tuple.
+
+:rtype: scipy.sparse.csr_matrix
+";
+
+
+
+%feature("docstring") rr::RoadRunner::getLinkMatrixSparse "
+RoadRunner.getLinkMatrixSparse()
+
+The link matrix in compressed sparse row format.
+
+If scipy is available, this returns a scipy.sparse.csr_matrix with rownames and colnames
+attributes, otherwise a (data, indices, indptr, shape) tuple.
+
+:rtype: scipy.sparse.csr_matrix
+";
+
+
+
+%feature("docstring") rr::RoadRunner::getConservationMatrixSparse "
+RoadRunner.getConservationMatrixSparse()
+
+The conservation matrix in compressed sparse row format.
+
+If scipy is available, this returns a scipy.sparse.csr_matrix with rownames and colnames
+attributes, otherwise a (data, indices, indptr, shape) tuple.
+
+:rtype: scipy.sparse.csr_matrix
+";
+
+
+
 %feature("docstring") rr::RoadRunner::getLinkMatrix "
 RoadRunner.getLinkMatrix()
 
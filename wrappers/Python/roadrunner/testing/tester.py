@@ -1097,8 +1097,1211 @@ def unitTestIntegratorSettings(testDir):
     print(passMsg (errorFlag))
 
 
+def unitTestColumnarData(testDir):
+    print(string.ljust ("Check Columnar Data Round Trip", rpadding), end="")
+    import tempfile
+    errorFlag = False
+
+    r = roadrunner.RoadRunner(os.path.join(testDir,'Test_1.xml'))
+    result = r.simulate(0, 10, 101)
+    names = r.timeCourseSelections
+
+    fd, fileName = tempfile.mkstemp(suffix='.rrcd')
+    os.close(fd)
+
+    try:
+        # 101 rows in chunks of 16 leaves a partial last chunk.
+        for compress in [False, True]:
+            w = roadrunner.ColumnarDataWriter(fileName, names, 16, compress)
+            w.writeArray(result[:50])
+            w.writeArray(result[50:])
+            w.close()
+
+            reader = roadrunner.ColumnarDataReader(fileName)
+            if reader.getNumRows() != result.shape[0] or reader.getNumChunks() != 7:
+                errorFlag = True
+            if list(reader.getColumnNames()) != names:
+                errorFlag = True
+            if not numpy.array_equal(reader.toArray(), result):
+                errorFlag = True
+            if not numpy.array_equal(reader.getColumn(names[1]), result[:,1]):
+                errorFlag = True
+
+            if not compress:
+                # chunk columns are read only views into the mapped file.
+                column = numpy.concatenate([reader.getChunkColumn(i, names[1])
+                        for i in range(reader.getNumChunks())])
+                if not numpy.array_equal(column, result[:,1]):
+                    errorFlag = True
+
+                last = reader.getChunkColumn(6, 1)
+                if last.shape != (5,) or last.flags.writeable:
+                    errorFlag = True
+
+                # the view keeps the reader, and so the mapping, alive.
+                del reader
+                if not numpy.array_equal(last, result[96:,1]):
+                    errorFlag = True
+                del last
+            else:
+                del reader
+    finally:
+        os.remove(fileName)
+
+    print(passMsg (errorFlag))
+
+
+def unitTestSteadyStateSearch(testDir):
+    print(string.ljust ("Check Steady State Search", rpadding), end="")
+    errorFlag = False
+
+    # dS/dt = 0.05 + S^2/(1 + S^2) - 0.5 S is bistable, the steady states are
+    # the roots of 0.5 S^3 - 1.05 S^2 + 0.5 S - 0.05, the middle one unstable.
+    sbml = ('<?xml version="1.0" encoding="UTF-8"?>'
+        '<sbml xmlns="http://www.sbml.org/sbml/level2/version4" level="2" version="4">'
+        '<model id="bistable"><listOfCompartments><compartment id="c" size="1"/></listOfCompartments>'
+        '<listOfSpecies><species id="S" compartment="c" initialConcentration="1"/></listOfSpecies>'
+        '<listOfReactions>'
+        '<reaction id="J0" reversible="false">'
+        '<listOfProducts><speciesReference species="S"/></listOfProducts>'
+        '<kineticLaw><math xmlns="http://www.w3.org/1998/Math/MathML">'
+        '<apply><plus/><cn>0.05</cn><apply><divide/>'
+        '<apply><power/><ci>S</ci><cn>2</cn></apply>'
+        '<apply><plus/><cn>1</cn><apply><power/><ci>S</ci><cn>2</cn></apply></apply>'
+        '</apply></apply></math></kineticLaw></reaction>'
+        '<reaction id="J1" reversible="false">'
+        '<listOfReactants><speciesReference species="S"/></listOfReactants>'
+        '<kineticLaw><math xmlns="http://www.w3.org/1998/Math/MathML">'
+        '<apply><times/><cn>0.5</cn><ci>S</ci></apply>'
+        '</math></kineticLaw></reaction>'
+        '</listOfReactions></model></sbml>')
+
+    expected = sorted(numpy.real(numpy.roots([0.5, -1.05, 0.5, -0.05])))
+
+    r = roadrunner.RoadRunner(sbml)
+    search = roadrunner.SteadyStateSearch(r)
+    search.setBounds('S', 0, 3)
+    search.setNumStarts(60)
+    search.setSeed(1234)
+
+    # columns are S, stable, max_eigenvalue and starts.
+    result = numpy.array(search.search())
+    found = sorted([(row[0], row[1]) for row in result])
+
+    if len(found) != 3:
+        errorFlag = True
+    else:
+        for (value, stable), root, isStable in zip(found, expected, [1, 0, 1]):
+            if abs(value - root) > 1e-5 or stable != isStable:
+                errorFlag = True
+
+    print(passMsg (errorFlag))
+
+
+def unitTestSimulateStops(testDir):
+    print(string.ljust ("Check Simulate Stop Conditions", rpadding), end="")
+    errorFlag = False
+    o = roadrunner.SimulateOptions
+
+    r = roadrunner.RoadRunner(os.path.join(testDir,'Test_1.xml'))
+
+    # the result and the simulation data end at the point where it stopped.
+    def stopped(result, reason):
+        return (r.getSimulateStopReason() == reason and 1 < result.shape[0] < 1001
+                and r.getSimulationData().shape[0] == result.shape[0])
+
+    for integrator in ['cvode', 'rk4']:
+        r.setIntegrator(integrator)
+
+        r.reset()
+        result = r.simulate(0, 100, 1001, ['time', '[S1]'], stopCondition='[S1] > 0.5')
+        if not stopped(result, o.STOP_CONDITION) or result[-1,1] <= 0.5 or result[-2,1] > 0.5:
+            errorFlag = True
+
+        r.reset()
+        result = r.simulate(0, 1000, 1001, steadyStateTolerance=1e-6)
+        if not stopped(result, o.STOP_STEADY_STATE):
+            errorFlag = True
+
+    r.setIntegrator('cvode')
+
+    r.reset()
+    result = r.simulate(0, 1000, 1001, maxWallTime=1e-9)
+    if not (r.getSimulateStopReason() == o.STOP_WALL_TIME and result.shape[0] < 1001):
+        errorFlag = True
+
+    # the conditions only apply to the one simulation.
+    r.reset()
+    result = r.simulate(0, 100, 1001)
+    if r.getSimulateStopReason() != o.STOP_END_TIME or result.shape[0] != 1001:
+        errorFlag = True
+
+    print(passMsg (errorFlag))
+
+
+def unitTestStiffInterrupt(testDir):
+    print(string.ljust ("Check Interrupting a Stiff Simulation", rpadding), end="")
+    errorFlag = False
+    o = roadrunner.SimulateOptions
+
+    # the Robertson problem, stiff enough that cvode spends most of its time
+    # in the Newton iteration and the difference quotient Jacobian.
+    def massAction(id, reactants, products, k):
+        return ('<reaction id="{0}" reversible="false">'
+            '<listOfReactants>{1}</listOfReactants><listOfProducts>{2}</listOfProducts>'
+            '<kineticLaw><math xmlns="http://www.w3.org/1998/Math/MathML">'
+            '<apply><times/><cn>{3}</cn>{4}</apply></math></kineticLaw></reaction>').format(
+            id, ''.join(['<speciesReference species="{0}"/>'.format(x) for x in reactants]),
+            ''.join(['<speciesReference species="{0}"/>'.format(x) for x in products]),
+            k, ''.join(['<ci>{0}</ci>'.format(x) for x in reactants]))
+
+    sbml = ('<?xml version="1.0" encoding="UTF-8"?>'
+        '<sbml xmlns="http://www.sbml.org/sbml/level2/version4" level="2" version="4">'
+        '<model id="robertson"><listOfCompartments><compartment id="c" size="1"/></listOfCompartments>'
+        '<listOfSpecies><species id="A" compartment="c" initialConcentration="1"/>'
+        '<species id="B" compartment="c" initialConcentration="0"/>'
+        '<species id="C" compartment="c" initialConcentration="0"/></listOfSpecies>'
+        '<listOfReactions>' +
+        massAction('J1', ['A'], ['B'], 0.04) +
+        massAction('J2', ['B', 'B'], ['B', 'C'], 3e7) +
+        massAction('J3', ['B', 'C'], ['A', 'C'], 1e4) +
+        '</listOfReactions></model></sbml>')
+
+    r = roadrunner.RoadRunner(sbml)
+    r.setIntegrator('cvode')
+    r.getIntegrator().setValue('stiff', True)
+    r.getIntegrator().setValue('relative_tolerance', 1e-12)
+    r.getIntegrator().setValue('absolute_tolerance', 1e-16)
+
+    # far more output points than can be done before the cancel.
+    opt = roadrunner.SimulateOptions()
+    opt.start = 0
+    opt.duration = 1e11
+    opt.steps = 2000000
+
+    f = r.simulateAsync(opt)
+    f.wait(0.2)
+    f.cancel()
+
+    try:
+        result = f.getResult()
+        if (not f.isCancelled() or f.getStopReason() != o.STOP_CANCELLED
+                or not 0 < result.shape[0] < opt.steps + 1):
+            errorFlag = True
+    except Exception:
+        # an interrupted step must not surface as a cvode error.
+        errorFlag = True
+    del f
+
+    # the wall time limit stops the same way.
+    r.reset()
+    try:
+        result = r.simulate(0, 1e11, 2000001, maxWallTime=0.2)
+        if (r.getSimulateStopReason() != o.STOP_WALL_TIME
+                or not 0 < result.shape[0] < 2000001):
+            errorFlag = True
+    except Exception:
+        errorFlag = True
+
+    print(passMsg (errorFlag))
+
+
+def unitTestPerfCountersAcrossEvents(testDir):
+    print(string.ljust ("Check Performance Counters Across Events", rpadding), end="")
+    errorFlag = False
+
+    # S decays and is set back to 1 whenever it drops below 0.5, an event
+    # about every ln(2) time units, each of which reinitializes cvode.
+    sbml = ('<?xml version="1.0" encoding="UTF-8"?>'
+        '<sbml xmlns="http://www.sbml.org/sbml/level2/version4" level="2" version="4">'
+        '<model id="dosing"><listOfCompartments><compartment id="c" size="1"/></listOfCompartments>'
+        '<listOfSpecies><species id="S" compartment="c" initialConcentration="1"/></listOfSpecies>'
+        '<listOfReactions><reaction id="J1" reversible="false">'
+        '<listOfReactants><speciesReference species="S"/></listOfReactants>'
+        '<kineticLaw><math xmlns="http://www.w3.org/1998/Math/MathML"><ci>S</ci></math></kineticLaw>'
+        '</reaction></listOfReactions>'
+        '<listOfEvents><event id="dose" useValuesFromTriggerTime="true"><trigger>'
+        '<math xmlns="http://www.w3.org/1998/Math/MathML"><apply><lt/><ci>S</ci><cn>0.5</cn></apply></math>'
+        '</trigger><listOfEventAssignments><eventAssignment variable="S">'
+        '<math xmlns="http://www.w3.org/1998/Math/MathML"><cn>1</cn></math>'
+        '</eventAssignment></listOfEventAssignments></event></listOfEvents>'
+        '</model></sbml>')
+
+    r = roadrunner.RoadRunner(sbml)
+
+    if r.getPerformanceCounters()['enabled']:
+        keys = ['integrator_steps', 'integrator_rhs_evals', 'integrator_root_evals',
+                'event_applications']
+        last = None
+        # the counts describe the whole run, so they grow with the number of
+        # events, not just the last segment between two events.
+        for end in [5, 10, 20, 40]:
+            r.reset()
+            r.simulate(0, end, 101)
+            c = r.getPerformanceCounters()
+            counts = [c[k] for k in keys]
+            if last is not None and not all([a > b for a, b in zip(counts, last)]):
+                errorFlag = True
+            last = counts
+
+        # the steps of 40 time units, with about 57 events, are far more
+        # than those of the longest stretch between two events.
+        if last[0] < 2 * last[3]:
+            errorFlag = True
+
+    print(passMsg (errorFlag))
 
 
+def unitTestParameterEstimation(testDir):
+    print(string.ljust ("Check Parameter Estimation", rpadding), end="")
+    import tempfile
+    errorFlag = False
+
+    def writeData(data, names):
+        fd, fileName = tempfile.mkstemp(suffix='.dat')
+        with os.fdopen(fd, 'w') as f:
+            f.write('[INFO]\nNUMBER_OF_COLS={0}\nNUMBER_OF_ROWS={1}\nCOLUMN_HEADERS={2}\n\n[DATA]\n'
+                    .format(data.shape[1], data.shape[0], ','.join(names)))
+            for row in data:
+                f.write(','.join(['{0:.17g}'.format(v) for v in row]) + '\n')
+        return fileName
+
+    # synthetic data, simulated with the value of k2 in the model.
+    r = roadrunner.RoadRunner(os.path.join(testDir,'Test_1.xml'))
+    k2 = r['k2']
+    names = ['time', 'S1', 'S2', 'S3']
+    fileName = writeData(r.simulate(0, 20, 41, names), names)
+
+    try:
+        for method in [roadrunner.ParameterEstimation.LEVENBERG_MARQUARDT,
+                       roadrunner.ParameterEstimation.NELDER_MEAD]:
+            r.reset()
+            r['k2'] = 2 * k2
+
+            pe = roadrunner.ParameterEstimation(r)
+            pe.setMethod(method)
+            pe.addParameter('k2', 0.01, 1)
+            pe.addExperiment(fileName)
+
+            # columns are value, standard_error, lower and upper.
+            result = numpy.array(pe.fit())
+            if abs(result[0,0] - k2) > 1e-3 * k2:
+                errorFlag = True
+            if not (result[0,2] <= result[0,0] <= result[0,3]):
+                errorFlag = True
+            if pe.getChiSquare() > 1e-6:
+                errorFlag = True
+            del pe
+    finally:
+        os.remove(fileName)
+
+    # a only sets the initial amount of S, through an initial assignment,
+    # so the fit only sees it if the assignment follows the fitted value.
+    sbml = ('<?xml version="1.0" encoding="UTF-8"?>'
+        '<sbml xmlns="http://www.sbml.org/sbml/level2/version4" level="2" version="4">'
+        '<model id="initial"><listOfCompartments><compartment id="c" size="1"/></listOfCompartments>'
+        '<listOfSpecies><species id="S" compartment="c" initialAmount="0"/></listOfSpecies>'
+        '<listOfParameters><parameter id="a" value="1"/></listOfParameters>'
+        '<listOfInitialAssignments><initialAssignment symbol="S">'
+        '<math xmlns="http://www.w3.org/1998/Math/MathML"><apply><times/><cn>10</cn><ci>a</ci></apply></math>'
+        '</initialAssignment></listOfInitialAssignments>'
+        '<listOfReactions><reaction id="J1" reversible="false">'
+        '<listOfReactants><speciesReference species="S"/></listOfReactants>'
+        '<kineticLaw><math xmlns="http://www.w3.org/1998/Math/MathML">'
+        '<apply><times/><cn>0.5</cn><ci>S</ci></apply></math></kineticLaw>'
+        '</reaction></listOfReactions></model></sbml>')
+
+    r = roadrunner.RoadRunner(sbml)
+    names = ['time', 'S']
+    fileName = writeData(r.simulate(0, 5, 21, names), names)
+
+    try:
+        r['a'] = 2
+        pe = roadrunner.ParameterEstimation(r)
+        pe.addParameter('a', 0.1, 10)
+        pe.addExperiment(fileName)
+
+        result = numpy.array(pe.fit())
+        if abs(result[0,0] - 1) > 1e-3 or pe.getChiSquare() > 1e-6:
+            errorFlag = True
+        del pe
+    except Exception:
+        errorFlag = True
+    finally:
+        os.remove(fileName)
+
+    print(passMsg (errorFlag))
+
+
+def unitTestValueHandles(testDir):
+    print(string.ljust ("Check Value Handles", rpadding), end="")
+    errorFlag = False
+
+    fileName = os.path.join(testDir,'Test_1.xml')
+    r = roadrunner.RoadRunner(fileName)
+    r.simulate(0, 5, 11)
+
+    # getValues gives the same values as getValue, for each kind of id.
+    ids = ['S1', '[S2]', 'k1', 'init([S3])', 'Xo', 'compartment', 'J1']
+    h = r.createValueHandle(ids)
+    if not numpy.allclose(r.getValues(h), [r.getValue(i) for i in ids], rtol=1e-14):
+        errorFlag = True
+
+    # setValues leaves the model in the same state as setValue for each id.
+    ids = ['S1', '[S2]', 'k1', 'Xo', 'init([S3])']
+    values = numpy.array([0.3, 0.4, 0.2, 2, 0.5])
+
+    ref = roadrunner.RoadRunner(fileName)
+    ref.simulate(0, 5, 11)
+    for i, v in zip(ids, values):
+        ref.setValue(i, v)
+
+    h = r.createValueHandle(ids)
+    r.setValues(h, values)
+
+    check = ['S1', 'S2', 'S3', 'k1', 'Xo', 'init(S3)', 'time']
+    if not numpy.allclose([r.getValue(i) for i in check],
+                          [ref.getValue(i) for i in check], rtol=1e-14):
+        errorFlag = True
+
+    # a handle is not valid for a newly loaded model.
+    r.load(fileName)
+    try:
+        r.getValues(h)
+        errorFlag = True
+    except Exception:
+        pass
+
+    print(passMsg (errorFlag))
+
+
+def unitTestSimulateResultSharing(testDir):
+    print(string.ljust ("Check Simulate Result Sharing", rpadding), end="")
+    errorFlag = False
+
+    r = roadrunner.RoadRunner(os.path.join(testDir,'Test_1.xml'))
+
+    # the result is the simulation data, not a copy of it.
+    a = r.simulate(0, 10, 11)
+    if not numpy.may_share_memory(a, r.getSimulationData()):
+        errorFlag = True
+    expected = numpy.array(a)
+
+    # the next simulation writes to new memory, the first result is intact.
+    r.reset()
+    b = r.simulate(0, 20, 21)
+    if numpy.may_share_memory(a, b) or not numpy.array_equal(a, expected):
+        errorFlag = True
+    if not numpy.array_equal(b, r.getSimulationData()):
+        errorFlag = True
+
+    # the result outlives the RoadRunner.
+    del r
+    if not numpy.array_equal(a, expected) or b.shape[0] != 21:
+        errorFlag = True
+
+    print(passMsg (errorFlag))
+
+
+def unitTestColoredJacobian(testDir):
+    print(string.ljust ("Check Colored Jacobian", rpadding), end="")
+    errorFlag = False
+
+    # a chain of reactions, Xo -> S1 -> ... -> Sn -> X1, has a tridiagonal
+    # Jacobian, so the reduced Jacobian is computed with 3 colors.
+    n = 8
+    species = ''.join(['<species id="S{0}" compartment="c" initialConcentration="{1}"/>'
+                       .format(i, 0.1 * i) for i in range(1, n + 1)])
+    names = ['Xo'] + ['S{0}'.format(i) for i in range(1, n + 1)] + ['X1']
+    reactions = ''
+    for i in range(n + 1):
+        reactions += ('<reaction id="J{0}" reversible="false">'
+            '<listOfReactants><speciesReference species="{1}"/></listOfReactants>'
+            '<listOfProducts><speciesReference species="{2}"/></listOfProducts>'
+            '<kineticLaw><math xmlns="http://www.w3.org/1998/Math/MathML">'
+            '<apply><divide/><apply><times/><cn>{3}</cn><ci>{1}</ci></apply>'
+            '<apply><plus/><cn>1</cn><ci>{1}</ci></apply></apply>'
+            '</math></kineticLaw></reaction>').format(i, names[i], names[i + 1], 1 + 0.1 * i)
+    sbml = ('<?xml version="1.0" encoding="UTF-8"?>'
+        '<sbml xmlns="http://www.sbml.org/sbml/level2/version4" level="2" version="4">'
+        '<model id="chain"><listOfCompartments><compartment id="c" size="1"/></listOfCompartments>'
+        '<listOfSpecies><species id="Xo" compartment="c" initialConcentration="1" boundaryCondition="true"/>'
+        '<species id="X1" compartment="c" initialConcentration="0" boundaryCondition="true"/>'
+        + species + '</listOfSpecies><listOfReactions>' + reactions +
+        '</listOfReactions></model></sbml>')
+
+    r = roadrunner.RoadRunner(sbml)
+    r.simulate(0, 1, 11)
+
+    full = r.getFullJacobian()
+    reduced = r.getReducedJacobian()
+
+    if full.shape != (n, n) or reduced.shape != (n, n):
+        errorFlag = True
+    elif numpy.max(numpy.abs(reduced - full)) > 1e-6 * numpy.max(numpy.abs(full)):
+        errorFlag = True
+
+    print(passMsg (errorFlag))
+
+
+
+
+
+
+def unitTestOptimizedPipelines(testDir):
+    print(string.ljust ("Check Optimized and Fast Math Models", rpadding), end="")
+    errorFlag = False
+
+    # a kinetic law with a piecewise, whose condition must stay exact under
+    # fast math, and a rate rule with a sum the optimizer may re-associate.
+    sbml = ('<?xml version="1.0" encoding="UTF-8"?>'
+        '<sbml xmlns="http://www.sbml.org/sbml/level2/version4" level="2" version="4">'
+        '<model id="pipelines"><listOfCompartments><compartment id="c" size="1"/></listOfCompartments>'
+        '<listOfSpecies><species id="S" compartment="c" initialConcentration="1"/>'
+        '<species id="P" compartment="c" initialConcentration="0"/></listOfSpecies>'
+        '<listOfParameters><parameter id="k" value="0.7"/>'
+        '<parameter id="x" value="0" constant="false"/></listOfParameters>'
+        '<listOfRules><rateRule variable="x"><math xmlns="http://www.w3.org/1998/Math/MathML">'
+        '<apply><plus/><apply><times/><ci>k</ci><ci>S</ci></apply>'
+        '<apply><times/><cn>0.25</cn><ci>P</ci></apply>'
+        '<apply><minus/><apply><times/><ci>k</ci><ci>x</ci></apply></apply>'
+        '<cn>0.1</cn></apply></math></rateRule></listOfRules>'
+        '<listOfReactions><reaction id="J1" reversible="false">'
+        '<listOfReactants><speciesReference species="S"/></listOfReactants>'
+        '<listOfProducts><speciesReference species="P"/></listOfProducts>'
+        '<kineticLaw><math xmlns="http://www.w3.org/1998/Math/MathML"><piecewise>'
+        '<piece><apply><times/><cn>2</cn><ci>k</ci><ci>S</ci></apply>'
+        '<apply><gt/><apply><minus/><ci>S</ci><apply><times/><cn>0.5</cn><ci>k</ci></apply></apply>'
+        '<cn>0.15</cn></apply></piece>'
+        '<otherwise><apply><times/><ci>k</ci><ci>S</ci></apply></otherwise>'
+        '</piecewise></math></kineticLaw></reaction></listOfReactions>'
+        '</model></sbml>')
+
+    keys = [Config.LOADSBMLOPTIONS_OPTIMIZE_LEVEL, Config.LOADSBMLOPTIONS_FAST_MATH,
+            Config.LLVM_TARGET_CPU]
+    saved = [Config.getValue(key) for key in keys]
+
+    def run():
+        r = roadrunner.RoadRunner(sbml)
+        r.getIntegrator().setValue('relative_tolerance', 1e-10)
+        r.getIntegrator().setValue('absolute_tolerance', 1e-12)
+        return r.simulate(0, 10, 101)
+
+    try:
+        ref = run()
+
+        # each option on its own, and all of them together.
+        variants = [[2, False, ''], [3, False, ''], [0, True, ''], [0, False, 'host'],
+                    [3, True, 'host']]
+
+        for variant in variants:
+            for key, value in zip(keys, variant):
+                Config.setValue(key, value)
+            result = run()
+            if result.shape != ref.shape or not numpy.allclose(result, ref,
+                    rtol=1e-6, atol=1e-9):
+                errorFlag = True
+    except Exception:
+        errorFlag = True
+    finally:
+        for key, value in zip(keys, saved):
+            Config.setValue(key, value)
+
+    print(passMsg (errorFlag))
+
+
+def unitTestPiecewiseTables(testDir):
+    print(string.ljust ("Check Piecewise Table Lookups", rpadding), end="")
+    errorFlag = False
+
+    def ci(x):
+        return '<ci>{0}</ci>'.format(x)
+
+    def cn(x):
+        return '<cn>{0!r}</cn>'.format(float(x))
+
+    def apply(op, *args):
+        return '<apply><{0}/>{1}</apply>'.format(op, ''.join(args))
+
+    # y = piecewise of x, each piece a constant or 'a + b * (x - c)', with
+    # conditions 'x pred bound' or 'x lowerPred lower && x pred bound'.
+    def model(pieces, otherwise):
+        return ('<?xml version="1.0" encoding="UTF-8"?>'
+            '<sbml xmlns="http://www.sbml.org/sbml/level2/version4" level="2" version="4">'
+            '<model id="table"><listOfParameters>'
+            '<parameter id="x" value="0" constant="false"/>'
+            '<parameter id="y" constant="false"/></listOfParameters>'
+            '<listOfRules><assignmentRule variable="y">'
+            '<math xmlns="http://www.w3.org/1998/Math/MathML"><piecewise>' +
+            ''.join(['<piece>{0}{1}</piece>'.format(v, c) for v, c in pieces]) +
+            '<otherwise>' + cn(otherwise) + '</otherwise>'
+            '</piecewise></math></assignmentRule></listOfRules></model></sbml>')
+
+    def linear(a, b, c):
+        return apply('plus', cn(a), apply('times', cn(b), apply('minus', ci('x'), cn(c))))
+
+    uniform = [float(i) for i in range(10)]
+    nonUniform = [-3, -1, 0, 0.5, 2, 2.25, 5, 9, 10, 20]
+
+    # (sbml, the points where the pieces change)
+    tables = [
+        # thresholds on a uniform grid, constant pieces.
+        (model([(cn(1.5 * i + 0.25), apply('lt', ci('x'), cn(b)))
+            for i, b in enumerate(uniform)], -1), uniform),
+        # thresholds on a non-uniform grid, interpolated pieces, the bound
+        # on the left of the comparison.
+        (model([(linear(i, 0.5 * i - 2, b), apply('geq', cn(b), ci('x')))
+            for i, b in enumerate(nonUniform)], 7), nonUniform),
+        # intervals on a uniform grid, with gaps which are 'otherwise'.
+        (model([(cn(i + 1), apply('and', apply('geq', ci('x'), cn(b - 0.5)),
+            apply('lt', ci('x'), cn(b)))) for i, b in enumerate(uniform)], -2),
+            uniform + [b - 0.5 for b in uniform]),
+        # contiguous intervals on a non-uniform grid.
+        (model([(linear(2 * i, 1 - i, b), apply('and', apply('leq', ci('x'), cn(b)),
+            apply('gt', ci('x'), cn(a)))) for i, (a, b) in
+            enumerate(zip([-4] + nonUniform[:-1], nonUniform))], 3), nonUniform)
+    ]
+
+    saved = Config.getValue(Config.LLVM_PIECEWISE_TABLE_MIN_SIZE)
+
+    def evaluate(sbml, minSize, points):
+        Config.setValue(Config.LLVM_PIECEWISE_TABLE_MIN_SIZE, minSize)
+        r = roadrunner.RoadRunner(sbml)
+        values = []
+        for x in points:
+            r['x'] = x
+            values.append(r['y'])
+        return values
+
+    try:
+        for sbml, bounds in tables:
+            bounds = sorted(bounds)
+            # at, between, below and past the bounds, and NaN.
+            points = (bounds + [(a + b) / 2.0 for a, b in zip(bounds, bounds[1:])] +
+                [bounds[0] - 1, bounds[0] - 1e-9, bounds[-1] + 1e-9, bounds[-1] + 1,
+                 float('nan')])
+
+            # zero is the chain of comparisons, 8 a table for 10 pieces.
+            chain = evaluate(sbml, 0, points)
+            table = evaluate(sbml, 8, points)
+
+            for x, a, b in zip(points, chain, table):
+                if not (a == b or (a != a and b != b) or abs(a - b) <= 1e-12 * (1 + abs(a))):
+                    errorFlag = True
+    except Exception:
+        errorFlag = True
+    finally:
+        Config.setValue(Config.LLVM_PIECEWISE_TABLE_MIN_SIZE, saved)
+
+    print(passMsg (errorFlag))
+
+
+def unitTestModelCache(testDir):
+    print(string.ljust ("Check Compiled Model Cache", rpadding), end="")
+    errorFlag = False
+
+    # the rate constant is in the kinetic laws, not a parameter, so each n
+    # is a different structure, a different compiled model of the same size.
+    def chain(n):
+        return ('<?xml version="1.0" encoding="UTF-8"?>'
+            '<sbml xmlns="http://www.sbml.org/sbml/level2/version4" level="2" version="4">'
+            '<model id="chain"><listOfCompartments><compartment id="c" size="1"/></listOfCompartments>'
+            '<listOfSpecies>' +
+            ''.join(['<species id="S{0}" compartment="c" initialConcentration="1"/>'.format(i)
+                for i in range(5)]) +
+            '</listOfSpecies><listOfReactions>' +
+            ''.join(['<reaction id="J{0}" reversible="false">'
+                '<listOfReactants><speciesReference species="S{0}"/></listOfReactants>'
+                '<listOfProducts><speciesReference species="S{1}"/></listOfProducts>'
+                '<kineticLaw><math xmlns="http://www.w3.org/1998/Math/MathML">'
+                '<apply><times/><cn>{2}</cn><ci>S{0}</ci></apply></math></kineticLaw>'
+                '</reaction>'.format(i, i + 1, n) for i in range(4)]) +
+            '</listOfReactions></model></sbml>')
+
+    keys = ['hits', 'misses', 'evictions']
+
+    def load(n):
+        # the RoadRunner is deleted at once, only the cache keeps the model.
+        before = roadrunner.getModelCacheStatistics()
+        r = roadrunner.RoadRunner(chain(n))
+        del r
+        after = roadrunner.getModelCacheStatistics()
+        return [after[k] - before[k] for k in keys]
+
+    saved = Config.getValue(Config.LLVM_MODEL_CACHE_SIZE)
+
+    try:
+        roadrunner.clearModelCache()
+        Config.setValue(Config.LLVM_MODEL_CACHE_SIZE, 2)
+        stats = roadrunner.getModelCacheStatistics()
+        if stats['models'] != 0 or stats['size'] != 0 or stats['capacity'] != 2 * 1024 * 1024:
+            errorFlag = True
+
+        # fill the cache, the first model is evicted when the one after the
+        # last which fits is loaded, each a miss.
+        full = None
+        for n in range(1, 40):
+            d = load(n)
+            stats = roadrunner.getModelCacheStatistics()
+            if d[0:2] != [0, 1] or stats['size'] > stats['capacity']:
+                errorFlag = True
+            if d[2]:
+                full = n
+                break
+
+        if full is None or full < 4 or d != [0, 1, 1]:
+            errorFlag = True
+        else:
+            # using the second makes the third the least recently used, so
+            # loading the first again evicts the third and not the second.
+            if load(2) != [1, 0, 0]:
+                errorFlag = True
+            if load(1) != [0, 1, 1]:
+                errorFlag = True
+            if load(2) != [1, 0, 0]:
+                errorFlag = True
+            if load(3) != [0, 1, 1]:
+                errorFlag = True
+            if roadrunner.getModelCacheStatistics()['models'] != full - 1:
+                errorFlag = True
+
+        # clearing releases all of the models, but not the counters.
+        before = roadrunner.getModelCacheStatistics()
+        roadrunner.clearModelCache()
+        stats = roadrunner.getModelCacheStatistics()
+        if stats['models'] != 0 or stats['size'] != 0:
+            errorFlag = True
+        if [stats[k] for k in keys] != [before[k] for k in keys]:
+            errorFlag = True
+        if load(2) != [0, 1, 0]:
+            errorFlag = True
+    except Exception:
+        errorFlag = True
+    finally:
+        Config.setValue(Config.LLVM_MODEL_CACHE_SIZE, saved)
+        roadrunner.clearModelCache()
+
+    print(passMsg (errorFlag))
+
+
+def unitTestStructureSharing(testDir):
+    print(string.ljust ("Check Sharing Models of the Same Structure", rpadding), end="")
+    errorFlag = False
+
+    # S decays with k * S, or a local kl * S, in a compartment of size c,
+    # so [S] = S0 * exp(-k * t / c).
+    def decay(k=1.0, S0=10.0, c=1.0, kl=None):
+        if kl is None:
+            law = '<apply><times/><ci>k</ci><ci>S</ci></apply></math>'
+            local = ''
+        else:
+            law = '<apply><times/><ci>kl</ci><ci>S</ci></apply></math>'
+            local = '<listOfParameters><parameter id="kl" value="{0!r}"/></listOfParameters>'.format(kl)
+        return ('<?xml version="1.0" encoding="UTF-8"?>'
+            '<sbml xmlns="http://www.sbml.org/sbml/level2/version4" level="2" version="4">'
+            '<model id="decay"><listOfCompartments><compartment id="c" size="{2!r}"/></listOfCompartments>'
+            '<listOfSpecies><species id="S" compartment="c" initialConcentration="{1!r}"/></listOfSpecies>'
+            '<listOfParameters><parameter id="k" value="{0!r}"/></listOfParameters>'
+            '<listOfReactions><reaction id="J1" reversible="false">'
+            '<listOfReactants><speciesReference species="S"/></listOfReactants>'
+            '<kineticLaw><math xmlns="http://www.w3.org/1998/Math/MathML">'.format(k, S0, c) +
+            law + local + '</kineticLaw></reaction></listOfReactions></model></sbml>')
+
+    def check(r, k, S0, c):
+        r.getIntegrator().setValue('relative_tolerance', 1e-10)
+        r.getIntegrator().setValue('absolute_tolerance', 1e-12)
+        result = r.simulate(0, 2, 21, ['time', '[S]'])
+        expected = S0 * numpy.exp(-k * result[:,0] / c)
+        return numpy.allclose(result[:,1], expected, rtol=1e-6, atol=1e-9)
+
+    def counts():
+        stats = roadrunner.getModelCacheStatistics()
+        return [stats['hits'], stats['misses']]
+
+    try:
+        # the models are in use, so they are shared whatever the cache size.
+        models = []
+        before = counts()
+        models.append((roadrunner.RoadRunner(decay()), 1.0, 10.0, 1.0))
+        after = counts()
+        # the first one may still be cached from another test.
+        if after[0] + after[1] != before[0] + before[1] + 1:
+            errorFlag = True
+
+        # only the values differ, each a hit on the structure of the first.
+        for k, S0, c in [(2.0, 10.0, 1.0), (1.0, 5.0, 1.0), (1.0, 10.0, 2.0),
+                         (0.5, 3.0, 4.0)]:
+            before = counts()
+            models.append((roadrunner.RoadRunner(decay(k, S0, c)), k, S0, c))
+            if counts() != [before[0] + 1, before[1]]:
+                errorFlag = True
+
+        # each simulates with its own values.
+        for r, k, S0, c in models:
+            if not check(r, k, S0, c):
+                errorFlag = True
+
+        # local parameters are part of the structure.
+        r1 = roadrunner.RoadRunner(decay(kl=1.0))
+        before = counts()
+        r2 = roadrunner.RoadRunner(decay(kl=3.0))
+        if counts() != [before[0], before[1] + 1]:
+            errorFlag = True
+        if not check(r1, 1.0, 10.0, 1.0) or not check(r2, 3.0, 10.0, 1.0):
+            errorFlag = True
+    except Exception:
+        errorFlag = True
+
+    print(passMsg (errorFlag))
+
+
+def unitTestSelectionRow(testDir):
+    print(string.ljust ("Check Selection Rows of Eigen, Elasticity and Control", rpadding), end="")
+    errorFlag = False
+
+    fileName = os.path.join(testDir,'Test_1.xml')
+
+    # the first control column moves the model to its steady state, so the
+    # columns before it are at the current state and the ones after it at
+    # the steady state.
+    before = ['eigenReal(S1)', 'uec(J1, S1)', 'ec(J2, S1)', 'eigenImag(S2)',
+              'uec(J1, k1)']
+    controls = ['cc(J1, k1)', 'ucc(S1, k2)', 'cc(S2, k1)', 'ucc(J3, k1)']
+    after = ['eigenReal(S2)', 'ec(J1, S1)', 'uec(J2, S1)', 'eigenImag(S1)',
+             'ec(J1, k1)']
+
+    try:
+        r = roadrunner.RoadRunner(fileName)
+        r.selections = before + controls + after
+        first = numpy.array(r.getSelectedValues())
+        # now at the steady state, every column is.
+        second = numpy.array(r.getSelectedValues())
+
+        ref = roadrunner.RoadRunner(fileName)
+        expectedBefore = [ref.getValue(s) for s in before]
+        ref.steadyState()
+        expectedControls = [ref.getValue(s) for s in controls]
+        ref.steadyState()
+        expectedAfter = [ref.getValue(s) for s in after]
+        expectedSteady = [ref.getValue(s) for s in before]
+
+        if not numpy.allclose(first, expectedBefore + expectedControls + expectedAfter,
+                              rtol=1e-5, atol=1e-8):
+            errorFlag = True
+        if not numpy.allclose(second, expectedSteady + expectedControls + expectedAfter,
+                              rtol=1e-5, atol=1e-8):
+            errorFlag = True
+
+        # the columns before the controls did see the initial state.
+        if numpy.allclose(expectedBefore, expectedSteady, rtol=1e-5, atol=1e-8):
+            errorFlag = True
+    except Exception:
+        errorFlag = True
+
+    print(passMsg (errorFlag))
+
+
+def unitTestStateVectorRate(testDir):
+    print(string.ljust ("Check State Vector Rates with Conversion Factors", rpadding), end="")
+    errorFlag = False
+
+    # A -> sB B, B -> C, a model conversion factor mcf, C with its own ccf,
+    # and a rate rule x' = k1 * A - x. With a variable stoichiometry sB = 1 + x
+    # the rates are reaction rates times the stoichiometry, otherwise they
+    # are the fused state vector rate function.
+    def model(variable):
+        math = '<math xmlns="http://www.w3.org/1998/Math/MathML">{0}</math>'
+        return ('<?xml version="1.0" encoding="UTF-8"?>'
+            '<sbml xmlns="http://www.sbml.org/sbml/level3/version1/core" level="3" version="1">'
+            '<model id="factors" conversionFactor="mcf">'
+            '<listOfCompartments><compartment id="c" size="1" constant="true"/></listOfCompartments>'
+            '<listOfSpecies>'
+            '<species id="A" compartment="c" initialConcentration="10" hasOnlySubstanceUnits="false" boundaryCondition="false" constant="false"/>'
+            '<species id="B" compartment="c" initialConcentration="1" hasOnlySubstanceUnits="false" boundaryCondition="false" constant="false"/>'
+            '<species id="C" compartment="c" initialConcentration="0" hasOnlySubstanceUnits="false" boundaryCondition="false" constant="false" conversionFactor="ccf"/>'
+            '</listOfSpecies><listOfParameters>'
+            '<parameter id="k1" value="0.7" constant="true"/>'
+            '<parameter id="k2" value="0.3" constant="true"/>'
+            '<parameter id="mcf" value="2" constant="true"/>'
+            '<parameter id="ccf" value="0.5" constant="true"/>'
+            '<parameter id="x" value="0" constant="false"/>'
+            '</listOfParameters><listOfRules>'
+            '<rateRule variable="x">' + math.format(
+                '<apply><minus/><apply><times/><ci>k1</ci><ci>A</ci></apply><ci>x</ci></apply>') +
+            '</rateRule>' +
+            ('<assignmentRule variable="sB">' + math.format(
+                '<apply><plus/><cn>1</cn><ci>x</ci></apply>') + '</assignmentRule>'
+             if variable else '') +
+            '</listOfRules><listOfReactions>'
+            '<reaction id="J1" reversible="false" fast="false">'
+            '<listOfReactants><speciesReference species="A" stoichiometry="1" constant="true"/></listOfReactants>'
+            '<listOfProducts>' +
+            ('<speciesReference id="sB" species="B" constant="false"/>' if variable else
+             '<speciesReference species="B" stoichiometry="2" constant="true"/>') +
+            '</listOfProducts><kineticLaw>' + math.format(
+                '<apply><times/><ci>k1</ci><ci>A</ci></apply>') + '</kineticLaw></reaction>'
+            '<reaction id="J2" reversible="false" fast="false">'
+            '<listOfReactants><speciesReference species="B" stoichiometry="1" constant="true"/></listOfReactants>'
+            '<listOfProducts><speciesReference species="C" stoichiometry="1" constant="true"/></listOfProducts>'
+            '<kineticLaw>' + math.format(
+                '<apply><times/><ci>k2</ci><ci>B</ci></apply>') + '</kineticLaw></reaction>'
+            '</listOfReactions></model></sbml>')
+
+    try:
+        for variable in [False, True]:
+            r = roadrunner.RoadRunner(model(variable))
+            for t in [0, 0.5, 2]:
+                if t > 0:
+                    r.reset()
+                    r.simulate(0, t, 11)
+
+                rates = r.model.getStateVectorRate()
+                ids = r.model.getStateVectorIds()
+                v1, v2 = r.model.getReactionRates()
+                sB = 1 + r['x'] if variable else 2
+
+                expected = {
+                    'x' : 0.7 * r['A'] - r['x'],
+                    'A' : 2 * -v1,
+                    'B' : 2 * (sB * v1 - v2),
+                    'C' : 0.5 * v2 }
+
+                if sorted(ids) != sorted(expected.keys()):
+                    errorFlag = True
+                    continue
+
+                if not numpy.allclose(rates, [expected[i] for i in ids],
+                                      rtol=1e-12, atol=1e-14):
+                    errorFlag = True
+
+                # the amount rates are the same function.
+                amounts = r.model.getFloatingSpeciesAmountRates()
+                species = r.model.getFloatingSpeciesIds()
+                if not numpy.allclose(amounts, [expected[i] for i in species],
+                                      rtol=1e-12, atol=1e-14):
+                    errorFlag = True
+    except Exception:
+        errorFlag = True
+
+    print(passMsg (errorFlag))
+
+
+def unitTestGillespieReplicates(testDir):
+    print(string.ljust ("Check Gillespie Seed and Replicate Streams", rpadding), end="")
+    errorFlag = False
+
+    # A -> B, enough molecules that two different streams cannot give the
+    # same trajectory.
+    sbml = ('<?xml version="1.0" encoding="UTF-8"?>'
+        '<sbml xmlns="http://www.sbml.org/sbml/level2/version4" level="2" version="4">'
+        '<model id="decay">'
+        '<listOfCompartments><compartment id="c" size="1"/></listOfCompartments>'
+        '<listOfSpecies>'
+        '<species id="A" compartment="c" initialAmount="1000" hasOnlySubstanceUnits="true"/>'
+        '<species id="B" compartment="c" initialAmount="0" hasOnlySubstanceUnits="true"/>'
+        '</listOfSpecies>'
+        '<listOfParameters><parameter id="k1" value="0.1"/></listOfParameters>'
+        '<listOfReactions><reaction id="J1" reversible="false">'
+        '<listOfReactants><speciesReference species="A"/></listOfReactants>'
+        '<listOfProducts><speciesReference species="B"/></listOfProducts>'
+        '<kineticLaw><math xmlns="http://www.w3.org/1998/Math/MathML">'
+        '<apply><times/><ci>k1</ci><ci>A</ci></apply>'
+        '</math></kineticLaw></reaction></listOfReactions>'
+        '</model></sbml>')
+
+    def run(r, seed, replicate):
+        r.reset()
+        r.getIntegrator().setValue('seed', seed)
+        r.getIntegrator().setValue('replicate', replicate)
+        return numpy.array(r.simulate(0, 10, 11))
+
+    try:
+        r = roadrunner.RoadRunner(sbml)
+        r.setIntegrator('gillespie')
+
+        first = run(r, 1234, 7)
+
+        # each replicate is a pure function of seed and replicate, so running
+        # another replicate in between does not shift it.
+        other = run(r, 1234, 8)
+        again = run(r, 1234, 7)
+
+        # and a separate instance reproduces it directly.
+        r2 = roadrunner.RoadRunner(sbml)
+        r2.setIntegrator('gillespie')
+        copy = run(r2, 1234, 7)
+
+        if not numpy.array_equal(first, again) or not numpy.array_equal(first, copy):
+            errorFlag = True
+
+        if numpy.array_equal(first, other):
+            errorFlag = True
+
+        # the same replicate number under another seed is another stream.
+        if numpy.array_equal(first, run(r, 4321, 7)):
+            errorFlag = True
+
+        # molecules are conserved on every path.
+        for a in [first, other]:
+            if not numpy.allclose(a[:,1] + a[:,2], 1000):
+                errorFlag = True
+    except Exception:
+        errorFlag = True
+
+    print(passMsg (errorFlag))
+
+
+def unitTestSparseMatrices(testDir):
+    print(string.ljust ("Check Sparse Matrices against Dense", rpadding), end="")
+    errorFlag = False
+
+    # the sparse getters return a scipy.sparse.csr_matrix, or a
+    # (data, indices, indptr, shape) tuple without scipy.
+    def toDense(m):
+        if isinstance(m, tuple):
+            data, indices, indptr, shape = m
+            result = numpy.zeros(shape)
+            for i in range(shape[0]):
+                for k in range(indptr[i], indptr[i+1]):
+                    result[i, indices[k]] = data[k]
+            return result, None, None
+        return m.toarray(), m.rownames, m.colnames
+
+    def compare(dense, sparse):
+        values, rownames, colnames = toDense(sparse)
+        if values.shape != dense.shape:
+            return False
+
+        # match the rows and columns by name where both have them.
+        if rownames is not None and len(rownames) and len(dense.rownames):
+            values = values[[list(rownames).index(n) for n in dense.rownames],:]
+        if colnames is not None and len(colnames) and len(dense.colnames):
+            values = values[:,[list(colnames).index(n) for n in dense.colnames]]
+
+        dense = numpy.array(dense)
+        nan = numpy.isnan(dense)
+        if not numpy.array_equal(nan, numpy.isnan(values)):
+            return False
+        return numpy.allclose(values[~nan], dense[~nan], rtol=1e-10, atol=1e-12)
+
+    try:
+        for conserved in [False, True]:
+            r = roadrunner.RoadRunner(os.path.join(testDir, 'Test_1.xml'))
+            r.conservedMoietyAnalysis = conserved
+            r.simulate(0, 1, 11)
+
+            pairs = [(r.getFullStoichiometryMatrix(), r.getFullStoichiometryMatrixSparse()),
+                     (r.getUnscaledElasticityMatrix(), r.getUnscaledElasticityMatrixSparse()),
+                     (r.getScaledElasticityMatrix(), r.getScaledElasticityMatrixSparse()),
+                     (r.getFullJacobian(), r.getFullJacobianSparse())]
+
+            for dense, sparse in pairs:
+                if not compare(dense, sparse):
+                    errorFlag = True
+
+            # the CSR arrays have the scipy layout, 32 bit sorted indices.
+            sparse = r.getFullStoichiometryMatrixSparse()
+            if not isinstance(sparse, tuple):
+                if (sparse.indices.dtype != numpy.int32 or
+                    sparse.indptr.dtype != numpy.int32 or
+                    not sparse.has_sorted_indices):
+                    errorFlag = True
+    except Exception:
+        errorFlag = True
+
+    print(passMsg (errorFlag))
+
+
+def unitTestRKEvents(testDir):
+    print(string.ljust ("Check RK4 and RK45 Events against CVODE", rpadding), end="")
+    errorFlag = False
+
+    math = '<math xmlns="http://www.w3.org/1998/Math/MathML">{0}</math>'
+
+    def model(events):
+        return ('<?xml version="1.0" encoding="UTF-8"?>'
+            '<sbml xmlns="http://www.sbml.org/sbml/level2/version4" level="2" version="4">'
+            '<model id="rkevents">'
+            '<listOfCompartments><compartment id="c" size="1"/></listOfCompartments>'
+            '<listOfSpecies>'
+            '<species id="X0" compartment="c" initialConcentration="2" boundaryCondition="true"/>'
+            '<species id="S1" compartment="c" initialConcentration="10"/>'
+            '<species id="S2" compartment="c" initialConcentration="0"/>'
+            '</listOfSpecies><listOfParameters>'
+            '<parameter id="k0" value="0.3"/>'
+            '<parameter id="k1" value="0.5"/>'
+            '</listOfParameters><listOfReactions>'
+            '<reaction id="J0" reversible="false">'
+            '<listOfReactants><speciesReference species="X0"/></listOfReactants>'
+            '<listOfProducts><speciesReference species="S1"/></listOfProducts>'
+            '<kineticLaw>' + math.format('<apply><times/><ci>k0</ci><ci>X0</ci></apply>') +
+            '</kineticLaw></reaction>'
+            '<reaction id="J1" reversible="false">'
+            '<listOfReactants><speciesReference species="S1"/></listOfReactants>'
+            '<listOfProducts><speciesReference species="S2"/></listOfProducts>'
+            '<kineticLaw>' + math.format('<apply><times/><ci>k1</ci><ci>S1</ci></apply>') +
+            '</kineticLaw></reaction>'
+            '</listOfReactions>' +
+            # a time triggered event between output points, and a state
+            # triggered one which resets S2.
+            ('<listOfEvents>'
+             '<event id="Etime"><trigger>' + math.format(
+                 '<apply><gt/><csymbol encoding="text" '
+                 'definitionURL="http://www.sbml.org/sbml/symbols/time">time</csymbol>'
+                 '<cn>1.37</cn></apply>') + '</trigger>'
+             '<listOfEventAssignments><eventAssignment variable="k1">' +
+             math.format('<cn>0.2</cn>') + '</eventAssignment></listOfEventAssignments></event>'
+             '<event id="Estate"><trigger>' + math.format(
+                 '<apply><gt/><ci>S2</ci><cn>4</cn></apply>') + '</trigger>'
+             '<listOfEventAssignments><eventAssignment variable="S2">' +
+             math.format('<cn>0</cn>') + '</eventAssignment></listOfEventAssignments></event>'
+             '</listOfEvents>' if events else '') +
+            '</model></sbml>')
+
+    def reference(sbml):
+        r = roadrunner.RoadRunner(sbml)
+        r.setIntegrator('cvode')
+        r.getIntegrator().setValue('relative_tolerance', 1e-10)
+        r.getIntegrator().setValue('absolute_tolerance', 1e-12)
+        return r
+
+    try:
+        # events located inside a step, both the trajectory and the number
+        # of times the state event fired must match.
+        sbml = model(True)
+        r = reference(sbml)
+        ref = numpy.array(r.simulate(0, 10, 101, ['time', 'S1', 'S2', 'k1']))
+
+        for integrator in ['rk4', 'rk45']:
+            r = roadrunner.RoadRunner(sbml)
+            r.setIntegrator(integrator)
+            result = numpy.array(r.simulate(0, 10, 101, ['time', 'S1', 'S2', 'k1']))
+
+            if result.shape != ref.shape or not numpy.allclose(result, ref, rtol=1e-4, atol=1e-6):
+                errorFlag = True
+
+        # the reference fires the state event more than once.
+        if numpy.sum(numpy.diff(ref[:,2]) < -1) < 2:
+            errorFlag = True
+
+        # RK45 continues a pending step between outputs, changing a parameter,
+        # boundary species or compartment volume in between must not.
+        sbml = model(False)
+        changes = {5 : ('k1', 2.0), 10 : ('X0', 7.0), 15 : ('c', 0.25)}
+
+        def steps(r):
+            r.reset()
+            t = 0
+            values = []
+            for i in range(20):
+                if i in changes:
+                    r[changes[i][0]] = changes[i][1]
+                t = r.oneStep(t, 0.1)
+                values.append([t, r['S1'], r['S2']])
+            return numpy.array(values)
+
+        ref = steps(reference(sbml))
+
+        r = roadrunner.RoadRunner(sbml)
+        r.setIntegrator('rk45')
+        if not numpy.allclose(steps(r), ref, rtol=1e-6, atol=1e-9):
+            errorFlag = True
+    except Exception:
+        errorFlag = True
+
+    print(passMsg (errorFlag))
+
+
+def unitTestStiffnessDetection(testDir):
+    print(string.ljust ("Check Stiffness Detection across a Dose", rpadding), end="")
+    errorFlag = False
+
+    math = '<math xmlns="http://www.w3.org/1998/Math/MathML">{0}</math>'
+
+    # S is made at a constant rate and removed at (k + D) * S. A dose of D at
+    # t = 5 makes S relax four orders of magnitude faster than it moves,
+    # which is stiff until D has decayed again, around t = 25.
+    sbml = ('<?xml version="1.0" encoding="UTF-8"?>'
+        '<sbml xmlns="http://www.sbml.org/sbml/level2/version4" level="2" version="4">'
+        '<model id="stiffdose">'
+        '<listOfCompartments><compartment id="c" size="1"/></listOfCompartments>'
+        '<listOfSpecies>'
+        '<species id="S" compartment="c" initialConcentration="0"/>'
+        '<species id="D" compartment="c" initialConcentration="0"/>'
+        '</listOfSpecies><listOfParameters>'
+        '<parameter id="k" value="1"/>'
+        '<parameter id="kd" value="0.5"/>'
+        '</listOfParameters><listOfReactions>'
+        '<reaction id="J0" reversible="false">'
+        '<listOfProducts><speciesReference species="S"/></listOfProducts>'
+        '<kineticLaw>' + math.format('<cn>1</cn>') + '</kineticLaw></reaction>'
+        '<reaction id="J1" reversible="false">'
+        '<listOfReactants><speciesReference species="S"/></listOfReactants>'
+        '<listOfModifiers><modifierSpeciesReference species="D"/></listOfModifiers>'
+        '<kineticLaw>' + math.format(
+            '<apply><times/><apply><plus/><ci>k</ci><ci>D</ci></apply><ci>S</ci></apply>') +
+        '</kineticLaw></reaction>'
+        '<reaction id="J2" reversible="false">'
+        '<listOfReactants><speciesReference species="D"/></listOfReactants>'
+        '<kineticLaw>' + math.format('<apply><times/><ci>kd</ci><ci>D</ci></apply>') +
+        '</kineticLaw></reaction>'
+        '</listOfReactions><listOfEvents>'
+        '<event id="dose"><trigger>' + math.format(
+            '<apply><gt/><csymbol encoding="text" '
+            'definitionURL="http://www.sbml.org/sbml/symbols/time">time</csymbol>'
+            '<cn>5</cn></apply>') + '</trigger>'
+        '<listOfEventAssignments><eventAssignment variable="D">' +
+        math.format('<cn>10000</cn>') + '</eventAssignment></listOfEventAssignments></event>'
+        '</listOfEvents></model></sbml>')
+
+    def run(r):
+        r.reset()
+        return numpy.array(r.simulate(0, 40, 101, ['time', 'S', 'D']))
+
+    try:
+        ref = roadrunner.RoadRunner(sbml)
+        ref.getIntegrator().setValue('stiff', True)
+        ref.getIntegrator().setValue('relative_tolerance', 1e-8)
+        ref.getIntegrator().setValue('absolute_tolerance', 1e-12)
+        expected = run(ref)
+
+        # start non-stiff, detection must switch to BDF for the dose.
+        r = roadrunner.RoadRunner(sbml)
+        r.getIntegrator().setValue('stiff', False)
+        r.getIntegrator().setValue('stiffness_detection', True)
+        r.getIntegrator().setValue('relative_tolerance', 1e-8)
+        r.getIntegrator().setValue('absolute_tolerance', 1e-12)
+
+        first = run(r)
+        c1 = r.getPerformanceCounters()
+
+        if not numpy.allclose(first, expected, rtol=1e-5, atol=1e-9):
+            errorFlag = True
+
+        # a reset starts again with the configured Adams method, so the
+        # second run switches the same way and gives the same result.
+        second = run(r)
+        c2 = r.getPerformanceCounters()
+
+        if not numpy.array_equal(first, second):
+            errorFlag = True
+
+        if r.getIntegrator().getValue('stiff'):
+            errorFlag = True
+
+        if c1['enabled']:
+            # at least into BDF for the dose.
+            if c1['integrator_method_switches'] < 1:
+                errorFlag = True
+
+            for key in ['integrator_method_switches', 'integrator_steps']:
+                if c1[key] != c2[key]:
+                    errorFlag = True
+    except Exception:
+        errorFlag = True
+
+    print(passMsg (errorFlag))
+
 
 def scriptTests():
     print("\nTesting Set and Get Functions")
@@ -1264,7 +2467,16 @@ def runTester (testDir=None):
                 print(string.ljust (testId, rpadding), 'UNKNOWN TEST')
             testId = jumpToNextTest()
 
-    for testFunc in [unitTestIntegratorSettings]:
+    for testFunc in [unitTestIntegratorSettings, unitTestSimulateResultSharing,
+                     unitTestColumnarData, unitTestColoredJacobian,
+                     unitTestSteadyStateSearch, unitTestSimulateStops, unitTestStiffInterrupt,
+                     unitTestPerfCountersAcrossEvents,
+                     unitTestParameterEstimation, unitTestValueHandles,
+                     unitTestOptimizedPipelines, unitTestPiecewiseTables,
+                     unitTestModelCache, unitTestStructureSharing,
+                     unitTestSelectionRow, unitTestStateVectorRate,
+                     unitTestGillespieReplicates, unitTestSparseMatrices,
+                     unitTestRKEvents, unitTestStiffnessDetection]:
       testFunc(testDir)
         
     print("\n\nTotal failed tests:\t", gFailedTests, \